@@ -109,6 +109,11 @@ void MaxRectsBinPack::Insert(std::vector<RectSize> &rects, std::vector<Rect> &ds
 	}
 }
 
+void MaxRectsBinPack::Occupy(const Rect &node)
+{
+	PlaceRect(node);
+}
+
 void MaxRectsBinPack::PlaceRect(const Rect &node)
 {
 	for(size_t i = 0; i < freeRectangles.size();)
@@ -48,6 +48,10 @@ public:
 	/// Inserts a single rectangle into the bin, possibly rotated.
 	Rect Insert(int width, int height, FreeRectChoiceHeuristic method);
 
+	/// Marks the given rectangle as used without searching for a position. Used to
+	/// restore the rectangles that are kept when rebuilding a bin after removals.
+	void Occupy(const Rect &node);
+
 	/// Computes the ratio of used surface area to the total bin area.
 	double Occupancy() const;
 
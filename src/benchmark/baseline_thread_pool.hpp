@@ -0,0 +1,102 @@
+#pragma once
+
+#include <concurrentqueue.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace benchmark {
+
+// Thread pool as it was before the work stealing scheduler: one shared
+// lock-free queue of std::function tasks, idle workers sleep on a mutex and
+// condition variable. Kept here only as the reference for the scheduler
+// benchmark.
+class Baseline_thread_pool
+{
+public:
+    struct Queue
+    {
+        alignas(64) std::atomic<int> task_counter{0};
+    };
+
+    explicit Baseline_thread_pool(const std::size_t size)
+        : m_threads{size}
+    {
+        for (std::size_t i = 0; i < size; ++i) {
+            m_threads[i] = std::thread([this] { thread(); });
+        }
+    }
+
+    ~Baseline_thread_pool() noexcept
+    {
+        m_stop = true;
+        m_condition.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    Baseline_thread_pool(const Baseline_thread_pool&) = delete;
+    auto operator=(const Baseline_thread_pool&) -> Baseline_thread_pool& = delete;
+
+    void enqueue(Queue* queue, std::function<void()>&& func)
+    {
+        ++queue->task_counter;
+        m_tasks.enqueue(Task{queue, std::move(func)});
+        m_condition.notify_one();
+    }
+
+    auto dequeue_and_process() -> bool
+    {
+        Task task;
+        if (!m_tasks.try_dequeue(task)) {
+            return false;
+        }
+        task.func();
+        --task.queue->task_counter;
+        return true;
+    }
+
+    void wait(Queue* queue)
+    {
+        while (queue->task_counter > 0) {
+            dequeue_and_process();
+        }
+    }
+
+private:
+    struct Task
+    {
+        Queue*                queue{nullptr};
+        std::function<void()> func;
+    };
+
+    void thread()
+    {
+        using namespace std::chrono;
+        auto time0 = high_resolution_clock::now();
+        while (!m_stop.load(std::memory_order_relaxed)) {
+            if (dequeue_and_process()) {
+                time0 = high_resolution_clock::now();
+            } else if (high_resolution_clock::now() - time0 >= microseconds(1200)) {
+                std::unique_lock<std::mutex> lock{m_queue_mutex};
+                m_condition.wait_for(lock, milliseconds(120));
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    moodycamel::ConcurrentQueue<Task> m_tasks;
+    alignas(64) std::atomic<bool>     m_stop{false};
+    std::mutex                        m_queue_mutex;
+    std::condition_variable           m_condition;
+    std::vector<std::thread>          m_threads;
+};
+
+} // namespace benchmark
@@ -0,0 +1,293 @@
+#include "buffer_allocator_benchmark.hpp"
+
+#include "erhe_graphics/buffer_allocator.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace benchmark {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+using erhe::graphics::Buffer_allocator;
+
+auto seconds_since(const Clock::time_point start) -> double
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+class Checker
+{
+public:
+    void check(const bool condition, const char* description)
+    {
+        ++check_count;
+        if (!condition) {
+            ++failure_count;
+            fmt::print("  FAILED: {}\n", description);
+        }
+    }
+
+    int check_count  {0};
+    int failure_count{0};
+};
+
+void check_basic(Checker& checker)
+{
+    Buffer_allocator allocator{1024};
+
+    const std::optional<std::size_t> a = allocator.allocate(256, 1);
+    const std::optional<std::size_t> b = allocator.allocate(256, 1);
+    const std::optional<std::size_t> c = allocator.allocate(256, 1);
+    checker.check(a == 0,   "first allocation at offset 0");
+    checker.check(b == 256, "second allocation follows first");
+    checker.check(c == 512, "third allocation follows second");
+    checker.check(allocator.free_byte_count() == 256, "free byte count after three allocations");
+
+    checker.check(allocator.free(b.value()),  "free of allocation");
+    checker.check(!allocator.free(b.value()), "double free is rejected");
+    checker.check(!allocator.free(1),         "free of unallocated offset is rejected");
+    checker.check(allocator.get_statistics().free_range_count == 2, "hole and tail are separate free ranges");
+
+    // Freeing a next to the hole coalesces the two, c next to both
+    // coalesces everything back to one range
+    checker.check(allocator.free(a.value()), "free of first allocation");
+    checker.check(allocator.get_statistics().free_range_count == 2, "first allocation coalesces with hole");
+    checker.check(allocator.get_statistics().largest_free_byte_count == 512, "coalesced hole is 512 bytes");
+    checker.check(allocator.free(c.value()), "free of third allocation");
+    const Buffer_allocator::Statistics statistics = allocator.get_statistics();
+    checker.check(statistics.free_range_count == 1,           "all free ranges coalesce to one");
+    checker.check(statistics.largest_free_byte_count == 1024, "coalesced range covers capacity");
+    checker.check(statistics.allocation_count == 0,           "no allocations left");
+    checker.check(statistics.fragmentation() == 0.0f,         "no fragmentation when empty");
+    checker.check(statistics.high_water_mark == 768,          "high water mark is kept after free");
+
+    checker.check(!allocator.allocate(0, 1).has_value(), "zero byte allocation is rejected");
+    checker.check(!allocator.allocate(1, 0).has_value(), "zero alignment is rejected");
+}
+
+void check_alignment(Checker& checker)
+{
+    Buffer_allocator allocator{4096};
+
+    const std::optional<std::size_t> a = allocator.allocate(3, 1);
+    const std::optional<std::size_t> b = allocator.allocate(16, 256);
+    const std::optional<std::size_t> c = allocator.allocate(5, 12); // non power of two alignment
+    checker.check(a == 0,                                        "unaligned allocation at offset 0");
+    checker.check(b.has_value() && (b.value() % 256 == 0),       "allocation aligned to 256");
+    checker.check(c.has_value() && (c.value() % 12 == 0),        "allocation aligned to 12");
+    checker.check(b.has_value() && (b.value() >= 3),             "aligned allocation does not overlap previous");
+
+    // Padding is returned with the allocation
+    checker.check(allocator.free(b.value()), "free of aligned allocation");
+    checker.check(allocator.free(c.value()), "free of allocation aligned to 12");
+    checker.check(allocator.free(a.value()), "free of unaligned allocation");
+    checker.check(allocator.free_byte_count() == 4096, "padding is released with allocation");
+    checker.check(allocator.get_statistics().free_range_count == 1, "padding coalesces");
+}
+
+void check_exhaustion(Checker& checker)
+{
+    {
+        Buffer_allocator allocator{1000};
+        // Allocation of exactly the capacity, with alignment larger than
+        // the capacity, fits only through the lower bin fallback
+        const std::optional<std::size_t> all = allocator.allocate(1000, 4096);
+        checker.check(all == 0, "allocation of whole capacity with large alignment");
+        checker.check(!allocator.allocate(1, 1).has_value(), "allocation fails when full");
+        checker.check(allocator.free_byte_count() == 0, "no free bytes when full");
+        checker.check(allocator.free(all.value()), "free of whole capacity");
+        checker.check(!allocator.allocate(1001, 1).has_value(), "allocation above capacity fails");
+        checker.check(!allocator.allocate(SIZE_MAX, 16).has_value(), "allocation with overflowing padding fails");
+    }
+    {
+        // Eight 16 byte free ranges: 17 bytes do not fit even though 128
+        // bytes are free, 16 bytes aligned to 16 fit only through the exact
+        // check of the lower bin
+        Buffer_allocator allocator{256};
+        std::vector<std::size_t> offsets;
+        for (int i = 0; i < 16; ++i) {
+            offsets.push_back(allocator.allocate(16, 1).value_or(SIZE_MAX));
+        }
+        checker.check(!allocator.allocate(1, 1).has_value(), "sixteen allocations fill capacity");
+        for (std::size_t i = 0; i < offsets.size(); i += 2) {
+            allocator.free(offsets[i]);
+        }
+        checker.check(allocator.free_byte_count() == 128, "every other allocation freed");
+        checker.check(!allocator.allocate(17, 1).has_value(), "fragmented free space does not fit larger range");
+        const std::optional<std::size_t> fit = allocator.allocate(16, 16);
+        checker.check(fit.has_value() && (fit.value() % 16 == 0), "exact fit in fragmented free space");
+    }
+    {
+        Buffer_allocator allocator{100};
+        const std::optional<std::size_t> a = allocator.allocate(10, 1);
+        const std::optional<std::size_t> b = allocator.allocate(40, 1);
+        const std::optional<std::size_t> c = allocator.allocate(50, 1);
+        checker.check(a.has_value() && (b == 10) && c.has_value(), "three allocations fill capacity");
+        allocator.free(b.value());
+        checker.check(!allocator.allocate(40, 32).has_value(), "freed range too small once aligned");
+        checker.check(allocator.allocate(16, 32) == 32, "aligned allocation in freed range");
+        allocator.reset();
+        checker.check(allocator.get_statistics().largest_free_byte_count == 100, "reset frees everything");
+    }
+}
+
+// Validates allocations against each other and against allocator statistics
+auto validate(
+    const Buffer_allocator&                     allocator,
+    const std::map<std::size_t, std::size_t>&   allocations, // offset -> byte count
+    const std::size_t                           capacity
+) -> bool
+{
+    std::size_t end = 0;
+    for (const auto& [offset, byte_count] : allocations) {
+        if ((offset < end) || (offset + byte_count > capacity)) {
+            return false;
+        }
+        end = offset + byte_count;
+    }
+    const Buffer_allocator::Statistics statistics = allocator.get_statistics();
+    return
+        (statistics.allocation_count == allocations.size()) &&
+        (statistics.free_byte_count + statistics.allocated_byte_count == capacity) &&
+        (statistics.largest_free_byte_count <= statistics.free_byte_count) &&
+        ((statistics.free_range_count == 0) == (statistics.free_byte_count == 0));
+}
+
+void check_random(Checker& checker)
+{
+    const std::size_t                  capacity = 64 * 1024;
+    Buffer_allocator                   allocator{capacity};
+    std::map<std::size_t, std::size_t> allocations;
+    std::mt19937                       random{1};
+    std::uniform_int_distribution<int> size_distribution     {1, 2048};
+    std::uniform_int_distribution<int> alignment_distribution{0, 8};
+    int                                failure_count{0};
+    int                                alignment_failure_count{0};
+    int                                allocate_failure_count{0};
+
+    for (int i = 0; i < 100'000; ++i) {
+        const bool do_free = !allocations.empty() && ((random() % 2) == 0);
+        if (do_free) {
+            auto j = allocations.begin();
+            std::advance(j, random() % allocations.size());
+            if (!allocator.free(j->first)) {
+                ++failure_count;
+            }
+            allocations.erase(j);
+        } else {
+            const std::size_t                byte_count = static_cast<std::size_t>(size_distribution(random));
+            const std::size_t                alignment  = std::size_t{1} << alignment_distribution(random);
+            const std::optional<std::size_t> offset     = allocator.allocate(byte_count, alignment);
+            if (offset.has_value()) {
+                if (offset.value() % alignment != 0) {
+                    ++alignment_failure_count;
+                }
+                allocations.emplace(offset.value(), byte_count);
+            } else if (allocator.get_statistics().largest_free_byte_count >= byte_count + alignment - 1) {
+                // A free range which fits even with worst case padding exists
+                ++allocate_failure_count;
+            }
+        }
+        if (!validate(allocator, allocations, capacity)) {
+            ++failure_count;
+        }
+    }
+    checker.check(failure_count           == 0, "random operations keep allocations disjoint and statistics consistent");
+    checker.check(alignment_failure_count == 0, "random allocations are aligned");
+    checker.check(allocate_failure_count  == 0, "random allocations succeed when a large enough range is free");
+
+    for (const auto& [offset, byte_count] : allocations) {
+        allocator.free(offset);
+    }
+    const Buffer_allocator::Statistics statistics = allocator.get_statistics();
+    checker.check(
+        (statistics.free_range_count == 1) && (statistics.largest_free_byte_count == capacity),
+        "random operations coalesce back to one range"
+    );
+}
+
+auto run_timing(const Buffer_allocator_benchmark_config& config, const int allocation_count) -> bool
+{
+    Buffer_allocator                   allocator{config.capacity};
+    std::vector<std::size_t>           offsets;
+    std::mt19937                       random{2};
+    std::uniform_int_distribution<int> size_distribution     {16, 1024};
+    std::uniform_int_distribution<int> alignment_distribution{0, 8};
+    offsets.reserve(static_cast<std::size_t>(allocation_count));
+
+    for (int i = 0; i < allocation_count; ++i) {
+        const std::optional<std::size_t> offset = allocator.allocate(
+            static_cast<std::size_t>(size_distribution(random)),
+            std::size_t{1} << alignment_distribution(random)
+        );
+        if (!offset.has_value()) {
+            fmt::print("{:>11} capacity too small\n", allocation_count);
+            return false;
+        }
+        offsets.push_back(offset.value());
+    }
+
+    std::size_t failed_count = 0;
+    const Clock::time_point start = Clock::now();
+    for (int i = 0; i < config.operation_count; ++i) {
+        std::size_t& slot = offsets[random() % offsets.size()];
+        allocator.free(slot);
+        const std::optional<std::size_t> offset = allocator.allocate(
+            static_cast<std::size_t>(size_distribution(random)),
+            std::size_t{1} << alignment_distribution(random)
+        );
+        if (offset.has_value()) {
+            slot = offset.value();
+        } else {
+            ++failed_count;
+        }
+    }
+    const double time = seconds_since(start);
+
+    const Buffer_allocator::Statistics statistics = allocator.get_statistics();
+    fmt::print(
+        "{:>11} {:>10.1f} {:>11} {:>13.3f} {:>12}\n",
+        allocation_count,
+        time * 1'000'000'000.0 / static_cast<double>(std::max(config.operation_count, 1)),
+        statistics.free_range_count,
+        statistics.fragmentation(),
+        failed_count
+    );
+    return true;
+}
+
+} // anonymous namespace
+
+auto run_buffer_allocator_benchmark(const Buffer_allocator_benchmark_config& config) -> int
+{
+    Checker checker;
+    fmt::print("Buffer allocator checks\n");
+    check_basic     (checker);
+    check_alignment (checker);
+    check_exhaustion(checker);
+    check_random    (checker);
+    fmt::print("  {} of {} checks passed\n", checker.check_count - checker.failure_count, checker.check_count);
+
+    fmt::print("\nBuffer allocator: random free + allocate, capacity {} bytes\n", config.capacity);
+    fmt::print("{:>11} {:>10} {:>11} {:>13} {:>12}\n", "allocations", "ns/op pair", "free ranges", "fragmentation", "failed alloc");
+    bool timing_ok = true;
+    for (const int allocation_count : config.allocation_counts) {
+        if (!run_timing(config, allocation_count)) {
+            timing_ok = false;
+        }
+    }
+    return ((checker.failure_count == 0) && timing_ok) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+} // namespace benchmark
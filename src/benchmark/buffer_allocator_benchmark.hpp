@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace benchmark {
+
+class Buffer_allocator_benchmark_config
+{
+public:
+    std::vector<int> allocation_counts{1000, 10000, 100000};
+    int              operation_count  {1'000'000};
+    std::size_t      capacity         {256 * 1024 * 1024};
+};
+
+// Checks: allocate and free, coalescing of neighbouring free ranges,
+// alignment, exhaustion and double free, then a randomized run which
+// validates allocator invariants against a reference list of allocations
+// after every operation.
+// Timing: with allocation count live allocations of random size and
+// alignment, times random free + allocate pairs and reports fragmentation.
+// Returns EXIT_FAILURE if any check fails.
+auto run_buffer_allocator_benchmark(const Buffer_allocator_benchmark_config& config) -> int;
+
+} // namespace benchmark
@@ -0,0 +1,203 @@
+#include "commands_benchmark.hpp"
+
+#include "erhe_commands/command.hpp"
+#include "erhe_commands/commands.hpp"
+#include "erhe_commands/input_arguments.hpp"
+#include "erhe_window/window_event_handler.hpp"
+
+#include <fmt/format.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace benchmark {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int                   bound_command_count = 64;
+constexpr erhe::window::Keycode unused_keycode_base = 0x10000;
+
+class Benchmark_command : public erhe::commands::Command
+{
+public:
+    Benchmark_command(erhe::commands::Commands& commands, const int index, uint64_t& call_hash)
+        : Command    {commands, fmt::format("command {}", index)}
+        , m_index    {static_cast<uint64_t>(index)}
+        , m_call_hash{call_hash}
+    {
+    }
+
+    // Never consumes, so every matching binding is visited. Call order is
+    // hashed, so that dispatch order can be compared between versions.
+    auto try_call_with_input(erhe::commands::Input_arguments& input) -> bool override
+    {
+        static_cast<void>(input);
+        m_call_hash = (m_call_hash ^ m_index) * 0x100000001b3ull;
+        ++call_count;
+        return false;
+    }
+
+    uint64_t call_count{0};
+
+private:
+    uint64_t  m_index;
+    uint64_t& m_call_hash;
+};
+
+enum class Event_type : unsigned int
+{
+    key,
+    mouse_move,
+    mouse_button,
+    mouse_wheel
+};
+
+class Event
+{
+public:
+    Event_type type;
+    int        value;
+    bool       pressed;
+    float      x;
+    float      y;
+};
+
+// Deterministic stream: mostly mouse motion, with typing, wheel and drags
+auto make_events(const int event_count) -> std::vector<Event>
+{
+    std::vector<Event> events;
+    events.reserve(static_cast<std::size_t>(event_count));
+    uint32_t state = 0x12345678u;
+    auto next = [&state]() -> uint32_t {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    };
+    float x = 0.0f;
+    float y = 0.0f;
+    int   held_button  = -1;
+    int   drag_remains = 0;
+    while (static_cast<int>(events.size()) < event_count) {
+        const uint32_t r = next() % 100;
+        if (held_button >= 0) {
+            if (--drag_remains <= 0) {
+                events.push_back(Event{Event_type::mouse_button, held_button, false, 0.0f, 0.0f});
+                held_button = -1;
+                continue;
+            }
+        } else if (r < 2) {
+            held_button  = static_cast<int>(next() % 3);
+            drag_remains = 10 + static_cast<int>(next() % 30);
+            events.push_back(Event{Event_type::mouse_button, held_button, true, 0.0f, 0.0f});
+            continue;
+        }
+        if (r < 70) {
+            x += static_cast<float>(static_cast<int>(next() % 9) - 4);
+            y += static_cast<float>(static_cast<int>(next() % 9) - 4);
+            events.push_back(Event{Event_type::mouse_move, 0, false, x, y});
+        } else if (r < 90) {
+            const int key = erhe::window::Key_a + static_cast<int>(next() % 26);
+            events.push_back(Event{Event_type::key, key, true,  0.0f, 0.0f});
+            events.push_back(Event{Event_type::key, key, false, 0.0f, 0.0f});
+        } else {
+            events.push_back(Event{Event_type::mouse_wheel, 0, false, 0.0f, (r & 1) ? 1.0f : -1.0f});
+        }
+    }
+    events.resize(static_cast<std::size_t>(event_count));
+    return events;
+}
+
+} // anonymous namespace
+
+auto run_commands_benchmark(const Commands_benchmark_config& config) -> int
+{
+    const std::vector<Event> events = make_events(config.event_count);
+
+    fmt::print("Commands: {} replayed input events\n", config.event_count);
+    fmt::print("{:>9} {:>9} {:>14} {:>10} {:>14} {:>18}\n", "commands", "bindings", "events/s", "ns/event", "command calls", "call order hash");
+    for (const int command_count : config.command_counts) {
+        erhe::commands::Commands commands;
+        uint64_t                 call_hash{0xcbf29ce484222325ull};
+        std::vector<std::unique_ptr<Benchmark_command>> command_list;
+        int binding_count = 0;
+        for (int i = 0; i < command_count; ++i) {
+            auto& command = command_list.emplace_back(
+                std::make_unique<Benchmark_command>(commands, i, call_hash)
+            );
+            commands.register_command(command.get());
+
+            // A fixed set of commands is bound to the replayed inputs. The
+            // rest are bound to keys which are never pressed, so dispatch
+            // cost should not grow with the command count.
+            if (i < bound_command_count) {
+                const erhe::window::Keycode key = erhe::window::Key_a + (i % 26);
+                if ((i % 2) == 0) {
+                    commands.bind_command_to_key(command.get(), key, true, erhe::window::Key_modifier_bit_ctrl);
+                } else {
+                    commands.bind_command_to_key(command.get(), key, (i % 4) == 1);
+                }
+                const erhe::window::Mouse_button button = static_cast<erhe::window::Mouse_button>(i % 3);
+                if ((i % 8) == 1) {
+                    commands.bind_command_to_mouse_button(command.get(), button, (i % 16) == 1);
+                    ++binding_count;
+                }
+                if ((i % 8) == 3) {
+                    commands.bind_command_to_mouse_drag(command.get(), button, false);
+                    ++binding_count;
+                }
+                if ((i % 16) == 5) {
+                    commands.bind_command_to_mouse_motion(command.get());
+                    ++binding_count;
+                }
+                if ((i % 32) == 7) {
+                    commands.bind_command_to_mouse_wheel(command.get());
+                    ++binding_count;
+                }
+            } else {
+                commands.bind_command_to_key(command.get(), unused_keycode_base + i);
+            }
+            ++binding_count;
+        }
+        commands.sort_bindings();
+
+        // One frame per 16 input events
+        const Clock::time_point start = Clock::now();
+        std::size_t event_index = 0;
+        for (const Event& event : events) {
+            if ((++event_index % 16) == 0) {
+                commands.on_idle();
+            }
+            switch (event.type) {
+                case Event_type::key:          commands.on_key(event.value, 0, event.pressed); break;
+                case Event_type::mouse_move:   commands.on_mouse_move(event.x, event.y); break;
+                case Event_type::mouse_button: commands.on_mouse_button(static_cast<erhe::window::Mouse_button>(event.value), event.pressed); break;
+                case Event_type::mouse_wheel:  commands.on_mouse_wheel(event.x, event.y); break;
+            }
+        }
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        uint64_t call_count = 0;
+        for (const auto& command : command_list) {
+            call_count += command->call_count;
+        }
+        fmt::print(
+            "{:>9} {:>9} {:>14.0f} {:>10.1f} {:>14} {:>18x}\n",
+            command_count,
+            binding_count,
+            static_cast<double>(events.size()) / elapsed,
+            elapsed * 1'000'000'000.0 / static_cast<double>(events.size()),
+            call_count,
+            call_hash
+        );
+    }
+    return EXIT_SUCCESS;
+}
+
+} // namespace benchmark
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <vector>
+
+namespace benchmark {
+
+class Commands_benchmark_config
+{
+public:
+    std::vector<int> command_counts{100, 1000, 10000};
+    int              event_count   {1'000'000};
+};
+
+// Replays a deterministic stream of key, mouse move, button, drag and wheel
+// events through erhe::commands::Commands and reports events/sec. Number of
+// bindings matching the events is fixed, other commands add only bindings
+// which never match.
+auto run_commands_benchmark(const Commands_benchmark_config& config) -> int;
+
+} // namespace benchmark
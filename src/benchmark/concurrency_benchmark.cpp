@@ -0,0 +1,154 @@
+#include "concurrency_benchmark.hpp"
+#include "baseline_thread_pool.hpp"
+
+#include "erhe_concurrency/concurrent_queue.hpp"
+#include "erhe_concurrency/thread_pool.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+namespace benchmark {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int children_per_task = 64;
+
+thread_local uint64_t t_sink{0};
+
+void spin(const int work)
+{
+    uint64_t x = t_sink | 1u;
+    for (int i = 0; i < work; ++i) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+    t_sink = x;
+}
+
+auto seconds_since(const Clock::time_point start) -> double
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Main thread enqueues every task, then helps until the queue is drained
+auto flat_scheduler(erhe::concurrency::Thread_pool& pool, const Concurrency_benchmark_config& config) -> double
+{
+    erhe::concurrency::Concurrent_queue queue{pool, "benchmark.flat"};
+    const int work = config.task_work;
+    const Clock::time_point start = Clock::now();
+    for (int i = 0; i < config.task_count; ++i) {
+        queue.enqueue([work]() { spin(work); });
+    }
+    queue.wait();
+    return seconds_since(start);
+}
+
+auto flat_baseline(Baseline_thread_pool& pool, const Concurrency_benchmark_config& config) -> double
+{
+    Baseline_thread_pool::Queue queue;
+    const int work = config.task_work;
+    const Clock::time_point start = Clock::now();
+    for (int i = 0; i < config.task_count; ++i) {
+        pool.enqueue(&queue, [work]() { spin(work); });
+    }
+    pool.wait(&queue);
+    return seconds_since(start);
+}
+
+// Each root task enqueues its children from a worker thread
+auto nested_scheduler(erhe::concurrency::Thread_pool& pool, const Concurrency_benchmark_config& config) -> double
+{
+    erhe::concurrency::Concurrent_queue queue{pool, "benchmark.nested"};
+    const int work       = config.task_work;
+    const int root_count = std::max(1, config.task_count / (children_per_task + 1));
+    const Clock::time_point start = Clock::now();
+    for (int i = 0; i < root_count; ++i) {
+        queue.enqueue([&queue, work]() {
+            for (int j = 0; j < children_per_task; ++j) {
+                queue.enqueue_child([work]() { spin(work); });
+            }
+            spin(work);
+        });
+    }
+    queue.wait();
+    return seconds_since(start);
+}
+
+auto nested_baseline(Baseline_thread_pool& pool, const Concurrency_benchmark_config& config) -> double
+{
+    Baseline_thread_pool::Queue queue;
+    const int work       = config.task_work;
+    const int root_count = std::max(1, config.task_count / (children_per_task + 1));
+    const Clock::time_point start = Clock::now();
+    for (int i = 0; i < root_count; ++i) {
+        pool.enqueue(&queue, [&pool, &queue, work]() {
+            for (int j = 0; j < children_per_task; ++j) {
+                pool.enqueue(&queue, [work]() { spin(work); });
+            }
+            spin(work);
+        });
+    }
+    pool.wait(&queue);
+    return seconds_since(start);
+}
+
+template <typename Pool, typename Run>
+auto best_of(Pool& pool, const Concurrency_benchmark_config& config, Run run) -> double
+{
+    double best = 0.0;
+    for (int i = 0; i < std::max(1, config.repeat_count); ++i) {
+        const double elapsed = run(pool, config);
+        best = (i == 0) ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+} // anonymous namespace
+
+auto run_concurrency_benchmark(const Concurrency_benchmark_config& config) -> int
+{
+    const int    root_count   = std::max(1, config.task_count / (children_per_task + 1));
+    const double flat_tasks   = static_cast<double>(config.task_count);
+    const double nested_tasks = static_cast<double>(root_count * (children_per_task + 1));
+
+    fmt::print(
+        "Thread_pool: {} tasks of {} xorshift rounds, best of {}, hardware concurrency {}\n",
+        config.task_count, config.task_work, config.repeat_count, std::thread::hardware_concurrency()
+    );
+    fmt::print("{:>8} {:>8} {:>14} {:>14} {:>8}\n", "threads", "workload", "baseline/s", "scheduler/s", "ratio");
+    for (const int thread_count : config.thread_counts) {
+        const std::size_t size = static_cast<std::size_t>(std::max(1, thread_count));
+        double flat_old  {0.0};
+        double nested_old{0.0};
+        {
+            Baseline_thread_pool pool{size};
+            flat_old   = best_of(pool, config, flat_baseline);
+            nested_old = best_of(pool, config, nested_baseline);
+        }
+        double flat_new  {0.0};
+        double nested_new{0.0};
+        {
+            erhe::concurrency::Thread_pool pool{size};
+            flat_new   = best_of(pool, config, flat_scheduler);
+            nested_new = best_of(pool, config, nested_scheduler);
+        }
+        fmt::print(
+            "{:>8} {:>8} {:>14.0f} {:>14.0f} {:>8.2f}\n",
+            thread_count, "flat", flat_tasks / flat_old, flat_tasks / flat_new, flat_old / flat_new
+        );
+        fmt::print(
+            "{:>8} {:>8} {:>14.0f} {:>14.0f} {:>8.2f}\n",
+            thread_count, "nested", nested_tasks / nested_old, nested_tasks / nested_new, nested_old / nested_new
+        );
+    }
+    return EXIT_SUCCESS;
+}
+
+} // namespace benchmark
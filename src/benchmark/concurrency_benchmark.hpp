@@ -0,0 +1,20 @@
+#pragma once
+
+#include <vector>
+
+namespace benchmark {
+
+class Concurrency_benchmark_config
+{
+public:
+    std::vector<int> thread_counts{1, 2, 4, 8, 16, 32, 64};
+    int              task_count   {1'000'000};
+    int              task_work    {100};
+    int              repeat_count {3};
+};
+
+// Reports tasks/sec of erhe::concurrency::Thread_pool and of the previous
+// mutex/condition variable pool for flat and nested (fork-join) workloads
+auto run_concurrency_benchmark(const Concurrency_benchmark_config& config) -> int;
+
+} // namespace benchmark
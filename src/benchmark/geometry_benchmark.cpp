@@ -0,0 +1,270 @@
+#include "geometry_benchmark.hpp"
+
+#include "erhe_concurrency/thread_pool.hpp"
+#include "erhe_geometry/geometry.hpp"
+#include "erhe_geometry/operation/ambo.hpp"
+#include "erhe_geometry/operation/catmull_clark_subdivision.hpp"
+#include "erhe_geometry/operation/dual.hpp"
+#include "erhe_geometry/operation/gyro.hpp"
+#include "erhe_geometry/operation/join.hpp"
+#include "erhe_geometry/operation/kis.hpp"
+#include "erhe_geometry/operation/meta.hpp"
+#include "erhe_geometry/operation/sqrt3_subdivision.hpp"
+#include "erhe_geometry/operation/subdivide.hpp"
+#include "erhe_geometry/operation/triangulate.hpp"
+#include "erhe_geometry/operation/truncate.hpp"
+#include "erhe_geometry/shapes/torus.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace benchmark {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+using erhe::geometry::Edge_id;
+using erhe::geometry::Geometry;
+using erhe::geometry::Point_id;
+
+auto seconds_since(const Clock::time_point start) -> double
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+auto side_for(const int polygon_count) -> int
+{
+    return std::max(1, static_cast<int>(std::lround(std::sqrt(static_cast<double>(polygon_count)))));
+}
+
+// Quad grid of side x side polygons. An open grid has unshared boundary
+// edges, so build_edges() runs its second pass. A closed grid wraps around
+// in both directions (torus topology), so every edge is shared.
+auto make_grid(const int side, const bool closed) -> Geometry
+{
+    Geometry geometry{closed ? "closed grid" : "open grid"};
+    const int row = closed ? side : side + 1;
+    for (int y = 0; y < row; ++y) {
+        for (int x = 0; x < row; ++x) {
+            geometry.make_point(static_cast<float>(x), static_cast<float>(y), 0.0f);
+        }
+    }
+    const auto point = [row](const int x, const int y) -> Point_id {
+        return static_cast<Point_id>((x % row) + (y % row) * row);
+    };
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            geometry.make_polygon({point(x, y), point(x + 1, y), point(x + 1, y + 1), point(x, y + 1)});
+        }
+    }
+    geometry.make_point_corners();
+    return geometry;
+}
+
+// Point pairs of every polygon edge, as visited by build_edges() second pass
+auto collect_corner_edges(Geometry& geometry) -> std::vector<std::pair<Point_id, Point_id>>
+{
+    std::vector<std::pair<Point_id, Point_id>> corner_edges;
+    geometry.for_each_polygon([&](auto& i) {
+        i.polygon.for_each_corner_neighborhood(geometry, [&](auto& j) {
+            corner_edges.emplace_back(j.prev_corner.point_id, j.corner.point_id);
+        });
+    });
+    return corner_edges;
+}
+
+// find_edge() before the edge index
+auto find_edge_id_linear(const Geometry& geometry, Point_id a, Point_id b) -> std::optional<Edge_id>
+{
+    if (b < a) {
+        std::swap(a, b);
+    }
+    for (Edge_id edge_id = 0, end = geometry.get_edge_count(); edge_id < end; ++edge_id) {
+        const auto& edge = geometry.edges[edge_id];
+        if ((edge.a == a) && (edge.b == b)) {
+            return edge_id;
+        }
+    }
+    return {};
+}
+
+void run_edge_lookup(const Geometry_benchmark_config& config, const int polygon_count, const bool closed)
+{
+    Geometry geometry = make_grid(side_for(polygon_count), closed);
+
+    Clock::time_point start = Clock::now();
+    geometry.build_edges();
+    const double build_time = seconds_since(start);
+
+    const std::vector<std::pair<Point_id, Point_id>> corner_edges = collect_corner_edges(geometry);
+
+    std::vector<std::optional<Edge_id>> index_results(corner_edges.size());
+    start = Clock::now();
+    for (std::size_t i = 0, end = corner_edges.size(); i < end; ++i) {
+        index_results[i] = geometry.find_edge_id(corner_edges[i].first, corner_edges[i].second);
+    }
+    const double index_time = seconds_since(start);
+    const double index_ns   = index_time * 1'000'000'000.0 / static_cast<double>(corner_edges.size());
+
+    std::size_t not_found_count = 0;
+    for (const std::optional<Edge_id>& result : index_results) {
+        if (!result.has_value()) {
+            ++not_found_count;
+        }
+    }
+
+    const bool run_linear = static_cast<int>(geometry.get_polygon_count()) <= config.linear_polygon_limit;
+    if (!run_linear) {
+        fmt::print(
+            "{:>6} {:>9} {:>9} {:>11.2f} {:>12.1f} {:>13} {:>8} {:>9} {:>10}\n",
+            closed ? "closed" : "open",
+            geometry.get_polygon_count(),
+            geometry.get_edge_count(),
+            build_time * 1000.0,
+            index_ns,
+            "skipped",
+            "-",
+            not_found_count,
+            "-"
+        );
+        return;
+    }
+
+    std::size_t mismatch_count = 0;
+    start = Clock::now();
+    for (std::size_t i = 0, end = corner_edges.size(); i < end; ++i) {
+        const std::optional<Edge_id> result = find_edge_id_linear(geometry, corner_edges[i].first, corner_edges[i].second);
+        if (result != index_results[i]) {
+            ++mismatch_count;
+        }
+    }
+    const double linear_time = seconds_since(start);
+    const double linear_ns   = linear_time * 1'000'000'000.0 / static_cast<double>(corner_edges.size());
+
+    fmt::print(
+        "{:>6} {:>9} {:>9} {:>11.2f} {:>12.1f} {:>13.1f} {:>7.1f}x {:>9} {:>10}\n",
+        closed ? "closed" : "open",
+        geometry.get_polygon_count(),
+        geometry.get_edge_count(),
+        build_time * 1000.0,
+        index_ns,
+        linear_ns,
+        (index_ns > 0.0) ? linear_ns / index_ns : 0.0,
+        not_found_count,
+        mismatch_count
+    );
+}
+
+using Operation = std::function<Geometry(Geometry&, erhe::concurrency::Thread_pool*)>;
+
+// join and triangulate have no parallel version and ignore the thread pool
+auto find_operator(const std::string& name) -> Operation
+{
+    namespace operation = erhe::geometry::operation;
+    using erhe::concurrency::Thread_pool;
+    if (name == "ambo"         ) { return [](Geometry& source, Thread_pool* pool) { return operation::ambo                     (source, pool); }; }
+    if (name == "catmull_clark") { return [](Geometry& source, Thread_pool* pool) { return operation::catmull_clark_subdivision(source, pool); }; }
+    if (name == "dual"         ) { return [](Geometry& source, Thread_pool* pool) { return operation::dual                     (source, pool); }; }
+    if (name == "gyro"         ) { return [](Geometry& source, Thread_pool* pool) { return operation::gyro                     (source, pool); }; }
+    if (name == "join"         ) { return [](Geometry& source, Thread_pool*     ) { return operation::join                     (source);       }; }
+    if (name == "kis"          ) { return [](Geometry& source, Thread_pool* pool) { return operation::kis                      (source, pool); }; }
+    if (name == "meta"         ) { return [](Geometry& source, Thread_pool* pool) { return operation::meta                     (source, pool); }; }
+    if (name == "sqrt3"        ) { return [](Geometry& source, Thread_pool* pool) { return operation::sqrt3_subdivision        (source, pool); }; }
+    if (name == "subdivide"    ) { return [](Geometry& source, Thread_pool* pool) { return operation::subdivide                (source, pool); }; }
+    if (name == "triangulate"  ) { return [](Geometry& source, Thread_pool*     ) { return operation::triangulate              (source);       }; }
+    if (name == "truncate"     ) { return [](Geometry& source, Thread_pool* pool) { return operation::truncate                 (source, pool); }; }
+    return {};
+}
+
+} // anonymous namespace
+
+auto run_geometry_benchmark(const Geometry_benchmark_config& config) -> int
+{
+    fmt::print("Geometry edge lookup: linear lookup up to {} polygons\n", config.linear_polygon_limit);
+    fmt::print(
+        "{:>6} {:>9} {:>9} {:>11} {:>12} {:>13} {:>8} {:>9} {:>10}\n",
+        "grid", "polygons", "edges", "build ms", "index ns/op", "linear ns/op", "speedup", "not found", "mismatches"
+    );
+    for (const int polygon_count : config.polygon_counts) {
+        run_edge_lookup(config, polygon_count, false);
+        run_edge_lookup(config, polygon_count, true);
+    }
+
+    // Thread count 1 runs the operators serially, without a thread pool
+    std::vector<int>                                             thread_counts;
+    std::vector<std::unique_ptr<erhe::concurrency::Thread_pool>> thread_pools;
+    for (const int requested_count : config.operator_thread_counts) {
+        const int thread_count = (requested_count > 0)
+            ? requested_count
+            : static_cast<int>(std::max(std::thread::hardware_concurrency(), 1U));
+        thread_counts.push_back(thread_count);
+        thread_pools.push_back(
+            (thread_count > 1)
+                ? std::make_unique<erhe::concurrency::Thread_pool>(static_cast<std::size_t>(thread_count))
+                : std::unique_ptr<erhe::concurrency::Thread_pool>{}
+        );
+    }
+
+    int result = EXIT_SUCCESS;
+    for (const int polygon_count : config.operator_polygon_counts) {
+        const int side = side_for(polygon_count);
+        Geometry source = erhe::geometry::shapes::make_torus(1.0, 0.25, side, side);
+        fmt::print("\nGeometry operators: torus with {} polygons, ms per thread count\n", source.get_polygon_count());
+        fmt::print("{:>13} {:>9} {:>9}", "operator", "polygons", "edges");
+        for (const int thread_count : thread_counts) {
+            fmt::print(" {:>9}", fmt::format("{} thr", thread_count));
+        }
+        fmt::print(" {:>8} {:>10}\n", "speedup", "mismatches");
+        for (const std::string& name : config.operators) {
+            const Operation operation = find_operator(name);
+            if (!operation) {
+                fmt::print("{:>13} unknown operator\n", name);
+                result = EXIT_FAILURE;
+                continue;
+            }
+            std::vector<double> times;
+            uint32_t            polygon_count_out{0};
+            uint32_t            edge_count_out   {0};
+            std::size_t         mismatch_count   {0};
+            for (std::size_t i = 0, end = thread_pools.size(); i < end; ++i) {
+                const Clock::time_point start       = Clock::now();
+                const Geometry          destination = operation(source, thread_pools[i].get());
+                times.push_back(seconds_since(start));
+                if (i == 0) {
+                    polygon_count_out = destination.get_polygon_count();
+                    edge_count_out    = destination.get_edge_count();
+                } else if (
+                    (destination.get_polygon_count() != polygon_count_out) ||
+                    (destination.get_edge_count()    != edge_count_out)
+                ) {
+                    ++mismatch_count;
+                }
+            }
+            fmt::print("{:>13} {:>9} {:>9}", name, polygon_count_out, edge_count_out);
+            for (const double time : times) {
+                fmt::print(" {:>9.2f}", time * 1000.0);
+            }
+            const double speedup = (!times.empty() && (times.back() > 0.0)) ? times.front() / times.back() : 0.0;
+            fmt::print(" {:>7.1f}x {:>10}\n", speedup, mismatch_count);
+            if (mismatch_count > 0) {
+                result = EXIT_FAILURE;
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace benchmark
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace benchmark {
+
+class Geometry_benchmark_config
+{
+public:
+    std::vector<int>         polygon_counts         {1000, 10000, 100000, 1000000};
+    std::vector<int>         operator_polygon_counts{100'000, 1'000'000};
+    std::vector<int>         operator_thread_counts {1, 0}; // 0 selects hardware concurrency
+    std::vector<std::string> operators{
+        "ambo", "catmull_clark", "dual", "gyro", "join", "kis", "meta", "sqrt3", "subdivide", "triangulate", "truncate"
+    };
+    int                      linear_polygon_limit   {10'000};
+};
+
+// Edge lookup: times build_edges() on an open quad grid (which needs the
+// second, find_edge() based pass) and on a closed grid, then looks up the
+// edge of every corner through the edge index and, up to the linear polygon
+// limit, through a linear scan of the edges as find_edge() did before the
+// edge index. Lookup results of the two are compared.
+// Operators: times each operator on a torus of the given polygon counts,
+// once per thread count, and reports the speedup of the last thread count
+// over the first. Output polygon and edge counts are compared between
+// thread counts.
+auto run_geometry_benchmark(const Geometry_benchmark_config& config) -> int;
+
+} // namespace benchmark
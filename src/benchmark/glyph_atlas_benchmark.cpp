@@ -0,0 +1,447 @@
+#include "glyph_atlas_benchmark.hpp"
+
+#include "erhe_ui/bitmap.hpp"
+#include "erhe_ui/font.hpp"
+#include "erhe_ui/glyph_atlas.hpp"
+#include "erhe_ui/rectangle.hpp"
+
+#include <fmt/format.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace benchmark {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+using erhe::ui::Bitmap;
+using erhe::ui::Glyph_atlas;
+using erhe::ui::Glyph_atlas_entry;
+using erhe::ui::Glyph_atlas_statistics;
+
+// Somewhat more glyphs than fit in a 256 x 256 page, so that glyphs are evicted
+constexpr uint32_t key_count     {300};
+constexpr int      keys_per_frame{24};
+
+auto seconds_since(const Clock::time_point start) -> double
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+class Checker
+{
+public:
+    void check(const bool condition, const char* description)
+    {
+        ++check_count;
+        if (!condition) {
+            ++failure_count;
+            fmt::print("  FAILED: {}\n", description);
+        }
+    }
+
+    int check_count  {0};
+    int failure_count{0};
+};
+
+// Glyph sizes and pixel values are fixed per key, like rasterized glyphs
+auto glyph_width(const uint32_t key) -> int
+{
+    return 4 + static_cast<int>((key * 7919u) % 20u);
+}
+
+auto glyph_height(const uint32_t key) -> int
+{
+    return 6 + static_cast<int>((key * 104729u) % 18u);
+}
+
+auto glyph_value(const uint32_t key) -> Bitmap::value_t
+{
+    return static_cast<Bitmap::value_t>(1u + key % 251u);
+}
+
+// Skewed towards small keys, like common characters in text
+auto next_key(std::mt19937& random) -> uint32_t
+{
+    const double u = std::uniform_real_distribution<double>{0.0, 1.0}(random);
+    return static_cast<uint32_t>(u * u * u * static_cast<double>(key_count)) % key_count;
+}
+
+auto same_rect(const rbp::Rect& lhs, const rbp::Rect& rhs) -> bool
+{
+    return (lhs.x == rhs.x) && (lhs.y == rhs.y) && (lhs.width == rhs.width) && (lhs.height == rhs.height);
+}
+
+auto contains(const rbp::Rect& outer, const rbp::Rect& inner) -> bool
+{
+    return
+        (inner.x >= outer.x) &&
+        (inner.y >= outer.y) &&
+        (inner.x + inner.width  <= outer.x + outer.width) &&
+        (inner.y + inner.height <= outer.y + outer.height);
+}
+
+void fill(Bitmap& bitmap, const rbp::Rect& rect, const Bitmap::value_t value)
+{
+    for (int y = rect.y; y < rect.y + rect.height; ++y) {
+        for (int x = rect.x; x < rect.x + rect.width; ++x) {
+            bitmap.put(x, y, 0, value);
+        }
+    }
+}
+
+auto has_value(const Bitmap& bitmap, const rbp::Rect& rect, const Bitmap::value_t value) -> bool
+{
+    for (int y = rect.y; y < rect.y + rect.height; ++y) {
+        for (int x = rect.x; x < rect.x + rect.width; ++x) {
+            if (bitmap.get(x, y, 0) != value) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void check_basic(Checker& checker)
+{
+    {
+        Glyph_atlas atlas{64, 64, 2};
+        atlas.clear_dirty();
+        const Glyph_atlas_entry* entry = atlas.allocate(1, 10, 12);
+        checker.check((entry != nullptr) && (entry->rect.width == 10) && (entry->rect.height == 12), "allocation has requested size");
+        checker.check((entry != nullptr) && (entry->rect.x >= 1) && (entry->rect.y >= 1),             "allocation is inside page border");
+        checker.check((entry != nullptr) && atlas.is_dirty() && contains(atlas.dirty_rect(), entry->rect), "allocation is marked dirty");
+        checker.check(atlas.find(1) == entry, "find returns allocated entry");
+        checker.check(atlas.find(2) == nullptr, "find of unknown key misses");
+        checker.check(atlas.get(2) == nullptr, "get of unknown key misses");
+        const Glyph_atlas_statistics& statistics = atlas.get_statistics();
+        checker.check((statistics.hit_count == 1) && (statistics.miss_count == 1), "find counts hits and misses");
+        checker.check(atlas.allocate(2, 62, 1) == nullptr, "allocation wider than page fails");
+        atlas.clear_dirty();
+        checker.check(!atlas.is_dirty(), "clear_dirty clears dirty rectangle");
+    }
+    {
+        // Packer space is 62 x 62, and each glyph takes one pixel of gap
+        Glyph_atlas atlas{64, 64, 1};
+        const Glyph_atlas_entry* full = atlas.allocate(1, 61, 61);
+        checker.check(full != nullptr, "largest glyph fills page");
+        if (full == nullptr) {
+            return;
+        }
+        fill(atlas.bitmap(), full->rect, 7);
+        checker.check(atlas.allocate(2, 1, 1) == nullptr, "entry used in current frame is not evicted");
+        checker.check(atlas.get(1) != nullptr,            "full page entry stays resident");
+
+        atlas.begin_frame();
+        const Glyph_atlas_entry* small = atlas.allocate(2, 1, 1);
+        checker.check(small != nullptr,            "allocation evicts entry from previous frame");
+        checker.check(atlas.get(1) == nullptr,     "evicted entry is no longer resident");
+        checker.check(atlas.entry_count() == 1,    "only new entry is resident");
+        checker.check((small != nullptr) && has_value(atlas.bitmap(), small->rect, 0), "pixels of evicted entry are cleared");
+        const Glyph_atlas_statistics& statistics = atlas.get_statistics();
+        checker.check((statistics.eviction_count == 1) && (statistics.rebuild_count == 1), "one eviction and packer rebuild");
+    }
+}
+
+void check_random(Checker& checker, const Glyph_atlas_benchmark_config& config)
+{
+    class Model_entry
+    {
+    public:
+        rbp::Rect rect;
+        uint64_t  last_used;
+    };
+
+    const int                                 size = config.atlas_size;
+    Glyph_atlas                               atlas{size, size, 1};
+    std::unordered_map<uint32_t, Model_entry> model;
+    std::vector<uint8_t>                      occupied(static_cast<std::size_t>(size) * static_cast<std::size_t>(size));
+    std::vector<uint32_t>                     used_keys;
+    std::mt19937                              random{1};
+    uint64_t                                  frame{1};
+    int                                       allocate_failure_count {0};
+    int                                       clear_failure_count    {0};
+    int                                       dirty_failure_count    {0};
+    int                                       protect_failure_count  {0};
+    int                                       moved_count            {0};
+    int                                       bounds_failure_count   {0};
+    int                                       overlap_count          {0};
+    int                                       pattern_failure_count  {0};
+    int                                       lru_failure_count      {0};
+    int                                       count_failure_count    {0};
+
+    for (int f = 0; f < config.frame_count; ++f) {
+        atlas.begin_frame();
+        ++frame;
+        used_keys.clear();
+        for (int i = 0; i < keys_per_frame; ++i) {
+            const uint32_t           key   = next_key(random);
+            const Glyph_atlas_entry* entry = atlas.find(key);
+            if (entry != nullptr) {
+                const auto j = model.find(key);
+                if ((j == model.end()) || !same_rect(j->second.rect, entry->rect)) {
+                    ++moved_count;
+                } else {
+                    j->second.last_used = frame;
+                }
+                used_keys.push_back(key);
+                continue;
+            }
+
+            entry = atlas.allocate(key, glyph_width(key), glyph_height(key));
+            if (entry == nullptr) {
+                ++allocate_failure_count;
+                continue;
+            }
+            if (!has_value(atlas.bitmap(), entry->rect, 0)) {
+                ++clear_failure_count;
+            }
+            if (!contains(atlas.dirty_rect(), entry->rect)) {
+                ++dirty_failure_count;
+            }
+            atlas.clear_dirty();
+            fill(atlas.bitmap(), entry->rect, glyph_value(key));
+            model[key] = Model_entry{entry->rect, frame};
+            used_keys.push_back(key);
+            for (const uint32_t used_key : used_keys) {
+                if (atlas.get(used_key) == nullptr) {
+                    ++protect_failure_count;
+                }
+            }
+        }
+
+        // Every resident glyph and the gap on its right and top side must
+        // not overlap any other
+        std::fill(occupied.begin(), occupied.end(), uint8_t{0});
+        uint64_t max_evicted_last_used {0};
+        uint64_t min_resident_last_used{std::numeric_limits<uint64_t>::max()};
+        for (auto i = model.begin(); i != model.end();) {
+            const Glyph_atlas_entry* entry = atlas.get(i->first);
+            if (entry == nullptr) {
+                max_evicted_last_used = std::max(max_evicted_last_used, i->second.last_used);
+                i = model.erase(i);
+                continue;
+            }
+            min_resident_last_used = std::min(min_resident_last_used, entry->last_used);
+            const rbp::Rect& r = entry->rect;
+            if (!same_rect(r, i->second.rect)) {
+                ++moved_count;
+            }
+            if ((r.x < 1) || (r.y < 1) || (r.x + r.width > size - 2) || (r.y + r.height > size - 2)) {
+                ++bounds_failure_count;
+                ++i;
+                continue;
+            }
+            bool overlap = false;
+            for (int y = r.y; y <= r.y + r.height; ++y) {
+                for (int x = r.x; x <= r.x + r.width; ++x) {
+                    uint8_t& cell = occupied[static_cast<std::size_t>(x) + static_cast<std::size_t>(y) * static_cast<std::size_t>(size)];
+                    overlap = overlap || (cell != 0);
+                    cell = 1;
+                }
+            }
+            if (overlap) {
+                ++overlap_count;
+            }
+            if (!has_value(atlas.bitmap(), r, glyph_value(i->first))) {
+                ++pattern_failure_count;
+            }
+            ++i;
+        }
+        // Entries are evicted oldest first
+        if (max_evicted_last_used > min_resident_last_used) {
+            ++lru_failure_count;
+        }
+        if (atlas.entry_count() != model.size()) {
+            ++count_failure_count;
+        }
+    }
+
+    const Glyph_atlas_statistics& statistics = atlas.get_statistics();
+    checker.check(allocate_failure_count == 0, "glyphs fit after evicting entries of previous frames");
+    checker.check(clear_failure_count    == 0, "allocated rectangles are cleared");
+    checker.check(dirty_failure_count    == 0, "allocated rectangles are marked dirty");
+    checker.check(protect_failure_count  == 0, "entries used in current frame are never evicted");
+    checker.check(moved_count            == 0, "resident entries never move");
+    checker.check(bounds_failure_count   == 0, "entries are inside page border");
+    checker.check(overlap_count          == 0, "entries and their gaps do not overlap");
+    checker.check(pattern_failure_count  == 0, "resident entries keep their pixels");
+    checker.check(lru_failure_count      == 0, "least recently used entries are evicted first");
+    checker.check(count_failure_count    == 0, "entry count matches resident entries");
+    checker.check(statistics.eviction_count > 0, "random run evicts entries");
+    checker.check(statistics.rebuild_count  > 0, "random run rebuilds packer");
+}
+
+#if defined(ERHE_FONT_RASTERIZATION_LIBRARY_FREETYPE) && defined(ERHE_TEXT_LAYOUT_LIBRARY_HARFBUZZ)
+class Print_buffer
+{
+public:
+    std::vector<float>    float_data;
+    std::vector<uint32_t> uint_data;
+};
+
+auto print(const erhe::ui::Font& font, const std::string_view text, const glm::vec3 position, Print_buffer& buffer) -> std::size_t
+{
+    // 4 vertices of 6 words per glyph, at most one glyph per byte
+    const std::size_t word_count = text.size() * 4 * 6;
+    buffer.float_data.assign(word_count, 0.0f);
+    buffer.uint_data .assign(word_count, 0);
+    erhe::ui::Rectangle bounds{};
+    return font.print(buffer.float_data, buffer.uint_data, text, position, 0xffffffffu, bounds);
+}
+
+void check_shaped_runs(Checker& checker, const Glyph_atlas_benchmark_config& config)
+{
+    erhe::ui::Font font{config.font_path, static_cast<unsigned int>(config.font_size)};
+    checker.check(font.atlas() != nullptr, "font loads without graphics instance");
+    if (font.atlas() == nullptr) {
+        return;
+    }
+
+    const erhe::ui::Shaped_run_cache_statistics& statistics = font.get_shaped_run_statistics();
+    Print_buffer a;
+    Print_buffer b;
+    const std::size_t glyph_count_a = print(font, "Glyph atlas", glm::vec3{0.0f}, a);
+    checker.check(
+        (glyph_count_a > 0) && (statistics.miss_count == 1) && (statistics.entry_count == 1),
+        "first print shapes string"
+    );
+    const std::size_t glyph_count_b = print(font, "Glyph atlas", glm::vec3{10.0f, 20.0f, 0.0f}, b);
+    checker.check(
+        (glyph_count_b == glyph_count_a) && (statistics.hit_count == 1) && (statistics.entry_count == 1),
+        "second print hits shaped run cache"
+    );
+    bool offset_ok = true;
+    for (std::size_t i = 0, end = glyph_count_a * 4; i < end; ++i) {
+        const std::size_t w = i * 6;
+        offset_ok = offset_ok &&
+            (b.float_data[w + 0] == a.float_data[w + 0] + 10.0f) &&
+            (b.float_data[w + 1] == a.float_data[w + 1] + 20.0f) &&
+            (b.float_data[w + 4] == a.float_data[w + 4]) &&
+            (b.float_data[w + 5] == a.float_data[w + 5]);
+    }
+    checker.check(offset_ok, "cached print offsets positions and keeps texture coordinates");
+    checker.check(font.atlas()->entry_count() > 0, "printed glyphs are resident in atlas");
+
+    static_cast<void>(print(font, "Shaped run", glm::vec3{0.0f}, a));
+    checker.check((statistics.miss_count == 2) && (statistics.entry_count == 2), "other string is shaped");
+
+    // Runs not printed for longer than the maximum age are evicted
+    for (int i = 0; i < 200; ++i) {
+        font.begin_frame();
+    }
+    checker.check((statistics.entry_count == 0) && (statistics.byte_count == 0), "unused shaped runs are evicted");
+    static_cast<void>(print(font, "Glyph atlas", glm::vec3{0.0f}, a));
+    checker.check((statistics.miss_count == 3) && (statistics.entry_count == 1), "evicted run is shaped again");
+}
+
+void run_print_timing(const Glyph_atlas_benchmark_config& config)
+{
+    const erhe::ui::Font font{config.font_path, static_cast<unsigned int>(config.font_size)};
+    if (font.atlas() == nullptr) {
+        return;
+    }
+
+    constexpr int print_count = 10'000;
+    std::vector<std::string> labels;
+    labels.reserve(print_count);
+    for (int i = 0; i < print_count; ++i) {
+        labels.push_back(fmt::format("Label {}", i));
+    }
+
+    Print_buffer buffer;
+    static_cast<void>(print(font, labels.front(), glm::vec3{0.0f}, buffer));
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < print_count; ++i) {
+        static_cast<void>(print(font, labels.front(), glm::vec3{0.0f}, buffer));
+    }
+    const double hit_time = seconds_since(start);
+
+    start = Clock::now();
+    for (int i = 1; i < print_count; ++i) {
+        static_cast<void>(print(font, labels[static_cast<std::size_t>(i)], glm::vec3{0.0f}, buffer));
+    }
+    const double miss_time = seconds_since(start);
+
+    fmt::print("\nFont print: {} pixel font, {} prints\n", config.font_size, print_count);
+    fmt::print("{:>13} {:>14}\n", "hit ns/print", "miss ns/print");
+    fmt::print(
+        "{:>13.1f} {:>14.1f}\n",
+        hit_time  * 1'000'000'000.0 / static_cast<double>(print_count),
+        miss_time * 1'000'000'000.0 / static_cast<double>(print_count - 1)
+    );
+}
+#endif
+
+void run_timing(const Glyph_atlas_benchmark_config& config)
+{
+    const int    frame_count = config.frame_count * 10;
+    Glyph_atlas  atlas{config.atlas_size, config.atlas_size, 1};
+    std::mt19937 random{2};
+    uint64_t     lookup_count{0};
+    uint64_t     failed_count{0};
+
+    const Clock::time_point start = Clock::now();
+    for (int f = 0; f < frame_count; ++f) {
+        atlas.begin_frame();
+        for (int i = 0; i < keys_per_frame; ++i) {
+            const uint32_t key = next_key(random);
+            ++lookup_count;
+            if (atlas.find(key) != nullptr) {
+                continue;
+            }
+            if (atlas.allocate(key, glyph_width(key), glyph_height(key)) == nullptr) {
+                ++failed_count;
+            }
+        }
+        atlas.clear_dirty();
+    }
+    const double time = seconds_since(start);
+
+    const Glyph_atlas_statistics& statistics = atlas.get_statistics();
+    fmt::print("\nGlyph atlas: {} x {} page, {} glyphs per frame\n", config.atlas_size, config.atlas_size, keys_per_frame);
+    fmt::print("{:>8} {:>10} {:>9} {:>10} {:>9} {:>13} {:>7}\n", "frames", "lookups", "hit rate", "evictions", "rebuilds", "ns per lookup", "failed");
+    fmt::print(
+        "{:>8} {:>10} {:>8.1f}% {:>10} {:>9} {:>13.1f} {:>7}\n",
+        frame_count,
+        lookup_count,
+        100.0 * static_cast<double>(statistics.hit_count) / static_cast<double>(std::max(lookup_count, uint64_t{1})),
+        statistics.eviction_count,
+        statistics.rebuild_count,
+        time * 1'000'000'000.0 / static_cast<double>(std::max(lookup_count, uint64_t{1})),
+        failed_count
+    );
+}
+
+} // anonymous namespace
+
+auto run_glyph_atlas_benchmark(const Glyph_atlas_benchmark_config& config) -> int
+{
+    Checker checker;
+    fmt::print("Glyph atlas checks\n");
+    check_basic (checker);
+    check_random(checker, config);
+#if defined(ERHE_FONT_RASTERIZATION_LIBRARY_FREETYPE) && defined(ERHE_TEXT_LAYOUT_LIBRARY_HARFBUZZ)
+    check_shaped_runs(checker, config);
+#endif
+    fmt::print("  {} of {} checks passed\n", checker.check_count - checker.failure_count, checker.check_count);
+
+    run_timing(config);
+#if defined(ERHE_FONT_RASTERIZATION_LIBRARY_FREETYPE) && defined(ERHE_TEXT_LAYOUT_LIBRARY_HARFBUZZ)
+    run_print_timing(config);
+#endif
+    return (checker.failure_count == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+} // namespace benchmark
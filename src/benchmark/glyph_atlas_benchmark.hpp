@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+
+namespace benchmark {
+
+class Glyph_atlas_benchmark_config
+{
+public:
+    int         frame_count{1000};
+    int         atlas_size {256};
+    std::string font_path  {"../editor/res/fonts/SourceSansPro-Regular.otf"};
+    int         font_size  {14};
+};
+
+// Checks: glyph atlas allocation, lookup and protection of entries used in
+// the current frame, then a randomized run which requests glyphs of varying
+// size over frame count frames, fills each allocated rectangle with a per
+// glyph pattern in the CPU side bitmap, and after every frame validates
+// that resident rectangles are inside the page, keep their place, do not
+// overlap including the gap between glyphs, still hold their pattern, and
+// that evicted glyphs were the least recently used ones. With freetype and
+// harfbuzz, also checks shaped run cache hits, misses and aging of a font
+// loaded without graphics instance.
+// Timing: lookup + allocate cost of the same workload without validation,
+// and font print cost with and without a shaped run cache hit.
+// Returns EXIT_FAILURE if any check fails.
+auto run_glyph_atlas_benchmark(const Glyph_atlas_benchmark_config& config) -> int;
+
+} // namespace benchmark
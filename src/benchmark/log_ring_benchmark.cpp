@@ -0,0 +1,226 @@
+#include "log_ring_benchmark.hpp"
+
+#include "erhe_log/log.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace benchmark {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+using erhe::log::Entry;
+using erhe::log::Store_log_sink;
+
+constexpr uint64_t read_window{64}; // latest entries read per reader pass
+
+class Checker
+{
+public:
+    void check(const bool condition, const char* description)
+    {
+        ++check_count;
+        if (!condition) {
+            ++failure_count;
+            fmt::print("  FAILED: {}\n", description);
+        }
+    }
+
+    int check_count  {0};
+    int failure_count{0};
+};
+
+auto seconds_since(const Clock::time_point start) -> double
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+auto logger_name(const int writer) -> std::string
+{
+    return fmt::format("writer {}", writer);
+}
+
+auto level_for(const int message) -> spdlog::level::level_enum
+{
+    return static_cast<spdlog::level::level_enum>(message % spdlog::level::off);
+}
+
+// Writer and message number, then a pattern of varying length; long enough
+// messages wrap around the end of the arena
+auto make_message(const int writer, const int message) -> std::string
+{
+    std::string text = fmt::format("{} {} ", writer, message);
+    const int pattern_length = (message * 31 + writer * 7) % 200;
+    for (int i = 0; i < pattern_length; ++i) {
+        text.push_back(static_cast<char>('a' + (message + writer + i) % 26));
+    }
+    return text;
+}
+
+auto is_valid(const Store_log_sink& sink, const Entry& entry) -> bool
+{
+    int writer {-1};
+    int message{-1};
+    if (std::sscanf(entry.message.c_str(), "%d %d ", &writer, &message) != 2) {
+        return false;
+    }
+    return
+        (writer >= 0) &&
+        (message >= 0) &&
+        (entry.message == make_message(writer, message)) &&
+        (entry.level == level_for(message)) &&
+        (sink.get_logger_name(entry.logger_id) == logger_name(writer));
+}
+
+class Reader_result
+{
+public:
+    uint64_t read_count    {0};
+    uint64_t rejected_count{0};
+    uint64_t invalid_count {0};
+};
+
+} // anonymous namespace
+
+auto run_log_ring_benchmark(const Log_ring_benchmark_config& config) -> int
+{
+    Checker checker;
+    fmt::print(
+        "Log ring checks: {} writers, {} readers, {} messages per writer, {} slots, {} byte arena\n",
+        config.writer_count, config.reader_count, config.message_count, config.capacity, config.arena_size
+    );
+
+    Store_log_sink sink{config.capacity, config.arena_size};
+    {
+        Entry entry;
+        checker.check(sink.get_serial() == 0,     "empty sink has serial 0");
+        checker.check(!sink.get_entry(1, entry), "empty sink has no entries");
+    }
+
+    std::vector<std::string> names;
+    for (int writer = 0; writer < config.writer_count; ++writer) {
+        names.push_back(logger_name(writer));
+    }
+
+    std::atomic<bool>          writers_done{false};
+    std::vector<Reader_result> reader_results(static_cast<std::size_t>(config.reader_count));
+    std::vector<std::thread>   readers;
+    for (int reader = 0; reader < config.reader_count; ++reader) {
+        readers.emplace_back(
+            [&sink, &writers_done, &result = reader_results[static_cast<std::size_t>(reader)]]() {
+                Entry entry;
+                while (!writers_done.load(std::memory_order_acquire)) {
+                    const uint64_t latest = sink.get_serial();
+                    const uint64_t first  = std::max(sink.get_first_serial(), (latest > read_window) ? latest - read_window : 1);
+                    for (uint64_t serial = first; serial <= latest; ++serial) {
+                        if (!sink.get_entry(serial, entry)) {
+                            ++result.rejected_count;
+                            continue;
+                        }
+                        ++result.read_count;
+                        if ((entry.serial != serial) || !is_valid(sink, entry)) {
+                            ++result.invalid_count;
+                        }
+                    }
+                }
+            }
+        );
+    }
+
+    const Clock::time_point start = Clock::now();
+    std::vector<std::thread> writers;
+    for (int writer = 0; writer < config.writer_count; ++writer) {
+        writers.emplace_back(
+            [&sink, &config, &name = names[static_cast<std::size_t>(writer)], writer]() {
+                for (int message = 0; message < config.message_count; ++message) {
+                    const std::string text = make_message(writer, message);
+                    sink.log(spdlog::details::log_msg{name, level_for(message), text});
+                }
+            }
+        );
+    }
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+    const double write_time = seconds_since(start);
+    writers_done.store(true, std::memory_order_release);
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+
+    Reader_result total;
+    for (const Reader_result& result : reader_results) {
+        total.read_count     += result.read_count;
+        total.rejected_count += result.rejected_count;
+        total.invalid_count  += result.invalid_count;
+    }
+    checker.check(total.invalid_count == 0, "concurrent readers get only intact entries");
+    checker.check((config.reader_count == 0) || (total.read_count > 0), "concurrent readers get entries");
+
+    const uint64_t message_total = static_cast<uint64_t>(config.writer_count) * static_cast<uint64_t>(config.message_count);
+    const uint64_t latest        = sink.get_serial();
+    const uint64_t first         = sink.get_first_serial();
+    const uint64_t capacity      = std::bit_ceil(config.capacity); // as rounded by the sink
+    checker.check(latest == message_total,                                           "serial counts every message");
+    checker.check(latest - first + 1 == std::min<uint64_t>(message_total, capacity), "first serial is capacity behind latest");
+
+    // Without writers, slots of the range are readable, except where a writer
+    // stalled while the ring wrapped and then overwrote a newer entry; each
+    // writer can do that at most once per wrap. Messages are readable while
+    // their bytes are still in the arena; arena and slot are claimed
+    // separately, so that is not strictly in serial order.
+    Entry    entry;
+    uint64_t slot_readable_count   {0};
+    bool     messages_valid        {true};
+    uint64_t message_readable_count{0};
+    for (uint64_t serial = first; serial <= latest; ++serial) {
+        if (sink.get_entry(serial, entry, false)) {
+            ++slot_readable_count;
+        }
+        if (sink.get_entry(serial, entry)) {
+            ++message_readable_count;
+            if (!is_valid(sink, entry)) {
+                messages_valid = false;
+            }
+        }
+    }
+    const uint64_t range_count    = latest - first + 1;
+    const uint64_t max_lost_count = 2 * static_cast<uint64_t>(config.writer_count);
+    checker.check(slot_readable_count + max_lost_count >= range_count, "slots in range are readable without message");
+    checker.check(message_readable_count > 0,                          "latest messages are readable");
+    checker.check(messages_valid,                                      "readable messages are intact");
+    checker.check(!sink.get_entry(first - 1, entry),                   "overwritten slot is not readable");
+    checker.check(!sink.get_entry(latest + 1, entry),                  "future slot is not readable");
+
+    sink.trim(10);
+    checker.check(sink.get_first_serial() == latest - 9, "trim keeps latest entries");
+    checker.check(!sink.get_entry(latest - 10, entry),   "trimmed entry is not readable");
+
+    fmt::print("  {} of {} checks passed\n", checker.check_count - checker.failure_count, checker.check_count);
+
+    fmt::print(
+        "  writes: {:.1f} M messages/s, {:.1f} ns per message\n",
+        static_cast<double>(message_total) / write_time / 1'000'000.0,
+        write_time * 1'000'000'000.0 / static_cast<double>(message_total)
+    );
+    fmt::print(
+        "  reads:  {} intact, {} rejected as being written or overwritten\n"
+        "  at end: {} of {} slots and {} messages readable\n",
+        total.read_count, total.rejected_count, slot_readable_count, range_count, message_readable_count
+    );
+    return (checker.failure_count == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+} // namespace benchmark
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+namespace benchmark {
+
+class Log_ring_benchmark_config
+{
+public:
+    int         writer_count {4};
+    int         reader_count {2};
+    int         message_count{200'000}; // per writer
+    std::size_t capacity     {1024};
+    std::size_t arena_size   {16 * 1024};
+};
+
+// Checks: writer threads log messages whose level, logger name and text are
+// derived from writer and message number into a small Store_log_sink, so
+// that slots and message arena wrap around many times, while reader threads
+// read the latest entries. Every entry a reader gets is validated against
+// the expected message; entries being overwritten must be rejected, never
+// returned torn. After writers finish, serials, readable range and trim are
+// checked.
+// Timing: messages per second with concurrent writers and readers.
+// Returns EXIT_FAILURE if any check fails.
+auto run_log_ring_benchmark(const Log_ring_benchmark_config& config) -> int;
+
+} // namespace benchmark
@@ -0,0 +1,221 @@
+#include "buffer_allocator_benchmark.hpp"
+#include "commands_benchmark.hpp"
+#include "concurrency_benchmark.hpp"
+#include "geometry_benchmark.hpp"
+#include "glyph_atlas_benchmark.hpp"
+#include "log_ring_benchmark.hpp"
+#include "physics_benchmark.hpp"
+#include "primitive_benchmark.hpp"
+#include "raytrace_benchmark.hpp"
+
+#include "erhe_commands/commands_log.hpp"
+#include "erhe_geometry/geometry_log.hpp"
+#include "erhe_log/log.hpp"
+#include "erhe_physics/physics_log.hpp"
+#include "erhe_primitive/primitive_log.hpp"
+#include "erhe_raytrace/raytrace_log.hpp"
+#include "erhe_ui/ui_log.hpp"
+
+#include <cxxopts.hpp>
+#include <fmt/format.h>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+auto str(const bool value) -> const char*
+{
+    return value ? "true" : "false";
+}
+
+class Options
+{
+public:
+    Options(int argc, char** argv)
+    {
+        cxxopts::Options options{"erhe-benchmark", "Erhe benchmarks"};
+
+        options.add_options()
+            ("help", "Print usage");
+
+        options.add_options("Thread pool")
+            ("concurrency",         "Run Thread_pool benchmark", cxxopts::value<bool>()->default_value(str(concurrency)))
+            ("concurrency-threads", "Comma separated worker thread counts", cxxopts::value<std::vector<int>>()->default_value("1,2,4,8,16,32,64"), "<counts>")
+            ("concurrency-tasks",   "Task count per run", cxxopts::value<int>()->default_value("1000000"), "<count>")
+            ("concurrency-work",    "xorshift rounds per task", cxxopts::value<int>()->default_value("100"), "<count>")
+            ("concurrency-repeat",  "Runs per case, best is reported", cxxopts::value<int>()->default_value("3"), "<count>");
+
+        options.add_options("Commands")
+            ("commands",          "Run input replay benchmark", cxxopts::value<bool>()->default_value(str(commands)))
+            ("commands-commands", "Comma separated registered command counts", cxxopts::value<std::vector<int>>()->default_value("100,1000,10000"), "<counts>")
+            ("commands-events",   "Replayed input event count", cxxopts::value<int>()->default_value("1000000"), "<count>");
+
+        options.add_options("Raytrace")
+            ("raytrace",             "Run instance picking benchmark", cxxopts::value<bool>()->default_value(str(raytrace)))
+            ("raytrace-instances",   "Comma separated instance counts", cxxopts::value<std::vector<int>>()->default_value("1000,10000,100000"), "<counts>")
+            ("raytrace-rays",        "Ray count traced through top-level BVH", cxxopts::value<int>()->default_value("100000"), "<count>")
+            ("raytrace-linear-rays", "Ray count traced without top-level BVH", cxxopts::value<int>()->default_value("1000"), "<count>");
+
+        options.add_options("Geometry")
+            ("geometry",                   "Run edge lookup and operator benchmark", cxxopts::value<bool>()->default_value(str(geometry)))
+            ("geometry-polygons",          "Comma separated polygon counts for edge lookup", cxxopts::value<std::vector<int>>()->default_value("1000,10000,100000,1000000"), "<counts>")
+            ("geometry-linear-limit",      "Largest polygon count for linear edge lookup", cxxopts::value<int>()->default_value("10000"), "<count>")
+            ("geometry-operator-polygons", "Comma separated polygon counts for operators", cxxopts::value<std::vector<int>>()->default_value("100000,1000000"), "<counts>")
+            ("geometry-operator-threads",  "Comma separated thread counts for operators, 0 selects hardware concurrency", cxxopts::value<std::vector<int>>()->default_value("1,0"), "<counts>")
+            ("geometry-operators",         "Comma separated operators", cxxopts::value<std::vector<std::string>>()->default_value("ambo,catmull_clark,dual,gyro,join,kis,meta,sqrt3,subdivide,triangulate,truncate"), "<names>");
+
+        options.add_options("Physics")
+            ("physics",        "Run rigid body insertion benchmark", cxxopts::value<bool>()->default_value(str(physics)))
+            ("physics-bodies", "Comma separated rigid body counts", cxxopts::value<std::vector<int>>()->default_value("10000,100000"), "<counts>");
+
+        options.add_options("Buffer allocator")
+            ("buffer-allocator",            "Run buffer sub-allocator checks and benchmark", cxxopts::value<bool>()->default_value(str(buffer_allocator)))
+            ("buffer-allocator-live",       "Comma separated live allocation counts", cxxopts::value<std::vector<int>>()->default_value("1000,10000,100000"), "<counts>")
+            ("buffer-allocator-operations", "Free + allocate pairs per live allocation count", cxxopts::value<int>()->default_value("1000000"), "<count>");
+
+        options.add_options("Primitive")
+            ("primitive",          "Run serial vs parallel polygon fill check and benchmark", cxxopts::value<bool>()->default_value(str(primitive)))
+            ("primitive-polygons", "Comma separated polygon counts", cxxopts::value<std::vector<int>>()->default_value("10000,100000"), "<counts>")
+            ("primitive-threads",  "Parallel fill thread count, 0 selects hardware concurrency", cxxopts::value<int>()->default_value("0"), "<count>");
+
+        options.add_options("Glyph atlas")
+            ("glyph-atlas",        "Run glyph atlas and shaped run cache checks and benchmark", cxxopts::value<bool>()->default_value(str(glyph_atlas)))
+            ("glyph-atlas-frames", "Frame count of randomized check", cxxopts::value<int>()->default_value("1000"), "<count>")
+            ("glyph-atlas-size",   "Atlas page width and height", cxxopts::value<int>()->default_value("256"), "<pixels>")
+            ("glyph-atlas-font",   "Font file for shaped run checks", cxxopts::value<std::string>()->default_value("../editor/res/fonts/SourceSansPro-Regular.otf"), "<path>");
+
+        options.add_options("Log ring")
+            ("log-ring",          "Run concurrent log ring writer and reader checks and benchmark", cxxopts::value<bool>()->default_value(str(log_ring)))
+            ("log-ring-writers",  "Writer thread count", cxxopts::value<int>()->default_value("4"), "<count>")
+            ("log-ring-readers",  "Reader thread count", cxxopts::value<int>()->default_value("2"), "<count>")
+            ("log-ring-messages", "Message count per writer", cxxopts::value<int>()->default_value("200000"), "<count>");
+
+        try {
+            auto arguments = options.parse(argc, argv);
+            if (arguments.count("help") > 0) {
+                fmt::print("{}\n", options.help());
+                help = true;
+                return;
+            }
+
+            concurrency                      = arguments["concurrency"        ].as<bool>();
+            concurrency_config.thread_counts = arguments["concurrency-threads"].as<std::vector<int>>();
+            concurrency_config.task_count    = arguments["concurrency-tasks"  ].as<int>();
+            concurrency_config.task_work     = arguments["concurrency-work"   ].as<int>();
+            concurrency_config.repeat_count  = arguments["concurrency-repeat" ].as<int>();
+            commands                         = arguments["commands"           ].as<bool>();
+            commands_config.command_counts   = arguments["commands-commands"  ].as<std::vector<int>>();
+            commands_config.event_count      = arguments["commands-events"    ].as<int>();
+            raytrace                         = arguments["raytrace"            ].as<bool>();
+            raytrace_config.instance_counts  = arguments["raytrace-instances"  ].as<std::vector<int>>();
+            raytrace_config.ray_count        = arguments["raytrace-rays"       ].as<int>();
+            raytrace_config.linear_ray_count = arguments["raytrace-linear-rays"].as<int>();
+            geometry                                = arguments["geometry"                  ].as<bool>();
+            geometry_config.polygon_counts          = arguments["geometry-polygons"         ].as<std::vector<int>>();
+            geometry_config.linear_polygon_limit    = arguments["geometry-linear-limit"     ].as<int>();
+            geometry_config.operator_polygon_counts = arguments["geometry-operator-polygons"].as<std::vector<int>>();
+            geometry_config.operator_thread_counts  = arguments["geometry-operator-threads" ].as<std::vector<int>>();
+            geometry_config.operators               = arguments["geometry-operators"        ].as<std::vector<std::string>>();
+            physics                    = arguments["physics"       ].as<bool>();
+            physics_config.body_counts = arguments["physics-bodies"].as<std::vector<int>>();
+            buffer_allocator                          = arguments["buffer-allocator"           ].as<bool>();
+            buffer_allocator_config.allocation_counts = arguments["buffer-allocator-live"      ].as<std::vector<int>>();
+            buffer_allocator_config.operation_count   = arguments["buffer-allocator-operations"].as<int>();
+            primitive                       = arguments["primitive"         ].as<bool>();
+            primitive_config.polygon_counts = arguments["primitive-polygons"].as<std::vector<int>>();
+            primitive_config.thread_count   = arguments["primitive-threads" ].as<int>();
+            glyph_atlas                    = arguments["glyph-atlas"       ].as<bool>();
+            glyph_atlas_config.frame_count = arguments["glyph-atlas-frames"].as<int>();
+            glyph_atlas_config.atlas_size  = arguments["glyph-atlas-size"  ].as<int>();
+            glyph_atlas_config.font_path   = arguments["glyph-atlas-font"  ].as<std::string>();
+            log_ring                      = arguments["log-ring"         ].as<bool>();
+            log_ring_config.writer_count  = arguments["log-ring-writers" ].as<int>();
+            log_ring_config.reader_count  = arguments["log-ring-readers" ].as<int>();
+            log_ring_config.message_count = arguments["log-ring-messages"].as<int>();
+        } catch (const std::exception& e) {
+            fmt::print("Error parsing command line arguments: {}\n", e.what());
+            help = true;
+        }
+    }
+
+    [[nodiscard]] auto any() const -> bool
+    {
+        return concurrency || commands || raytrace || geometry || physics || buffer_allocator || primitive || glyph_atlas || log_ring;
+    }
+
+    bool                                         help{false};
+    bool                                         concurrency{false};
+    benchmark::Concurrency_benchmark_config      concurrency_config;
+    bool                                         commands{false};
+    benchmark::Commands_benchmark_config         commands_config;
+    bool                                         raytrace{false};
+    benchmark::Raytrace_benchmark_config         raytrace_config;
+    bool                                         geometry{false};
+    benchmark::Geometry_benchmark_config         geometry_config;
+    bool                                         physics{false};
+    benchmark::Physics_benchmark_config          physics_config;
+    bool                                         buffer_allocator{false};
+    benchmark::Buffer_allocator_benchmark_config buffer_allocator_config;
+    bool                                         primitive{false};
+    benchmark::Primitive_benchmark_config        primitive_config;
+    bool                                         glyph_atlas{false};
+    benchmark::Glyph_atlas_benchmark_config      glyph_atlas_config;
+    bool                                         log_ring{false};
+    benchmark::Log_ring_benchmark_config         log_ring_config;
+};
+
+} // anonymous namespace
+
+auto main(int argc, char** argv) -> int
+{
+    const Options options{argc, argv};
+    if (options.help) {
+        return EXIT_SUCCESS;
+    }
+    if (!options.any()) {
+        fmt::print("No benchmark selected, see --help\n");
+        return EXIT_FAILURE;
+    }
+
+    erhe::log::console_init();
+    erhe::log::log_to_console();
+    erhe::log::initialize_log_sinks();
+    erhe::commands::initialize_logging();
+    erhe::raytrace::initialize_logging();
+    erhe::geometry::initialize_logging();
+    erhe::physics::initialize_logging();
+    erhe::primitive::initialize_logging();
+    erhe::ui::initialize_logging();
+
+    int result = EXIT_SUCCESS;
+    if (options.concurrency && (benchmark::run_concurrency_benchmark(options.concurrency_config) != EXIT_SUCCESS)) {
+        result = EXIT_FAILURE;
+    }
+    if (options.commands && (benchmark::run_commands_benchmark(options.commands_config) != EXIT_SUCCESS)) {
+        result = EXIT_FAILURE;
+    }
+    if (options.raytrace && (benchmark::run_raytrace_benchmark(options.raytrace_config) != EXIT_SUCCESS)) {
+        result = EXIT_FAILURE;
+    }
+    if (options.geometry && (benchmark::run_geometry_benchmark(options.geometry_config) != EXIT_SUCCESS)) {
+        result = EXIT_FAILURE;
+    }
+    if (options.physics && (benchmark::run_physics_benchmark(options.physics_config) != EXIT_SUCCESS)) {
+        result = EXIT_FAILURE;
+    }
+    if (options.buffer_allocator && (benchmark::run_buffer_allocator_benchmark(options.buffer_allocator_config) != EXIT_SUCCESS)) {
+        result = EXIT_FAILURE;
+    }
+    if (options.primitive && (benchmark::run_primitive_benchmark(options.primitive_config) != EXIT_SUCCESS)) {
+        result = EXIT_FAILURE;
+    }
+    if (options.glyph_atlas && (benchmark::run_glyph_atlas_benchmark(options.glyph_atlas_config) != EXIT_SUCCESS)) {
+        result = EXIT_FAILURE;
+    }
+    if (options.log_ring && (benchmark::run_log_ring_benchmark(options.log_ring_config) != EXIT_SUCCESS)) {
+        result = EXIT_FAILURE;
+    }
+    return result;
+}
@@ -0,0 +1,122 @@
+#include "physics_benchmark.hpp"
+
+#include "erhe_configuration/configuration.hpp"
+#include "erhe_physics/icollision_shape.hpp"
+#include "erhe_physics/irigid_body.hpp"
+#include "erhe_physics/iworld.hpp"
+
+#include <fmt/format.h>
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace benchmark {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr float grid_spacing = 2.0f; // boxes are 1 unit wide, so they do not overlap
+
+auto seconds_since(const Clock::time_point start) -> double
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+auto get_max_bodies() -> int
+{
+    int max_bodies = 1024 * 32;
+    auto ini = erhe::configuration::get_ini("erhe.ini", "physics");
+    ini->get("max_bodies", max_bodies);
+    return max_bodies;
+}
+
+} // anonymous namespace
+
+auto run_physics_benchmark(const Physics_benchmark_config& config) -> int
+{
+    const int max_bodies = get_max_bodies();
+
+    fmt::print("Physics: rigid body insertion and removal, max_bodies {}\n", max_bodies);
+    fmt::print(
+        "{:>7} {:>10} {:>10} {:>10} {:>10} {:>11} {:>10} {:>8}\n",
+        "bodies", "create ms", "add ms", "remove ms", "batch add", "optimize ms", "batch rem", "speedup"
+    );
+
+    for (const int body_count : config.body_counts) {
+        if (body_count > max_bodies) {
+            fmt::print("{:>7} skipped, above max_bodies\n", body_count);
+            continue;
+        }
+        const int side = static_cast<int>(std::ceil(std::cbrt(static_cast<double>(body_count))));
+
+        // Bodies must be destroyed before the world
+        std::unique_ptr<erhe::physics::IWorld>                   world = erhe::physics::IWorld::create_unique();
+        std::vector<std::shared_ptr<erhe::physics::IRigid_body>> bodies;
+        std::vector<erhe::physics::IRigid_body*>                 body_pointers;
+        bodies       .reserve(static_cast<std::size_t>(body_count));
+        body_pointers.reserve(static_cast<std::size_t>(body_count));
+
+        erhe::physics::IRigid_body_create_info create_info{
+            .collision_shape = erhe::physics::ICollision_shape::create_box_shape_shared(glm::vec3{0.5f}),
+            .mass            = 1.0f,
+            .debug_label     = "box"
+        };
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < body_count; ++i) {
+            const glm::vec3 position = grid_spacing * glm::vec3{
+                static_cast<float>(i % side),
+                static_cast<float>((i / side) % side),
+                static_cast<float>(i / (side * side))
+            };
+            auto& body = bodies.emplace_back(world->create_rigid_body_shared(create_info, position));
+            body_pointers.push_back(body.get());
+        }
+        const double create_time = seconds_since(start);
+
+        start = Clock::now();
+        for (erhe::physics::IRigid_body* body : body_pointers) {
+            world->add_rigid_body(body);
+        }
+        const double add_time = seconds_since(start);
+
+        start = Clock::now();
+        for (erhe::physics::IRigid_body* body : body_pointers) {
+            world->remove_rigid_body(body);
+        }
+        const double remove_time = seconds_since(start);
+
+        start = Clock::now();
+        world->add_rigid_bodies(body_pointers);
+        const double batch_add_time = seconds_since(start);
+
+        start = Clock::now();
+        world->optimize_broad_phase();
+        const double optimize_time = seconds_since(start);
+
+        start = Clock::now();
+        world->remove_rigid_bodies(body_pointers);
+        const double batch_remove_time = seconds_since(start);
+
+        const double single_time = add_time + remove_time;
+        const double batch_time  = batch_add_time + batch_remove_time;
+        fmt::print(
+            "{:>7} {:>10.2f} {:>10.2f} {:>10.2f} {:>10.2f} {:>11.2f} {:>10.2f} {:>7.1f}x\n",
+            body_count,
+            create_time       * 1000.0,
+            add_time          * 1000.0,
+            remove_time       * 1000.0,
+            batch_add_time    * 1000.0,
+            optimize_time     * 1000.0,
+            batch_remove_time * 1000.0,
+            (batch_time > 0.0) ? single_time / batch_time : 0.0
+        );
+    }
+    return EXIT_SUCCESS;
+}
+
+} // namespace benchmark
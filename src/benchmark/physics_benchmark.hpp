@@ -0,0 +1,20 @@
+#pragma once
+
+#include <vector>
+
+namespace benchmark {
+
+class Physics_benchmark_config
+{
+public:
+    std::vector<int> body_counts{10'000, 100'000};
+};
+
+// Adds and removes a grid of box rigid bodies, first one body at a time
+// with add_rigid_body() / remove_rigid_body(), then as one batch with
+// add_rigid_bodies() / remove_rigid_bodies(). Also reports the time of
+// optimize_broad_phase() after the batch insert. Body counts above the
+// max_bodies setting in the [physics] section of erhe.ini are skipped.
+auto run_physics_benchmark(const Physics_benchmark_config& config) -> int;
+
+} // namespace benchmark
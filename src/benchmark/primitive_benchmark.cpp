@@ -0,0 +1,155 @@
+#include "primitive_benchmark.hpp"
+
+#include "erhe_concurrency/thread_pool.hpp"
+#include "erhe_geometry/geometry.hpp"
+#include "erhe_geometry/shapes/torus.hpp"
+#include "erhe_graphics/vertex_attribute.hpp"
+#include "erhe_graphics/vertex_format.hpp"
+#include "erhe_primitive/buffer_sink.hpp"
+#include "erhe_primitive/build_info.hpp"
+#include "erhe_primitive/geometry_mesh.hpp"
+#include "erhe_primitive/primitive_builder.hpp"
+#include "erhe_raytrace/ibuffer.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace benchmark {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+using erhe::geometry::Geometry;
+
+auto seconds_since(const Clock::time_point start) -> double
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+class Build_result
+{
+public:
+    double                 time                {0.0};
+    std::size_t            triangle_index_count{0};
+    std::size_t            corner_index_count  {0};
+    std::vector<std::byte> vertex_data;
+    std::vector<std::byte> index_data;
+    std::vector<uint32_t>  primitive_id_to_polygon_id;
+    std::vector<uint32_t>  corner_to_vertex_id;
+};
+
+// Builds into CPU side raytrace buffers, which hold the written bytes
+auto build(
+    const Geometry&                 geometry,
+    const bool                      fill_triangles,
+    erhe::concurrency::Thread_pool* thread_pool
+) -> Build_result
+{
+    const erhe::graphics::Vertex_format vertex_format{
+        erhe::graphics::Vertex_attribute::position_float3(),
+        erhe::graphics::Vertex_attribute::normal0_float3()
+    };
+    const erhe::geometry::Mesh_info mesh_info = geometry.get_mesh_info();
+    const std::size_t index_count = (fill_triangles ? mesh_info.index_count_fill_triangles : 0) + mesh_info.index_count_corner_points;
+    const std::shared_ptr<erhe::raytrace::IBuffer> vertex_buffer = erhe::raytrace::IBuffer::create_shared(
+        "vertex", mesh_info.vertex_count_corners * vertex_format.stride() + 64
+    );
+    const std::shared_ptr<erhe::raytrace::IBuffer> index_buffer = erhe::raytrace::IBuffer::create_shared(
+        "index", index_count * 4 + 64
+    );
+    erhe::primitive::Raytrace_buffer_sink buffer_sink{*vertex_buffer.get(), *index_buffer.get()};
+    const erhe::primitive::Build_info build_info{
+        .primitive_types = {
+            .fill_triangles = fill_triangles,
+            .corner_points  = true
+        },
+        .buffer_info = {
+            .normal_style  = erhe::primitive::Normal_style::corner_normals,
+            .index_type    = gl::Draw_elements_type::unsigned_int,
+            .vertex_format = vertex_format,
+            .buffer_sink   = buffer_sink
+        },
+        .thread_pool = thread_pool
+    };
+
+    Build_result result;
+    const Clock::time_point start = Clock::now();
+    erhe::primitive::Geometry_mesh geometry_mesh = erhe::primitive::make_geometry_mesh(geometry, build_info);
+    result.time = seconds_since(start);
+
+    // Raytrace buffers are released with vertex_buffer and index_buffer
+    geometry_mesh.buffer_sink = nullptr;
+
+    const auto& vertex_range = geometry_mesh.vertex_buffer_range;
+    const auto& index_range  = geometry_mesh.index_buffer_range;
+    const auto  vertex_span  = vertex_buffer->span().subspan(vertex_range.byte_offset, vertex_range.count * vertex_range.element_size);
+    const auto  index_span   = index_buffer ->span().subspan(index_range .byte_offset, index_range .count * index_range .element_size);
+    result.triangle_index_count       = geometry_mesh.triangle_fill_indices.index_count;
+    result.corner_index_count         = geometry_mesh.corner_point_indices .index_count;
+    result.vertex_data                = std::vector<std::byte>(vertex_span.begin(), vertex_span.end());
+    result.index_data                 = std::vector<std::byte>(index_span .begin(), index_span .end());
+    result.primitive_id_to_polygon_id = geometry_mesh.primitive_id_to_polygon_id;
+    result.corner_to_vertex_id        = geometry_mesh.corner_to_vertex_id;
+    return result;
+}
+
+} // anonymous namespace
+
+auto run_primitive_benchmark(const Primitive_benchmark_config& config) -> int
+{
+    const int thread_count = (config.thread_count > 0)
+        ? config.thread_count
+        : static_cast<int>(std::max(std::thread::hardware_concurrency(), 1U));
+    erhe::concurrency::Thread_pool thread_pool{static_cast<std::size_t>(thread_count)};
+
+    fmt::print("Primitive builder: serial vs parallel polygon fill, {} threads\n", thread_count);
+    fmt::print(
+        "{:>9} {:>9} {:>10} {:>10} {:>11} {:>8} {:>10}\n",
+        "polygons", "triangles", "triangle i", "serial ms", "parallel ms", "speedup", "mismatches"
+    );
+
+    int result = EXIT_SUCCESS;
+    for (const int polygon_count : config.polygon_counts) {
+        const int side = std::max(3, static_cast<int>(std::lround(std::sqrt(static_cast<double>(polygon_count)))));
+        Geometry geometry = erhe::geometry::shapes::make_torus(1.0, 0.25, side, side);
+        for (const bool fill_triangles : {true, false}) {
+            const Build_result serial   = build(geometry, fill_triangles, nullptr);
+            const Build_result parallel = build(geometry, fill_triangles, &thread_pool);
+
+            const std::size_t expected_triangle_index_count = fill_triangles ? geometry.get_mesh_info().index_count_fill_triangles : 0;
+            std::size_t mismatch_count = 0;
+            if (serial  .triangle_index_count       != expected_triangle_index_count      ) { ++mismatch_count; }
+            if (parallel.triangle_index_count       != expected_triangle_index_count      ) { ++mismatch_count; }
+            if (parallel.corner_index_count         != serial.corner_index_count          ) { ++mismatch_count; }
+            if (parallel.vertex_data                != serial.vertex_data                 ) { ++mismatch_count; }
+            if (parallel.index_data                 != serial.index_data                  ) { ++mismatch_count; }
+            if (parallel.primitive_id_to_polygon_id != serial.primitive_id_to_polygon_id) { ++mismatch_count; }
+            if (parallel.corner_to_vertex_id        != serial.corner_to_vertex_id       ) { ++mismatch_count; }
+
+            fmt::print(
+                "{:>9} {:>9} {:>10} {:>10.2f} {:>11.2f} {:>7.1f}x {:>10}\n",
+                geometry.get_polygon_count(),
+                fill_triangles ? "fill" : "no fill",
+                parallel.triangle_index_count,
+                serial.time   * 1000.0,
+                parallel.time * 1000.0,
+                (parallel.time > 0.0) ? serial.time / parallel.time : 0.0,
+                mismatch_count
+            );
+            if (mismatch_count > 0) {
+                result = EXIT_FAILURE;
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace benchmark
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vector>
+
+namespace benchmark {
+
+class Primitive_benchmark_config
+{
+public:
+    std::vector<int> polygon_counts{10'000, 100'000};
+    int              thread_count  {0}; // 0 selects hardware concurrency
+};
+
+// Builds vertex and index data of a torus with Primitive_builder, serially
+// and with parallel polygon fill, once with and once without triangle fill.
+// Vertex and index bytes, triangle and corner point index counts and the
+// triangle to polygon and corner to vertex maps of the two builds are
+// compared, and build times are reported. Returns EXIT_FAILURE on mismatch.
+auto run_primitive_benchmark(const Primitive_benchmark_config& config) -> int;
+
+} // namespace benchmark
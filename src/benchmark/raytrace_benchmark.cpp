@@ -0,0 +1,289 @@
+#include "raytrace_benchmark.hpp"
+
+#include "erhe_raytrace/ibuffer.hpp"
+#include "erhe_raytrace/igeometry.hpp"
+#include "erhe_raytrace/iinstance.hpp"
+#include "erhe_raytrace/iscene.hpp"
+#include "erhe_raytrace/ray.hpp"
+
+#include <fmt/format.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace benchmark {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr float grid_spacing = 2.0f; // boxes are 1 unit wide
+
+class Box_geometry
+{
+public:
+    Box_geometry()
+    {
+        static constexpr float vertices[8 * 3] = {
+            -0.5f, -0.5f, -0.5f,   0.5f, -0.5f, -0.5f,   0.5f,  0.5f, -0.5f,  -0.5f,  0.5f, -0.5f,
+            -0.5f, -0.5f,  0.5f,   0.5f, -0.5f,  0.5f,   0.5f,  0.5f,  0.5f,  -0.5f,  0.5f,  0.5f
+        };
+        static constexpr uint32_t indices[12 * 3] = {
+            0, 2, 1,  0, 3, 2, // -z
+            4, 5, 6,  4, 6, 7, // +z
+            0, 1, 5,  0, 5, 4, // -y
+            3, 6, 2,  3, 7, 6, // +y
+            0, 4, 7,  0, 7, 3, // -x
+            1, 2, 6,  1, 6, 5  // +x
+        };
+
+        buffer = erhe::raytrace::IBuffer::create_unique("box", sizeof(vertices) + sizeof(indices) + 128);
+        const std::size_t vertex_offset = buffer->allocate_bytes(sizeof(vertices));
+        const std::size_t index_offset  = buffer->allocate_bytes(sizeof(indices));
+        std::memcpy(buffer->span().data() + vertex_offset, vertices, sizeof(vertices));
+        std::memcpy(buffer->span().data() + index_offset,  indices,  sizeof(indices));
+
+        geometry = erhe::raytrace::IGeometry::create_unique("box", erhe::raytrace::Geometry_type::GEOMETRY_TYPE_TRIANGLE);
+        geometry->set_buffer(erhe::raytrace::Buffer_type::BUFFER_TYPE_VERTEX, 0, erhe::raytrace::Format::FORMAT_FLOAT3, buffer.get(), vertex_offset, 3 * sizeof(float), 8);
+        geometry->set_buffer(erhe::raytrace::Buffer_type::BUFFER_TYPE_INDEX,  0, erhe::raytrace::Format::FORMAT_UINT3,  buffer.get(), index_offset,  3 * sizeof(uint32_t), 12);
+        geometry->commit();
+
+        scene = erhe::raytrace::IScene::create_unique("box");
+        scene->attach(geometry.get());
+        scene->commit();
+    }
+
+    std::unique_ptr<erhe::raytrace::IBuffer>   buffer;
+    std::unique_ptr<erhe::raytrace::IGeometry> geometry;
+    std::unique_ptr<erhe::raytrace::IScene>    scene;
+};
+
+class Random
+{
+public:
+    auto next() -> uint32_t
+    {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return m_state;
+    }
+
+    auto unit() -> float // [0, 1)
+    {
+        return static_cast<float>(next() >> 8) * (1.0f / 16777216.0f);
+    }
+
+private:
+    uint32_t m_state{0x12345678u};
+};
+
+auto make_translation(const glm::vec3 position) -> glm::mat4
+{
+    glm::mat4 matrix{1.0f};
+    matrix[3] = glm::vec4{position, 1.0f};
+    return matrix;
+}
+
+// From random points outside the grid towards random points inside it
+auto make_rays(const int ray_count, const float grid_size) -> std::vector<erhe::raytrace::Ray>
+{
+    Random random;
+    const glm::vec3 center{0.5f * grid_size};
+    const float     radius = grid_size;
+    std::vector<erhe::raytrace::Ray> rays;
+    rays.reserve(static_cast<std::size_t>(ray_count));
+    while (static_cast<int>(rays.size()) < ray_count) {
+        const glm::vec3 outward{random.unit() - 0.5f, random.unit() - 0.5f, random.unit() - 0.5f};
+        const float     length = glm::length(outward);
+        if ((length < 0.01f) || (length > 0.5f)) {
+            continue;
+        }
+        const glm::vec3 origin = center + (radius / length) * outward;
+        const glm::vec3 target = grid_size * glm::vec3{random.unit(), random.unit(), random.unit()};
+        rays.push_back(
+            erhe::raytrace::Ray{
+                .origin    = origin,
+                .t_near    = 0.0f,
+                .direction = glm::normalize(target - origin),
+                .time      = 0.0f,
+                .t_far     = 4.0f * grid_size,
+                .mask      = 0xffffffffu
+            }
+        );
+    }
+    return rays;
+}
+
+auto seconds_since(const Clock::time_point start) -> double
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+} // anonymous namespace
+
+auto run_raytrace_benchmark(const Raytrace_benchmark_config& config) -> int
+{
+    Box_geometry box;
+
+    fmt::print("Raytrace: {} rays, {} linear rays\n", config.ray_count, config.linear_ray_count);
+    fmt::print(
+        "{:>9} {:>9} {:>9} {:>13} {:>11} {:>12} {:>8} {:>7} {:>10} {:>11}\n",
+        "instances", "build ms", "refit ms", "linear ns/ray", "tlas ns/ray", "batch ns/ray", "speedup", "hits", "mismatches", "moved hit"
+    );
+    int result = EXIT_SUCCESS;
+    for (const int instance_count : config.instance_counts) {
+        const int   side      = static_cast<int>(std::ceil(std::cbrt(static_cast<double>(instance_count))));
+        const float grid_size = static_cast<float>(side) * grid_spacing;
+
+        auto scene = erhe::raytrace::IScene::create_unique("benchmark");
+        std::vector<std::unique_ptr<erhe::raytrace::IInstance>> instances;
+        std::vector<glm::vec3>                                  positions;
+        instances.reserve(static_cast<std::size_t>(instance_count));
+        positions.reserve(static_cast<std::size_t>(instance_count));
+        for (int i = 0; i < instance_count; ++i) {
+            const glm::vec3 position = grid_spacing * glm::vec3{
+                static_cast<float>(i % side) + 0.5f,
+                static_cast<float>((i / side) % side) + 0.5f,
+                static_cast<float>(i / (side * side)) + 0.5f
+            };
+            auto& instance = instances.emplace_back(erhe::raytrace::IInstance::create_unique("box"));
+            instance->set_scene(box.scene.get());
+            instance->set_transform(make_translation(position));
+            instance->commit();
+            scene->attach(instance.get());
+            positions.push_back(position);
+        }
+
+        const std::vector<erhe::raytrace::Ray> rays = make_rays(config.ray_count, grid_size);
+        const std::size_t linear_ray_count = std::min(rays.size(), static_cast<std::size_t>(config.linear_ray_count));
+
+        // Scene has not been committed after attach, so every instance is tested
+        std::vector<erhe::raytrace::IInstance*> linear_hits(linear_ray_count, nullptr);
+        Clock::time_point start = Clock::now();
+        for (std::size_t i = 0; i < linear_ray_count; ++i) {
+            erhe::raytrace::Ray ray = rays[i];
+            erhe::raytrace::Hit hit{};
+            if (scene->intersect(ray, hit)) {
+                linear_hits[i] = hit.instance;
+            }
+        }
+        const double linear_time = seconds_since(start);
+
+        start = Clock::now();
+        scene->commit();
+        const double build_time = seconds_since(start);
+
+        std::size_t                             hit_count      = 0;
+        std::size_t                             mismatch_count = 0;
+        std::vector<erhe::raytrace::IInstance*> tlas_hits(rays.size(), nullptr);
+        start = Clock::now();
+        for (std::size_t i = 0, end = rays.size(); i < end; ++i) {
+            erhe::raytrace::Ray ray = rays[i];
+            erhe::raytrace::Hit hit{};
+            const bool is_hit = scene->intersect(ray, hit);
+            if (is_hit) {
+                ++hit_count;
+                tlas_hits[i] = hit.instance;
+            }
+            if ((i < linear_ray_count) && ((is_hit ? hit.instance : nullptr) != linear_hits[i])) {
+                ++mismatch_count;
+            }
+        }
+        const double tlas_time = seconds_since(start);
+
+        std::vector<erhe::raytrace::Ray> batch_rays{rays};
+        std::vector<erhe::raytrace::Hit> batch_hits(rays.size());
+        start = Clock::now();
+        const std::size_t batch_hit_count = scene->intersect_batch(batch_rays, batch_hits);
+        const double batch_time = seconds_since(start);
+        if (batch_hit_count != hit_count) {
+            ++mismatch_count;
+        }
+        for (std::size_t i = 0, end = rays.size(); i < end; ++i) {
+            if (batch_hits[i].instance != tlas_hits[i]) {
+                ++mismatch_count;
+            }
+        }
+
+        // Zero length rays miss, and must reset hits left by the previous call
+        for (erhe::raytrace::Ray& ray : batch_rays) {
+            ray.t_far = ray.t_near;
+        }
+        if (scene->intersect_batch(batch_rays, batch_hits) != 0) {
+            ++mismatch_count;
+        }
+        for (const erhe::raytrace::Hit& hit : batch_hits) {
+            if ((hit.geometry != nullptr) || (hit.instance != nullptr)) {
+                ++mismatch_count;
+            }
+        }
+
+        // Move one instance outside the grid and pick it without commit().
+        // Bvh_scene refits the top-level BVH on the next query. Embree
+        // requires commit() after instance changes, and the none backend
+        // does not trace, so the check is only done with the bvh backend.
+#if defined(ERHE_RAYTRACE_LIBRARY_BVH)
+        const glm::vec3 moved_position{-4.0f * grid_size, 0.5f * grid_size, 0.5f * grid_size};
+        instances.front()->set_transform(make_translation(moved_position));
+        erhe::raytrace::Ray moved_ray{
+            .origin    = moved_position - glm::vec3{0.0f, 0.0f, grid_size},
+            .t_near    = 0.0f,
+            .direction = glm::vec3{0.0f, 0.0f, 1.0f},
+            .time      = 0.0f,
+            .t_far     = 2.0f * grid_size,
+            .mask      = 0xffffffffu
+        };
+        erhe::raytrace::Hit moved_hit{};
+        const bool moved_is_hit = scene->intersect(moved_ray, moved_hit) && (moved_hit.instance == instances.front().get());
+        const char* moved_result = moved_is_hit ? "ok" : "FAILED";
+        if (!moved_is_hit) {
+            result = EXIT_FAILURE;
+        }
+#else
+        const char* moved_result = "-";
+#endif
+
+        // Only transforms change, so commit() refits instead of rebuilding
+        for (std::size_t i = 0, end = instances.size(); i < end; ++i) {
+            instances[i]->set_transform(make_translation(positions[i] + glm::vec3{0.25f, 0.0f, 0.0f}));
+        }
+        start = Clock::now();
+        scene->commit();
+        const double refit_time = seconds_since(start);
+
+        const double linear_ns = (linear_ray_count > 0) ? linear_time * 1'000'000'000.0 / static_cast<double>(linear_ray_count) : 0.0;
+        const double tlas_ns   = tlas_time  * 1'000'000'000.0 / static_cast<double>(rays.size());
+        const double batch_ns  = batch_time * 1'000'000'000.0 / static_cast<double>(rays.size());
+        fmt::print(
+            "{:>9} {:>9.2f} {:>9.2f} {:>13.1f} {:>11.1f} {:>12.1f} {:>7.1f}x {:>7} {:>10} {:>11}\n",
+            instance_count,
+            build_time * 1000.0,
+            refit_time * 1000.0,
+            linear_ns,
+            tlas_ns,
+            batch_ns,
+            (tlas_ns > 0.0) ? linear_ns / tlas_ns : 0.0,
+            hit_count,
+            mismatch_count,
+            moved_result
+        );
+        if (mismatch_count > 0) {
+            result = EXIT_FAILURE;
+        }
+
+        for (const auto& instance : instances) {
+            scene->detach(instance.get());
+        }
+    }
+    return result;
+}
+
+} // namespace benchmark
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+
+namespace benchmark {
+
+class Raytrace_benchmark_config
+{
+public:
+    std::vector<int> instance_counts{1000, 10000, 100000};
+    int              ray_count       {100'000};
+    int              linear_ray_count{1'000};
+};
+
+// Picks random rays against a grid of box instances. Rays are first traced
+// before the scene is committed, which tests every instance (as without the
+// top-level BVH), then after commit() through the top-level BVH, then with
+// intersect_batch(). Closest hits of the linear rays are compared between
+// the first two, and closest hits of all rays between the last two. Zero
+// length rays are then traced into the same hits, which must all be reset
+// to misses. With the bvh
+// backend, one instance is then moved and picked without commit(). Also
+// reports the top-level BVH build time, and refit time after moving all
+// instances. Returns EXIT_FAILURE on mismatches or a missed moved instance.
+auto run_raytrace_benchmark(const Raytrace_benchmark_config& config) -> int;
+
+} // namespace benchmark
@@ -57,6 +57,7 @@
 
 #include "erhe_commands/commands.hpp"
 #include "erhe_commands/commands_log.hpp"
+#include "erhe_concurrency/thread_pool.hpp"
 #include "erhe_configuration/configuration.hpp"
 #include "erhe_file/file_log.hpp"
 #include "erhe_geometry/geometry_log.hpp"
@@ -99,6 +100,9 @@
 #include "erhe_window/window_event_handler.hpp"
 #include "erhe_ui/ui_log.hpp"
 
+#include <algorithm>
+#include <thread>
+
 #if defined(ERHE_PROFILE_LIBRARY_NVTX)
 #   include <nvtx3/nvToolsExt.h>
 #endif
@@ -146,11 +150,12 @@ public:
 
     Editor()
         : m_commands          {}
+        , m_thread_pool       {std::max(std::thread::hardware_concurrency(), 2U) - 1}
         , m_scene_message_bus {}
         , m_editor_message_bus{}
         , m_input_state       {}
         , m_time              {}
-        , m_editor_context    {}
+        , m_editor_context    {.thread_pool = &m_thread_pool} // needed by scene roots created below
 
         , m_clipboard             {m_commands, m_editor_context}
         , m_context_window        {create_window()}
@@ -287,8 +292,10 @@ public:
         fill_editor_context();
 
         auto ini = erhe::configuration::get_ini("erhe.ini", "physics");
-        ini->get("static_enable",  m_editor_settings.physics.static_enable);
-        ini->get("dynamic_enable", m_editor_settings.physics.dynamic_enable);
+        ini->get("static_enable",   m_editor_settings.physics.static_enable);
+        ini->get("dynamic_enable",  m_editor_settings.physics.dynamic_enable);
+        ini->get("fixed_step_rate", m_editor_settings.physics.fixed_step_rate);
+        ini->get("interpolate",     m_editor_settings.physics.interpolate);
         if (!m_editor_settings.physics.static_enable) {
             m_editor_settings.physics.dynamic_enable = false;
         }
@@ -335,6 +342,7 @@ public:
     void fill_editor_context()
     {
         m_editor_context.commands               = &m_commands              ;
+        m_editor_context.thread_pool            = &m_thread_pool           ;
         m_editor_context.graphics_instance      = &m_graphics_instance     ;
         m_editor_context.imgui_renderer         = &m_imgui_renderer        ;
         m_editor_context.imgui_windows          = &m_imgui_windows         ;
@@ -409,6 +417,7 @@ public:
 
         m_editor_scenes.after_physics_simulation_steps();
         m_editor_scenes.update_node_transforms();
+        m_scene_message_bus.update(); // Delivers node changed messages from update_node_transforms()
 
         m_editor_rendering.begin_frame();
         m_imgui_windows.imgui_windows();
@@ -437,6 +446,7 @@ public:
 
     // No dependencies (constructors)
     erhe::commands::Commands       m_commands;
+    erhe::concurrency::Thread_pool m_thread_pool;
     erhe::scene::Scene_message_bus m_scene_message_bus;
     Editor_message_bus             m_editor_message_bus;
     Input_state                    m_input_state;
@@ -3,6 +3,9 @@
 namespace erhe::commands {
     class Commands;
 }
+namespace erhe::concurrency {
+    class Thread_pool;
+}
 namespace erhe::graphics {
     class Instance;
 }
@@ -79,6 +82,7 @@ class Editor_context
 {
 public:
     erhe::commands::Commands*               commands              {nullptr};
+    erhe::concurrency::Thread_pool*         thread_pool           {nullptr};
     erhe::graphics::Instance*               graphics_instance     {nullptr};
     erhe::imgui::Imgui_renderer*            imgui_renderer        {nullptr};
     erhe::imgui::Imgui_windows*             imgui_windows         {nullptr};
@@ -1,8 +1,42 @@
 #include "editor_message_bus.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
 namespace editor
 {
 
-Editor_message_bus::Editor_message_bus() = default;
+namespace {
+
+// Node touched messages are collapsed per node until the next update()
+auto node_touched_coalesce_key(const Editor_message& message) -> uint64_t
+{
+    if ((message.update_flags != Message_flag_bit::c_flag_bit_node_touched_operation_stack) || (message.node == nullptr)) {
+        return 0;
+    }
+    return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(message.node));
+}
+
+// Statistics are kept per lowest update flag bit, the last kind is for
+// messages without flags
+constexpr std::size_t c_statistics_kind_count = 11;
+
+auto statistics_kind(const Editor_message& message) -> std::size_t
+{
+    if (message.update_flags == 0) {
+        return c_statistics_kind_count - 1;
+    }
+    return std::min(static_cast<std::size_t>(std::countr_zero(message.update_flags)), c_statistics_kind_count - 1);
+}
+
+}
+
+Editor_message_bus::Editor_message_bus()
+{
+    set_coalescing(&node_touched_coalesce_key);
+    set_statistics_kinds(&statistics_kind, c_statistics_kind_count);
+}
 
 } // namespace editor
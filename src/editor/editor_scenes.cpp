@@ -11,6 +11,8 @@
 
 #include <imgui/imgui.h>
 
+#include <algorithm>
+
 namespace editor
 {
 
@@ -58,22 +60,40 @@ void Editor_scenes::imgui()
     }
 }
 
+auto Editor_scenes::get_physics_fixed_step_dt() const -> double
+{
+    const float rate = std::max(m_context.editor_settings->physics.fixed_step_rate, 1.0f);
+    return 1.0 / static_cast<double>(rate);
+}
+
 void Editor_scenes::update_physics_simulation_fixed_step(const Time_context& time_context)
 {
     if (
         !m_context.editor_settings->physics.static_enable ||
         !m_context.editor_settings->physics.dynamic_enable
     ) {
+        m_physics_time_accumulator = 0.0;
         return;
     }
 
-    for (const auto& scene_root : m_scene_roots) {
-        scene_root->update_physics_simulation_fixed_step(time_context.dt);
+    // Physics runs at its own fixed rate, which may be lower than the time update rate
+    const double physics_dt = get_physics_fixed_step_dt();
+    m_physics_time_accumulator += time_context.dt;
+    while (m_physics_time_accumulator >= physics_dt) {
+        for (const auto& scene_root : m_scene_roots) {
+            scene_root->update_physics_simulation_fixed_step(physics_dt);
+        }
+        m_physics_time_accumulator -= physics_dt;
     }
 }
 
 void Editor_scenes::before_physics_simulation_steps()
 {
+    // Bodies are added to physics worlds also while simulation is disabled
+    for (const auto& scene_root : m_scene_roots) {
+        scene_root->flush_pending_rigid_bodies();
+    }
+
     if (
         !m_context.editor_settings->physics.static_enable ||
         !m_context.editor_settings->physics.dynamic_enable
@@ -89,11 +109,11 @@ void Editor_scenes::before_physics_simulation_steps()
 void Editor_scenes::update_node_transforms()
 {
     for (const auto& scene_root : m_scene_roots) {
-        scene_root->get_scene().update_node_transforms();
+        scene_root->get_scene().update_node_transforms(m_context.thread_pool);
     }
 
     // Not in m_scene_roots
-    m_context.tools->get_tool_scene_root()->get_hosted_scene()->update_node_transforms();
+    m_context.tools->get_tool_scene_root()->get_hosted_scene()->update_node_transforms(m_context.thread_pool);
 }
 
 void Editor_scenes::update_fixed_step(const Time_context& time_context)
@@ -110,8 +130,16 @@ void Editor_scenes::after_physics_simulation_steps()
         return;
     }
 
+    // Fraction of the way from the previous to the latest physics step
+    float alpha = 1.0f;
+    if (m_context.editor_settings->physics.interpolate) {
+        const double physics_dt = get_physics_fixed_step_dt();
+        const double time_ahead = m_physics_time_accumulator + m_time.get_fixed_step_remainder();
+        alpha = static_cast<float>(std::min(time_ahead / physics_dt, 1.0));
+    }
+
     for (const auto& scene_root : m_scene_roots) {
-        scene_root->after_physics_simulation_steps();
+        scene_root->after_physics_simulation_steps(alpha);
     }
 }
 
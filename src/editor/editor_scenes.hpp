@@ -43,9 +43,12 @@ public:
     void imgui();
 
 private:
+    [[nodiscard]] auto get_physics_fixed_step_dt() const -> double;
+
     Editor_context&          m_context;
     std::mutex               m_mutex;
     std::vector<Scene_root*> m_scene_roots;
+    double                   m_physics_time_accumulator{0.0};
 };
 
 } // namespace editor
@@ -24,8 +24,10 @@ class Physics_settings
 {
 public:
     // Physics
-    bool static_enable {true};
-    bool dynamic_enable{true};
+    bool  static_enable  {true};
+    bool  dynamic_enable {true};
+    float fixed_step_rate{100.0f}; // physics steps per second
+    bool  interpolate    {true};   // interpolate rendered transforms between physics steps
 };
 
 class Graphics_preset
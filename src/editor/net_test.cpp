@@ -1,7 +1,17 @@
+#include "scene/scene_replication.hpp"
+
+#include "erhe_item/item_log.hpp"
 #include "erhe_log/log.hpp"
+#include "erhe_log/timestamp.hpp"
 #include "erhe_net/client.hpp"
 #include "erhe_net/server.hpp"
 #include "erhe_net/net_log.hpp"
+#include "erhe_net/packet.hpp"
+#include "erhe_scene/node.hpp"
+#include "erhe_scene/scene.hpp"
+#include "erhe_scene/scene_host.hpp"
+#include "erhe_scene/scene_log.hpp"
+#include "erhe_scene/scene_message_bus.hpp"
 
 #if defined(ERHE_TERMINAL_LIBRARY_CPP_TERMINAL)
 #   include "cpp-terminal/base.hpp"
@@ -12,12 +22,33 @@
 #   include "cpp-terminal/tty.hpp"
 #endif
 
+#if defined(ERHE_OS_LINUX)
+#   include <netinet/in.h>
+#   include <netinet/tcp.h>
+#   include <arpa/inet.h>
+#   include <fcntl.h>
+#   include <poll.h>
+#   include <signal.h>
+#   include <sys/resource.h>
+#   include <sys/socket.h>
+#   include <sys/wait.h>
+#   include <unistd.h>
+#endif
+
 #include <cxxopts.hpp>
 #include <fmt/format.h>
 
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
 #include <cstdio>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 class Peer
 {
@@ -164,20 +195,19 @@ public:
         auto& tail  = erhe::log::get_tail_store_log();
         //auto& frame = erhe::log::get_frame_store_log();
 
-        auto& tail_entries = tail->get_log();
-        const auto visible_count = (std::min)(
-            static_cast<size_t>(10),
-            tail_entries.size()
-        );
+        const uint64_t   last_serial  = tail->get_serial();
+        const uint64_t   first_serial = tail->get_first_serial();
+        erhe::log::Entry entry;
         for (
-            auto i = tail_entries.rbegin(),
-            end = tail_entries.rbegin() + visible_count;
-            i != end;
-            ++i
+            uint64_t serial = last_serial, end = (last_serial > 10) ? last_serial - 10 : 0;
+            (serial > end) && (serial >= first_serial);
+            --serial
         ) {
-            auto& entry = *i;
+            if (!tail->get_entry(serial, entry)) {
+                continue;
+            }
             s.append(Term::color_fg(Term::Color::Name::Blue));
-            s.append(entry.timestamp.c_str());
+            s.append(erhe::log::timestamp_short(entry.timestamp_ns));
             s.append(Term::color_fg(Term::Color::Name::Gray));
             s.append(entry.message);
             s.append(Term::clear_eol());
@@ -415,6 +445,16 @@ public:
         options.add_options("Terminal configuration")
             ("terminal",        "Enable terminal", cxxopts::value<bool>()->default_value(str(terminal)));
 
+        options.add_options("Scene replication benchmark")
+            ("replication-benchmark", "Run scene replication loopback benchmark and exit", cxxopts::value<bool>()->default_value(str(replication_benchmark)))
+            ("replication-nodes",     "Node count in benchmark scene", cxxopts::value<int>()->default_value("10000"), "<count>")
+            ("replication-frames",    "Animated frame count", cxxopts::value<int>()->default_value("600"), "<count>");
+
+        options.add_options("Server loopback benchmark")
+            ("net-benchmark",         "Run server loopback benchmark with epoll and select and exit", cxxopts::value<bool>()->default_value(str(net_benchmark)))
+            ("net-benchmark-clients", "Comma separated connected client counts", cxxopts::value<std::vector<int>>()->default_value("10,1000,10000"), "<counts>")
+            ("net-benchmark-rounds",  "Rounds where each client sends one message", cxxopts::value<int>()->default_value("100"), "<count>");
+
         try {
             auto arguments = options.parse(argc, argv);
 
@@ -425,6 +465,12 @@ public:
             run_server      = arguments["server"         ].as<bool>();
             listen_address  = arguments["listen-address" ].as<std::string>();
             listen_port     = arguments["listen-port"    ].as<int>();
+            replication_benchmark = arguments["replication-benchmark"].as<bool>();
+            replication_nodes     = arguments["replication-nodes"    ].as<int>();
+            replication_frames    = arguments["replication-frames"   ].as<int>();
+            net_benchmark         = arguments["net-benchmark"        ].as<bool>();
+            net_benchmark_clients = arguments["net-benchmark-clients"].as<std::vector<int>>();
+            net_benchmark_rounds  = arguments["net-benchmark-rounds" ].as<int>();
         } catch (const std::exception& e) {
             fmt::print(
                 "Error parsing command line argumenst: {}",
@@ -433,15 +479,474 @@ public:
         }
     }
 
-    bool        terminal{false};
-    bool        run_client{true};
-    std::string connect_address;
-    int         connect_port;
-    bool        run_server{false};
-    std::string listen_address;
-    int         listen_port;
+    bool             terminal{false};
+    bool             run_client{true};
+    std::string      connect_address;
+    int              connect_port;
+    bool             run_server{false};
+    std::string      listen_address;
+    int              listen_port;
+    bool             replication_benchmark{false};
+    int              replication_nodes{10000};
+    int              replication_frames{600};
+    bool             net_benchmark{false};
+    std::vector<int> net_benchmark_clients{10, 1000, 10000};
+    int              net_benchmark_rounds{100};
+};
+
+class Benchmark_scene_host
+    : public erhe::scene::Scene_host
+{
+public:
+    Benchmark_scene_host(erhe::scene::Scene_message_bus& scene_message_bus, const std::string_view name)
+        : m_name {name}
+        , m_scene{scene_message_bus, name, this}
+    {
+    }
+
+    auto get_scene() -> erhe::scene::Scene& { return m_scene; }
+
+    // Implements erhe::Item_host
+    auto get_host_name() const -> const char* override { return m_name.c_str(); }
+
+    // Implements erhe::scene::Scene_host
+    auto get_hosted_scene () -> erhe::scene::Scene* override { return &m_scene; }
+    void register_node    (const std::shared_ptr<erhe::scene::Node>&   node)   override { m_scene.register_node(node); }
+    void unregister_node  (const std::shared_ptr<erhe::scene::Node>&   node)   override { m_scene.unregister_node(node); }
+    void register_camera  (const std::shared_ptr<erhe::scene::Camera>& camera) override { m_scene.register_camera(camera); }
+    void unregister_camera(const std::shared_ptr<erhe::scene::Camera>& camera) override { m_scene.unregister_camera(camera); }
+    void register_mesh    (const std::shared_ptr<erhe::scene::Mesh>&   mesh)   override { m_scene.register_mesh(mesh); }
+    void unregister_mesh  (const std::shared_ptr<erhe::scene::Mesh>&   mesh)   override { m_scene.unregister_mesh(mesh); }
+    void register_skin    (const std::shared_ptr<erhe::scene::Skin>&   skin)   override { m_scene.register_skin(skin); }
+    void unregister_skin  (const std::shared_ptr<erhe::scene::Skin>&   skin)   override { m_scene.unregister_skin(skin); }
+    void register_light   (const std::shared_ptr<erhe::scene::Light>&  light)  override { m_scene.register_light(light); }
+    void unregister_light (const std::shared_ptr<erhe::scene::Light>&  light)  override { m_scene.unregister_light(light); }
+
+private:
+    std::string        m_name;
+    erhe::scene::Scene m_scene;
+};
+
+// Replicates an animated scene from server to client through loopback
+// connection, and reports bandwidth and latency from encode to applied.
+auto run_replication_benchmark(const Options& options) -> int
+{
+    using Clock = std::chrono::steady_clock;
+
+    erhe::item::initialize_logging();
+    erhe::scene::initialize_logging();
+
+    erhe::scene::Scene_message_bus server_message_bus;
+    erhe::scene::Scene_message_bus client_message_bus;
+    Benchmark_scene_host           server_host{server_message_bus, "server"};
+    Benchmark_scene_host           client_host{client_message_bus, "client"};
+    erhe::scene::Scene&            server_scene = server_host.get_scene();
+    erhe::scene::Scene&            client_scene = client_host.get_scene();
+
+    // Groups of nodes; group nodes and their children are all animated
+    const int group_count        = std::max(1, static_cast<int>(std::sqrt(static_cast<float>(options.replication_nodes))));
+    const int children_per_group = std::max(0, options.replication_nodes / group_count - 1);
+    std::vector<std::shared_ptr<erhe::scene::Node>> nodes;
+    nodes.reserve(static_cast<std::size_t>(group_count) * (children_per_group + 1));
+    for (int group = 0; group < group_count; ++group) {
+        auto group_node = std::make_shared<erhe::scene::Node>(fmt::format("group {}", group));
+        group_node->enable_flag_bits(erhe::Item_flags::content | erhe::Item_flags::visible);
+        group_node->set_parent(server_scene.get_root_node());
+        nodes.push_back(group_node);
+        for (int child = 0; child < children_per_group; ++child) {
+            auto node = std::make_shared<erhe::scene::Node>(fmt::format("node {} {}", group, child));
+            node->enable_flag_bits(erhe::Item_flags::content | erhe::Item_flags::visible);
+            node->set_parent(group_node);
+            nodes.push_back(node);
+        }
+    }
+
+    erhe::net::Server server;
+    erhe::net::Client client;
+    editor::Scene_replication_server replication_server{server_message_bus, server_scene, server};
+    editor::Scene_replication_client replication_client{client_scene};
+    client.set_receive_handler(
+        [&replication_client](const uint8_t* data, const std::size_t length) {
+            replication_client.apply(data, length);
+        }
+    );
+
+    if (!server.listen(options.listen_address.c_str(), options.listen_port)) {
+        fmt::print("listen failed\n");
+        return EXIT_FAILURE;
+    }
+    client.connect(options.listen_address.c_str(), options.listen_port);
+
+    const auto poll = [&server, &client]() {
+        if (server.get_state() != erhe::net::Socket::State::CLOSED) {
+            server.poll(0);
+        }
+        if (client.get_state() != erhe::net::Socket::State::CLOSED) {
+            client.poll(0);
+        }
+    };
+    const auto connect_deadline = Clock::now() + std::chrono::seconds{5};
+    while (
+        ((client.get_state() != erhe::net::Socket::State::CONNECTED) || (server.get_client_count() == 0)) &&
+        (Clock::now() < connect_deadline)
+    ) {
+        poll();
+    }
+    if (server.get_client_count() == 0) {
+        fmt::print("connect failed\n");
+        return EXIT_FAILURE;
+    }
+
+    const auto send_and_wait = [&]() -> bool {
+        server_scene.update_node_transforms();
+        server_message_bus.update();
+        replication_server.update();
+        const uint64_t sent_frame_count = replication_server.get_statistics().frame_count;
+        const auto     deadline         = Clock::now() + std::chrono::seconds{2};
+        while (replication_client.get_statistics().frame_count + replication_client.get_statistics().error_count < sent_frame_count) {
+            if (Clock::now() > deadline) {
+                return false;
+            }
+            poll();
+        }
+        return true;
+    };
+
+    // Keyframe
+    if (!send_and_wait()) {
+        fmt::print("keyframe was not received\n");
+        return EXIT_FAILURE;
+    }
+    const editor::Scene_replication_server_statistics keyframe_server = replication_server.get_statistics();
+    const editor::Scene_replication_client_statistics keyframe_client = replication_client.get_statistics();
+
+    const auto start_time = Clock::now();
+    for (int frame = 0; frame < options.replication_frames; ++frame) {
+        const float time = static_cast<float>(frame) / 60.0f;
+        for (std::size_t i = 0, end = nodes.size(); i < end; ++i) {
+            const float     phase       = time + 0.001f * static_cast<float>(i);
+            const glm::vec3 translation{static_cast<float>(i % 100), std::sin(phase), static_cast<float>(i / 100)};
+            const glm::quat rotation   {std::cos(0.5f * phase), 0.0f, std::sin(0.5f * phase), 0.0f};
+            erhe::scene::Node& node = *nodes[i].get();
+            node.node_data.transforms.parent_from_node.set_trs(translation, rotation, glm::vec3{1.0f, 1.0f, 1.0f});
+            node.handle_transform_update(erhe::scene::Node_transforms::get_next_serial());
+        }
+        if (!send_and_wait()) {
+            fmt::print("frame {} was not received\n", frame);
+            return EXIT_FAILURE;
+        }
+    }
+    const double elapsed_s = std::chrono::duration<double>(Clock::now() - start_time).count();
+
+    client_scene.update_node_transforms();
+
+    // Compare replicated transforms against server
+    std::unordered_map<std::string, const erhe::scene::Node*> client_nodes;
+    for (const auto& node : client_scene.get_flat_nodes()) {
+        client_nodes[node->get_name()] = node.get();
+    }
+    std::size_t missing_count{0};
+    float       max_translation_error{0.0f};
+    for (const auto& node : nodes) {
+        const auto i = client_nodes.find(node->get_name());
+        if (i == client_nodes.end()) {
+            ++missing_count;
+            continue;
+        }
+        const glm::vec3 error = i->second->parent_from_node_transform().get_translation() - node->parent_from_node_transform().get_translation();
+        max_translation_error = std::max(max_translation_error, std::max(std::abs(error.x), std::max(std::abs(error.y), std::abs(error.z))));
+    }
+
+    const editor::Scene_replication_server_statistics& server_statistics = replication_server.get_statistics();
+    const editor::Scene_replication_client_statistics& client_statistics = replication_client.get_statistics();
+    const uint64_t frame_count = client_statistics.frame_count      - keyframe_client.frame_count;
+    const uint64_t byte_count  = server_statistics.byte_count       - keyframe_server.byte_count;
+    const uint64_t latency_ns  = client_statistics.total_latency_ns - keyframe_client.total_latency_ns;
+    const double   frame_bytes = (frame_count > 0) ? static_cast<double>(byte_count) / static_cast<double>(frame_count) : 0.0;
+
+    fmt::print("nodes:                 {} server, {} client, {} missing\n", nodes.size(), replication_client.get_node_count(), missing_count);
+    fmt::print("keyframe:              {} bytes, {:.1f} bytes per node\n", keyframe_server.byte_count, static_cast<double>(keyframe_server.byte_count) / static_cast<double>(nodes.size()));
+    fmt::print("delta frames:          {} in {:.3f} s\n", frame_count, elapsed_s);
+    fmt::print("delta frame size:      {:.0f} bytes, {:.2f} bytes per node\n", frame_bytes, frame_bytes / static_cast<double>(nodes.size()));
+    fmt::print("bandwidth at 60 Hz:    {:.2f} Mbit/s\n", frame_bytes * 60.0 * 8.0 / 1'000'000.0);
+    fmt::print("encode time:           {:.3f} ms per frame\n", (frame_count > 0) ? static_cast<double>(server_statistics.encode_time_ns - keyframe_server.encode_time_ns) / 1'000'000.0 / static_cast<double>(frame_count) : 0.0);
+    fmt::print("apply latency:         {:.3f} ms average, {:.3f} ms max\n", (frame_count > 0) ? static_cast<double>(latency_ns) / 1'000'000.0 / static_cast<double>(frame_count) : 0.0, static_cast<double>(client_statistics.max_latency_ns) / 1'000'000.0);
+    fmt::print("max translation error: {}\n", max_translation_error);
+    fmt::print("errors:                {}\n", client_statistics.error_count);
+
+    client.disconnect();
+    server.disconnect();
+
+    const bool ok = (client_statistics.error_count == 0) && (missing_count == 0) && (max_translation_error < 0.001f);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#if defined(ERHE_OS_LINUX)
+// Load generator for run_net_benchmark(). It runs in a child process, which
+// is forked once before any server has been created, so that client and
+// server ends do not share the file descriptor limit. Commands from the
+// server process:
+//  'N' + int32 count: connect count clients, reply 'C'
+//  'R':               send one timestamped message from each client
+//  'X':               close all clients
+[[noreturn]] void run_net_benchmark_clients(
+    const Options& options,
+    const int      to_clients_fd,
+    const int      to_server_fd
+)
+{
+    using Clock = std::chrono::steady_clock;
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port   = htons(static_cast<uint16_t>(options.listen_port));
+    inet_pton(AF_INET, options.listen_address.c_str(), &address.sin_addr);
+
+    struct Message
+    {
+        erhe::net::Packet_header header{sizeof(int64_t)};
+        int64_t                  send_time_ns{0};
+    };
+
+    std::vector<int> sockets;
+    char             command{0};
+    while (::read(to_clients_fd, &command, 1) == 1) {
+        switch (command) {
+            case 'N': {
+                int32_t client_count{0};
+                if (::read(to_clients_fd, &client_count, sizeof(client_count)) != sizeof(client_count)) {
+                    std::_Exit(EXIT_FAILURE);
+                }
+                sockets.reserve(static_cast<std::size_t>(client_count));
+                for (int32_t i = 0; i < client_count; ++i) {
+                    const int socket = ::socket(AF_INET, SOCK_STREAM, 0);
+                    if (socket < 0) {
+                        break;
+                    }
+                    if (::connect(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+                        ::close(socket);
+                        break;
+                    }
+                    const int no_delay = 1;
+                    ::setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+                    ::fcntl(socket, F_SETFL, ::fcntl(socket, F_GETFL) | O_NONBLOCK);
+                    sockets.push_back(socket);
+                }
+                const char connected = 'C';
+                static_cast<void>(::write(to_server_fd, &connected, 1));
+                break;
+            }
+            case 'R': {
+                for (const int socket : sockets) {
+                    Message message;
+                    message.send_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+                    // Rejected connections fail here, server only waits for accepted clients
+                    static_cast<void>(::send(socket, &message, sizeof(message), MSG_NOSIGNAL));
+                }
+                break;
+            }
+            case 'X': {
+                for (const int socket : sockets) {
+                    ::close(socket);
+                }
+                sockets.clear();
+                break;
+            }
+            default: {
+                std::_Exit(EXIT_FAILURE);
+            }
+        }
+    }
+    std::_Exit(EXIT_SUCCESS);
+}
+
+class Net_benchmark_result
+{
+public:
+    int      connected_count{0};
+    uint64_t message_count  {0};
+    double   elapsed_s      {0.0};
+    double   poll_s         {0.0};
+    double   p50_us         {0.0};
+    double   p99_us         {0.0};
+    bool     ok             {false};
 };
 
+auto run_net_benchmark_case(
+    const Options& options,
+    const int      client_count,
+    const bool     use_epoll,
+    const int      to_clients_fd,
+    const int      to_server_fd
+) -> Net_benchmark_result
+{
+    using Clock = std::chrono::steady_clock;
+
+    Net_benchmark_result result;
+
+    std::vector<int64_t> latencies_ns;
+    uint64_t             received_count{0};
+
+    erhe::net::Server server;
+    server.set_receive_handler(
+        [&latencies_ns, &received_count](const uint8_t* data, const std::size_t length) {
+            if (length != sizeof(int64_t)) {
+                return;
+            }
+            int64_t send_time_ns{0};
+            std::memcpy(&send_time_ns, data, sizeof(int64_t));
+            const int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+            latencies_ns.push_back(now_ns - send_time_ns);
+            ++received_count;
+        }
+    );
+    if (!server.listen(options.listen_address.c_str(), options.listen_port, use_epoll)) {
+        return result;
+    }
+
+    const char    connect_command = 'N';
+    const int32_t connect_count   = client_count;
+    static_cast<void>(::write(to_clients_fd, &connect_command, 1));
+    static_cast<void>(::write(to_clients_fd, &connect_count, sizeof(connect_count)));
+
+    // Accept until the load generator has connected and no more clients arrive
+    bool        clients_connected{false};
+    std::size_t last_client_count{0};
+    auto        last_progress = Clock::now();
+    for (;;) {
+        server.poll(1);
+        if (!clients_connected) {
+            pollfd fd{.fd = to_server_fd, .events = POLLIN, .revents = 0};
+            char   reply{0};
+            if ((::poll(&fd, 1, 0) == 1) && (::read(to_server_fd, &reply, 1) == 1)) {
+                clients_connected = true;
+                last_progress     = Clock::now();
+            }
+        }
+        const std::size_t current_client_count = server.get_client_count();
+        if (current_client_count != last_client_count) {
+            last_client_count = current_client_count;
+            last_progress     = Clock::now();
+        }
+        if (clients_connected && (current_client_count == static_cast<std::size_t>(client_count))) {
+            break;
+        }
+        if (clients_connected && (Clock::now() - last_progress > std::chrono::milliseconds{500})) {
+            break;
+        }
+    }
+    result.connected_count = static_cast<int>(server.get_client_count());
+    latencies_ns.reserve(static_cast<std::size_t>(result.connected_count) * static_cast<std::size_t>(options.net_benchmark_rounds));
+
+    result.ok = (result.connected_count > 0);
+    const auto      start_time = Clock::now();
+    Clock::duration poll_time{};
+    for (int round = 0; result.ok && (round < options.net_benchmark_rounds); ++round) {
+        const uint64_t target        = static_cast<uint64_t>(round + 1) * static_cast<uint64_t>(result.connected_count);
+        const char     round_command = 'R';
+        const auto     deadline      = Clock::now() + std::chrono::seconds{10};
+        static_cast<void>(::write(to_clients_fd, &round_command, 1));
+        while (received_count < target) {
+            if (Clock::now() > deadline) {
+                result.ok = false;
+                break;
+            }
+            const auto poll_start = Clock::now();
+            server.poll(1);
+            poll_time += Clock::now() - poll_start;
+        }
+    }
+    result.elapsed_s     = std::chrono::duration<double>(Clock::now() - start_time).count();
+    result.poll_s        = std::chrono::duration<double>(poll_time).count();
+    result.message_count = received_count;
+
+    const char close_command = 'X';
+    static_cast<void>(::write(to_clients_fd, &close_command, 1));
+    server.disconnect();
+
+    if (!latencies_ns.empty()) {
+        const auto percentile = [&latencies_ns](const double p) -> double {
+            const std::size_t i = static_cast<std::size_t>(p * static_cast<double>(latencies_ns.size() - 1));
+            std::nth_element(latencies_ns.begin(), latencies_ns.begin() + static_cast<std::ptrdiff_t>(i), latencies_ns.end());
+            return static_cast<double>(latencies_ns[i]) / 1000.0;
+        };
+        result.p50_us = percentile(0.50);
+        result.p99_us = percentile(0.99);
+    }
+    return result;
+}
+
+// Compares epoll and select() server backends over loopback. Latency is
+// from client send to server receive handler; both processes use the same
+// monotonic clock.
+auto run_net_benchmark(const Options& options) -> int
+{
+    // Server and client ends of each connection are in separate processes,
+    // but 10k clients still need more than the usual soft limit.
+    rlimit limit{};
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        limit.rlim_cur = limit.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+        fmt::print("file descriptor limit: {}\n", static_cast<uint64_t>(limit.rlim_cur));
+    }
+    ::signal(SIGPIPE, SIG_IGN);
+
+    int to_clients[2];
+    int to_server [2];
+    if ((::pipe(to_clients) != 0) || (::pipe(to_server) != 0)) {
+        fmt::print("pipe() failed\n");
+        return EXIT_FAILURE;
+    }
+    const pid_t child = ::fork();
+    if (child == 0) {
+        ::close(to_clients[1]);
+        ::close(to_server [0]);
+        run_net_benchmark_clients(options, to_clients[0], to_server[1]);
+    }
+    ::close(to_clients[0]);
+    ::close(to_server [1]);
+    if (child < 0) {
+        fmt::print("fork() failed\n");
+        return EXIT_FAILURE;
+    }
+
+    // Per connection logging would dominate
+    erhe::net::log_net   ->set_level(spdlog::level::err);
+    erhe::net::log_socket->set_level(spdlog::level::err);
+    erhe::net::log_client->set_level(spdlog::level::err);
+    erhe::net::log_server->set_level(spdlog::level::err);
+
+    fmt::print("{:>7} {:>8} {:>11} {:>10} {:>12} {:>10} {:>10} {:>14}\n", "backend", "clients", "connected", "messages", "msgs/s", "p50 us", "p99 us", "poll us/round");
+    bool ok = true;
+    for (const int client_count : options.net_benchmark_clients) {
+        for (const bool use_epoll : {true, false}) {
+            const Net_benchmark_result result = run_net_benchmark_case(options, client_count, use_epoll, to_clients[1], to_server[0]);
+            fmt::print(
+                "{:>7} {:>8} {:>11} {:>10} {:>12.0f} {:>10.1f} {:>10.1f} {:>14.1f}{}\n",
+                use_epoll ? "epoll" : "select",
+                client_count,
+                result.connected_count,
+                result.message_count,
+                (result.elapsed_s > 0.0) ? static_cast<double>(result.message_count) / result.elapsed_s : 0.0,
+                result.p50_us,
+                result.p99_us,
+                (options.net_benchmark_rounds > 0) ? result.poll_s * 1'000'000.0 / static_cast<double>(options.net_benchmark_rounds) : 0.0,
+                result.ok ? "" : "  (failed)"
+            );
+            // select() is expected to be limited by FD_SETSIZE
+            if (use_epoll && (!result.ok || (result.connected_count != client_count))) {
+                ok = false;
+            }
+        }
+    }
+
+    ::close(to_clients[1]);
+    ::close(to_server [0]);
+    ::waitpid(child, nullptr, 0);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+#endif
+
 auto main(int argc, char** argv) -> int
 {
     std::unique_ptr<Server_peer>    server_peer;
@@ -474,6 +979,15 @@ auto main(int argc, char** argv) -> int
     erhe::net::initialize_logging();
     erhe::net::initialize_net();
 
+    if (options.replication_benchmark) {
+        return run_replication_benchmark(options);
+    }
+#if defined(ERHE_OS_LINUX)
+    if (options.net_benchmark) {
+        return run_net_benchmark(options);
+    }
+#endif
+
     erhe::net::Client client;
     erhe::net::Server server;
 
@@ -44,6 +44,22 @@ void Compound_operation::undo(Editor_context& context)
     log_operations->trace("Op Undo End {}", describe());
 }
 
+auto Compound_operation::get_memory_usage() const -> std::size_t
+{
+    std::size_t sum = 0;
+    for (const auto& operation : m_parameters.operations) {
+        sum += operation->get_memory_usage();
+    }
+    return sum;
+}
+
+void Compound_operation::compact()
+{
+    for (const auto& operation : m_parameters.operations) {
+        operation->compact();
+    }
+}
+
 auto Compound_operation::describe() const -> std::string
 {
     std::stringstream ss;
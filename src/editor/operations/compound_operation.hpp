@@ -25,6 +25,8 @@ public:
     [[nodiscard]] auto describe() const -> std::string override;
     void execute(Editor_context& context) override;
     void undo   (Editor_context& context) override;
+    [[nodiscard]] auto get_memory_usage() const -> std::size_t override;
+    void compact() override;
 
 private:
     Parameters m_parameters;
@@ -1,5 +1,7 @@
 #include "operations/geometry_operations.hpp"
 
+#include "editor_context.hpp"
+
 #include "erhe_geometry/geometry.hpp"
 #include "erhe_geometry/operation/ambo.hpp"
 #include "erhe_geometry/operation/catmull_clark_subdivision.hpp"
@@ -29,7 +31,11 @@ auto Catmull_clark_subdivision_operation::describe() const -> std::string
 Catmull_clark_subdivision_operation::Catmull_clark_subdivision_operation(Parameters&& context)
     : Mesh_operation{std::move(context)}
 {
-    make_entries(erhe::geometry::operation::catmull_clark_subdivision);
+    make_entries(
+        [this](erhe::geometry::Geometry& geometry) {
+            return erhe::geometry::operation::catmull_clark_subdivision(geometry, m_parameters.context.thread_pool);
+        }
+    );
 }
 
 auto Sqrt3_subdivision_operation::describe() const -> std::string
@@ -40,7 +46,11 @@ auto Sqrt3_subdivision_operation::describe() const -> std::string
 Sqrt3_subdivision_operation::Sqrt3_subdivision_operation(Parameters&& context)
     : Mesh_operation{std::move(context)}
 {
-    make_entries(erhe::geometry::operation::sqrt3_subdivision);
+    make_entries(
+        [this](erhe::geometry::Geometry& geometry) {
+            return erhe::geometry::operation::sqrt3_subdivision(geometry, m_parameters.context.thread_pool);
+        }
+    );
 }
 
 auto Triangulate_operation::describe() const -> std::string
@@ -73,7 +83,11 @@ auto Kis_operation::describe() const -> std::string
 Kis_operation::Kis_operation(Parameters&& context)
     : Mesh_operation{std::move(context)}
 {
-    make_entries(erhe::geometry::operation::kis);
+    make_entries(
+        [this](erhe::geometry::Geometry& geometry) {
+            return erhe::geometry::operation::kis(geometry, m_parameters.context.thread_pool);
+        }
+    );
 }
 
 auto Subdivide_operation::describe() const -> std::string
@@ -84,7 +98,11 @@ auto Subdivide_operation::describe() const -> std::string
 Subdivide_operation::Subdivide_operation(Parameters&& context)
     : Mesh_operation{std::move(context)}
 {
-    make_entries(erhe::geometry::operation::subdivide);
+    make_entries(
+        [this](erhe::geometry::Geometry& geometry) {
+            return erhe::geometry::operation::subdivide(geometry, m_parameters.context.thread_pool);
+        }
+    );
 }
 
 auto Meta_operation::describe() const -> std::string
@@ -95,7 +113,11 @@ auto Meta_operation::describe() const -> std::string
 Meta_operation::Meta_operation(Parameters&& context)
     : Mesh_operation{std::move(context)}
 {
-    make_entries(erhe::geometry::operation::meta);
+    make_entries(
+        [this](erhe::geometry::Geometry& geometry) {
+            return erhe::geometry::operation::meta(geometry, m_parameters.context.thread_pool);
+        }
+    );
 }
 
 auto Gyro_operation::describe() const -> std::string
@@ -106,7 +128,11 @@ auto Gyro_operation::describe() const -> std::string
 Gyro_operation::Gyro_operation(Parameters&& context)
     : Mesh_operation{std::move(context)}
 {
-    make_entries(erhe::geometry::operation::gyro);
+    make_entries(
+        [this](erhe::geometry::Geometry& geometry) {
+            return erhe::geometry::operation::gyro(geometry, m_parameters.context.thread_pool);
+        }
+    );
 }
 
 auto Dual_operator::describe() const -> std::string
@@ -117,7 +143,11 @@ auto Dual_operator::describe() const -> std::string
 Dual_operator::Dual_operator(Parameters&& context)
     : Mesh_operation{std::move(context)}
 {
-    make_entries(erhe::geometry::operation::dual);
+    make_entries(
+        [this](erhe::geometry::Geometry& geometry) {
+            return erhe::geometry::operation::dual(geometry, m_parameters.context.thread_pool);
+        }
+    );
 }
 
 auto Ambo_operator::describe() const -> std::string
@@ -128,7 +158,11 @@ auto Ambo_operator::describe() const -> std::string
 Ambo_operator::Ambo_operator(Parameters&& context)
     : Mesh_operation{std::move(context)}
 {
-    make_entries(erhe::geometry::operation::ambo);
+    make_entries(
+        [this](erhe::geometry::Geometry& geometry) {
+            return erhe::geometry::operation::ambo(geometry, m_parameters.context.thread_pool);
+        }
+    );
 }
 
 auto Truncate_operator::describe() const -> std::string
@@ -139,7 +173,11 @@ auto Truncate_operator::describe() const -> std::string
 Truncate_operator::Truncate_operator(Parameters&& context)
     : Mesh_operation{std::move(context)}
 {
-    make_entries(erhe::geometry::operation::truncate);
+    make_entries(
+        [this](erhe::geometry::Geometry& geometry) {
+            return erhe::geometry::operation::truncate(geometry, m_parameters.context.thread_pool);
+        }
+    );
 }
 
 auto Reverse_operation::describe() const -> std::string
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 
 namespace editor
@@ -15,6 +16,13 @@ public:
     virtual void execute (Editor_context& context) = 0;
     virtual void undo    (Editor_context& context) = 0;
     virtual auto describe() const -> std::string = 0;
+
+    // Approximate memory held for undo / redo, in bytes
+    [[nodiscard]] virtual auto get_memory_usage() const -> std::size_t;
+
+    // Releases data which can be rebuilt when the operation is executed or undone again.
+    // Called for operations which are deep in the undo / redo history.
+    virtual void compact();
 };
 
 } // namespace editor
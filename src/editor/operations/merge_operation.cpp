@@ -36,6 +36,18 @@ auto Merge_operation::describe() const -> std::string
     return ss.str();
 }
 
+auto Merge_operation::get_memory_usage() const -> std::size_t
+{
+    // Source mesh primitives are held by the scene; count the merged result
+    std::size_t sum = 0;
+    for (const auto& primitive : m_first_mesh_primitives_after) {
+        if (primitive.geometry_primitive) {
+            sum += primitive.geometry_primitive->get_memory_usage();
+        }
+    }
+    return sum;
+}
+
 Merge_operation::Merge_operation(Parameters&& parameters)
     : m_parameters{std::move(parameters)}
 {
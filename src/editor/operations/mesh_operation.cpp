@@ -40,17 +40,8 @@ void Mesh_operation::execute(Editor_context&)
 {
     log_operations->trace("Op Execute {}", describe());
 
-    for (const auto& entry : m_entries) {
-        auto* node = entry.mesh->get_node();
-        entry.mesh->set_primitives(entry.after.primitives);
-
-        auto old_node_physics = get_node_physics(node);
-        if (old_node_physics) {
-            node->detach(old_node_physics.get());
-        }
-        if (entry.after.node_physics) {
-            node->attach(entry.after.node_physics);
-        }
+    for (auto& entry : m_entries) {
+        apply(entry, entry.after);
     }
 }
 
@@ -58,16 +49,85 @@ void Mesh_operation::undo(Editor_context&)
 {
     log_operations->trace("Op Undo {}", describe());
 
-    for (const auto& entry : m_entries) {
-        auto* node = entry.mesh->get_node();
-        entry.mesh->set_primitives(entry.before.primitives);
+    for (auto& entry : m_entries) {
+        apply(entry, entry.before);
+    }
+}
+
+void Mesh_operation::apply(Entry& entry, Entry::Version& version)
+{
+    // Rebuild buffers for primitives released by compact()
+    for (auto& primitive : version.primitives) {
+        auto& geometry_primitive = primitive.geometry_primitive;
+        if (!geometry_primitive || geometry_primitive->has_buffers() || !geometry_primitive->source_geometry) {
+            continue;
+        }
+        geometry_primitive = std::make_shared<erhe::primitive::Geometry_primitive>(
+            geometry_primitive->source_geometry,
+            m_parameters.build_info,
+            geometry_primitive->normal_style
+        );
+    }
+
+    auto* node = entry.mesh->get_node();
+    entry.mesh->set_primitives(version.primitives);
+
+    auto old_node_physics = get_node_physics(node);
+    if (old_node_physics) {
+        node->detach(old_node_physics.get());
+    }
+    if (version.node_physics) {
+        node->attach(version.node_physics);
+    }
+}
 
-        auto old_node_physics = get_node_physics(node);
-        if (old_node_physics) {
-            node->detach(old_node_physics.get());
+namespace {
+
+[[nodiscard]] auto is_shared(
+    const erhe::primitive::Primitive&              primitive,
+    const std::vector<erhe::primitive::Primitive>& primitives
+) -> bool
+{
+    for (const auto& other : primitives) {
+        if (other.geometry_primitive == primitive.geometry_primitive) {
+            return true;
         }
-        if (entry.before.node_physics) {
-            node->attach(entry.before.node_physics);
+    }
+    return false;
+}
+
+}
+
+auto Mesh_operation::get_memory_usage() const -> std::size_t
+{
+    // Before primitives are held by the scene or by the previous operation,
+    // so only primitives made by this operation are counted.
+    std::size_t sum = 0;
+    for (const auto& entry : m_entries) {
+        for (const auto& primitive : entry.after.primitives) {
+            if (primitive.geometry_primitive && !is_shared(primitive, entry.before.primitives)) {
+                sum += primitive.geometry_primitive->get_memory_usage();
+            }
+        }
+    }
+    return sum;
+}
+
+void Mesh_operation::compact()
+{
+    // Keep source geometry only; apply() rebuilds buffers when needed.
+    // Other holders of the same Geometry_primitive are not affected.
+    for (auto& entry : m_entries) {
+        for (Entry::Version* version : {&entry.before, &entry.after}) {
+            for (auto& primitive : version->primitives) {
+                auto& geometry_primitive = primitive.geometry_primitive;
+                if (!geometry_primitive || !geometry_primitive->has_buffers() || !geometry_primitive->source_geometry) {
+                    continue;
+                }
+                const erhe::primitive::Normal_style normal_style = geometry_primitive->normal_style;
+                geometry_primitive = std::make_shared<erhe::primitive::Geometry_primitive>(geometry_primitive->source_geometry);
+                geometry_primitive->normal_style = normal_style;
+            }
         }
     }
 }
@@ -131,6 +191,8 @@ void Mesh_operation::make_entries(
 
         for (auto& primitive : mesh->get_primitives()) {
             if (!primitive.geometry_primitive->source_geometry) {
+                // Unchanged primitive is shared by before and after
+                entry.after.primitives.push_back(primitive);
                 continue;
             }
             auto after_geometry = std::make_shared<erhe::geometry::Geometry>(
@@ -55,6 +55,8 @@ protected:
     [[nodiscard]] auto describe() const -> std::string override;
     void execute(Editor_context& context) override;
     void undo   (Editor_context& context) override;
+    [[nodiscard]] auto get_memory_usage() const -> std::size_t override;
+    void compact() override;
 
     // Public API
     void add_entry(Entry&& entry);
@@ -63,6 +65,8 @@ protected:
     );
 
 protected:
+    void apply(Entry& entry, Entry::Version& version);
+
     Parameters         m_parameters;
     std::vector<Entry> m_entries;
 };
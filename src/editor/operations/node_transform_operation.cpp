@@ -107,7 +107,7 @@ void Node_transform_operation::execute(Editor_context& context)
 {
     log_operations->trace("Op Execute {}", describe());
     m_parameters.node->set_parent_from_node(m_parameters.parent_from_node_after);
-    context.editor_message_bus->send_message(
+    context.editor_message_bus->queue_message(
         Editor_message{
             .update_flags = Message_flag_bit::c_flag_bit_node_touched_operation_stack,
             .node         = m_parameters.node.get()
@@ -119,7 +119,7 @@ void Node_transform_operation::undo(Editor_context& context)
 {
     log_operations->trace("Op Undo {}", describe());
     m_parameters.node->set_parent_from_node(m_parameters.parent_from_node_before);
-    context.editor_message_bus->send_message(
+    context.editor_message_bus->queue_message(
         Editor_message{
             .update_flags = Message_flag_bit::c_flag_bit_node_touched_operation_stack,
             .node         = m_parameters.node.get()
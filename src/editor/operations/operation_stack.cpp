@@ -1,9 +1,12 @@
 #include "operations/operation_stack.hpp"
 
 #include "editor_context.hpp"
+#include "editor_log.hpp"
 #include "operations/ioperation.hpp"
 #include "tools/tool.hpp"
 
+#include "erhe_concurrency/concurrent_queue.hpp"
+#include "erhe_configuration/configuration.hpp"
 #include "erhe_imgui/imgui_windows.hpp"
 #include "erhe_commands/commands.hpp"
 #include "erhe_profile/profile.hpp"
@@ -12,7 +15,9 @@
 #   include <imgui/imgui.h>
 #endif
 
-#include <taskflow/taskflow.hpp>
+#include <fmt/format.h>
+
+#include <algorithm>
 
 namespace editor
 {
@@ -21,6 +26,15 @@ IOperation::~IOperation() noexcept
 {
 }
 
+auto IOperation::get_memory_usage() const -> std::size_t
+{
+    return 0;
+}
+
+void IOperation::compact()
+{
+}
+
 #pragma region Commands
 Undo_command::Undo_command(
     erhe::commands::Commands& commands,
@@ -77,7 +91,17 @@ Operation_stack::Operation_stack(
     commands.bind_command_to_key(&m_undo_command, erhe::window::Key_z, true, erhe::window::Key_modifier_bit_ctrl);
     commands.bind_command_to_key(&m_redo_command, erhe::window::Key_y, true, erhe::window::Key_modifier_bit_ctrl);
 
-    m_executor = std::make_unique<tf::Executor>();
+    if (editor_context.thread_pool != nullptr) {
+        m_async_queue = std::make_unique<erhe::concurrency::Concurrent_queue>(*editor_context.thread_pool, "operation_stack");
+    }
+
+    auto ini = erhe::configuration::get_ini("erhe.ini", "undo");
+    int memory_budget_mb{512};
+    int compact_depth   {8};
+    ini->get("memory_budget", memory_budget_mb);
+    ini->get("compact_depth", compact_depth);
+    m_memory_budget = static_cast<std::size_t>(std::max(memory_budget_mb, 0)) * 1024 * 1024;
+    m_compact_depth = static_cast<std::size_t>(std::max(compact_depth, 0));
 
     m_undo_command.set_host(this);
     m_redo_command.set_host(this);
@@ -85,30 +109,45 @@ Operation_stack::Operation_stack(
 
 Operation_stack::~Operation_stack() = default;
 
-auto Operation_stack::get_executor() -> tf::Executor&
-{
-    return *m_executor.get();
-}
-
 void Operation_stack::queue(
     const std::shared_ptr<IOperation>& operation
 )
 {
+    const std::lock_guard<std::mutex> lock{m_queued_mutex};
     m_queued.push_back(operation);
 }
 
-void Operation_stack::update()
+void Operation_stack::queue_async(std::function<std::shared_ptr<IOperation>()>&& make_operation)
 {
-    if (m_queued.empty()) {
+    if (!m_async_queue) {
+        queue(make_operation());
         return;
     }
+    m_async_queue->enqueue(
+        [this, make_operation = std::move(make_operation)]() {
+            queue(make_operation());
+        }
+    );
+}
+
+void Operation_stack::update()
+{
+    std::vector<std::shared_ptr<IOperation>> queued;
+    {
+        const std::lock_guard<std::mutex> lock{m_queued_mutex};
+        if (m_queued.empty()) {
+            return;
+        }
+        std::swap(queued, m_queued);
+    }
 
-    for (const auto& operation : m_queued) {
+    for (const auto& operation : queued) {
         operation->execute(m_context);
         m_executed.push_back(operation);
     }
-    m_queued.clear();
     m_undone.clear();
+
+    apply_memory_budget();
 }
 
 void Operation_stack::undo()
@@ -120,6 +159,8 @@ void Operation_stack::undo()
     m_executed.pop_back();
     operation->undo(m_context);
     m_undone.push_back(operation);
+
+    apply_memory_budget();
 }
 
 void Operation_stack::redo()
@@ -131,6 +172,8 @@ void Operation_stack::redo()
     m_undone.pop_back();
     operation->execute(m_context);
     m_executed.push_back(operation);
+
+    apply_memory_budget();
 }
 
 auto Operation_stack::can_undo() const -> bool
@@ -143,6 +186,49 @@ auto Operation_stack::can_redo() const -> bool
     return !m_undone.empty();
 }
 
+auto Operation_stack::get_memory_usage() const -> std::size_t
+{
+    std::size_t sum = 0;
+    for (const auto& operation : m_executed) {
+        sum += operation->get_memory_usage();
+    }
+    for (const auto& operation : m_undone) {
+        sum += operation->get_memory_usage();
+    }
+    return sum;
+}
+
+void Operation_stack::apply_memory_budget()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    // Front of both stacks is furthest away from the current state
+    if (m_executed.size() > m_compact_depth) {
+        for (std::size_t i = 0, end = m_executed.size() - m_compact_depth; i < end; ++i) {
+            m_executed[i]->compact();
+        }
+    }
+    if (m_undone.size() > m_compact_depth) {
+        for (std::size_t i = 0, end = m_undone.size() - m_compact_depth; i < end; ++i) {
+            m_undone[i]->compact();
+        }
+    }
+
+    // Drop oldest undo steps first, then furthest redo steps.
+    // The most recently executed operation is always kept.
+    std::size_t memory_usage = get_memory_usage();
+    while ((memory_usage > m_memory_budget) && (m_executed.size() > 1)) {
+        memory_usage -= m_executed.front()->get_memory_usage();
+        log_operations->info("Undo memory budget exceeded, dropping {}", m_executed.front()->describe());
+        m_executed.erase(m_executed.begin());
+    }
+    while ((memory_usage > m_memory_budget) && !m_undone.empty()) {
+        memory_usage -= m_undone.front()->get_memory_usage();
+        log_operations->info("Undo memory budget exceeded, dropping redo {}", m_undone.front()->describe());
+        m_undone.erase(m_undone.begin());
+    }
+}
+
 #if defined(ERHE_GUI_LIBRARY_IMGUI)
 void Operation_stack::imgui(
     const char*                                     stack_label,
@@ -162,7 +248,12 @@ void Operation_stack::imgui(
 
     if (ImGui::TreeNodeEx(stack_label, parent_flags)) {
         for (const auto& op : operations) {
-            ImGui::TreeNodeEx(op->describe().c_str(), leaf_flags);
+            const std::string label = fmt::format(
+                "{} ({:.2f} MB)",
+                op->describe(),
+                static_cast<double>(op->get_memory_usage()) / (1024.0 * 1024.0)
+            );
+            ImGui::TreeNodeEx(label.c_str(), leaf_flags);
         }
         ImGui::TreePop();
     }
@@ -174,6 +265,11 @@ void Operation_stack::imgui()
     ERHE_PROFILE_FUNCTION();
 
 #if defined(ERHE_GUI_LIBRARY_IMGUI)
+    ImGui::Text(
+        "Memory: %.2f / %.2f MB",
+        static_cast<double>(get_memory_usage()) / (1024.0 * 1024.0),
+        static_cast<double>(m_memory_budget)    / (1024.0 * 1024.0)
+    );
     imgui("Executed", m_executed);
     imgui("Undone", m_undone);
 #endif
@@ -3,18 +3,21 @@
 #include "erhe_commands/command.hpp"
 #include "erhe_imgui/imgui_window.hpp"
 
+#include <cstddef>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 namespace erhe::commands {
     class CommandS;
 }
+namespace erhe::concurrency {
+    class Concurrent_queue;
+}
 namespace erhe::imgui {
     class Imgui_windows;
 }
-namespace tf {
-    class Executor;
-}
 
 namespace editor
 {
@@ -69,7 +72,13 @@ public:
 
     [[nodiscard]] auto can_undo() const -> bool;
     [[nodiscard]] auto can_redo() const -> bool;
+    [[nodiscard]] auto get_memory_usage() const -> std::size_t;
     void queue(const std::shared_ptr<IOperation>& operation);
+
+    // Calls make_operation() on the editor thread pool and queues the
+    // returned operation. For operations which do their work when they
+    // are constructed. Runs inline without a thread pool.
+    void queue_async(std::function<std::shared_ptr<IOperation>()>&& make_operation);
     void undo();
     void redo();
 
@@ -78,9 +87,8 @@ public:
     // Implements Window
     void imgui() override;
 
-    [[nodiscard]] auto get_executor() -> tf::Executor&;
-
 private:
+    void apply_memory_budget();
     void imgui(
         const char*                                     stack_label,
         const std::vector<std::shared_ptr<IOperation>>& operations
@@ -91,11 +99,16 @@ private:
     Undo_command m_undo_command;
     Redo_command m_redo_command;
 
-    std::unique_ptr<tf::Executor> m_executor;
-
     std::vector<std::shared_ptr<IOperation>> m_executed;
     std::vector<std::shared_ptr<IOperation>> m_undone;
+    std::mutex                               m_queued_mutex;
     std::vector<std::shared_ptr<IOperation>> m_queued;
+
+    std::size_t m_memory_budget{512 * 1024 * 1024}; // Oldest operations are dropped when exceeded
+    std::size_t m_compact_depth{8};                 // Deeper operations are compacted
+
+    // Declared last, so that tasks in flight complete before m_queued is destroyed
+    std::unique_ptr<erhe::concurrency::Concurrent_queue> m_async_queue;
 };
 
 } // namespace editor
@@ -87,6 +87,9 @@ void Node_physics::handle_item_host_update(
         Scene_root* old_scene_root = static_cast<Scene_root*>(old_item_host);
         old_scene_root->unregister_node_physics(shared_this);
         m_rigid_body.reset();
+        m_has_snapshot     = false;
+        m_snapshot_pending = false;
+        m_synced_serial    = 0;
     }
     if (new_item_host != nullptr) {
         Scene_root* new_scene_root = static_cast<Scene_root*>(new_item_host);
@@ -101,45 +104,99 @@ void Node_physics::handle_item_host_update(
 
 void Node_physics::before_physics_simulation()
 {
-    const erhe::scene::Trs_transform& world_from_node_transform = get_node()->world_from_node_transform();
+    erhe::scene::Node* node = get_node();
+    if (node->node_data.transforms.world_from_node_serial == m_synced_serial) {
+        return;
+    }
+
+    // Node was moved by something else than physics
+    const erhe::scene::Trs_transform& world_from_node_transform = node->world_from_node_transform();
     erhe::physics::Transform transform{
         glm::mat3_cast(world_from_node_transform.get_rotation()),
         world_from_node_transform.get_translation()
     };
     m_rigid_body->set_world_transform(transform);
 
-    const auto get_transform = m_rigid_body->get_world_transform();
-    const glm::vec3 get_world_position = glm::vec3{get_transform * glm::vec4{0.0f, 0.0f, 0.0f, 1.0f}};
+    // Restart interpolation from the new transform
+    m_previous_position = world_from_node_transform.get_translation();
+    m_previous_rotation = world_from_node_transform.get_rotation();
+    m_current_position  = m_previous_position;
+    m_current_rotation  = m_previous_rotation;
+    m_has_snapshot      = true;
+    m_snapshot_pending  = false;
+    m_synced_serial     = node->node_data.transforms.world_from_node_serial;
 }
 
-// This is intended to be called from physics backend
-void Node_physics::after_physics_simulation()
+void Node_physics::push_snapshot(
+    const glm::vec3 world_position,
+    const glm::quat world_rotation,
+    const uint64_t  physics_step
+)
 {
-    ERHE_PROFILE_FUNCTION();
-
-    ERHE_VERIFY(m_node != nullptr);
     ERHE_VERIFY(m_rigid_body);
 
-    const auto motion_mode = m_rigid_body->get_motion_mode();
-    if (motion_mode != erhe::physics::Motion_mode::e_dynamic) {
-        return;
-    }
-
-    const auto transform = m_rigid_body->get_world_transform();
-    const glm::vec3 world_position = glm::vec3{transform * glm::vec4{0.0f, 0.0f, 0.0f, 1.0f}};
+    m_snapshot_step    = physics_step;
+    m_snapshot_pending = true;
 
     if (world_position.y < -100.0f) {
         const glm::vec3 respawn_location{0.0f, 8.0f, 0.0f};
         m_rigid_body->set_world_transform (erhe::physics::Transform{glm::mat3{1.0f}, respawn_location});
         m_rigid_body->set_linear_velocity (glm::vec3{0.0f, 0.0f, 0.0f});
         m_rigid_body->set_angular_velocity(glm::vec3{0.0f, 0.0f, 0.0f});
-        const glm::mat4 matrix = erhe::math::create_translation<float>(respawn_location);
-        get_node()->set_world_from_node(matrix);
+
+        // Do not interpolate across the teleport
+        m_previous_position = respawn_location;
+        m_previous_rotation = glm::quat{1.0f, 0.0f, 0.0f, 0.0f};
+        m_current_position  = m_previous_position;
+        m_current_rotation  = m_previous_rotation;
+        m_has_snapshot      = true;
+        return;
+    }
+
+    if (m_has_snapshot) {
+        m_previous_position = m_current_position;
+        m_previous_rotation = m_current_rotation;
     } else {
-        get_node()->set_world_from_node(transform);
+        m_previous_position = world_position;
+        m_previous_rotation = world_rotation;
+        m_has_snapshot      = true;
+    }
+    m_current_position = world_position;
+    m_current_rotation = world_rotation;
+}
+
+void Node_physics::settle_snapshot()
+{
+    // Body did not move during the latest step
+    if ((m_previous_position != m_current_position) || (m_previous_rotation != m_current_rotation)) {
+        m_previous_position = m_current_position;
+        m_previous_rotation = m_current_rotation;
+        m_snapshot_pending  = true;
     }
 }
 
+void Node_physics::interpolate_snapshot(const float alpha, glm::vec3& world_position, glm::quat& world_rotation)
+{
+    world_position     = glm::mix  (m_previous_position, m_current_position, alpha);
+    world_rotation     = glm::slerp(m_previous_rotation, m_current_rotation, alpha);
+    m_snapshot_pending = false;
+}
+
+void Node_physics::mark_synced()
+{
+    m_synced_serial = get_node()->node_data.transforms.world_from_node_serial;
+}
+
+auto Node_physics::get_snapshot_step() const -> uint64_t
+{
+    return m_snapshot_step;
+}
+
+auto Node_physics::is_snapshot_pending() const -> bool
+{
+    return m_snapshot_pending;
+}
+
 auto Node_physics::get_rigid_body() -> IRigid_body*
 {
     return (m_physics_world != nullptr) ? m_rigid_body.get() : nullptr;
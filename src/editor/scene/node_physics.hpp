@@ -45,8 +45,19 @@ public:
     [[nodiscard]] auto get_rigid_body     () const -> const erhe::physics::IRigid_body*;
     [[nodiscard]] auto get_world_from_node() const -> erhe::physics::Transform;
 
+    // Pushes node transform to rigid body, unless node still has the transform
+    // last written from physics
     void before_physics_simulation();
-    void after_physics_simulation();
+
+    // Physics snapshots. After each fixed step, the rigid body transform is
+    // pushed as current snapshot, and the old current becomes previous.
+    // Rendered node transform is interpolated between the two.
+    void push_snapshot       (glm::vec3 world_position, glm::quat world_rotation, uint64_t physics_step);
+    void settle_snapshot     ();
+    void interpolate_snapshot(float alpha, glm::vec3& world_position, glm::quat& world_rotation);
+    void mark_synced         ();
+    [[nodiscard]] auto get_snapshot_step () const -> uint64_t;
+    [[nodiscard]] auto is_snapshot_pending() const -> bool;
 
     void set_physics_world(erhe::physics::IWorld* value);
     [[nodiscard]] auto get_physics_world() const -> erhe::physics::IWorld*;
@@ -59,6 +70,15 @@ private:
     erhe::physics::IWorld*                      m_physics_world{nullptr};
     erhe::physics::IRigid_body_create_info      m_create_info;
     std::shared_ptr<erhe::physics::IRigid_body> m_rigid_body;
+
+    glm::vec3 m_previous_position{0.0f, 0.0f, 0.0f};
+    glm::quat m_previous_rotation{1.0f, 0.0f, 0.0f, 0.0f};
+    glm::vec3 m_current_position {0.0f, 0.0f, 0.0f};
+    glm::quat m_current_rotation {1.0f, 0.0f, 0.0f, 0.0f};
+    uint64_t  m_snapshot_step    {0};
+    bool      m_has_snapshot     {false};
+    bool      m_snapshot_pending {false}; // snapshot not yet written to node
+    uint64_t  m_synced_serial    {0};     // node world_from_node_serial after last write from physics
 };
 
 auto is_physics(const erhe::Item_base* item) -> bool;
@@ -1,5 +1,6 @@
 #include "scene/scene_builder.hpp"
 
+#include "editor_context.hpp"
 #include "editor_rendering.hpp"
 #include "editor_scenes.hpp"
 #include "editor_settings.hpp"
@@ -404,7 +405,8 @@ auto Scene_builder::build_info(Mesh_memory& mesh_memory) -> erhe::primitive::Bui
             .corner_points   = true,
             .centroid_points = true
         },
-        .buffer_info = mesh_memory.buffer_info
+        .buffer_info = mesh_memory.buffer_info,
+        .thread_pool = m_context.thread_pool
     };
 }
 
@@ -439,12 +441,8 @@ void Scene_builder::make_brushes(
     std::unique_ptr<ITask_queue> execution_queue;
 
     const bool parallel_initialization = false; //// TODO
-    if (parallel_initialization) {
-        const std::size_t thread_count = std::min(
-            8U,
-            std::max(std::thread::hardware_concurrency() - 0, 1U)
-        );
-        execution_queue = std::make_unique<Parallel_task_queue>("scene builder", thread_count);
+    if (parallel_initialization && (m_context.thread_pool != nullptr)) {
+        execution_queue = std::make_unique<Parallel_task_queue>("scene builder", *m_context.thread_pool);
     } else {
         execution_queue = std::make_unique<Serial_task_queue>();
     }
@@ -0,0 +1,914 @@
+#include "scene/scene_replication.hpp"
+
+#include "erhe_net/packet.hpp"
+#include "erhe_net/server.hpp"
+#include "erhe_scene/light.hpp"
+#include "erhe_scene/node.hpp"
+#include "erhe_scene/scene.hpp"
+#include "erhe_scene/scene_message.hpp"
+#include "erhe_scene/scene_message_bus.hpp"
+#include "erhe_profile/profile.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+namespace editor
+{
+
+using erhe::scene::Node;
+using erhe::scene::Scene_message;
+using erhe::Item_flags;
+
+namespace {
+
+// Message layout, integers are little endian:
+//
+//   magic 'E' 'r' 'S' 'R', u8 version, varint frame number,
+//   u64 server steady clock ns, u32 record count, records
+//
+// Each record is u8 record type, varint node id, and record data.
+// Node id 0 refers to the scene root node.
+constexpr uint8_t c_magic[4]{'E', 'r', 'S', 'R'};
+constexpr uint8_t c_version{2};
+constexpr std::size_t c_header_size{sizeof(c_magic) + 1};
+
+enum class Record_type : uint8_t {
+    added       = 1, // varint parent id, name, varint flags, transform, attachments
+    removed     = 2, //
+    transform   = 3, // transform
+    flags       = 4, // varint flags
+    parent      = 5, // varint parent id
+    attachments = 6, // attachments
+    keyframe    = 7  // (node id 0) nodes not added in this frame are removed
+};
+
+// Attachments are written as varint count, and for each u8 attachment type,
+// varint byte count and attachment data, so that unknown types can be skipped.
+enum class Attachment_type : uint8_t {
+    light = 1
+};
+
+// Transform is u8 mask, followed by zigzag varint deltas of masked
+// components to the previous transform of the node.
+constexpr uint8_t c_mask_translation_x{1u << 0};
+constexpr uint8_t c_mask_rotation     {1u << 3}; // u8 largest component + 3 deltas
+constexpr uint8_t c_mask_scale_x      {1u << 4};
+
+constexpr float c_translation_scale{1024.0f};  // 1/1024 units
+constexpr float c_scale_scale      {4096.0f};
+constexpr float c_rotation_scale   {46340.0f}; // 32767 * sqrt(2), smallest three are within +-1/sqrt(2)
+
+// Selection and message suppression are local to each editor instance
+constexpr uint64_t c_replicated_flag_bits =
+    ((uint64_t{1} << Item_flags::count) - 1) & ~(Item_flags::selected | Item_flags::no_message);
+
+auto now_ns() -> uint64_t
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count()
+    );
+}
+
+auto to_fixed(const float value, const float scale) -> int32_t
+{
+    const double fixed = std::round(static_cast<double>(value) * static_cast<double>(scale));
+    return static_cast<int32_t>(std::clamp(fixed, -2147483647.0, 2147483647.0));
+}
+
+auto quantize(const erhe::scene::Trs_transform& transform) -> Quantized_transform
+{
+    Quantized_transform result;
+    const glm::vec3 translation = transform.get_translation();
+    const glm::vec3 scale       = transform.get_scale();
+    for (int i = 0; i < 3; ++i) {
+        result.translation[i] = to_fixed(translation[i], c_translation_scale);
+        result.scale      [i] = to_fixed(scale      [i], c_scale_scale);
+    }
+
+    const glm::quat q = glm::normalize(transform.get_rotation());
+    float c[4]{q.x, q.y, q.z, q.w};
+    uint8_t largest = 0;
+    for (uint8_t i = 1; i < 4; ++i) {
+        if (std::abs(c[i]) > std::abs(c[largest])) {
+            largest = i;
+        }
+    }
+    // q and -q are the same rotation; make the omitted component positive
+    const float sign = (c[largest] < 0.0f) ? -1.0f : 1.0f;
+    result.rotation_largest = largest;
+    for (int i = 0, j = 0; i < 4; ++i) {
+        if (i != largest) {
+            result.rotation[j++] = static_cast<int32_t>(std::lround(sign * c[i] * c_rotation_scale));
+        }
+    }
+    return result;
+}
+
+void dequantize(const Quantized_transform& quantized, erhe::scene::Trs_transform& transform)
+{
+    glm::vec3 translation;
+    glm::vec3 scale;
+    for (int i = 0; i < 3; ++i) {
+        translation[i] = static_cast<float>(quantized.translation[i]) / c_translation_scale;
+        scale      [i] = static_cast<float>(quantized.scale      [i]) / c_scale_scale;
+    }
+
+    float c[4]{};
+    float sum_of_squares{0.0f};
+    const int largest = std::min<int>(quantized.rotation_largest, 3);
+    for (int i = 0, j = 0; i < 4; ++i) {
+        if (i != largest) {
+            c[i] = static_cast<float>(quantized.rotation[j++]) / c_rotation_scale;
+            sum_of_squares += c[i] * c[i];
+        }
+    }
+    c[largest] = std::sqrt(std::max(0.0f, 1.0f - sum_of_squares));
+    const glm::quat rotation = glm::normalize(glm::quat{c[3], c[0], c[1], c[2]});
+
+    transform.set_trs(translation, rotation, scale);
+}
+
+class Writer
+{
+public:
+    explicit Writer(std::vector<uint8_t>& buffer)
+        : m_buffer{buffer}
+    {
+    }
+
+    void u8(const uint8_t value)
+    {
+        m_buffer.push_back(value);
+    }
+    void u32(const uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i) {
+            m_buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+    void u64(const uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i) {
+            m_buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+    void varint(uint64_t value)
+    {
+        while (value >= 0x80u) {
+            m_buffer.push_back(static_cast<uint8_t>(value | 0x80u));
+            value >>= 7;
+        }
+        m_buffer.push_back(static_cast<uint8_t>(value));
+    }
+    void zigzag(const int64_t value)
+    {
+        varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+    void f32(const float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        u32(bits);
+    }
+    void string(const std::string& value)
+    {
+        varint(value.size());
+        m_buffer.insert(m_buffer.end(), value.begin(), value.end());
+    }
+    void transform(const Quantized_transform& previous, const Quantized_transform& current)
+    {
+        uint8_t mask{0};
+        for (int i = 0; i < 3; ++i) {
+            if (current.translation[i] != previous.translation[i]) mask |= static_cast<uint8_t>(c_mask_translation_x << i);
+            if (current.scale      [i] != previous.scale      [i]) mask |= static_cast<uint8_t>(c_mask_scale_x       << i);
+        }
+        if ((current.rotation != previous.rotation) || (current.rotation_largest != previous.rotation_largest)) {
+            mask |= c_mask_rotation;
+        }
+        u8(mask);
+        for (int i = 0; i < 3; ++i) {
+            if ((mask & (c_mask_translation_x << i)) != 0) {
+                zigzag(static_cast<int64_t>(current.translation[i]) - previous.translation[i]);
+            }
+        }
+        if ((mask & c_mask_rotation) != 0) {
+            u8(current.rotation_largest);
+            for (int i = 0; i < 3; ++i) {
+                zigzag(static_cast<int64_t>(current.rotation[i]) - previous.rotation[i]);
+            }
+        }
+        for (int i = 0; i < 3; ++i) {
+            if ((mask & (c_mask_scale_x << i)) != 0) {
+                zigzag(static_cast<int64_t>(current.scale[i]) - previous.scale[i]);
+            }
+        }
+    }
+    void attachments(const Node& node)
+    {
+        std::size_t light_count{0};
+        for (const auto& attachment : node.get_attachments()) {
+            if (erhe::scene::is_light(attachment)) {
+                ++light_count;
+            }
+        }
+        varint(light_count);
+        for (const auto& attachment : node.get_attachments()) {
+            if (!erhe::scene::is_light(attachment)) {
+                continue;
+            }
+            const auto* light = static_cast<const erhe::scene::Light*>(attachment.get());
+            u8(static_cast<uint8_t>(Attachment_type::light));
+            const std::size_t length_offset = m_buffer.size();
+            u32(0); // patched below
+            const std::size_t data_offset = m_buffer.size();
+            string(light->get_name());
+            u8    (static_cast<uint8_t>(light->type));
+            f32   (light->color.r);
+            f32   (light->color.g);
+            f32   (light->color.b);
+            f32   (light->intensity);
+            f32   (light->range);
+            f32   (light->inner_spot_angle);
+            f32   (light->outer_spot_angle);
+            u8    (static_cast<uint8_t>((light->cast_shadow ? 1u : 0u) | (light->tight_frustum_fit ? 2u : 0u)));
+            varint(light->layer_id);
+            const uint32_t length = static_cast<uint32_t>(m_buffer.size() - data_offset);
+            for (int i = 0; i < 4; ++i) {
+                m_buffer[length_offset + i] = static_cast<uint8_t>(length >> (8 * i));
+            }
+        }
+    }
+
+private:
+    std::vector<uint8_t>& m_buffer;
+};
+
+// Reads are bounds checked; reading past the end sets is_ok() false and
+// returns zero values.
+class Reader
+{
+public:
+    Reader(const uint8_t* data, const std::size_t length)
+        : m_data{data}
+        , m_end {data + length}
+    {
+    }
+
+    [[nodiscard]] auto is_ok    () const -> bool { return m_ok; }
+    [[nodiscard]] auto remaining() const -> std::size_t { return static_cast<std::size_t>(m_end - m_data); }
+
+    auto u8() -> uint8_t
+    {
+        if (!check(1)) {
+            return 0;
+        }
+        return *m_data++;
+    }
+    auto u32() -> uint32_t
+    {
+        if (!check(4)) {
+            return 0;
+        }
+        uint32_t value{0};
+        for (int i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(*m_data++) << (8 * i);
+        }
+        return value;
+    }
+    auto u64() -> uint64_t
+    {
+        if (!check(8)) {
+            return 0;
+        }
+        uint64_t value{0};
+        for (int i = 0; i < 8; ++i) {
+            value |= static_cast<uint64_t>(*m_data++) << (8 * i);
+        }
+        return value;
+    }
+    auto varint() -> uint64_t
+    {
+        uint64_t value{0};
+        for (int shift = 0; shift < 64; shift += 7) {
+            const uint8_t byte = u8();
+            value |= static_cast<uint64_t>(byte & 0x7fu) << shift;
+            if ((byte & 0x80u) == 0) {
+                return value;
+            }
+        }
+        m_ok = false;
+        return 0;
+    }
+    auto zigzag() -> int64_t
+    {
+        const uint64_t value = varint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1u);
+    }
+    auto f32() -> float
+    {
+        const uint32_t bits = u32();
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    auto string() -> std::string
+    {
+        const uint64_t length = varint();
+        if (!check(length)) {
+            return {};
+        }
+        std::string value{reinterpret_cast<const char*>(m_data), static_cast<std::size_t>(length)};
+        m_data += length;
+        return value;
+    }
+    void skip(const uint64_t length)
+    {
+        if (check(length)) {
+            m_data += length;
+        }
+    }
+    void transform(Quantized_transform& transform)
+    {
+        const uint8_t mask = u8();
+        for (int i = 0; i < 3; ++i) {
+            if ((mask & (c_mask_translation_x << i)) != 0) {
+                transform.translation[i] = static_cast<int32_t>(transform.translation[i] + zigzag());
+            }
+        }
+        if ((mask & c_mask_rotation) != 0) {
+            transform.rotation_largest = u8();
+            for (int i = 0; i < 3; ++i) {
+                transform.rotation[i] = static_cast<int32_t>(transform.rotation[i] + zigzag());
+            }
+        }
+        for (int i = 0; i < 3; ++i) {
+            if ((mask & (c_mask_scale_x << i)) != 0) {
+                transform.scale[i] = static_cast<int32_t>(transform.scale[i] + zigzag());
+            }
+        }
+        if (transform.rotation_largest > 3) {
+            m_ok = false;
+        }
+    }
+    auto light() -> std::shared_ptr<erhe::scene::Light>
+    {
+        const std::string name = string();
+        auto light = std::make_shared<erhe::scene::Light>(name);
+        const uint8_t type = u8();
+        light->type             = static_cast<erhe::scene::Light_type>(std::min<uint8_t>(type, 2));
+        light->color.r          = f32();
+        light->color.g          = f32();
+        light->color.b          = f32();
+        light->intensity        = f32();
+        light->range            = f32();
+        light->inner_spot_angle = f32();
+        light->outer_spot_angle = f32();
+        const uint8_t bits = u8();
+        light->cast_shadow       = (bits & 1u) != 0;
+        light->tight_frustum_fit = (bits & 2u) != 0;
+        light->layer_id          = static_cast<std::size_t>(varint());
+        return light;
+    }
+
+private:
+    auto check(const uint64_t length) -> bool
+    {
+        if (!m_ok || (length > remaining())) {
+            m_ok = false;
+            return false;
+        }
+        return true;
+    }
+
+    const uint8_t* m_data;
+    const uint8_t* m_end;
+    bool           m_ok{true};
+};
+
+} // anonymous namespace
+
+auto is_scene_replication_message(const uint8_t* const data, const std::size_t length) -> bool
+{
+    return
+        (data != nullptr) &&
+        (length >= c_header_size) &&
+        (std::memcmp(data, c_magic, sizeof(c_magic)) == 0);
+}
+
+#pragma region Scene_replication_server
+
+Scene_replication_server::Scene_replication_server(
+    erhe::scene::Scene_message_bus& scene_message_bus,
+    erhe::scene::Scene&             scene,
+    erhe::net::Server&              server
+)
+    : m_scene_message_bus{scene_message_bus}
+    , m_scene            {scene}
+    , m_server           {server}
+    , m_accepted_count   {server.get_accepted_count()}
+{
+    m_receiver_handle = m_scene_message_bus.add_receiver(
+        [](void* const context, Scene_message& message) {
+            static_cast<Scene_replication_server*>(context)->on_message(message);
+        },
+        this
+    );
+    m_scene_message_bus.set_node_changed_enabled(true);
+}
+
+Scene_replication_server::~Scene_replication_server() noexcept
+{
+    m_scene_message_bus.set_node_changed_enabled(false);
+    m_scene_message_bus.remove_receiver(m_receiver_handle);
+}
+
+auto Scene_replication_server::get_statistics() const -> const Scene_replication_server_statistics&
+{
+    return m_statistics;
+}
+
+void Scene_replication_server::on_message(Scene_message& message)
+{
+    if ((message.scene != &m_scene) || !message.lhs) {
+        return;
+    }
+    switch (message.event_type) {
+        case erhe::scene::Scene_event_type::node_added_to_scene:     mark_changed(message.lhs, ~0u); break;
+        case erhe::scene::Scene_event_type::node_removed_from_scene: mark_removed(*message.lhs.get()); break;
+        case erhe::scene::Scene_event_type::node_changed:            mark_changed(message.lhs, message.changes); break;
+        default: break;
+    }
+}
+
+void Scene_replication_server::mark_changed(const std::shared_ptr<Node>& node, const unsigned int changes)
+{
+    if (m_server.get_client_count() == 0) {
+        return;
+    }
+    const uint64_t id = node->get_id();
+    const auto [i, inserted] = m_pending.try_emplace(id);
+    if (inserted) {
+        i->second.node = node;
+        m_pending_order.push_back(id);
+    }
+    i->second.changes |= changes;
+}
+
+void Scene_replication_server::mark_removed(const Node& node)
+{
+    const uint64_t id = node.get_id();
+    m_pending.erase(id);
+    if (m_sent.erase(id) > 0) {
+        m_removed.push_back(id);
+    }
+}
+
+void Scene_replication_server::reset()
+{
+    m_pending.clear();
+    m_pending_order.clear();
+    m_removed.clear();
+    m_sent.clear();
+}
+
+auto Scene_replication_server::get_parent_id(const Node& node) const -> uint64_t
+{
+    const std::shared_ptr<Node> parent = node.get_parent_node();
+    if (
+        !parent ||
+        (parent == m_scene.get_root_node()) ||
+        (parent->get_scene() != &m_scene) ||
+        ((parent->get_flag_bits() & Item_flags::no_message) != 0)
+    ) {
+        return 0;
+    }
+    return parent->get_id();
+}
+
+void Scene_replication_server::encode_parent(Node& node, const uint64_t parent_id)
+{
+    if ((parent_id != 0) && !m_sent.contains(parent_id)) {
+        encode_added(*node.get_parent_node().get());
+    }
+}
+
+void Scene_replication_server::encode_added(Node& node)
+{
+    const uint64_t id        = node.get_id();
+    const uint64_t parent_id = get_parent_id(node);
+    encode_parent(node, parent_id);
+
+    // Also covers changes queued for the node, if any
+    m_pending.erase(id);
+
+    Sent_node& sent = m_sent[id];
+    sent.transform = quantize(node.parent_from_node_transform());
+    sent.flags     = node.get_flag_bits() & c_replicated_flag_bits;
+    sent.parent_id = parent_id;
+
+    Writer writer{m_buffer};
+    writer.u8       (static_cast<uint8_t>(Record_type::added));
+    writer.varint   (id);
+    writer.varint   (parent_id);
+    writer.string   (node.get_name());
+    writer.varint   (sent.flags);
+    writer.transform(Quantized_transform{}, sent.transform);
+    writer.attachments(node);
+    ++m_record_count;
+}
+
+void Scene_replication_server::encode_changed(Node& node, const unsigned int changes)
+{
+    const uint64_t id = node.get_id();
+    Writer writer{m_buffer};
+
+    if ((changes & Scene_message::bit_parent) != 0) {
+        const uint64_t parent_id = get_parent_id(node);
+        encode_parent(node, parent_id); // may rehash m_sent
+        Sent_node& sent = m_sent.at(id);
+        if (parent_id != sent.parent_id) {
+            sent.parent_id = parent_id;
+            writer.u8    (static_cast<uint8_t>(Record_type::parent));
+            writer.varint(id);
+            writer.varint(parent_id);
+            ++m_record_count;
+        }
+    }
+
+    Sent_node& sent = m_sent.at(id);
+    if ((changes & Scene_message::bit_transform) != 0) {
+        const Quantized_transform transform = quantize(node.parent_from_node_transform());
+        if (transform != sent.transform) {
+            writer.u8       (static_cast<uint8_t>(Record_type::transform));
+            writer.varint   (id);
+            writer.transform(sent.transform, transform);
+            sent.transform = transform;
+            ++m_record_count;
+        }
+    }
+    if ((changes & Scene_message::bit_flags) != 0) {
+        const uint64_t flags = node.get_flag_bits() & c_replicated_flag_bits;
+        if (flags != sent.flags) {
+            writer.u8    (static_cast<uint8_t>(Record_type::flags));
+            writer.varint(id);
+            writer.varint(flags);
+            sent.flags = flags;
+            ++m_record_count;
+        }
+    }
+    if ((changes & Scene_message::bit_attachments) != 0) {
+        writer.u8         (static_cast<uint8_t>(Record_type::attachments));
+        writer.varint     (id);
+        writer.attachments(node);
+        ++m_record_count;
+    }
+}
+
+void Scene_replication_server::begin_frame()
+{
+    m_frame_start_ns = now_ns();
+    m_buffer.clear();
+    m_record_count = 0;
+    Writer writer{m_buffer};
+    m_buffer.insert(m_buffer.end(), std::begin(c_magic), std::end(c_magic));
+    writer.u8    (c_version);
+    writer.varint(m_frame_number);
+    writer.u64   (m_frame_start_ns);
+    m_count_offset = m_buffer.size();
+    writer.u32   (0); // patched in send_frame()
+}
+
+void Scene_replication_server::send_frame(const uint64_t first_accepted, const uint64_t end_accepted)
+{
+    if ((m_record_count == 0) || (first_accepted == end_accepted)) {
+        return;
+    }
+    for (int i = 0; i < 4; ++i) {
+        m_buffer[m_count_offset + i] = static_cast<uint8_t>(m_record_count >> (8 * i));
+    }
+
+    const bool sent = m_server.broadcast(
+        erhe::net::make_shared_payload(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size()),
+        first_accepted,
+        end_accepted
+    );
+    if (!sent) {
+        // m_sent already has the new state, so following deltas would
+        // be relative to state which some clients may not have
+        m_keyframe_needed = true;
+    }
+
+    ++m_frame_number;
+    ++m_statistics.frame_count;
+    m_statistics.record_count     += m_record_count;
+    m_statistics.byte_count       += m_buffer.size();
+    m_statistics.last_frame_bytes  = m_buffer.size();
+    m_statistics.encode_time_ns   += now_ns() - m_frame_start_ns;
+}
+
+// Complete scene, replacing what clients in the range had before
+void Scene_replication_server::send_keyframe(const uint64_t first_accepted, const uint64_t end_accepted)
+{
+    m_sent.clear();
+    begin_frame();
+    Writer writer{m_buffer};
+    writer.u8    (static_cast<uint8_t>(Record_type::keyframe));
+    writer.varint(0);
+    ++m_record_count;
+    for (const auto& node : m_scene.get_flat_nodes()) {
+        if (
+            ((node->get_flag_bits() & Item_flags::no_message) == 0) &&
+            !m_sent.contains(node->get_id()) // parents are added before children
+        ) {
+            encode_added(*node.get());
+        }
+    }
+    ++m_statistics.keyframe_count;
+    send_frame(first_accepted, end_accepted);
+}
+
+void Scene_replication_server::update()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    // Without clients there is nothing to track; next client gets a keyframe
+    if (m_server.get_client_count() == 0) {
+        reset();
+        m_accepted_count  = m_server.get_accepted_count();
+        m_keyframe_needed = false;
+        return;
+    }
+
+    // Clients accepted since previous update get a keyframe of their own
+    const uint64_t accepted_count = m_server.get_accepted_count();
+    uint64_t       first_new      = m_accepted_count;
+    m_accepted_count = accepted_count;
+
+    // Some clients may have missed changes; keyframe replaces all deltas
+    if (m_keyframe_needed) {
+        m_keyframe_needed = false;
+        m_pending.clear();
+        m_pending_order.clear();
+        m_removed.clear();
+        send_keyframe(0, accepted_count);
+        return;
+    }
+
+    if (!m_pending_order.empty() || !m_removed.empty()) {
+        begin_frame();
+        Writer writer{m_buffer};
+
+        // Removals first, so that a node can be removed and added in one frame
+        for (const uint64_t id : m_removed) {
+            writer.u8    (static_cast<uint8_t>(Record_type::removed));
+            writer.varint(id);
+            ++m_record_count;
+        }
+
+        for (const uint64_t id : m_pending_order) {
+            const auto i = m_pending.find(id);
+            if (i == m_pending.end()) {
+                continue; // removed, or already sent as parent of another added node
+            }
+            const std::shared_ptr<Node> node    = i->second.node.lock();
+            const unsigned int          changes = i->second.changes;
+            m_pending.erase(i);
+            if (!node || (node->get_scene() != &m_scene)) {
+                continue;
+            }
+            if (!m_sent.contains(id)) {
+                encode_added(*node.get());
+            } else {
+                encode_changed(*node.get(), changes);
+            }
+        }
+        m_pending.clear();
+        m_pending_order.clear();
+        m_removed.clear();
+
+        send_frame(0, first_new);
+    }
+
+    // Other clients already have this state, all changes were sent above
+    if (first_new != accepted_count) {
+        send_keyframe(first_new, accepted_count);
+    }
+}
+
+#pragma endregion Scene_replication_server
+
+#pragma region Scene_replication_client
+
+Scene_replication_client::Scene_replication_client(erhe::scene::Scene& scene)
+    : m_scene{scene}
+{
+}
+
+Scene_replication_client::~Scene_replication_client() noexcept = default;
+
+auto Scene_replication_client::get_node_count() const -> std::size_t
+{
+    return m_nodes.size();
+}
+
+auto Scene_replication_client::get_statistics() const -> const Scene_replication_client_statistics&
+{
+    return m_statistics;
+}
+
+void Scene_replication_client::clear()
+{
+    for (auto& i : m_nodes) {
+        i.second.node->set_node_parent(nullptr);
+    }
+    m_nodes.clear();
+}
+
+auto Scene_replication_client::apply(const uint8_t* const data, const std::size_t length) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (!is_scene_replication_message(data, length)) {
+        return false;
+    }
+    Reader reader{data + sizeof(c_magic), length - sizeof(c_magic)};
+    if (reader.u8() != c_version) {
+        ++m_statistics.error_count;
+        return false;
+    }
+    static_cast<void>(reader.varint()); // frame number
+    const uint64_t server_time_ns = reader.u64();
+    const uint32_t record_count   = reader.u32();
+
+    const auto find_node = [this](const uint64_t id) -> std::shared_ptr<Node> {
+        if (id == 0) {
+            return m_scene.get_root_node();
+        }
+        const auto i = m_nodes.find(id);
+        return (i != m_nodes.end()) ? i->second.node : m_scene.get_root_node();
+    };
+    // Parent which is the node itself or one of its descendants would create
+    // a cycle; it is counted as error, and the node keeps its current parent,
+    // or goes under the root if it has none yet.
+    const auto set_parent = [this, &find_node](Node& node, const uint64_t parent_id) {
+        std::shared_ptr<Node> parent = find_node(parent_id);
+        if ((parent.get() == &node) || parent->is_ancestor(&node)) {
+            ++m_statistics.error_count;
+            if (node.get_parent_node()) {
+                return;
+            }
+            parent = m_scene.get_root_node();
+        }
+        if (node.get_parent_node() != parent) {
+            node.set_parent(parent);
+        }
+    };
+    const auto set_flags = [](Node& node, const uint64_t flags) {
+        node.disable_flag_bits(c_replicated_flag_bits & ~flags);
+        node.enable_flag_bits (c_replicated_flag_bits & flags);
+    };
+    const auto set_transform = [](Remote_node& remote) {
+        dequantize(remote.transform, remote.node->node_data.transforms.parent_from_node);
+        remote.node->handle_transform_update(erhe::scene::Node_transforms::get_next_serial());
+    };
+    const auto set_attachments = [&reader](Remote_node& remote) {
+        for (const auto& light : remote.lights) {
+            remote.node->detach(light.get());
+        }
+        remote.lights.clear();
+        const uint64_t attachment_count = reader.varint();
+        for (uint64_t i = 0; (i < attachment_count) && reader.is_ok(); ++i) {
+            const auto     type        = static_cast<Attachment_type>(reader.u8());
+            const uint32_t byte_count  = reader.u32();
+            const std::size_t expected = reader.remaining() - std::min<std::size_t>(byte_count, reader.remaining());
+            if (type == Attachment_type::light) {
+                auto light = reader.light();
+                if (reader.is_ok()) {
+                    remote.node->attach(light);
+                    remote.lights.push_back(light);
+                }
+            }
+            if (reader.remaining() > expected) {
+                reader.skip(reader.remaining() - expected);
+            }
+        }
+    };
+
+    // Records for unknown nodes are read into this, and dropped
+    Remote_node unknown;
+    unknown.node = std::make_shared<Node>();
+
+    // Nodes from before keyframe record, which are not added again
+    std::unordered_map<uint64_t, Remote_node> previous_nodes;
+
+    for (uint32_t record = 0; (record < record_count) && reader.is_ok(); ++record) {
+        const auto     type = static_cast<Record_type>(reader.u8());
+        const uint64_t id   = reader.varint();
+        if (type == Record_type::added) {
+            const uint64_t    parent_id = reader.varint();
+            const std::string name      = reader.string();
+            const uint64_t    flags     = reader.varint();
+            Remote_node& remote = m_nodes[id];
+            if (!remote.node) {
+                const auto previous = previous_nodes.find(id);
+                if (previous != previous_nodes.end()) {
+                    remote = std::move(previous->second);
+                    previous_nodes.erase(previous);
+                }
+            }
+            if (!remote.node) {
+                remote.node = std::make_shared<Node>(name);
+            } else if (remote.node->get_name() != name) {
+                remote.node->set_name(name);
+            }
+            remote.transform = Quantized_transform{};
+            reader.transform(remote.transform);
+            if (!reader.is_ok()) {
+                break;
+            }
+            set_flags    (*remote.node.get(), flags);
+            set_transform(remote);
+            set_parent   (*remote.node.get(), parent_id);
+            set_attachments(remote);
+            continue;
+        }
+
+        if (type == Record_type::keyframe) {
+            previous_nodes.swap(m_nodes);
+            continue;
+        }
+
+        const auto   i      = m_nodes.find(id);
+        Remote_node& remote = (i != m_nodes.end()) ? i->second : unknown;
+        switch (type) {
+            case Record_type::removed: {
+                if (i != m_nodes.end()) {
+                    remote.node->set_node_parent(nullptr);
+                    m_nodes.erase(i);
+                }
+                break;
+            }
+            case Record_type::transform: {
+                reader.transform(remote.transform);
+                if (reader.is_ok()) {
+                    set_transform(remote);
+                }
+                break;
+            }
+            case Record_type::flags: {
+                const uint64_t flags = reader.varint();
+                if (reader.is_ok()) {
+                    set_flags(*remote.node.get(), flags);
+                }
+                break;
+            }
+            case Record_type::parent: {
+                const uint64_t parent_id = reader.varint();
+                if (reader.is_ok() && (&remote != &unknown)) {
+                    set_parent(*remote.node.get(), parent_id);
+                }
+                break;
+            }
+            case Record_type::attachments: {
+                set_attachments(remote);
+                break;
+            }
+            default: {
+                // Unknown record types can not be skipped
+                ++m_statistics.error_count;
+                return false;
+            }
+        }
+    }
+
+    for (auto& i : previous_nodes) {
+        i.second.node->set_node_parent(nullptr);
+    }
+
+    if (!reader.is_ok()) {
+        ++m_statistics.error_count;
+        return false;
+    }
+
+    const uint64_t end_time_ns = now_ns();
+    const uint64_t latency_ns  = (end_time_ns > server_time_ns) ? end_time_ns - server_time_ns : 0;
+    ++m_statistics.frame_count;
+    m_statistics.record_count     += record_count;
+    m_statistics.byte_count       += length;
+    m_statistics.last_latency_ns   = latency_ns;
+    m_statistics.max_latency_ns    = std::max(m_statistics.max_latency_ns, latency_ns);
+    m_statistics.total_latency_ns += latency_ns;
+    return true;
+}
+
+#pragma endregion Scene_replication_client
+
+} // namespace editor
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "erhe_message_bus/message_bus.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace erhe::net {
+    class Server;
+}
+namespace erhe::scene {
+    class Light;
+    class Node;
+    class Scene;
+    class Scene_message;
+    class Scene_message_bus;
+}
+
+namespace editor
+{
+
+// Scene replication sends changes of one authoritative scene to any number
+// of followers, as one binary message per frame through erhe::net::Server.
+//
+// Node changes are collected from the scene message bus and coalesced per
+// node until the next Scene_replication_server::update(). Transforms are
+// quantized, and each node transform record only contains components which
+// changed since the previous frame, as zigzag varint deltas. When a client
+// connects, a keyframe with the complete scene is sent to that client only.
+// If sending a frame fails, a keyframe is sent to all clients next update.
+//
+// Replicated: node hierarchy, names, item flags (except selection),
+// parent_from_node transforms, and light attachments. Meshes and cameras
+// are not replicated.
+
+// Translation and scale are fixed point, rotation uses smallest three
+// components of the unit quaternion.
+class Quantized_transform
+{
+public:
+    std::array<int32_t, 3> translation     {0, 0, 0};
+    std::array<int32_t, 3> scale           {0, 0, 0};
+    std::array<int32_t, 3> rotation        {0, 0, 0};
+    uint8_t                rotation_largest{0}; // index of omitted quaternion component
+
+    [[nodiscard]] auto operator==(const Quantized_transform& other) const -> bool = default;
+};
+
+class Scene_replication_server_statistics
+{
+public:
+    uint64_t frame_count      {0}; // messages sent
+    uint64_t keyframe_count   {0};
+    uint64_t record_count     {0};
+    uint64_t byte_count       {0}; // message payload bytes
+    uint64_t last_frame_bytes {0};
+    uint64_t encode_time_ns   {0}; // total
+};
+
+class Scene_replication_client_statistics
+{
+public:
+    uint64_t frame_count     {0}; // messages applied
+    uint64_t record_count    {0};
+    uint64_t byte_count      {0};
+    uint64_t error_count     {0}; // malformed messages
+    uint64_t last_latency_ns {0}; // from server encode to applied, steady clock; valid only on loopback
+    uint64_t max_latency_ns  {0};
+    uint64_t total_latency_ns{0};
+};
+
+[[nodiscard]] auto is_scene_replication_message(const uint8_t* data, std::size_t length) -> bool;
+
+class Scene_replication_server
+{
+public:
+    Scene_replication_server(
+        erhe::scene::Scene_message_bus& scene_message_bus,
+        erhe::scene::Scene&             scene,
+        erhe::net::Server&              server
+    );
+    ~Scene_replication_server() noexcept;
+    Scene_replication_server   (const Scene_replication_server&) = delete;
+    void operator=             (const Scene_replication_server&) = delete;
+
+    // Call once per frame, after Scene::update_node_transforms() and
+    // Scene_message_bus::update(). Sends at most one message.
+    void update();
+
+    [[nodiscard]] auto get_statistics() const -> const Scene_replication_server_statistics&;
+
+private:
+    class Pending_node
+    {
+    public:
+        std::weak_ptr<erhe::scene::Node> node;
+        unsigned int                     changes{0};
+    };
+
+    class Sent_node
+    {
+    public:
+        Quantized_transform transform;
+        uint64_t            flags    {0};
+        uint64_t            parent_id{0};
+    };
+
+    void on_message      (erhe::scene::Scene_message& message);
+    void mark_changed    (const std::shared_ptr<erhe::scene::Node>& node, unsigned int changes);
+    void mark_removed    (const erhe::scene::Node& node);
+    void reset           ();
+    void encode_added    (erhe::scene::Node& node);
+    void encode_changed  (erhe::scene::Node& node, unsigned int changes);
+    void encode_parent   (erhe::scene::Node& node, uint64_t parent_id); // as added, if not sent yet
+    void begin_frame     ();
+    void send_frame      (uint64_t first_accepted, uint64_t end_accepted);
+    void send_keyframe   (uint64_t first_accepted, uint64_t end_accepted);
+    auto get_parent_id   (const erhe::scene::Node& node) const -> uint64_t;  // 0 for scene root
+
+    erhe::scene::Scene_message_bus&            m_scene_message_bus;
+    erhe::scene::Scene&                        m_scene;
+    erhe::net::Server&                         m_server;
+    erhe::message_bus::Receiver_handle         m_receiver_handle{0};
+    uint64_t                                   m_accepted_count {0};
+    uint64_t                                   m_frame_number   {0};
+    std::unordered_map<uint64_t, Pending_node> m_pending;
+    std::vector<uint64_t>                      m_pending_order;
+    std::vector<uint64_t>                      m_removed;
+    std::unordered_map<uint64_t, Sent_node>    m_sent;
+    std::vector<uint8_t>                       m_buffer;
+    std::size_t                                m_count_offset   {0}; // record count position in m_buffer
+    uint32_t                                   m_record_count   {0};
+    uint64_t                                   m_frame_start_ns {0};
+    bool                                       m_keyframe_needed{false}; // previous frame was not sent to all clients
+    Scene_replication_server_statistics        m_statistics;
+};
+
+class Scene_replication_client
+{
+public:
+    // Replicated nodes are created as children of the scene root node
+    explicit Scene_replication_client(erhe::scene::Scene& scene);
+    ~Scene_replication_client() noexcept;
+    Scene_replication_client   (const Scene_replication_client&) = delete;
+    void operator=             (const Scene_replication_client&) = delete;
+
+    // Returns false if the message is not a valid scene replication message
+    auto apply(const uint8_t* data, std::size_t length) -> bool;
+
+    // Removes all replicated nodes from the scene
+    void clear();
+
+    [[nodiscard]] auto get_node_count() const -> std::size_t;
+    [[nodiscard]] auto get_statistics() const -> const Scene_replication_client_statistics&;
+
+private:
+    class Remote_node
+    {
+    public:
+        std::shared_ptr<erhe::scene::Node>               node;
+        Quantized_transform                              transform;
+        std::vector<std::shared_ptr<erhe::scene::Light>> lights;
+    };
+
+    erhe::scene::Scene&                       m_scene;
+    std::unordered_map<uint64_t, Remote_node> m_nodes;
+    Scene_replication_client_statistics       m_statistics;
+};
+
+} // namespace editor
@@ -120,7 +120,7 @@ Scene_root::Scene_root(
 
     //m_scene->enable_flag_bits(erhe::Item_flags::show_in_ui);
     m_scene->get_root_node()->enable_flag_bits(erhe::Item_flags::invisible_parent);
-    m_physics_world  = erhe::physics::IWorld::create_unique();
+    m_physics_world  = erhe::physics::IWorld::create_unique((editor_context != nullptr) ? editor_context->thread_pool : nullptr);
     m_physics_world->set_on_body_activated(
         [this](erhe::physics::IRigid_body* rigid_body) {
             ERHE_VERIFY(rigid_body != nullptr);
@@ -507,14 +507,13 @@ void Scene_root::register_node_physics(const std::shared_ptr<Node_physics>& node
 #endif
     {
         m_node_physics.push_back(node_physics);
-        m_node_physics_sorted = false;
     }
 
-    node_physics->set_physics_world(m_physics_world.get());
-    erhe::physics::IRigid_body* rigid_body = node_physics->get_rigid_body();
-    if (rigid_body != nullptr) {
-        m_physics_world->add_rigid_body(node_physics->get_rigid_body());
-    }
+    // Rigid body is added and physics world is set in flush_pending_rigid_bodies(),
+    // so that scene loads insert into the broad phase once instead of once per
+    // body. Until then get_rigid_body() returns nullptr, so tools do not use a
+    // body which is not yet in the world.
+    m_pending_node_physics.push_back(node_physics.get());
 }
 
 void Scene_root::unregister_node_physics(const std::shared_ptr<Node_physics>& node_physics)
@@ -533,16 +532,49 @@ void Scene_root::unregister_node_physics(const std::shared_ptr<Node_physics>& no
         log_physics->error("Node_physics for '{}' not in Scene_root", (node != nullptr) ? node->get_name().c_str() : "");
     } else {
         m_node_physics.erase(i, m_node_physics.end());
-        m_node_physics_sorted = false;
     }
+    m_interpolated_node_physics.erase(
+        std::remove(m_interpolated_node_physics.begin(), m_interpolated_node_physics.end(), node_physics.get()),
+        m_interpolated_node_physics.end()
+    );
 
-    erhe::physics::IRigid_body* rigid_body = node_physics->get_rigid_body();
-    if (rigid_body != nullptr) {
-        m_physics_world->remove_rigid_body(node_physics->get_rigid_body());
+    const auto pending = std::find(m_pending_node_physics.begin(), m_pending_node_physics.end(), node_physics.get());
+    if (pending != m_pending_node_physics.end()) {
+        m_pending_node_physics.erase(pending);
+    } else {
+        erhe::physics::IRigid_body* rigid_body = node_physics->get_rigid_body();
+        if (rigid_body != nullptr) {
+            m_physics_world->remove_rigid_body(rigid_body);
+        }
     }
     node_physics->set_physics_world(nullptr);
 }
 
+void Scene_root::flush_pending_rigid_bodies()
+{
+    if (!m_physics_world || m_pending_node_physics.empty()) {
+        return;
+    }
+
+    // Large batches leave the broad phase tree unbalanced
+    static constexpr std::size_t optimize_broad_phase_threshold = 256;
+
+    m_pending_rigid_bodies.clear();
+    for (Node_physics* node_physics : m_pending_node_physics) {
+        node_physics->set_physics_world(m_physics_world.get());
+        erhe::physics::IRigid_body* rigid_body = node_physics->get_rigid_body();
+        if (rigid_body != nullptr) {
+            m_pending_rigid_bodies.push_back(rigid_body);
+        }
+    }
+    m_physics_world->add_rigid_bodies(m_pending_rigid_bodies);
+    if (m_pending_rigid_bodies.size() >= optimize_broad_phase_threshold) {
+        m_physics_world->optimize_broad_phase();
+    }
+    m_pending_node_physics.clear();
+    m_pending_rigid_bodies.clear();
+}
+
 void Scene_root::before_physics_simulation_steps()
 {
     for (const auto& node_physics : m_node_physics) {
@@ -556,41 +588,66 @@ void Scene_root::before_physics_simulation_steps()
 
 void Scene_root::update_physics_simulation_fixed_step(const double dt)
 {
-    if (m_physics_world) {
-        m_physics_world->update_fixed_step(dt);
+    ERHE_PROFILE_FUNCTION();
+
+    if (!m_physics_world) {
+        return;
+    }
+
+    m_physics_world->update_fixed_step(dt);
+    ++m_physics_step;
+
+    // Snapshot transforms of bodies which moved during this step
+    m_physics_world->get_active_body_transforms(m_active_body_transforms);
+    m_next_interpolated_node_physics.clear();
+    for (std::size_t i = 0, end = m_active_body_transforms.size(); i < end; ++i) {
+        Node_physics* node_physics = static_cast<Node_physics*>(m_active_body_transforms.owners[i]);
+        if ((node_physics == nullptr) || (node_physics->get_node() == nullptr)) {
+            continue;
+        }
+        node_physics->push_snapshot(m_active_body_transforms.positions[i], m_active_body_transforms.rotations[i], m_physics_step);
+        m_next_interpolated_node_physics.push_back(node_physics);
+    }
+    for (Node_physics* node_physics : m_interpolated_node_physics) {
+        if (node_physics->get_snapshot_step() == m_physics_step) {
+            continue;
+        }
+        // Not active in this step; keep until the final transform has been written to node
+        node_physics->settle_snapshot();
+        if (node_physics->is_snapshot_pending()) {
+            m_next_interpolated_node_physics.push_back(node_physics);
+        }
     }
+    std::swap(m_interpolated_node_physics, m_next_interpolated_node_physics);
 }
 
-void Scene_root::after_physics_simulation_steps()
+void Scene_root::after_physics_simulation_steps(const float alpha)
 {
+    ERHE_PROFILE_FUNCTION();
+
     if (!m_physics_world) {
         return;
     }
 
-    // Sort nodes, so that parent transforms are updated before child nodes
-    if (!m_node_physics_sorted) {
-        std::sort(
-            m_node_physics.begin(),
-            m_node_physics.end(),
-            [](const auto& lhs, const auto& rhs) -> bool {
-                erhe::scene::Node* lhs_node = lhs->get_node();
-                erhe::scene::Node* rhs_node = rhs->get_node();
-                if ((lhs_node == nullptr) || (rhs_node == nullptr)) {
-                    return true;
-                }
-                return lhs_node->get_depth() < rhs_node->get_depth();
-            }
-        );
-        m_node_physics_sorted = true;
+    // Apply interpolated snapshots to nodes as one batch; Scene::update_node_transforms()
+    // then propagates them to children and attachments.
+    m_active_body_nodes    .clear();
+    m_active_body_positions.clear();
+    m_active_body_rotations.clear();
+    for (Node_physics* node_physics : m_interpolated_node_physics) {
+        glm::vec3 position;
+        glm::quat rotation;
+        node_physics->interpolate_snapshot(alpha, position, rotation);
+        m_active_body_nodes    .push_back(node_physics->get_node());
+        m_active_body_positions.push_back(position);
+        m_active_body_rotations.push_back(rotation);
+    }
+    if (m_active_body_nodes.empty()) {
+        return;
     }
-
-    for (const auto& node_physics : m_node_physics) {
-        auto* rigid_body = node_physics->get_rigid_body();
-        if (rigid_body) {
-            if (rigid_body->is_active()) {
-                node_physics->after_physics_simulation();
-            }
-        }
+    m_scene->set_world_transforms(m_active_body_nodes, m_active_body_positions, m_active_body_rotations);
+    for (Node_physics* node_physics : m_interpolated_node_physics) {
+        node_physics->mark_synced();
     }
 }
 
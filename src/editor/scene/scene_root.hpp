@@ -7,6 +7,7 @@
 #include "erhe_commands/command.hpp"
 #include "erhe_gl/wrapper_enums.hpp"
 #include "erhe_message_bus/message_bus.hpp"
+#include "erhe_physics/iworld.hpp"
 #include "erhe_primitive/material.hpp"
 #include "erhe_primitive/enums.hpp"
 #include "erhe_primitive/format_info.hpp"
@@ -36,6 +37,7 @@ namespace erhe::imgui {
     class Imgui_windows;
 }
 namespace erhe::physics {
+    class IRigid_body;
     class IWorld;
 }
 namespace erhe::primitive {
@@ -158,9 +160,13 @@ public:
     void register_node_physics  (const std::shared_ptr<Node_physics>& node_physics);
     void unregister_node_physics(const std::shared_ptr<Node_physics>& node_physics);
 
+    // Adds rigid bodies of registered Node_physics to the physics world as one
+    // batch. Node_physics are attached to the physics world only here.
+    void flush_pending_rigid_bodies();
+
     void before_physics_simulation_steps     ();
     void update_physics_simulation_fixed_step(double dt);
-    void after_physics_simulation_steps      ();
+    void after_physics_simulation_steps      (float alpha);
 
     [[nodiscard]] auto layers            () -> Scene_layers&;
     [[nodiscard]] auto layers            () const -> const Scene_layers&;
@@ -210,13 +216,21 @@ private:
     bool                                            m_is_registered{false};
 
     // Must live longer than m_scene for example
-    bool                                            m_node_physics_sorted{false};
     std::vector<std::shared_ptr<Node_physics>>      m_node_physics;
+    std::vector<Node_physics*>                      m_pending_node_physics; // registered, not yet in physics world
+    std::vector<erhe::physics::IRigid_body*>        m_pending_rigid_bodies; // scratch for flush_pending_rigid_bodies()
     std::vector<std::shared_ptr<Rendertarget_mesh>> m_rendertarget_meshes;
 
     std::vector<std::shared_ptr<erhe::Item_base>>   m_physics_disabled_nodes;
 
     std::unique_ptr<erhe::physics::IWorld>          m_physics_world;
+    erhe::physics::Rigid_body_transforms            m_active_body_transforms;
+    uint64_t                                        m_physics_step{0};
+    std::vector<Node_physics*>                      m_interpolated_node_physics;      // moved during latest steps
+    std::vector<Node_physics*>                      m_next_interpolated_node_physics;
+    std::vector<erhe::scene::Node*>                 m_active_body_nodes;
+    std::vector<glm::vec3>                          m_active_body_positions;
+    std::vector<glm::quat>                          m_active_body_rotations;
     std::unique_ptr<erhe::raytrace::IScene>         m_raytrace_scene;
 
     std::unique_ptr<erhe::scene::Scene>             m_scene;
@@ -298,30 +298,36 @@ void Scene_view::update_hover_with_raytrace()
         return;
     }
 
+    // Trace all scene slots with one batch query. The tool slot ray gets
+    // an empty mask for the batch, and is traced against the tool scene.
+    std::array<erhe::raytrace::Ray, Hover_entry::slot_count> rays;
+    std::array<erhe::raytrace::Hit, Hover_entry::slot_count> hits;
     for (std::size_t slot = 0; slot < Hover_entry::slot_count; ++slot) {
-        const uint32_t slot_mask = Hover_entry::raytrace_slot_masks[slot];
-        Hover_entry entry {
-            .slot = slot,
-            .mask = slot_mask
-        };
-        erhe::raytrace::Ray ray{
+        rays[slot] = erhe::raytrace::Ray{
             .origin    = ray_origin,
             .t_near    = 0.0f,
             .direction = ray_direction,
             .time      = 0.0f,
             .t_far     = 9999.0f,
-            .mask      = slot_mask,
+            .mask      = (slot == Hover_entry::tool_slot) ? 0u : Hover_entry::raytrace_slot_masks[slot],
             .id        = 0,
             .flags     = 0
         };
-        erhe::raytrace::Hit hit;
-        if (slot == Hover_entry::tool_slot) {
-            if (tool_scene_root != nullptr) {
-                tool_scene_root->get_raytrace_scene().intersect(ray, hit);
-            }
-        } else {
-            rt_scene.intersect(ray, hit);
-        }
+    }
+    rt_scene.intersect_batch(rays, hits);
+    if (tool_scene_root != nullptr) {
+        rays[Hover_entry::tool_slot].mask = Hover_entry::raytrace_slot_masks[Hover_entry::tool_slot];
+        tool_scene_root->get_raytrace_scene().intersect(rays[Hover_entry::tool_slot], hits[Hover_entry::tool_slot]);
+    }
+
+    for (std::size_t slot = 0; slot < Hover_entry::slot_count; ++slot) {
+        const uint32_t slot_mask = Hover_entry::raytrace_slot_masks[slot];
+        Hover_entry entry {
+            .slot = slot,
+            .mask = slot_mask
+        };
+        const erhe::raytrace::Ray& ray = rays[slot];
+        const erhe::raytrace::Hit& hit = hits[slot];
         entry.valid = (hit.instance != nullptr);
         if (entry.valid) {
             void* node_instance_user_data = hit.instance->get_user_data();
@@ -24,13 +24,13 @@ class Parallel_task_queue
     : public ITask_queue
 {
 public:
-    Parallel_task_queue(const std::string_view name, std::size_t thread_count);
+    // Runs tasks on the given (shared) thread pool
+    Parallel_task_queue(const std::string_view name, erhe::concurrency::Thread_pool& thread_pool);
 
     void enqueue(std::function<void()>&& func) override;
     void wait   () override;
 
 private:
-    erhe::concurrency::Thread_pool      m_thread_pool;
     erhe::concurrency::Concurrent_queue m_queue;
 };
 
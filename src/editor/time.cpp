@@ -130,6 +130,11 @@ auto Time::frame_number() const -> uint64_t
     return m_frame_number;
 }
 
+auto Time::get_fixed_step_remainder() const -> double
+{
+    return m_time_accumulator;
+}
+
 auto Time::time() const -> double
 {
     return m_time;
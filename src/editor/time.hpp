@@ -55,6 +55,9 @@ public:
     void update_once_per_frame();
     auto frame_number         () const -> uint64_t;
 
+    // Time accumulated towards the next fixed step, in seconds
+    [[nodiscard]] auto get_fixed_step_remainder() const -> double;
+
     void register_update_fixed_step      (Update_fixed_step* entry);
     void register_update_once_per_frame  (Update_once_per_frame* entry);
     void unregister_update_fixed_step    (Update_fixed_step* entry);
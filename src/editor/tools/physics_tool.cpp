@@ -229,7 +229,12 @@ auto Physics_tool::acquire_target() -> bool
         return false;
     }
 
+    // Rigid body is not available until it has been added to the physics world
     erhe::physics::IRigid_body* rigid_body = target_node_physics->get_rigid_body();
+    if (rigid_body == nullptr) {
+        log_physics->warn("Cant target: Rigid body not in physics world");
+        return false;
+    }
     if (rigid_body->get_motion_mode() == erhe::physics::Motion_mode::e_static) {
         log_physics->warn("Cant target: Static mesh");
         return false;
@@ -128,6 +128,11 @@ void Range_selection::end()
     m_entries.clear();
 }
 
+auto Range_selection::is_edited() const -> bool
+{
+    return m_edited;
+}
+
 void Range_selection::reset()
 {
     log_selection->trace("resetting range selection");
@@ -133,6 +133,9 @@ public:
     void end           ();
     void reset         ();
 
+    // True when terminators were set since begin(), so end() needs entries
+    [[nodiscard]] auto is_edited() const -> bool;
+
 private:
     Selection&                                    m_selection;
     std::shared_ptr<erhe::Item_base>              m_primary_terminator;
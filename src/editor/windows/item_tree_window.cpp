@@ -32,6 +32,9 @@
 #   include <imgui/imgui_internal.h>
 #endif
 
+#include <algorithm>
+#include <iterator>
+
 namespace editor
 {
 
@@ -60,6 +63,7 @@ Item_tree_window::Item_tree_window(
 void Item_tree_window::set_item_filter(const erhe::Item_filter& filter)
 {
     m_filter = filter;
+    m_index_valid = false;
 }
 
 void Item_tree_window::set_item_callback(
@@ -388,16 +392,19 @@ void Item_tree_window::drag_and_drop_source(
     log_tree_frame->trace("DnD source: '{}'", item->describe());
 
     if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_SourceAllowNullID)) {
+        // Source row must be submitted while dragging, even when scrolled out of view
+        m_drag_source_item = item;
+
         erhe::Item_base* item_raw = item.get();
         ImGui::SetDragDropPayload(item->get_type_name().data(), &item_raw, sizeof(item_raw));
 
         const auto& selection = m_context.selection->get_selection();
         if (is_in(item, selection)) {
             for (const auto& selection_item : selection) {
-                item_icon_and_text(selection_item, false, false);
+                item_icon_and_text(selection_item, false, item_has_children(selection_item), false);
             }
         } else {
-            item_icon_and_text(item, false, false);
+            item_icon_and_text(item, false, item_has_children(item), false);
         }
         ImGui::EndDragDropSource();
     }
@@ -733,54 +740,53 @@ void Item_tree_window::item_popup_menu(
     ImGui::PopStyleVar(1);
 }
 
+auto Item_tree_window::item_has_children(const std::shared_ptr<erhe::Item_base>& item) const -> bool
+{
+    const auto& hierarchy = std::dynamic_pointer_cast<erhe::Hierarchy>(item);
+    if (hierarchy && (hierarchy->get_child_count(m_filter) > 0)) {
+        return true;
+    }
+    const auto& scene = std::dynamic_pointer_cast<erhe::scene::Scene>(item);
+    return scene && scene->get_root_node() && (scene->get_root_node()->get_child_count(m_filter) > 0);
+}
+
 auto Item_tree_window::item_icon_and_text(
     const std::shared_ptr<erhe::Item_base>& item,
     const bool                              update,
-    bool                                    force_expand
-) -> Tree_node_state
+    const bool                              has_children,
+    const bool                              is_open
+) -> bool
 {
     ERHE_PROFILE_FUNCTION();
 
     const float scale = get_scale_value();
     m_context.icon_set->item_icon(item, scale);
 
-    const auto& node = std::dynamic_pointer_cast<erhe::scene::Node>(item);
-    if (!m_context.editor_settings->node_tree_expand_attachments && node) {
-        for (const auto& node_attachment : node->get_attachments()) {
-            m_context.icon_set->item_icon(node_attachment, scale);
+    if (!m_context.editor_settings->node_tree_expand_attachments) {
+        const auto& node = std::dynamic_pointer_cast<erhe::scene::Node>(item);
+        if (node) {
+            for (const auto& node_attachment : node->get_attachments()) {
+                m_context.icon_set->item_icon(node_attachment, scale);
+            }
         }
     }
 
-    const auto& content_library_node = std::dynamic_pointer_cast<Content_library_node>(item);
-    const auto& hierarchy            = std::dynamic_pointer_cast<erhe::Hierarchy>(item);
-    const auto& scene                = std::dynamic_pointer_cast<erhe::scene::Scene  >(item);
-
-    bool is_leaf = true;
-    if (hierarchy && (hierarchy->get_child_count(m_filter) > 0)) {
-        is_leaf = false;
-    }
-    if (scene && scene->get_root_node() && scene->get_root_node()->get_child_count(m_filter) > 0) {
-        is_leaf = false;
-    }
-    if (scene || content_library_node) {
-        force_expand = true;
-    }
-
+    // Rows are not nested, open state is kept in m_open_state
     const ImGuiTreeNodeFlags flags =
         ImGuiTreeNodeFlags_SpanAvailWidth |
-        (force_expand
-            ? ImGuiTreeNodeFlags_DefaultOpen
-            : ImGuiTreeNodeFlags_None
-        ) |
-        (is_leaf
-            ? (ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_Leaf)
-            : ImGuiTreeNodeFlags_OpenOnArrow
+        ImGuiTreeNodeFlags_NoTreePushOnOpen |
+        (has_children
+            ? ImGuiTreeNodeFlags_OpenOnArrow
+            : ImGuiTreeNodeFlags_Leaf
         ) |
         (update && item->is_selected()
             ? ImGuiTreeNodeFlags_Selected
             : ImGuiTreeNodeFlags_None
         );
 
+    if (has_children) {
+        ImGui::SetNextItemOpen(is_open);
+    }
     const bool item_node_open = ImGui::TreeNodeEx(
         item->get_label().c_str(),
         flags
@@ -788,25 +794,6 @@ auto Item_tree_window::item_icon_and_text(
 
     const bool consumed = m_item_callback ? m_item_callback(item) : false;
 
-#if 0
-    std::stringstream ss;
-    if (ImGui::IsItemClicked()) ss << "clicked ";
-    if (ImGui::IsItemToggledOpen()) ss << "toggled_open ";
-    if (ImGui::IsItemToggledSelection()) ss << "toggled_selection ";
-    //if (ImGui::IsItemHovered()) ss << "hovered ";
-    //if (ImGui::IsItemActive()) ss << "active ";
-    if (ImGui::IsItemActivated()) ss << "activated ";
-    if (ImGui::IsItemDeactivated()) ss << "deactivated ";
-    //if (ImGui::IsItemFocused()) ss << "focused ";
-    //if (ImGui::IsItemVisible()) ss << "visible ";
-    if (ImGui::IsItemEdited()) ss << "edited ";
-    const std::string message = ss.str();
-    if (!message.empty())
-    {
-        log_tree->info("{} {}", item->get_label(), message);
-    }
-#endif
-
     const bool is_item_toggled_open = ImGui::IsItemToggledOpen();
     if (is_item_toggled_open) {
         m_toggled_open = true;
@@ -821,101 +808,311 @@ auto Item_tree_window::item_icon_and_text(
             }
         }
     }
-    //// log_frame->info("{} - is_leaf = {}", item->get_label(), is_leaf);
 
-    return Tree_node_state{
-        .is_open       = item_node_open,
-        .need_tree_pop = !is_leaf
-    };
+    return item_node_open;
 }
 
-auto Item_tree_window::should_show(
-    const std::shared_ptr<erhe::Item_base>& item
-) -> Show_mode
+void Item_tree_window::update_index()
 {
-    const bool show_by_type = m_filter(item->get_flag_bits());
-    const bool show_by_name = m_text_filter.PassFilter(item->get_name().c_str());
-    if (show_by_type && show_by_name) {
-        return Show_mode::Show;
+    ERHE_PROFILE_FUNCTION();
+
+    const bool expand_attachments = m_context.editor_settings->node_tree_expand_attachments;
+    if (!m_index_valid || (m_index_expand_attachments != expand_attachments)) {
+        m_index_expand_attachments = expand_attachments;
+        m_index_valid              = true;
+        rebuild_index();
+    } else if (m_entries.empty() || !patch_index(0)) {
+        return;
     }
+    forget_open_state();
+    update_show_modes();
+    rebuild_rows();
+}
 
-    bool show_by_attachments = false;
-    const auto& node = std::dynamic_pointer_cast<erhe::scene::Node>(item);
-    if (node) {
-        for (const auto& node_attachment : node->get_attachments()) {
-            if (should_show(node_attachment) != Show_mode::Hide) {
-                show_by_attachments = true;
-                break;
+void Item_tree_window::rebuild_index()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    m_entries.clear();
+    if (m_root) {
+        index_item(m_root, 0, 0, false);
+    }
+}
+
+// Returns false if nothing in the subtree of the entry has changed
+auto Item_tree_window::patch_index(const std::size_t index) -> bool
+{
+    {
+        const Entry& entry = m_entries[index];
+        if ((entry.hierarchy == nullptr) || (entry.hierarchy->get_subtree_serial() == entry.serial)) {
+            return false;
+        }
+    }
+    if (!is_entry_current(index)) {
+        reindex_entry(index);
+        return true;
+    }
+
+    // Only names, flags, or something deeper in the subtree changed
+    {
+        Entry& entry = m_entries[index];
+        entry.serial       = entry.hierarchy->get_subtree_serial();
+        entry.has_children = item_has_children(entry.item);
+    }
+    // Entries after a reindexed child move, so end is read again each time
+    for (std::size_t child = index + 1; child < m_entries[index].end; child = m_entries[child].end) {
+        patch_index(child);
+    }
+    return true;
+}
+
+// Checks that attachments and children of the entry are still as indexed
+auto Item_tree_window::is_entry_current(const std::size_t index) const -> bool
+{
+    const Entry& entry            = m_entries[index];
+    const bool   invisible_parent = erhe::bit::test_all_rhs_bits_set(entry.item->get_flag_bits(), erhe::Item_flags::invisible_parent);
+    if (entry.is_row == invisible_parent) {
+        return false;
+    }
+    std::size_t child = index + 1;
+    const auto next_is = [this, &entry, &child](const erhe::Item_base* item) -> bool {
+        if ((child >= entry.end) || (m_entries[child].item.get() != item)) {
+            return false;
+        }
+        child = m_entries[child].end;
+        return true;
+    };
+    if ((entry.node != nullptr) && !invisible_parent) {
+        for (const auto& node_attachment : entry.node->get_attachments()) {
+            if (!next_is(node_attachment.get())) {
+                return false;
             }
         }
     }
-    if (show_by_attachments) {
-        return Show_mode::Show;
+    for (const auto& hierarchy_child : entry.hierarchy->get_children()) {
+        if (!next_is(hierarchy_child.get())) {
+            return false;
+        }
     }
+    return child == entry.end;
+}
 
-    const auto& hierarchy = std::dynamic_pointer_cast<erhe::Hierarchy>(item);
-    if (hierarchy) {
-        for (const auto& child_node : hierarchy->get_children()) {
-            if (should_show(child_node) != Show_mode::Hide) {
-                return Show_mode::Show_expanded;
+void Item_tree_window::reindex_entry(const std::size_t index)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const std::size_t old_end = m_entries[index].end;
+    m_entry_scratch.assign(
+        std::make_move_iterator(m_entries.begin() + old_end),
+        std::make_move_iterator(m_entries.end())
+    );
+    const Entry entry = std::move(m_entries[index]);
+    m_entries.resize(index);
+    index_item(entry.item, entry.parent, entry.depth, entry.is_attachment);
+    const std::size_t new_end = m_entries.size();
+
+    // Move ancestor ends, and indices of entries after the subtree
+    if (index > 0) {
+        for (std::size_t ancestor = entry.parent;; ancestor = m_entries[ancestor].parent) {
+            m_entries[ancestor].end = m_entries[ancestor].end - old_end + new_end;
+            if (ancestor == 0) {
+                break;
             }
         }
     }
+    for (Entry& tail_entry : m_entry_scratch) {
+        tail_entry.end = tail_entry.end - old_end + new_end;
+        if (tail_entry.parent >= old_end) {
+            tail_entry.parent = tail_entry.parent - old_end + new_end;
+        }
+    }
+    m_entries.insert(
+        m_entries.end(),
+        std::make_move_iterator(m_entry_scratch.begin()),
+        std::make_move_iterator(m_entry_scratch.end())
+    );
+    m_entry_scratch.clear();
+}
 
-    return Show_mode::Hide;
+void Item_tree_window::forget_open_state()
+{
+    // Forget open state of removed items
+    if (m_open_state.size() > m_entries.size()) {
+        std::unordered_map<std::size_t, bool> open_state;
+        for (const Entry& entry : m_entries) {
+            const auto i = m_open_state.find(entry.item->get_id());
+            if (i != m_open_state.end()) {
+                open_state.insert(*i);
+            }
+        }
+        m_open_state = std::move(open_state);
+    }
 }
 
-void Item_tree_window::imgui_item_node(
-    const std::shared_ptr<erhe::Item_base>& item
+void Item_tree_window::index_item(
+    const std::shared_ptr<erhe::Item_base>& item,
+    const std::size_t                       parent,
+    const int                               depth,
+    const bool                              is_attachment
 )
 {
-    // Special handling for invisible parents (scene root)
-    if (erhe::bit::test_all_rhs_bits_set(item->get_flag_bits(), erhe::Item_flags::invisible_parent)) {
-        const auto& hierarchy = std::dynamic_pointer_cast<erhe::Hierarchy>(item);
-        if (hierarchy) {
-            for (const auto& child_node : hierarchy->get_children()) {
-                imgui_item_node(child_node);
-            }
+    const std::size_t index = m_entries.size();
+    m_entries.push_back(
+        Entry{
+            .item          = item,
+            .parent        = parent,
+            .depth         = depth,
+            .is_attachment = is_attachment
         }
+    );
+    if (is_attachment) {
+        m_entries[index].end = index + 1;
         return;
     }
 
+    // Invisible parents (scene root) are not shown, their children are shown in their place
+    const bool invisible_parent = erhe::bit::test_all_rhs_bits_set(item->get_flag_bits(), erhe::Item_flags::invisible_parent);
+    const auto& hierarchy            = std::dynamic_pointer_cast<erhe::Hierarchy>(item);
+    const auto& node                 = std::dynamic_pointer_cast<erhe::scene::Node>(item);
+    const auto& scene                = std::dynamic_pointer_cast<erhe::scene::Scene>(item);
+    const auto& content_library_node = std::dynamic_pointer_cast<Content_library_node>(item);
+    {
+        Entry& entry = m_entries[index];
+        entry.hierarchy    = hierarchy.get();
+        entry.serial       = hierarchy ? hierarchy->get_subtree_serial() : 0;
+        entry.node         = node.get();
+        entry.is_row       = !invisible_parent;
+        entry.has_children = item_has_children(item);
+        entry.force_expand = scene || content_library_node;
+    }
+
+    const int child_depth = invisible_parent ? depth : depth + 1;
+    if (node && !invisible_parent) {
+        for (const auto& node_attachment : node->get_attachments()) {
+            index_item(node_attachment, index, child_depth, true);
+        }
+    }
+    if (hierarchy) {
+        for (const auto& child : hierarchy->get_children()) {
+            index_item(child, index, child_depth, false);
+        }
+    }
+    m_entries[index].end = m_entries.size();
+}
+
+void Item_tree_window::update_show_modes()
+{
     ERHE_PROFILE_FUNCTION();
 
-    const Show_mode show = should_show(item);
-    if (show == Show_mode::Hide) {
-        //// log_tree->info("filtered {}", item->describe());
-        return;
+    for (Entry& entry : m_entries) {
+        entry.child_visible      = false;
+        entry.attachment_visible = false;
     }
 
-    m_context.selection->range_selection().entry(item);
+    // Reverse depth first order visits descendants before ancestors
+    for (std::size_t i = m_entries.size(); i > 0; --i) {
+        Entry& entry = m_entries[i - 1];
+        const bool pass =
+            m_filter(entry.item->get_flag_bits()) &&
+            m_text_filter.PassFilter(entry.item->get_name().c_str());
+        if (pass || entry.attachment_visible) {
+            entry.show = Show_mode::Show;
+        } else if (entry.child_visible) {
+            entry.show = Show_mode::Show_expanded;
+        } else {
+            entry.show = Show_mode::Hide;
+        }
 
-    const auto tree_node_state = item_icon_and_text(
-        item,
-        true,
-        show == Show_mode::Show_expanded
-    );
-    if (tree_node_state.is_open) {
-        if (m_context.editor_settings->node_tree_expand_attachments) {
-            const auto& node = std::dynamic_pointer_cast<erhe::scene::Node>(item);
-            if (node) {
-                const float attachment_indent = 15.0f; // TODO
-                ImGui::Indent(attachment_indent);
-                for (const auto& node_attachment : node->get_attachments()) {
-                    imgui_item_node(node_attachment);
-                }
-                ImGui::Unindent(attachment_indent);
+        if ((i > 1) && (entry.show != Show_mode::Hide)) {
+            Entry& parent = m_entries[entry.parent];
+            if (entry.is_attachment) {
+                parent.attachment_visible = true;
+            } else {
+                parent.child_visible = true;
             }
         }
-        const auto& hierarchy = std::dynamic_pointer_cast<erhe::Hierarchy>(item);
-        if (hierarchy) {
-            for (const auto& child_node : hierarchy->get_children()) {
-                imgui_item_node(child_node);
-            }
+    }
+}
+
+void Item_tree_window::rebuild_rows()
+{
+    m_rows.clear();
+    append_rows(0, m_entries.size(), m_rows);
+}
+
+void Item_tree_window::append_rows(
+    const std::size_t         begin,
+    const std::size_t         end,
+    std::vector<std::size_t>& rows
+) const
+{
+    std::size_t i = begin;
+    while (i < end) {
+        const Entry& entry = m_entries[i];
+        if (!entry.is_row) {
+            ++i;
+            continue;
         }
-        if (tree_node_state.need_tree_pop) {
-            ImGui::TreePop();
+        if (
+            (entry.show == Show_mode::Hide) ||
+            (entry.is_attachment && !m_index_expand_attachments)
+        ) {
+            i = entry.end;
+            continue;
         }
+        rows.push_back(i);
+        i = is_open(entry) ? i + 1 : entry.end;
+    }
+}
+
+auto Item_tree_window::is_open(const Entry& entry) const -> bool
+{
+    // Leaf rows may still have attachment rows or children hidden by item filter
+    if (!entry.has_children) {
+        return true;
+    }
+    const auto i = m_open_state.find(entry.item->get_id());
+    if (i != m_open_state.end()) {
+        return i->second;
+    }
+    return entry.force_expand || (entry.show == Show_mode::Show_expanded);
+}
+
+void Item_tree_window::set_row_open(const std::size_t row, const bool open)
+{
+    const std::size_t entry_index = m_rows[row];
+    const Entry&      entry       = m_entries[entry_index];
+    m_open_state[entry.item->get_id()] = open;
+
+    // Rows are in entry order, so rows of the subtree are contiguous
+    const auto first = m_rows.begin() + row + 1;
+    const auto last  = std::lower_bound(first, m_rows.end(), entry.end);
+    m_rows.erase(first, last);
+    if (open) {
+        m_row_scratch.clear();
+        append_rows(entry_index + 1, entry.end, m_row_scratch);
+        m_rows.insert(m_rows.begin() + row + 1, m_row_scratch.begin(), m_row_scratch.end());
+    }
+}
+
+void Item_tree_window::imgui_row(const std::size_t row)
+{
+    const Entry& entry  = m_entries[m_rows[row]];
+    const float  indent = static_cast<float>(entry.depth) * ImGui::GetStyle().IndentSpacing;
+    if (indent > 0.0f) {
+        ImGui::Indent(indent);
+    }
+
+    const bool was_open = is_open(entry);
+    const bool open     = item_icon_and_text(entry.item, true, entry.has_children, was_open);
+    if (entry.has_children && (open != was_open)) {
+        m_toggled_row      = row;
+        m_toggled_row_open = open;
+        m_has_toggled_row  = true;
+    }
+
+    if (indent > 0.0f) {
+        ImGui::Unindent(indent);
     }
 }
 #endif
@@ -940,7 +1137,13 @@ void Item_tree_window::imgui()
 #if defined(ERHE_GUI_LIBRARY_IMGUI)
     ERHE_PROFILE_FUNCTION();
 
-    m_text_filter.Draw("?");
+    if (m_text_filter.Draw("?")) {
+        if (m_index_valid) {
+            update_show_modes();
+            rebuild_rows();
+        }
+    }
+    update_index();
 
 #if 0 //// TODO
     ImGui::Checkbox("Expand Attachments", &m_context.editor_settings->node_tree_expand_attachments);
@@ -994,14 +1197,43 @@ void Item_tree_window::imgui()
         m_context.editor_scenes->register_scene_root(scene_root);
     }
 #endif
-    //// const auto& scene_roots = m_context.editor_scenes->get_scene_roots();
-    //// for (const auto& scene_root : scene_roots) {
-    ////     const auto& scene = scene_root->get_scene();
-    ////     for (const auto& node : scene.get_root_node()->get_children()) {
-    ////         imgui_item_node(node);
-    ////     }
-    //// }
-    imgui_item_node(m_root);
+    auto& range_selection = m_context.selection->range_selection();
+    {
+        ERHE_PROFILE_SCOPE("rows");
+
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(m_rows.size()));
+        if (!ImGui::IsDragDropActive()) {
+            m_drag_source_item.reset();
+        }
+        const auto drag_source_item = m_drag_source_item.lock();
+        if (drag_source_item) {
+            for (std::size_t row = 0, end = m_rows.size(); row < end; ++row) {
+                if (m_entries[m_rows[row]].item == drag_source_item) {
+                    clipper.IncludeItemByIndex(static_cast<int>(row));
+                    break;
+                }
+            }
+        }
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                imgui_row(static_cast<std::size_t>(row));
+            }
+        }
+        clipper.End();
+    }
+
+    if (m_has_toggled_row) {
+        set_row_open(m_toggled_row, m_toggled_row_open);
+        m_has_toggled_row = false;
+    }
+
+    // Range selection needs all rows, but only when a range was edited
+    if (range_selection.is_edited()) {
+        for (const std::size_t entry_index : m_rows) {
+            range_selection.entry(m_entries[entry_index].item);
+        }
+    }
 
     for (const auto& fun : m_operations) {
         fun();
@@ -10,6 +10,8 @@
 
 #include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace erhe {
     class Hierarchy;
@@ -44,13 +46,13 @@ enum class Selection_usage : unsigned int {
     Selection_used
 };
 
-class Tree_node_state
-{
-public:
-    bool is_open      {false};
-    bool need_tree_pop{false};
-};
-
+// Items are kept in a flattened depth first index. When the subtree serial
+// of the root changes (see erhe::Hierarchy::get_subtree_serial()), only
+// changed subtrees are visited, and only those whose children or
+// attachments changed are indexed again. Filtering runs over the index when
+// the index or filter changes, and visible rows are updated incrementally
+// when rows are opened or closed. Only rows on screen are emitted, using
+// ImGuiListClipper.
 class Item_tree_window
     : public erhe::imgui::Imgui_window
 {
@@ -91,20 +93,51 @@ private:
         erhe::Item_base*                        payload_item
     );
 
-    void item_popup_menu      (const std::shared_ptr<erhe::Item_base>& item);
-    void item_icon            (const std::shared_ptr<erhe::Item_base>& item);
-    auto item_icon_and_text   (const std::shared_ptr<erhe::Item_base>& item, bool update, bool force_expand) -> Tree_node_state;
-    void item_update_selection(const std::shared_ptr<erhe::Item_base>& item);
-    void imgui_item_node      (const std::shared_ptr<erhe::Item_base>& item);
-
     enum class Show_mode : unsigned int {
         Hide          = 0,
         Show          = 1,
         Show_expanded = 2
     };
-    [[nodiscard]] auto should_show(
-        const std::shared_ptr<erhe::Item_base>& item
-    ) -> Show_mode;
+
+    // One item in depth first order. Descendants of entry i are [i + 1, end).
+    class Entry
+    {
+    public:
+        std::shared_ptr<erhe::Item_base> item;
+        erhe::Hierarchy*                 hierarchy         {nullptr};
+        erhe::scene::Node*               node              {nullptr};
+        uint64_t                         serial            {0};     // subtree serial when indexed
+        std::size_t                      parent            {0};
+        std::size_t                      end               {0};
+        int                              depth             {0};
+        bool                             is_row            {true};  // false for invisible parents
+        bool                             is_attachment     {false};
+        bool                             has_children      {false}; // per item filter
+        bool                             force_expand      {false};
+        bool                             child_visible     {false};
+        bool                             attachment_visible{false};
+        Show_mode                        show              {Show_mode::Show};
+    };
+
+    void item_popup_menu      (const std::shared_ptr<erhe::Item_base>& item);
+    void item_icon            (const std::shared_ptr<erhe::Item_base>& item);
+    auto item_icon_and_text   (const std::shared_ptr<erhe::Item_base>& item, bool update, bool has_children, bool is_open) -> bool;
+    void item_update_selection(const std::shared_ptr<erhe::Item_base>& item);
+    auto item_has_children    (const std::shared_ptr<erhe::Item_base>& item) const -> bool;
+
+    void update_index     ();
+    void rebuild_index    ();
+    auto patch_index      (std::size_t index) -> bool;
+    auto is_entry_current (std::size_t index) const -> bool;
+    void reindex_entry    (std::size_t index);
+    void index_item       (const std::shared_ptr<erhe::Item_base>& item, std::size_t parent, int depth, bool is_attachment);
+    void forget_open_state();
+    void update_show_modes();
+    void rebuild_rows     ();
+    void append_rows      (std::size_t begin, std::size_t end, std::vector<std::size_t>& rows) const;
+    void set_row_open     (std::size_t row, bool open);
+    void imgui_row        (std::size_t row);
+    [[nodiscard]] auto is_open(const Entry& entry) const -> bool;
 
     auto get_item_by_id(
         std::size_t id
@@ -137,10 +170,21 @@ private:
 
     bool                               m_toggled_open{false};
     std::weak_ptr<erhe::Item_base>     m_last_focus_item;
+    std::weak_ptr<erhe::Item_base>     m_drag_source_item;
     std::shared_ptr<erhe::Item_base>   m_popup_item;
     std::string                        m_popup_id_string;
     unsigned int                       m_popup_id{0};
 
+    std::vector<Entry>                    m_entries;
+    std::vector<Entry>                    m_entry_scratch;
+    std::vector<std::size_t>              m_rows;              // entry indices of visible rows
+    std::vector<std::size_t>              m_row_scratch;
+    std::unordered_map<std::size_t, bool> m_open_state;        // item id to open state toggled by user
+    bool                                  m_index_expand_attachments{false};
+    bool                                  m_index_valid             {false};
+    std::size_t                           m_toggled_row             {0};
+    bool                                  m_toggled_row_open        {false};
+    bool                                  m_has_toggled_row         {false};
 };
 
 } // namespace editor
@@ -1,6 +1,9 @@
 #include "windows/network_window.hpp"
 
 #include "editor_context.hpp"
+#include "editor_scenes.hpp"
+#include "scene/scene_replication.hpp"
+#include "scene/scene_root.hpp"
 
 #include "erhe_configuration/configuration.hpp"
 #include "erhe_imgui/imgui_window.hpp"
@@ -32,6 +35,12 @@ Network_window::Network_window(
 
     m_client.set_receive_handler(
         [this](const uint8_t* data, const std::size_t length) {
+            if (is_scene_replication_message(data, length)) {
+                if (m_replication_client) {
+                    m_replication_client->apply(data, length);
+                }
+                return;
+            }
             m_upstream_messages.push_back("received " + std::string{reinterpret_cast<const char*>(data), length});
         }
     );
@@ -43,6 +52,8 @@ Network_window::Network_window(
     );
 }
 
+Network_window::~Network_window() noexcept = default;
+
 void Network_window::update_once_per_frame(const Time_context&)
 {
     update_network();
@@ -50,14 +61,122 @@ void Network_window::update_once_per_frame(const Time_context&)
 
 void Network_window::update_network()
 {
+    // Scene roots can be removed while replicating
+    if (m_replication_server && !is_scene_alive(m_replication_server_scene)) {
+        m_replication_server.reset();
+        m_replication_server_scene = nullptr;
+    }
+    if (m_replication_client && !is_scene_alive(m_replication_client_scene)) {
+        m_replication_client.reset();
+        m_replication_client_scene = nullptr;
+    }
+
     if (m_server.get_state() != erhe::net::Socket::State::CLOSED) {
         m_server.poll(0);
+        if (m_replication_server) {
+            m_replication_server->update();
+        }
     }
     if (m_client.get_state() != erhe::net::Socket::State::CLOSED) {
         m_client.poll(0);
     }
 }
 
+auto Network_window::is_scene_alive(const erhe::scene::Scene* const scene) const -> bool
+{
+    for (Scene_root* scene_root : m_context.editor_scenes->get_scene_roots()) {
+        if (&scene_root->get_scene() == scene) {
+            return true;
+        }
+    }
+    return false;
+}
+
+auto Network_window::get_selected_scene() const -> erhe::scene::Scene*
+{
+    const auto& scene_roots = m_context.editor_scenes->get_scene_roots();
+    if ((m_scene_index < 0) || (static_cast<std::size_t>(m_scene_index) >= scene_roots.size())) {
+        return nullptr;
+    }
+    return &scene_roots[m_scene_index]->get_scene();
+}
+
+void Network_window::scene_combo()
+{
+    const auto& scene_roots = m_context.editor_scenes->get_scene_roots();
+    const char* preview = (static_cast<std::size_t>(m_scene_index) < scene_roots.size())
+        ? scene_roots[m_scene_index]->get_name().c_str()
+        : "";
+    if (ImGui::BeginCombo("Scene", preview)) {
+        for (int i = 0, end = static_cast<int>(scene_roots.size()); i < end; ++i) {
+            if (ImGui::Selectable(scene_roots[i]->get_name().c_str(), i == m_scene_index)) {
+                m_scene_index = i;
+            }
+        }
+        ImGui::EndCombo();
+    }
+}
+
+void Network_window::replication_imgui()
+{
+    ImGui::PushID("Replication");
+    ImGui::Text("Scene Replication");
+    scene_combo();
+
+    bool replicate = static_cast<bool>(m_replication_server);
+    if (ImGui::Checkbox("Send Scene", &replicate)) {
+        m_replication_server.reset();
+        m_replication_server_scene = replicate ? get_selected_scene() : nullptr;
+        if (m_replication_server_scene != nullptr) {
+            m_replication_server = std::make_unique<Scene_replication_server>(
+                *m_context.scene_message_bus,
+                *m_replication_server_scene,
+                m_server
+            );
+        }
+    }
+    if (m_replication_server) {
+        const Scene_replication_server_statistics& statistics = m_replication_server->get_statistics();
+        ImGui::Text(
+            "Sent: %llu frames, %llu keyframes, %llu records, %llu bytes, last %llu bytes",
+            static_cast<unsigned long long>(statistics.frame_count),
+            static_cast<unsigned long long>(statistics.keyframe_count),
+            static_cast<unsigned long long>(statistics.record_count),
+            static_cast<unsigned long long>(statistics.byte_count),
+            static_cast<unsigned long long>(statistics.last_frame_bytes)
+        );
+    }
+
+    bool follow = static_cast<bool>(m_replication_client);
+    if (ImGui::Checkbox("Follow Scene", &follow)) {
+        if (m_replication_client) {
+            m_replication_client->clear();
+            m_replication_client.reset();
+        }
+        m_replication_client_scene = follow ? get_selected_scene() : nullptr;
+        if (m_replication_client_scene != nullptr) {
+            m_replication_client = std::make_unique<Scene_replication_client>(*m_replication_client_scene);
+        }
+    }
+    if (m_replication_client) {
+        const Scene_replication_client_statistics& statistics = m_replication_client->get_statistics();
+        ImGui::Text(
+            "Received: %llu frames, %llu records, %llu bytes, %llu errors, %zu nodes",
+            static_cast<unsigned long long>(statistics.frame_count),
+            static_cast<unsigned long long>(statistics.record_count),
+            static_cast<unsigned long long>(statistics.byte_count),
+            static_cast<unsigned long long>(statistics.error_count),
+            m_replication_client->get_node_count()
+        );
+        ImGui::Text(
+            "Loopback latency: last %.3f ms, max %.3f ms (compares clocks of server and this host, not valid across machines)",
+            static_cast<double>(statistics.last_latency_ns) / 1'000'000.0,
+            static_cast<double>(statistics.max_latency_ns) / 1'000'000.0
+        );
+    }
+    ImGui::PopID();
+}
+
 void Network_window::imgui()
 {
     using namespace erhe::net;
@@ -100,6 +219,11 @@ void Network_window::imgui()
         ImGui::DragInt  ("Downstream Port",    &m_downstream_port, 0.1f, 1, 65535);
         ImGui::Text     ("State: %s",         c_str(m_server.get_state()));
         ImGui::Text     ("Clients: %d",       static_cast<int>(m_server.get_client_count()));
+        {
+            const Socket_statistics statistics = m_server.get_statistics();
+            ImGui::Text("Sent: %llu bytes, %llu send calls", static_cast<unsigned long long>(statistics.bytes_sent), static_cast<unsigned long long>(statistics.send_syscalls));
+            ImGui::Text("Copies avoided: %llu (%llu bytes)", static_cast<unsigned long long>(statistics.copies_avoided), static_cast<unsigned long long>(statistics.copy_bytes_avoided));
+        }
         const bool is_stopped  = m_server.get_state() == Socket::State::CLOSED;
         const bool has_clients = m_server.get_client_count() > 0;
         if (is_stopped) {
@@ -123,6 +247,8 @@ void Network_window::imgui()
         }
         ImGui::PopID();
     }
+
+    replication_imgui();
     ImGui::PopID();
 }
 
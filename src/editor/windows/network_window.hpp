@@ -5,16 +5,22 @@
 #include "erhe_net/client.hpp"
 #include "erhe_net/server.hpp"
 
+#include <memory>
 #include <vector>
 
 namespace erhe::imgui {
     class Imgui_windows;
 }
+namespace erhe::scene {
+    class Scene;
+}
 
 namespace editor
 {
 
 class Editor_context;
+class Scene_replication_client;
+class Scene_replication_server;
 
 class Network_window
     : public Update_once_per_frame
@@ -27,6 +33,7 @@ public:
         Editor_context&              editor_context,
         Time&                        time
     );
+    ~Network_window() noexcept override;
 
     // Implements Imgui_window
     void imgui() override;
@@ -35,21 +42,32 @@ public:
     void update_once_per_frame(const Time_context&) override;
 
 private:
-    void update_network();
+    void update_network    ();
+    void scene_combo       ();
+    auto get_selected_scene() const -> erhe::scene::Scene*;
+    auto is_scene_alive    (const erhe::scene::Scene* scene) const -> bool;
+    void replication_imgui ();
 
-    Editor_context&          m_context;
-    erhe::net::Client        m_client;
-    erhe::net::Server        m_server;
+    Editor_context&                           m_context;
+    erhe::net::Client                         m_client;
+    erhe::net::Server                         m_server;
 
     // Network client
-    std::string              m_upstream_address;
-    int                      m_upstream_port{0};
-    std::vector<std::string> m_upstream_messages;
+    std::string                               m_upstream_address;
+    int                                       m_upstream_port{0};
+    std::vector<std::string>                  m_upstream_messages;
 
     // Network server
-    std::string              m_downstream_address;
-    int                      m_downstream_port{0};
-    std::vector<std::string> m_downstream_messages;
+    std::string                               m_downstream_address;
+    int                                       m_downstream_port{0};
+    std::vector<std::string>                  m_downstream_messages;
+
+    // Scene replication, server sends selected scene, client follows into selected scene
+    int                                       m_scene_index{0};
+    erhe::scene::Scene*                       m_replication_server_scene{nullptr};
+    erhe::scene::Scene*                       m_replication_client_scene{nullptr};
+    std::unique_ptr<Scene_replication_server> m_replication_server;
+    std::unique_ptr<Scene_replication_client> m_replication_client;
 };
 
 } // namespace editor
@@ -18,8 +18,6 @@
 #   include <imgui/imgui.h>
 #endif
 
-#include <taskflow/taskflow.hpp>  // Taskflow is header-only
-
 namespace editor
 {
 
@@ -87,7 +85,8 @@ void Operations::imgui()
             .context = m_context,
             .build_info{
                 .primitive_types = {.fill_triangles = true, .edge_lines = true, .corner_points = true, .centroid_points = true },
-                .buffer_info     = m_context.mesh_memory->buffer_info
+                .buffer_info     = m_context.mesh_memory->buffer_info,
+                .thread_pool     = m_context.thread_pool
             }
         };
     };
@@ -154,7 +153,8 @@ void Operations::imgui()
                     .context = m_context,
                     .build_info{
                         .primitive_types{ .fill_triangles = true, .edge_lines = true, .corner_points = true, .centroid_points = true },
-                        .buffer_info    = m_context.mesh_memory->buffer_info
+                        .buffer_info    = m_context.mesh_memory->buffer_info,
+                        .thread_pool    = m_context.thread_pool
                     }
                 }
             )
@@ -162,14 +162,11 @@ void Operations::imgui()
     }
 
     if (make_button("Catmull-Clark", has_selection_mode, button_size)) {
-        tf::Executor& executor = m_context.operation_stack->get_executor();
-        executor.silent_async([this, mesh_context](){
-        m_context.operation_stack->queue(
-                std::make_shared<Catmull_clark_subdivision_operation>(
-                    mesh_context()
-                )
-            );
-        });
+        m_context.operation_stack->queue_async(
+            [this, mesh_context]() -> std::shared_ptr<IOperation> {
+                return std::make_shared<Catmull_clark_subdivision_operation>(mesh_context());
+            }
+        );
     }
     if (make_button("Sqrt3", has_selection_mode, button_size)) {
         m_context.operation_stack->queue(
@@ -71,6 +71,8 @@ void Physics_window::imgui()
             ImGui::SetTooltip("erhe.ini has [physics] static_enable = false");
         }
     }
+    ImGui::SliderFloat("Fixed Step Rate", &m_context.editor_settings->physics.fixed_step_rate, 10.0f, 240.0f, "%.0f Hz");
+    ImGui::Checkbox   ("Interpolate",     &m_context.editor_settings->physics.interpolate);
 
     const auto& scene_roots = m_context.editor_scenes->get_scene_roots();
     for (const auto& scene_root : scene_roots) {
@@ -122,6 +122,7 @@ void Command::disable()
         set_inactive();
     }
     m_state = State::Disabled;
+    m_commands.command_state_changed(this);
 };
 
 void Command::enable()
@@ -143,6 +144,7 @@ void Command::set_ready()
 
     log_command_state_transition->trace("{} -> ready", get_name());
     m_state = State::Ready;
+    m_commands.command_state_changed(this);
 }
 
 void Command::set_active()
@@ -152,6 +154,7 @@ void Command::set_active()
     }
     log_command_state_transition->trace("{} -> active", get_name());
     m_state = State::Active;
+    m_commands.command_state_changed(this);
 }
 
 auto Command::is_accepted() const -> bool
@@ -18,8 +18,31 @@
 #include "erhe_commands/update_binding.hpp"
 #include "erhe_verify/verify.hpp"
 
+#include <algorithm>
+
 namespace erhe::commands {
 
+namespace {
+
+// Stable, so bindings with equal priority keep binding order
+template <typename T>
+void sort_by_priority(const Commands& commands, std::vector<T*>& bindings)
+{
+    std::stable_sort(
+        bindings.begin(),
+        bindings.end(),
+        [&commands](const T* lhs, const T* rhs) -> bool {
+            auto* const lhs_command = lhs->get_command();
+            auto* const rhs_command = rhs->get_command();
+            ERHE_VERIFY(lhs_command != nullptr);
+            ERHE_VERIFY(rhs_command != nullptr);
+            return commands.get_command_priority(lhs_command) > commands.get_command_priority(rhs_command);
+        }
+    );
+}
+
+}
+
 Commands::Commands()
 {
     float mouse_x{};
@@ -100,6 +123,7 @@ void Commands::bind_command_to_key(
 {
     std::lock_guard<std::mutex> lock{m_command_mutex};
     m_key_bindings.emplace_back(command, code, pressed, modifier_mask);
+    m_binding_index_dirty = true;
 }
 
 void Commands::bind_command_to_mouse_button(
@@ -112,6 +136,7 @@ void Commands::bind_command_to_mouse_button(
     m_mouse_bindings.push_back(
         std::make_unique<Mouse_button_binding>(command, button, trigger_on_pressed)
     );
+    m_binding_index_dirty = true;
 }
 
 void Commands::bind_command_to_mouse_wheel(
@@ -132,6 +157,7 @@ void Commands::bind_command_to_mouse_motion(
     m_mouse_bindings.push_back(
         std::make_unique<Mouse_motion_binding>(command)
     );
+    m_binding_index_dirty = true;
 }
 
 void Commands::bind_command_to_mouse_drag(
@@ -144,6 +170,7 @@ void Commands::bind_command_to_mouse_drag(
     m_mouse_bindings.push_back(
         std::make_unique<Mouse_drag_binding>(command, button, call_on_button_down_without_motion)
     );
+    m_binding_index_dirty = true;
 }
 
 #if defined(ERHE_XR_LIBRARY_OPENXR)
@@ -155,6 +182,7 @@ void Commands::bind_command_to_xr_boolean_action(
 {
     std::lock_guard<std::mutex> lock{m_command_mutex};
     m_xr_boolean_bindings.emplace_back(command, xr_action, button_trigger);
+    m_binding_index_dirty = true;
 }
 
 void Commands::bind_command_to_xr_float_action(
@@ -164,6 +192,7 @@ void Commands::bind_command_to_xr_float_action(
 {
     std::lock_guard<std::mutex> lock{m_command_mutex};
     m_xr_float_bindings.emplace_back(command, xr_action);
+    m_binding_index_dirty = true;
 }
 
 void Commands::bind_command_to_xr_vector2f_action(
@@ -173,6 +202,7 @@ void Commands::bind_command_to_xr_vector2f_action(
 {
     std::lock_guard<std::mutex> lock{m_command_mutex};
     m_xr_vector2f_bindings.emplace_back(command, xr_action);
+    m_binding_index_dirty = true;
 }
 #endif
 
@@ -269,8 +299,44 @@ void Commands::command_inactivated(Command* const command)
     // std::lock_guard<std::mutex> lock{m_command_mutex};
 
     if (m_active_mouse_command == command) {
-        m_active_mouse_command = nullptr;
+        set_active_mouse_command(nullptr);
+    }
+    command_state_changed(command);
+}
+
+void Commands::command_state_changed(Command* const command)
+{
+    if (command->get_command_state() == State::Ready) {
+        // Commands can cycle through ready state without mouse events,
+        // drop entries which are no longer ready before growing further
+        if (m_ready_commands.size() > m_commands.size()) {
+            m_ready_commands.erase(
+                std::remove_if(
+                    m_ready_commands.begin(),
+                    m_ready_commands.end(),
+                    [](const Command* ready_command) {
+                        return ready_command->get_command_state() != State::Ready;
+                    }
+                ),
+                m_ready_commands.end()
+            );
+        }
+        m_ready_commands.push_back(command);
+    }
+
+    // Mouse binding order depends on command state, see get_command_priority().
+    // This can be called while dispatching mouse bindings, so they are sorted
+    // before the next event.
+    m_mouse_bindings_dirty = true;
+}
+
+void Commands::set_active_mouse_command(Command* const command)
+{
+    if (m_active_mouse_command == command) {
+        return;
     }
+    m_active_mouse_command = command;
+    m_mouse_bindings_dirty = true;
 }
 
 auto Commands::has_active_mouse() const -> bool
@@ -286,14 +352,19 @@ auto Commands::on_key(
 {
     std::lock_guard<std::mutex> lock{m_command_mutex};
 
+    update_binding_index();
+
     Input_arguments context;
 
-    for (auto& binding : m_key_bindings) {
-        if (!binding.is_command_host_enabled()) {
-            continue;
-        }
-        if (binding.on_key(context, pressed, code, modifier_mask)) {
-            return true;
+    const auto i = m_key_binding_index.find(code);
+    if (i != m_key_binding_index.end()) {
+        for (Key_binding* binding : i->second) {
+            if (!binding->is_command_host_enabled()) {
+                continue;
+            }
+            if (binding->on_key(context, pressed, code, modifier_mask)) {
+                return true;
+            }
         }
     }
 
@@ -309,6 +380,8 @@ auto Commands::on_idle() -> bool
 {
     std::lock_guard<std::mutex> lock{m_command_mutex};
 
+    update_binding_index();
+
     for (auto& binding : m_update_bindings) {
         if (!binding.is_command_host_enabled()) {
             continue;
@@ -325,21 +398,19 @@ auto Commands::on_idle() -> bool
             }
         };
 
-        for (auto& binding : m_mouse_bindings) {
-            if (!binding->is_command_host_enabled()) {
+        for (erhe::window::Mouse_button button = 0; button < erhe::window::Mouse_button_count; ++button) {
+            const uint32_t bit = (1 << button);
+            if ((m_last_mouse_button_bits & bit) != bit) {
                 continue;
             }
-
-            if (binding->get_type() == Command_binding::Type::Mouse_drag) {
-                auto*      drag_binding = static_cast<Mouse_drag_binding*>(binding.get());
-                Command*   command      = binding->get_command();
-                const auto state        = command->get_command_state();
+            for (Mouse_drag_binding* drag_binding : m_mouse_drag_binding_index[button]) {
+                if (!drag_binding->is_command_host_enabled()) {
+                    continue;
+                }
+                Command*   command = drag_binding->get_command();
+                const auto state   = command->get_command_state();
                 if ((state == State::Ready) || (state == State::Active)) {
-                    const auto     button = drag_binding->get_button();
-                    const uint32_t bit    = (1 << button);
-                    if ((m_last_mouse_button_bits & bit) == bit) {
-                        drag_binding->on_motion(dummy_input);
-                    }
+                    drag_binding->on_motion(dummy_input);
                 }
             }
         }
@@ -364,7 +435,7 @@ auto Commands::get_command_priority(Command* const command) const -> int
 
 void Commands::sort_mouse_bindings()
 {
-    std::sort(
+    std::stable_sort(
         m_mouse_bindings.begin(),
         m_mouse_bindings.end(),
         [this](
@@ -387,6 +458,9 @@ void Commands::sort_mouse_bindings()
             return is_higher;
         }
     );
+
+    update_mouse_binding_index();
+
     // log_input->trace("Mouse bindings after sort:");
     // for (const auto& binding : m_mouse_bindings) {
     //     auto* const command = binding->get_command();
@@ -395,63 +469,77 @@ void Commands::sort_mouse_bindings()
     // }
 }
 
-#if defined(ERHE_XR_LIBRARY_OPENXR)
-void Commands::sort_xr_bindings()
+void Commands::update_binding_index()
 {
-    std::sort(
-        m_xr_boolean_bindings.begin(),
-        m_xr_boolean_bindings.end(),
-        [this](
-            const Xr_boolean_binding& lhs,
-            const Xr_boolean_binding& rhs
-        ) -> bool {
-            auto* const lhs_command = lhs.get_command();
-            auto* const rhs_command = rhs.get_command();
-            ERHE_VERIFY(lhs_command != nullptr);
-            ERHE_VERIFY(rhs_command != nullptr);
-            return get_command_priority(lhs_command) > get_command_priority(rhs_command);
-        }
-    );
-    std::sort(
-        m_xr_float_bindings.begin(),
-        m_xr_float_bindings.end(),
-        [this](
-            const Xr_float_binding& lhs,
-            const Xr_float_binding& rhs
-        ) -> bool {
-            auto* const lhs_command = lhs.get_command();
-            auto* const rhs_command = rhs.get_command();
-            ERHE_VERIFY(lhs_command != nullptr);
-            ERHE_VERIFY(rhs_command != nullptr);
-            return get_command_priority(lhs_command) > get_command_priority(rhs_command);
+    if (m_binding_index_dirty) {
+        m_binding_index_dirty = false;
+        update_key_binding_index();
+        m_mouse_bindings_dirty = true;
+    }
+    if (m_mouse_bindings_dirty) {
+        m_mouse_bindings_dirty = false;
+        sort_mouse_bindings();
+    }
+}
+
+// Mouse button and drag indices follow mouse binding order
+void Commands::update_mouse_binding_index()
+{
+    for (auto& bindings : m_mouse_button_binding_index) {
+        bindings.clear();
+    }
+    for (auto& bindings : m_mouse_drag_binding_index) {
+        bindings.clear();
+    }
+    for (const auto& binding : m_mouse_bindings) {
+        const erhe::window::Mouse_button button = binding->get_button();
+        if (button >= erhe::window::Mouse_button_count) {
+            continue; // motion bindings
         }
-    );
-    std::sort(
-        m_xr_vector2f_bindings.begin(),
-        m_xr_vector2f_bindings.end(),
-        [this](
-            const Xr_vector2f_binding& lhs,
-            const Xr_vector2f_binding& rhs
-        ) -> bool {
-            auto* const lhs_command = lhs.get_command();
-            auto* const rhs_command = rhs.get_command();
-            ERHE_VERIFY(lhs_command != nullptr);
-            ERHE_VERIFY(rhs_command != nullptr);
-            return get_command_priority(lhs_command) > get_command_priority(rhs_command);
+        m_mouse_button_binding_index[button].push_back(binding.get());
+        if (binding->get_type() == Command_binding::Type::Mouse_drag) {
+            m_mouse_drag_binding_index[button].push_back(static_cast<Mouse_drag_binding*>(binding.get()));
         }
-    );
+    }
 }
+
+// Also updates XR binding indices
+void Commands::update_key_binding_index()
+{
+    m_key_binding_index.clear();
+    for (auto& binding : m_key_bindings) {
+        m_key_binding_index[binding.get_keycode()].push_back(&binding);
+    }
+
+#if defined(ERHE_XR_LIBRARY_OPENXR)
+    m_xr_boolean_binding_index.clear();
+    for (auto& binding : m_xr_boolean_bindings) {
+        m_xr_boolean_binding_index[binding.xr_action].push_back(&binding);
+    }
+    m_xr_float_binding_index.clear();
+    for (auto& binding : m_xr_float_bindings) {
+        m_xr_float_binding_index[binding.xr_action].push_back(&binding);
+    }
+    m_xr_vector2f_binding_index.clear();
+    for (auto& binding : m_xr_vector2f_bindings) {
+        m_xr_vector2f_binding_index[binding.xr_action].push_back(&binding);
+    }
 #endif
+}
 
 void Commands::inactivate_ready_commands()
 {
     //std::lock_guard<std::mutex> lock{m_command_mutex};
 
-    for (auto* command : m_commands) {
+    // Only commands which have been set ready since the previous call can be
+    // in ready state. set_inactive() does not add commands to the list.
+    std::swap(m_ready_commands, m_inactivate_commands);
+    for (auto* command : m_inactivate_commands) {
         if (command->get_command_state() == State::Ready) {
             command->set_inactive();
         }
     }
+    m_inactivate_commands.clear();
 }
 
 auto Commands::last_mouse_button_bits() const -> uint32_t
@@ -481,13 +569,13 @@ void Commands::update_active_mouse_command(
     ) {
         ERHE_VERIFY(m_active_mouse_command == nullptr);
         log_input->trace("Set active mouse command = {}", command->get_name());
-        m_active_mouse_command = command;
+        set_active_mouse_command(command);
     } else if (
         (command->get_command_state() != State::Active) &&
         (m_active_mouse_command == command)
     ) {
         log_input->trace("reset active mouse command");
-        m_active_mouse_command = nullptr;
+        set_active_mouse_command(nullptr);
     }
 }
 
@@ -498,7 +586,11 @@ auto Commands::on_mouse_button(
 {
     std::lock_guard<std::mutex> lock{m_command_mutex};
 
-    sort_mouse_bindings();
+    if (button >= erhe::window::Mouse_button_count) {
+        return false;
+    }
+
+    update_binding_index();
 
     const uint32_t bit_mask = (1 << button);
     if (pressed) {
@@ -513,19 +605,18 @@ auto Commands::on_mouse_button(
 
     const char* button_name = erhe::window::c_str(button);
     log_input->trace("Mouse button {} {}", button_name, pressed ? "pressed" : "released");
-    for (const auto& binding : m_mouse_bindings) {
-        const bool button_match = binding->get_button() == button;
+
+    // Priorities depend on active mouse command and enabled command hosts
+    std::vector<Mouse_binding*>& bindings = m_mouse_button_binding_index[button];
+    sort_by_priority(*this, bindings);
+    for (Mouse_binding* binding : bindings) {
         log_input->trace(
-            "  {}/{} {} {} {}",
+            "  {}/{} {} {}",
             binding->get_command()->get_priority(),
             get_command_priority(binding->get_command()),
             binding->is_command_host_enabled() ? "host enabled" : "host disabled",
-            binding->get_command()->get_name(),
-            button_match ? "button match" : "button mismatch"
+            binding->get_command()->get_name()
         );
-        if (!button_match) {
-            continue;
-        }
         auto* const command = binding->get_command();
         ERHE_VERIFY(command != nullptr);
         if (!binding->is_command_host_enabled()) {
@@ -553,8 +644,6 @@ auto Commands::on_mouse_wheel(const float x, const float y) -> bool
 {
     std::lock_guard<std::mutex> lock{m_command_mutex};
 
-    sort_mouse_bindings();
-
     Input_arguments input{
         .vector2
         {
@@ -581,6 +670,8 @@ auto Commands::on_mouse_move(const float x, const float y) -> bool
 {
     std::lock_guard<std::mutex> lock{m_command_mutex};
 
+    update_binding_index();
+
     glm::vec2 new_mouse_position{x, y};
     m_last_mouse_position_delta = m_last_mouse_position - new_mouse_position;
 
@@ -617,7 +708,7 @@ void Commands::on_xr_action(
 {
     std::lock_guard<std::mutex> lock{m_command_mutex};
 
-    sort_xr_bindings();
+    update_binding_index();
 
     const bool state = xr_action.state.currentState == XR_TRUE;
     Input_arguments input{
@@ -625,10 +716,14 @@ void Commands::on_xr_action(
     };
 
     log_input->trace("{}: {}", xr_action.name, state);
-    for (auto& binding : m_xr_boolean_bindings) {
-        if (binding.xr_action != &xr_action) {
-            continue;
-        }
+    const auto i = m_xr_boolean_binding_index.find(&xr_action);
+    if (i == m_xr_boolean_binding_index.end()) {
+        log_input->trace("OpenXR bool {} was not consumed", state);
+        return;
+    }
+    sort_by_priority(*this, i->second);
+    for (Xr_boolean_binding* binding_pointer : i->second) {
+        Xr_boolean_binding& binding = *binding_pointer;
         log_input->trace(
             "  {} {} {} <- {} {}",
             binding.get_command()->get_priority(),
@@ -658,16 +753,20 @@ void Commands::on_xr_action(
 {
     std::lock_guard<std::mutex> lock{m_command_mutex};
 
-    sort_xr_bindings();
+    update_binding_index();
 
     Input_arguments input{
         .float_value = xr_action.state.currentState
     };
 
-    for (auto& binding : m_xr_float_bindings) {
-        if (binding.xr_action != &xr_action) {
-            continue;
-        }
+    const auto i = m_xr_float_binding_index.find(&xr_action);
+    if (i == m_xr_float_binding_index.end()) {
+        log_input->trace("OpenXR float input action was not consumed");
+        return;
+    }
+    sort_by_priority(*this, i->second);
+    for (Xr_float_binding* binding_pointer : i->second) {
+        Xr_float_binding& binding = *binding_pointer;
         if (!binding.is_command_host_enabled()) {
             continue;
         }
@@ -688,7 +787,7 @@ void Commands::on_xr_action(
 {
     std::lock_guard<std::mutex> lock{m_command_mutex};
 
-    sort_xr_bindings();
+    update_binding_index();
 
     Input_arguments context{
         .vector2{
@@ -700,10 +799,14 @@ void Commands::on_xr_action(
         }
     };
 
-    for (auto& binding : m_xr_vector2f_bindings) {
-        if (binding.xr_action != &xr_action) {
-            continue;
-        }
+    const auto i = m_xr_vector2f_binding_index.find(&xr_action);
+    if (i == m_xr_vector2f_binding_index.end()) {
+        log_input->trace("OpenXR vector2f input action was not consumed");
+        return;
+    }
+    sort_by_priority(*this, i->second);
+    for (Xr_vector2f_binding* binding_pointer : i->second) {
+        Xr_vector2f_binding& binding = *binding_pointer;
         if (!binding.is_command_host_enabled()) {
             continue;
         }
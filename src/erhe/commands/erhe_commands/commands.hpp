@@ -9,8 +9,11 @@
 
 #include <glm/glm.hpp>
 
+#include <array>
 #include <mutex>
 #include <optional>
+#include <unordered_map>
+#include <vector>
 
 #if defined(ERHE_XR_LIBRARY_OPENXR)
 namespace erhe::xr {
@@ -115,7 +118,8 @@ public:
             (m_active_mouse_command == command);
     }
 
-    void command_inactivated(Command* command);
+    void command_inactivated  (Command* command);
+    void command_state_changed(Command* command);
 
     [[nodiscard]] auto last_mouse_button_bits   () const -> uint32_t;
     [[nodiscard]] auto last_mouse_position      () const -> glm::vec2;
@@ -139,14 +143,18 @@ public:
     [[nodiscard]] auto get_active_mouse_command() -> Command* { return m_active_mouse_command; }
 
 private:
+    void set_active_mouse_command   (Command* command);
     void sort_mouse_bindings        ();
-    void sort_xr_bindings           ();
+    void update_binding_index       ();
+    void update_mouse_binding_index ();
+    void update_key_binding_index   ();
     void inactivate_ready_commands  ();
     void update_active_mouse_command(Command* command);
     void commands                   (State filter);
 
     std::mutex m_command_mutex;
     Command*   m_active_mouse_command     {nullptr}; // does not tell if command(s) is/are ready
+    bool       m_mouse_bindings_dirty     {false};   // command states changed since last sort
     uint32_t   m_last_mouse_button_bits   {0u};
     glm::vec2  m_last_mouse_position      {0.0f, 0.0f};
     glm::vec2  m_last_mouse_position_delta{0.0f, 0.0f};
@@ -161,6 +169,26 @@ private:
     std::vector<Xr_vector2f_binding>                  m_xr_vector2f_bindings;
 #endif
     std::vector<Update_binding>                       m_update_bindings;
+    std::vector<Command*>                             m_ready_commands; // may contain commands which are no longer ready
+    std::vector<Command*>                             m_inactivate_commands;
+
+    // Bindings by input, in mouse binding order. Rebuilt when bindings are
+    // added or mouse bindings are sorted.
+    // Key bindings are indexed by keycode only, as modifier mask can be a wildcard.
+    template <typename Key, typename Binding>
+    using Binding_index = std::unordered_map<Key, std::vector<Binding*>>;
+    template <typename Binding>
+    using Mouse_button_index = std::array<std::vector<Binding*>, erhe::window::Mouse_button_count>;
+
+    bool                                                                    m_binding_index_dirty{true};
+    Binding_index<erhe::window::Keycode, Key_binding>                       m_key_binding_index;
+    Mouse_button_index<Mouse_binding>                                       m_mouse_button_binding_index;
+    Mouse_button_index<Mouse_drag_binding>                                  m_mouse_drag_binding_index;
+#if defined(ERHE_XR_LIBRARY_OPENXR)
+    Binding_index<const erhe::xr::Xr_action_boolean*,  Xr_boolean_binding>  m_xr_boolean_binding_index;
+    Binding_index<const erhe::xr::Xr_action_float*,    Xr_float_binding>    m_xr_float_binding_index;
+    Binding_index<const erhe::xr::Xr_action_vector2f*, Xr_vector2f_binding> m_xr_vector2f_binding_index;
+#endif
 };
 
 } // namespace erhe::commands
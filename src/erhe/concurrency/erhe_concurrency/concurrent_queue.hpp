@@ -2,7 +2,9 @@
 
 #include "erhe_concurrency/thread_pool.hpp"
 
+#include <functional>
 #include <string_view>
+#include <utility>
 
 namespace erhe::concurrency {
 
@@ -51,13 +53,25 @@ public:
     template <class F, class... Args>
     void enqueue(F&& f, Args&&... args)
     {
-        m_pool.enqueue(
-            &m_queue,
-            std::bind(
-                std::forward<F>(f),
-                std::forward<Args>(args)...
-            )
-        );
+        if constexpr (sizeof...(Args) == 0) {
+            m_pool.enqueue(&m_queue, std::forward<F>(f));
+        } else {
+            m_pool.enqueue(
+                &m_queue,
+                [f = std::forward<F>(f), ...args = std::forward<Args>(args)]() mutable
+                {
+                    std::invoke(f, args...);
+                }
+            );
+        }
+    }
+
+    // Like enqueue(), but when called from a running task, that task and its
+    // queue do not complete before f has completed (nested fork-join).
+    template <class F>
+    void enqueue_child(F&& f)
+    {
+        m_pool.enqueue_child(&m_queue, std::forward<F>(f));
     }
 
     void steal ();
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "erhe_concurrency/concurrent_queue.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace erhe::concurrency {
+
+// Calls fn(begin, end) for consecutive ranges covering [0, count).
+//
+// Ranges are at least grain_size long. They are processed by thread_pool
+// workers and by the calling thread, and parallel_for() returns once all
+// ranges have completed. Runs fn(0, count) inline when thread_pool is
+// nullptr, has no threads, or count fits in a single range.
+template <class Fn>
+void parallel_for(
+    Thread_pool* const thread_pool,
+    const std::size_t  count,
+    const std::size_t  grain_size,
+    Fn&&               fn
+)
+{
+    if (count == 0) {
+        return;
+    }
+    const std::size_t thread_count = (thread_pool != nullptr) ? static_cast<std::size_t>(thread_pool->size()) : 0;
+    if ((thread_count == 0) || (count <= grain_size)) {
+        fn(std::size_t{0}, count);
+        return;
+    }
+
+    // A few ranges per thread (including the caller) for load balancing
+    const std::size_t range_count = 4 * (thread_count + 1);
+    const std::size_t range_size  = std::max(grain_size, (count + range_count - 1) / range_count);
+
+    Concurrent_queue queue{*thread_pool, "parallel_for", Priority::HIGH};
+    for (std::size_t begin = range_size; begin < count; begin += range_size) {
+        const std::size_t end = std::min(begin + range_size, count);
+        queue.enqueue(
+            [&fn, begin, end]()
+            {
+                fn(begin, end);
+            }
+        );
+    }
+    fn(std::size_t{0}, std::min(range_size, count));
+    queue.wait();
+}
+
+}
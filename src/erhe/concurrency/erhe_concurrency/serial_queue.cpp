@@ -1,72 +1,65 @@
 #include "erhe_concurrency/serial_queue.hpp"
 
+#include <thread>
+
 namespace erhe::concurrency {
 
-Serial_queue::Serial_queue()
-    : m_name{"serial.default"}
+Serial_queue::Serial_queue(Thread_pool& thread_pool)
+    : m_pool {thread_pool}
+    , m_queue{&m_pool, int(Priority::NORMAL), "serial.default"}
 {
-    m_thread = std::thread(
-        [this]
-        {
-            thread();
-        }
-    );
 }
 
-Serial_queue::Serial_queue(const std::string_view name)
-    : m_name{name}
+Serial_queue::Serial_queue(
+    Thread_pool&           thread_pool,
+    const std::string_view name,
+    Priority               priority
+)
+    : m_pool {thread_pool}
+    , m_queue{&m_pool, static_cast<int>(priority), name}
 {
-    m_thread = std::thread(
-        [this]
-        {
-            thread();
-        }
-    );
 }
 
 Serial_queue::~Serial_queue() noexcept
 {
     wait();
-
-    std::unique_lock<std::mutex> queue_lock{m_queue_mutex};
-
-    m_stop = true;
-    queue_lock.unlock();
-
-    m_task_condition.notify_one();
-    m_thread.join();
 }
 
-void Serial_queue::thread()
+// Runs the oldest task, then queues itself again if more tasks are pending.
+// Only one run_next() is queued or running at a time, and the mutex orders
+// each task after the previous one even when they run on different workers.
+void Serial_queue::run_next()
 {
-    while (!m_stop.load(std::memory_order_relaxed)) {
-        std::unique_lock<std::mutex> queue_lock{m_queue_mutex};
+    Task task;
+    {
+        std::lock_guard<std::mutex> lock{m_queue_mutex};
 
-        if (m_task_counter > 0) {
-            auto task = std::move(m_task_queue.front());
-            m_task_queue.pop_front();
-            queue_lock.unlock();
+        if (m_task_queue.empty()) { // cancelled
+            m_running = false;
+            return;
+        }
+        task = std::move(m_task_queue.front());
+        m_task_queue.pop_front();
+    }
 
-            task();
+    task();
 
-            std::unique_lock<std::mutex> wait_lock(m_wait_mutex);
-            --m_task_counter;
-        } else {
-            m_wait_condition.notify_all();
-            m_task_condition.wait(
-                queue_lock,
-                [this]
-                {
-                    return m_stop || m_task_counter;
-                }
-            );
-        }
+    bool more{false};
+    {
+        std::lock_guard<std::mutex> lock{m_queue_mutex};
+
+        --m_task_counter;
+        more = !m_task_queue.empty();
+        m_running = more;
+    }
+    if (more) {
+        m_pool.enqueue(&m_queue, [this]{ run_next(); });
     }
 }
 
 void Serial_queue::cancel()
 {
-    std::unique_lock<std::mutex> queue_lock{m_queue_mutex};
+    std::lock_guard<std::mutex> lock{m_queue_mutex};
 
     m_task_counter -= static_cast<int>(m_task_queue.size());
     m_task_queue.clear();
@@ -74,15 +67,13 @@ void Serial_queue::cancel()
 
 void Serial_queue::wait()
 {
-    std::unique_lock<std::mutex> wait_lock{m_wait_mutex};
-
-    m_wait_condition.wait(
-        wait_lock,
-        [this]
-        {
-            return !m_task_counter.load(std::memory_order_relaxed);
+    // Tasks are counted until they have completed; the pool queue also
+    // covers run_next() which is queued but finds no tasks after cancel().
+    while ((m_task_counter.load() > 0) || (m_queue.task_counter.load() > 0)) {
+        if (!m_pool.dequeue_and_process()) {
+            std::this_thread::yield();
         }
-    );
+    }
 }
 
 }
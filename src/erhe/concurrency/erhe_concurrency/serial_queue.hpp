@@ -1,13 +1,13 @@
 #pragma once
 
+#include "erhe_concurrency/thread_pool.hpp"
+
 #include <atomic>
-#include <condition_variable>
 #include <deque>
 #include <functional>
 #include <mutex>
-#include <string>
 #include <string_view>
-#include <thread>
+#include <utility>
 
 namespace erhe::concurrency {
 
@@ -17,8 +17,9 @@ namespace erhe::concurrency {
 
 /*
     SerialQueue is API to serialize tasks to be executed after previous task
-    in the queue has completed. The tasks are NOT executed in the Thread_pool; each
-    queue has it's own execution thread.
+    in the queue has completed. The tasks are executed in the Thread_pool, one
+    at a time; each task runs as a separate pool task, so a busy serial queue
+    does not hold on to a worker between its tasks.
 
     SerialQueue and ConcurrentQueue can be freely mixed can can enqueue work to other
     queues from their tasks.
@@ -26,7 +27,7 @@ namespace erhe::concurrency {
     Usage example:
 
     // create queue
-    SerialQueue s;
+    SerialQueue s{thread_pool};
 
     // submit work into the queue
     s.enqueue([]
@@ -35,7 +36,7 @@ namespace erhe::concurrency {
     });
 
     // wait until the queue is drained
-    s.wait(); // non-cooperative, blocking (CPU sleeps until queue is drained)
+    s.wait(); // cooperative, blocking (helps pool until all tasks are complete)
 
 */
 
@@ -44,40 +45,60 @@ class Serial_queue
 protected:
     using Task = std::function<void()>;
 
-    std::string m_name;
-    std::thread m_thread;
+    Thread_pool&       m_pool;
+    Thread_pool::Queue m_queue;
 
 #if defined(_MSC_VER)
 #   pragma warning(push)
 #   pragma warning(disable : 4324)  // structure was padded due to alignment specifier
 #endif
-    alignas(64) std::atomic<bool> m_stop        { false };
     alignas(64) std::atomic<int>  m_task_counter{ 0 };
 #if defined(_MSC_VER)
 #   pragma warning(pop)
 #endif
 
-    std::deque<Task>        m_task_queue;
-    std::mutex              m_queue_mutex;
-    std::mutex              m_wait_mutex;
-    std::condition_variable m_task_condition;
-    std::condition_variable m_wait_condition;
+    std::deque<Task> m_task_queue;
+    std::mutex       m_queue_mutex;
+    bool             m_running{false}; // guarded by m_queue_mutex, true while a pool task is queued or running
 
-    void thread();
+    void run_next();
 
 public:
-    Serial_queue();
-    explicit Serial_queue(const std::string_view name);
+    explicit Serial_queue(Thread_pool& thread_pool);
+    Serial_queue(
+        Thread_pool&           thread_pool,
+        const std::string_view name,
+        Priority               priority = Priority::NORMAL
+    );
     ~Serial_queue() noexcept;
 
+    Serial_queue(const Serial_queue&) = delete;
+    auto operator=(const Serial_queue&) -> Serial_queue = delete;
+
     template <class F, class... Args>
     void enqueue(F&& f, Args&&... args)
     {
-        std::unique_lock<std::mutex> lock{m_queue_mutex};
-
-        m_task_queue.emplace_back(f, (args)...);
-        ++m_task_counter;
-        m_task_condition.notify_one();
+        bool start{false};
+        {
+            std::lock_guard<std::mutex> lock{m_queue_mutex};
+
+            if constexpr (sizeof...(Args) == 0) {
+                m_task_queue.emplace_back(std::forward<F>(f));
+            } else {
+                m_task_queue.emplace_back(
+                    [f = std::forward<F>(f), ...args = std::forward<Args>(args)]() mutable
+                    {
+                        std::invoke(f, args...);
+                    }
+                );
+            }
+            ++m_task_counter;
+            start = !m_running;
+            m_running = true;
+        }
+        if (start) {
+            m_pool.enqueue(&m_queue, [this]{ run_next(); });
+        }
     }
 
     void cancel();
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace erhe::concurrency {
+
+// Type erased void() callable with inline storage.
+//
+// Callables up to inline_size bytes are constructed in place, so the
+// common case of a lambda capturing a few pointers does not allocate.
+// Larger callables fall back to the heap. Task_function is neither
+// copyable nor movable; it is constructed in place in pooled task nodes.
+class Task_function
+{
+public:
+    static constexpr std::size_t inline_size = 48;
+
+    Task_function() = default;
+    ~Task_function() noexcept
+    {
+        reset();
+    }
+
+    Task_function(const Task_function&) = delete;
+    auto operator=(const Task_function&) -> Task_function& = delete;
+
+    template <class F>
+    void emplace(F&& f)
+    {
+        using Callable = std::decay_t<F>;
+
+        reset();
+        if constexpr (fits_inline<Callable>()) {
+            ::new (static_cast<void*>(m_storage)) Callable(std::forward<F>(f));
+            m_invoke = [](void* storage) {
+                (*std::launder(static_cast<Callable*>(storage)))();
+            };
+            m_destroy = [](void* storage) noexcept {
+                std::launder(static_cast<Callable*>(storage))->~Callable();
+            };
+        } else {
+            Callable* const callable = new Callable(std::forward<F>(f));
+            ::new (static_cast<void*>(m_storage)) Callable*(callable);
+            m_invoke = [](void* storage) {
+                (**std::launder(static_cast<Callable**>(storage)))();
+            };
+            m_destroy = [](void* storage) noexcept {
+                delete *std::launder(static_cast<Callable**>(storage));
+            };
+        }
+    }
+
+    void operator()()
+    {
+        m_invoke(m_storage);
+    }
+
+    void reset() noexcept
+    {
+        if (m_destroy != nullptr) {
+            m_destroy(m_storage);
+            m_invoke  = nullptr;
+            m_destroy = nullptr;
+        }
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return m_invoke != nullptr;
+    }
+
+private:
+    template <class Callable>
+    static constexpr auto fits_inline() -> bool
+    {
+        return
+            (sizeof (Callable) <= inline_size) &&
+            (alignof(Callable) <= alignof(std::max_align_t));
+    }
+
+    alignas(std::max_align_t) unsigned char m_storage[inline_size];
+    void (*m_invoke )(void*)          {nullptr};
+    void (*m_destroy)(void*) noexcept {nullptr};
+};
+
+}
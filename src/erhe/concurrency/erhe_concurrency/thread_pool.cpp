@@ -1,34 +1,70 @@
 #include "erhe_concurrency/thread_pool.hpp"
+#include "erhe_concurrency/work_stealing_deque.hpp"
 
 #include <concurrentqueue.h>
 
+#include <array>
 #include <chrono>
+#include <mutex>
 
 namespace erhe::concurrency {
 
 using std::chrono::high_resolution_clock;
-using std::chrono::duration_cast;
 using std::chrono::microseconds;
-using std::chrono::milliseconds;
+
+namespace {
+
+constexpr std::size_t worker_deque_capacity = 4096;
+constexpr std::size_t task_block_size       = 256;
+
+}
 
 // ------------------------------------------------------------
 // Thread_pool
 // ------------------------------------------------------------
 
-
-struct Thread_pool::Task_queue
+struct Thread_pool::Worker
 {
-    using Task = Thread_pool::Task;
+    Worker(Thread_pool* pool, const std::size_t index)
+        : pool {pool}
+        , index{index}
+        , deques{
+            Work_stealing_deque<Task>{worker_deque_capacity},
+            Work_stealing_deque<Task>{worker_deque_capacity},
+            Work_stealing_deque<Task>{worker_deque_capacity}
+        }
+    {
+    }
 
-    moodycamel::ConcurrentQueue<Task> tasks;
+    Thread_pool*                                           pool;
+    std::size_t                                            index;
+    std::array<Work_stealing_deque<Task>, priority_count> deques;
 };
 
+struct Thread_pool::Shared_queues
+{
+    // Tasks enqueued from threads which are not workers of this pool,
+    // and overflow from full worker deques.
+    std::array<moodycamel::ConcurrentQueue<Task*>, priority_count> injection;
+
+    // Pooled task nodes. Blocks are only allocated when the free list runs dry.
+    moodycamel::ConcurrentQueue<Task*>   free_tasks;
+    std::mutex                           task_block_mutex;
+    std::vector<std::unique_ptr<Task[]>> task_blocks;
+};
+
+thread_local Thread_pool::Worker* Thread_pool::s_current_worker{nullptr};
+thread_local Thread_pool::Task*   Thread_pool::s_current_task  {nullptr};
+
 Thread_pool::Thread_pool(size_t size)
-    : m_queues      {nullptr}
+    : m_shared      {std::make_unique<Shared_queues>()}
     , m_static_queue{this, int(Priority::NORMAL), "static"}
     , m_threads     {size}
 {
-    m_queues = new Task_queue[3];
+    m_workers.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        m_workers.push_back(std::make_unique<Worker>(this, i));
+    }
 
     // NOTE: let OS scheduler shuffle tasks as it sees fit
     //       this gives better performance overall UNTIL we have some practical
@@ -65,27 +101,22 @@ Thread_pool::Thread_pool(size_t size)
 Thread_pool::~Thread_pool() noexcept
 {
     m_stop = true;
-    m_condition.notify_all();
+    m_work_epoch.fetch_add(1);
+    m_work_epoch.notify_all();
 
     for (auto& thread : m_threads) {
         thread.join();
     }
-
-    delete[] m_queues;
 }
 
-//int Thread_pool::getHardwareConcurrency() {
-//    return int(std::thread::hardware_concurrency());
-//}
-
 int Thread_pool::size() const
 {
     return int(m_threads.size());
 }
 
-void Thread_pool::thread(size_t threadID)
+void Thread_pool::thread(size_t thread_id)
 {
-    static_cast<void>(threadID);
+    s_current_worker = m_workers[thread_id].get();
 
     auto time0 = high_resolution_clock::now();
 
@@ -93,61 +124,171 @@ void Thread_pool::thread(size_t threadID)
         if (dequeue_and_process()) {
             // remember the last time we processed a task
             time0 = high_resolution_clock::now();
-        } else {
-            const auto time1   = high_resolution_clock::now();
-            const auto elapsed = time1 - time0;
-            if (elapsed >= microseconds(1200)) {
-                std::unique_lock<std::mutex> lock{m_queue_mutex};
-
-                m_condition.wait_for(lock, milliseconds(120));
-            } else { // if (elapsed >= microseconds(2))
-                std::this_thread::yield();
-            }
-            //else {
-            //    pause();
-            //}
+            continue;
+        }
+
+        const auto time1   = high_resolution_clock::now();
+        const auto elapsed = time1 - time0;
+        if (elapsed < microseconds(1200)) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Announce sleeping before sampling the epoch; wake_one() bumps the
+        // epoch after publishing a task, so either the retry below finds the
+        // task or wait() returns because the epoch has changed.
+        ++m_sleeping;
+        const uint32_t epoch = m_work_epoch.load();
+        if (!m_stop.load() && !dequeue_and_process()) {
+            m_work_epoch.wait(epoch);
         }
+        --m_sleeping;
+        time0 = high_resolution_clock::now();
     }
+
+    s_current_worker = nullptr;
 }
 
-void Thread_pool::enqueue(Queue* queue, std::function<void()>&& func)
+auto Thread_pool::allocate_task() -> Task*
 {
-    Task task;
-    task.queue = queue;
-    task.func = std::move(func);
+    Task* task{nullptr};
+    if (m_shared->free_tasks.try_dequeue(task)) {
+        return task;
+    }
 
+    std::lock_guard<std::mutex> lock{m_shared->task_block_mutex};
+    if (m_shared->free_tasks.try_dequeue(task)) {
+        return task;
+    }
+    auto& block = m_shared->task_blocks.emplace_back(std::make_unique<Task[]>(task_block_size));
+    std::array<Task*, task_block_size - 1> spare;
+    for (std::size_t i = 1; i < task_block_size; ++i) {
+        spare[i - 1] = &block[i];
+    }
+    m_shared->free_tasks.enqueue_bulk(spare.data(), spare.size());
+    return &block[0];
+}
+
+void Thread_pool::release_task(Task* task)
+{
+    task->func.reset();
+    task->queue  = nullptr;
+    task->parent = nullptr;
+    m_shared->free_tasks.enqueue(task);
+}
+
+void Thread_pool::submit(Queue* queue, Task* task, Task* parent)
+{
+    task->queue  = queue;
+    task->parent = parent;
+    task->pending.store(1, std::memory_order_relaxed);
+    if (task->parent != nullptr) {
+        task->parent->pending.fetch_add(1, std::memory_order_relaxed);
+    }
     ++queue->task_counter;
-    m_queues[queue->priority].tasks.enqueue(std::move(task));
 
-    m_condition.notify_one();
+    const std::size_t priority = static_cast<std::size_t>(queue->priority);
+    Worker* const     worker   = s_current_worker;
+    const bool        local    = (worker != nullptr) && (worker->pool == this) && worker->deques[priority].push(task);
+    if (!local) {
+        m_shared->injection[priority].enqueue(task);
+    }
+
+    wake_one();
 }
 
-bool Thread_pool::dequeue_and_process()
+void Thread_pool::wake_one()
+{
+    m_work_epoch.fetch_add(1);
+    if (m_sleeping.load() > 0) {
+        m_work_epoch.notify_one();
+    }
+}
+
+auto Thread_pool::find_task() -> Task*
 {
+    Worker* const worker = ((s_current_worker != nullptr) && (s_current_worker->pool == this))
+        ? s_current_worker
+        : nullptr;
+
     // scan task queues in priority order
-    for (size_t priority = 0; priority < 3; ++priority) {
-        Task task;
-        if (m_queues[priority].tasks.try_dequeue(task)) {
-            Queue* const queue = task.queue;
-
-            // check if the task is cancelled
-            if (!queue->cancelled) {
-                // process task
-                task.func();
+    for (std::size_t priority = 0; priority < priority_count; ++priority) {
+        if (worker != nullptr) {
+            if (Task* const task = worker->deques[priority].pop(); task != nullptr) {
+                return task;
+            }
+        }
+
+        Task* task{nullptr};
+        if (m_shared->injection[priority].try_dequeue(task)) {
+            return task;
+        }
+
+        const std::size_t worker_count = m_workers.size();
+        const std::size_t start        = (worker != nullptr)
+            ? worker->index + 1
+            : m_steal_start.fetch_add(1, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < worker_count; ++i) {
+            Worker* const victim = m_workers[(start + i) % worker_count].get();
+            if (victim == worker) {
+                continue;
+            }
+            if (Task* const stolen = victim->deques[priority].steal(); stolen != nullptr) {
+                return stolen;
             }
+        }
+    }
+    return nullptr;
+}
+
+void Thread_pool::process(Task* task)
+{
+    Task* const previous_task = s_current_task;
+    s_current_task = task;
+
+    // check if the task is cancelled
+    if (!task->queue->cancelled.load(std::memory_order_relaxed)) {
+        task->func();
+    }
+    task->func.reset();
 
-            --queue->task_counter;
-            return true;
+    s_current_task = previous_task;
+    finish(task);
+}
+
+void Thread_pool::finish(Task* task)
+{
+    // Completing the last child completes the parent, which may be owned by
+    // another pool. Queue::task_counter is decremented last since the queue
+    // may be destroyed as soon as it reaches zero.
+    while (task != nullptr) {
+        if (task->pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
         }
+        Task* const  parent = task->parent;
+        Queue* const queue  = task->queue;
+        queue->pool->release_task(task);
+        --queue->task_counter;
+        task = parent;
     }
+}
 
-    return false;
+bool Thread_pool::dequeue_and_process()
+{
+    Task* const task = find_task();
+    if (task == nullptr) {
+        return false;
+    }
+    process(task);
+    return true;
 }
 
 void Thread_pool::wait(Queue* queue)
 {
     while (queue->task_counter > 0) {
-        dequeue_and_process();
+        if (!dequeue_and_process()) {
+            std::this_thread::yield();
+        }
     }
 }
 
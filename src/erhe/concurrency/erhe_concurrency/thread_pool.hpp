@@ -1,16 +1,43 @@
 #pragma once
 
+#include "erhe_concurrency/task_function.hpp"
+
 #include <atomic>
-#include <condition_variable>
-#include <functional>
-#include <mutex>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <thread>
+#include <utility>
 #include <vector>
 
 namespace erhe::concurrency {
 
+enum class Priority
+{
+    HIGH   = 0,
+    NORMAL = 1,
+    LOW    = 2
+};
+
+static constexpr std::size_t priority_count = 3;
+
+// Work stealing thread pool.
+//
+// Each worker owns one Chase-Lev deque per Priority. Tasks enqueued from a
+// worker go to its own deque; tasks enqueued from other threads go to a
+// shared lock-free injection queue. Idle workers steal from each other,
+// always scanning higher priorities first.
+//
+// Task nodes are pooled and callables are stored inline when small, so
+// enqueue does not allocate in steady state.
+//
+// Tasks are independent unless enqueued with enqueue_child(): a child
+// task is linked to the task running on the calling thread, and the parent
+// is not considered complete, nor its queue drained, until all of its
+// children have completed. This makes nested fork-join work with
+// Concurrent_queue::wait(), without making fire-and-forget tasks that are
+// enqueued from tasks delay the queue of the enqueuing task.
 class Thread_pool
 {
 private:
@@ -18,6 +45,7 @@ private:
     auto operator=(const Thread_pool&) -> Thread_pool = delete;
 
     friend class Concurrent_queue;
+    friend class Serial_queue;
 
     struct Queue
     {
@@ -49,8 +77,10 @@ private:
 
     struct Task
     {
-        Queue*                queue;
-        std::function<void()> func;
+        Task_function    func;
+        Queue*           queue  {nullptr};
+        Task*            parent {nullptr};
+        std::atomic<int> pending{0}; // 1 for the task itself + number of incomplete children
     };
 
 public:
@@ -59,42 +89,68 @@ public:
 
     int size() const;
 
-    void enqueue(std::function<void()>&& func)
+    template <class F>
+    void enqueue(F&& func)
     {
-        enqueue(&m_static_queue, std::move(func));
+        enqueue(&m_static_queue, std::forward<F>(func));
     }
 
 protected:
-    void thread             (size_t threadID);
-    void enqueue            (Queue* queue, std::function<void()>&& func);
+    void thread(size_t thread_id);
+
+    template <class F>
+    void enqueue(Queue* queue, F&& func)
+    {
+        Task* const task = allocate_task();
+        task->func.emplace(std::forward<F>(func));
+        submit(queue, task, nullptr);
+    }
+
+    // Same as enqueue() when not called from a task of this thread
+    template <class F>
+    void enqueue_child(Queue* queue, F&& func)
+    {
+        Task* const task = allocate_task();
+        task->func.emplace(std::forward<F>(func));
+        submit(queue, task, s_current_task);
+    }
+
     bool dequeue_and_process();
     void cancel             (Queue* queue);
     void wait               (Queue* queue);
 
 private:
-    struct Task_queue;
-    alignas(64) Task_queue* m_queues;
+    struct Worker;
+    struct Shared_queues;
+
+    [[nodiscard]] auto allocate_task() -> Task*;
+    [[nodiscard]] auto find_task    () -> Task*;
+    void release_task(Task* task);
+    void submit      (Queue* queue, Task* task, Task* parent);
+    void process     (Task* task);
+    void finish      (Task* task);
+    void wake_one    ();
+
+    static thread_local Worker* s_current_worker;
+    static thread_local Task*   s_current_task;
+
+    std::unique_ptr<Shared_queues> m_shared;
 
 #if defined(_MSC_VER)
 #   pragma warning(push)
 #   pragma warning(disable : 4324)  // structure was padded due to alignment specifier
 #endif
-    alignas(64) std::atomic<bool> m_stop { false };
+    alignas(64) std::atomic<bool>     m_stop       { false };
+    alignas(64) std::atomic<uint32_t> m_work_epoch { 0 };
+    alignas(64) std::atomic<int>      m_sleeping   { 0 };
+    alignas(64) std::atomic<size_t>   m_steal_start{ 0 };
 #if defined(_MSC_VER)
 #   pragma warning(pop)
 #endif
 
-    std::mutex               m_queue_mutex;
-    std::condition_variable  m_condition;
-    Queue                    m_static_queue;
-    std::vector<std::thread> m_threads;
-};
-
-enum class Priority
-{
-    HIGH   = 0,
-    NORMAL = 1,
-    LOW    = 2
+    Queue                                m_static_queue;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread>             m_threads;
 };
 
 }
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace erhe::concurrency {
+
+// Fixed capacity Chase-Lev work stealing deque of pointers.
+//
+// The owning thread pushes and pops at the bottom (LIFO); any other thread
+// may steal from the top (FIFO). Memory orderings follow Le, Pop, Cohen and
+// Zappa Nardelli, "Correct and Efficient Work-Stealing for Weak Memory
+// Models" (PPoPP 2013). push() returns false when the deque is full; the
+// caller is expected to fall back to a shared queue.
+template <typename T>
+class Work_stealing_deque
+{
+public:
+    explicit Work_stealing_deque(const std::size_t capacity_power_of_two)
+        : m_mask  {static_cast<int64_t>(capacity_power_of_two) - 1}
+        , m_buffer{std::make_unique<std::atomic<T*>[]>(capacity_power_of_two)}
+    {
+    }
+
+    Work_stealing_deque(const Work_stealing_deque&) = delete;
+    auto operator=(const Work_stealing_deque&) -> Work_stealing_deque& = delete;
+
+    // Owner thread only
+    [[nodiscard]] auto push(T* item) -> bool
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const int64_t top    = m_top   .load(std::memory_order_acquire);
+        if (bottom - top > m_mask) {
+            return false;
+        }
+        m_buffer[bottom & m_mask].store(item, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Owner thread only
+    [[nodiscard]] auto pop() -> T*
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+        if (top > bottom) {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T* item = m_buffer[bottom & m_mask].load(std::memory_order_relaxed);
+        if (top == bottom) {
+            // Last item; race against thieves
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Any thread; returns nullptr when empty or when losing a race
+    [[nodiscard]] auto steal() -> T*
+    {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return nullptr;
+        }
+        T* const item = m_buffer[top & m_mask].load(std::memory_order_relaxed);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    [[nodiscard]] auto empty() const -> bool
+    {
+        return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+    }
+
+private:
+#if defined(_MSC_VER)
+#   pragma warning(push)
+#   pragma warning(disable : 4324)  // structure was padded due to alignment specifier
+#endif
+    alignas(64) std::atomic<int64_t> m_top   {0};
+    alignas(64) std::atomic<int64_t> m_bottom{0};
+#if defined(_MSC_VER)
+#   pragma warning(pop)
+#endif
+    int64_t                            m_mask;
+    std::unique_ptr<std::atomic<T*>[]> m_buffer;
+};
+
+}
@@ -0,0 +1,150 @@
+#include "erhe_file/mapped_file.hpp"
+#include "erhe_file/file_log.hpp"
+
+#if defined(ERHE_OS_WINDOWS)
+#   include <Windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+#include <utility>
+
+namespace erhe::file
+{
+
+Mapped_file::Mapped_file() = default;
+
+#if defined(ERHE_OS_WINDOWS)
+Mapped_file::Mapped_file(const std::filesystem::path& path)
+{
+    HANDLE file = CreateFileW(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    LARGE_INTEGER size{};
+    if ((GetFileSizeEx(file, &size) == 0) || (size.QuadPart == 0)) {
+        CloseHandle(file);
+        return;
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return;
+    }
+    m_file       = file;
+    m_mapping    = mapping;
+    m_data       = static_cast<const std::byte*>(view);
+    m_byte_count = static_cast<std::size_t>(size.QuadPart);
+}
+
+void Mapped_file::close()
+{
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping != nullptr) {
+        CloseHandle(static_cast<HANDLE>(m_mapping));
+    }
+    if (m_file != nullptr) {
+        CloseHandle(static_cast<HANDLE>(m_file));
+    }
+    m_data       = nullptr;
+    m_byte_count = 0;
+    m_mapping    = nullptr;
+    m_file       = nullptr;
+}
+#else
+Mapped_file::Mapped_file(const std::filesystem::path& path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    struct stat file_stat{};
+    if ((::fstat(fd, &file_stat) != 0) || (file_stat.st_size <= 0)) {
+        ::close(fd);
+        return;
+    }
+    const std::size_t byte_count = static_cast<std::size_t>(file_stat.st_size);
+    void* view = ::mmap(nullptr, byte_count, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps the file referenced
+    if (view == MAP_FAILED) {
+        log_file->warn("mmap('{}') failed", path.string());
+        return;
+    }
+    m_data       = static_cast<const std::byte*>(view);
+    m_byte_count = byte_count;
+}
+
+void Mapped_file::close()
+{
+    if (m_data != nullptr) {
+        ::munmap(const_cast<std::byte*>(m_data), m_byte_count);
+    }
+    m_data       = nullptr;
+    m_byte_count = 0;
+}
+#endif
+
+Mapped_file::~Mapped_file() noexcept
+{
+    close();
+}
+
+Mapped_file::Mapped_file(Mapped_file&& other) noexcept
+    : m_data      {std::exchange(other.m_data, nullptr)}
+    , m_byte_count{std::exchange(other.m_byte_count, 0)}
+#if defined(ERHE_OS_WINDOWS)
+    , m_file      {std::exchange(other.m_file, nullptr)}
+    , m_mapping   {std::exchange(other.m_mapping, nullptr)}
+#endif
+{
+}
+
+Mapped_file& Mapped_file::operator=(Mapped_file&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        m_data       = std::exchange(other.m_data, nullptr);
+        m_byte_count = std::exchange(other.m_byte_count, 0);
+#if defined(ERHE_OS_WINDOWS)
+        m_file       = std::exchange(other.m_file, nullptr);
+        m_mapping    = std::exchange(other.m_mapping, nullptr);
+#endif
+    }
+    return *this;
+}
+
+auto Mapped_file::is_valid() const -> bool
+{
+    return m_data != nullptr;
+}
+
+auto Mapped_file::data() const -> const std::byte*
+{
+    return m_data;
+}
+
+auto Mapped_file::byte_count() const -> std::size_t
+{
+    return m_byte_count;
+}
+
+} // namespace erhe::file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+namespace erhe::file
+{
+
+// Read-only memory mapping of a whole file. The mapping is released when
+// the Mapped_file is destroyed. Empty or missing files produce an invalid
+// (is_valid() == false) mapping.
+class Mapped_file
+{
+public:
+    Mapped_file();
+    explicit Mapped_file(const std::filesystem::path& path);
+    ~Mapped_file() noexcept;
+
+    Mapped_file(const Mapped_file&)            = delete;
+    Mapped_file& operator=(const Mapped_file&) = delete;
+    Mapped_file(Mapped_file&& other) noexcept;
+    Mapped_file& operator=(Mapped_file&& other) noexcept;
+
+    [[nodiscard]] auto is_valid  () const -> bool;
+    [[nodiscard]] auto data      () const -> const std::byte*;
+    [[nodiscard]] auto byte_count() const -> std::size_t;
+
+private:
+    void close();
+
+    const std::byte* m_data      {nullptr};
+    std::size_t      m_byte_count{0};
+#if defined(ERHE_OS_WINDOWS)
+    void*            m_file      {nullptr};
+    void*            m_mapping   {nullptr};
+#endif
+};
+
+} // namespace erhe::file
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "erhe_geometry/types.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace erhe::geometry
+{
+
+// Open addressing (linear probing) hash map from ordered point pair to
+// Edge_id. Used by Geometry::find_edge(); kept in sync by make_edge().
+class Edge_index
+{
+public:
+    void clear()
+    {
+        m_keys  .clear();
+        m_values.clear();
+        m_size          = 0;
+        m_indexed_count = 0;
+    }
+
+    void reserve(const std::size_t edge_count)
+    {
+        std::size_t capacity = 16;
+        while (capacity < edge_count * 2) {
+            capacity *= 2;
+        }
+        if (capacity > m_keys.size()) {
+            rehash(capacity);
+        }
+    }
+
+    // Does nothing if an edge between a and b is already indexed; the
+    // first edge made between two points is the one find() returns.
+    void insert(const Point_id a, const Point_id b, const Edge_id edge_id)
+    {
+        if ((m_size + 1) * 2 > m_keys.size()) {
+            rehash(m_keys.empty() ? 16 : m_keys.size() * 2);
+        }
+        const uint64_t    key  = make_key(a, b);
+        const std::size_t mask = m_keys.size() - 1;
+        for (std::size_t slot = hash(key) & mask;; slot = (slot + 1) & mask) {
+            if (m_keys[slot] == key) {
+                return;
+            }
+            if (m_keys[slot] == empty_key) {
+                m_keys  [slot] = key;
+                m_values[slot] = edge_id;
+                ++m_size;
+                return;
+            }
+        }
+    }
+
+    [[nodiscard]] auto find(const Point_id a, const Point_id b) const -> std::optional<Edge_id>
+    {
+        if (m_keys.empty()) {
+            return {};
+        }
+        const uint64_t    key  = make_key(a, b);
+        const std::size_t mask = m_keys.size() - 1;
+        for (std::size_t slot = hash(key) & mask;; slot = (slot + 1) & mask) {
+            if (m_keys[slot] == key) {
+                return m_values[slot];
+            }
+            if (m_keys[slot] == empty_key) {
+                return {};
+            }
+        }
+    }
+
+    // Number of leading Geometry::edges entries present in the index
+    [[nodiscard]] auto get_indexed_count() const -> Edge_id { return m_indexed_count; }
+    void set_indexed_count(const Edge_id count) { m_indexed_count = count; }
+
+    [[nodiscard]] auto memory_usage() const -> std::size_t
+    {
+        return m_keys.capacity() * sizeof(uint64_t) + m_values.capacity() * sizeof(Edge_id);
+    }
+
+private:
+    static constexpr uint64_t empty_key{~uint64_t{0}}; // a < b, so never a valid key
+
+    [[nodiscard]] static auto make_key(const Point_id a, const Point_id b) -> uint64_t
+    {
+        return (static_cast<uint64_t>(a) << 32) | static_cast<uint64_t>(b);
+    }
+
+    [[nodiscard]] static auto hash(const uint64_t key) -> std::size_t
+    {
+        // Fibonacci hashing; high bits are well mixed
+        const uint64_t h = key * 0x9e3779b97f4a7c15ull;
+        return static_cast<std::size_t>(h ^ (h >> 32));
+    }
+
+    void rehash(const std::size_t capacity)
+    {
+        std::vector<uint64_t> old_keys  (capacity, empty_key);
+        std::vector<Edge_id>  old_values(capacity, 0);
+        old_keys  .swap(m_keys);
+        old_values.swap(m_values);
+        const std::size_t mask = capacity - 1;
+        for (std::size_t i = 0, end = old_keys.size(); i < end; ++i) {
+            const uint64_t key = old_keys[i];
+            if (key == empty_key) {
+                continue;
+            }
+            std::size_t slot = hash(key) & mask;
+            while (m_keys[slot] != empty_key) {
+                slot = (slot + 1) & mask;
+            }
+            m_keys  [slot] = key;
+            m_values[slot] = old_values[i];
+        }
+    }
+
+    std::vector<uint64_t> m_keys;
+    std::vector<Edge_id>  m_values;
+    std::size_t           m_size         {0};
+    Edge_id               m_indexed_count{0};
+};
+
+} // namespace erhe::geometry
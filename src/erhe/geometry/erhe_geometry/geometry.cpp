@@ -64,6 +64,7 @@ Geometry::Geometry(Geometry&& other) noexcept
     , m_next_edge_polygon_id              {other.m_next_edge_polygon_id     }
     , m_polygon_corner_polygon            {other.m_polygon_corner_polygon   }
     , m_edge_polygon_edge                 {other.m_edge_polygon_edge        }
+    , m_edge_index                        {std::move(other.m_edge_index    )}
     , m_point_property_map_collection     {std::move(other.m_point_property_map_collection)}
     , m_corner_property_map_collection    {std::move(other.m_corner_property_map_collection)}
     , m_polygon_property_map_collection   {std::move(other.m_polygon_property_map_collection)}
@@ -129,6 +130,23 @@ auto Geometry::get_mesh_info() const -> Mesh_info
     };
 }
 
+auto Geometry::get_memory_usage() const -> std::size_t
+{
+    return
+        corners        .capacity() * sizeof(Corner    ) +
+        points         .capacity() * sizeof(Point     ) +
+        polygons       .capacity() * sizeof(Polygon   ) +
+        edges          .capacity() * sizeof(Edge      ) +
+        point_corners  .capacity() * sizeof(Corner_id ) +
+        polygon_corners.capacity() * sizeof(Corner_id ) +
+        edge_polygons  .capacity() * sizeof(Polygon_id) +
+        m_edge_index.memory_usage() +
+        m_point_property_map_collection  .memory_usage() +
+        m_corner_property_map_collection .memory_usage() +
+        m_polygon_property_map_collection.memory_usage() +
+        m_edge_property_map_collection   .memory_usage();
+}
+
 void Geometry::reserve_points(const std::size_t point_count)
 {
     ERHE_PROFILE_FUNCTION();
@@ -245,6 +263,26 @@ auto Geometry::has_edges() const -> bool
     return false;
 }
 
+auto Geometry::find_edge_id(Point_id a, Point_id b) -> std::optional<Edge_id>
+{
+    if (b < a) {
+        std::swap(a, b);
+    }
+
+    // Edges may also be copied in directly (see Clone); index any edges
+    // which were not made through make_edge().
+    if (m_edge_index.get_indexed_count() > m_next_edge_id) {
+        m_edge_index.clear();
+    }
+    for (Edge_id edge_id = m_edge_index.get_indexed_count(); edge_id < m_next_edge_id; ++edge_id) {
+        const Edge& edge = edges[edge_id];
+        m_edge_index.insert(edge.a, edge.b, edge_id);
+    }
+    m_edge_index.set_indexed_count(m_next_edge_id);
+
+    return m_edge_index.find(a, b);
+}
+
 void Geometry::build_edges(bool is_manifold)
 {
     ERHE_PROFILE_FUNCTION();
@@ -255,6 +293,8 @@ void Geometry::build_edges(bool is_manifold)
 
     edges.clear();
     m_next_edge_id = 0;
+    m_edge_index.clear();
+    m_edge_index.reserve(m_next_corner_id / 2);
 
     log_build_edges->trace("{} build_edges() : {} polygons", name, m_next_polygon_id);
 
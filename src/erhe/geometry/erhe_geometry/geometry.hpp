@@ -1,5 +1,6 @@
 #pragma once
 
+#include "erhe_geometry/edge_index.hpp"
 #include "erhe_geometry/property_map.hpp"
 #include "erhe_geometry/property_map_collection.hpp"
 #include "erhe_geometry/types.hpp"
@@ -508,17 +509,16 @@ public:
 
     [[nodiscard]] auto find_edge(Point_id a, Point_id b) -> std::optional<Edge>
     {
-        if (b < a) {
-            std::swap(a, b);
+        const std::optional<Edge_id> edge_id = find_edge_id(a, b);
+        if (!edge_id.has_value()) {
+            return {};
         }
-        for (const auto& edge : edges) {
-            if (edge.a == a && edge.b == b) {
-                return edge;
-            }
-        }
-        return {};
+        return edges[edge_id.value()];
     }
 
+    // Hashed lookup; point order does not matter
+    [[nodiscard]] auto find_edge_id(Point_id a, Point_id b) -> std::optional<Edge_id>;
+
     // Allocates new Corner / Corner_id
     // - Point must be allocated.
     // - Polygon must be allocated
@@ -556,11 +556,29 @@ public:
     // - Point must be already allocated.
     auto make_polygon_corner(Polygon_id polygon_id, Point_id point_id) -> Corner_id;
 
+    // Bulk allocation, for operations which fill connectivity directly and
+    // concurrently instead of through the make_*() functions above. Each
+    // returns the first allocated id; ids are consecutive.
+    // - make_polygons(): Polygons have no corners yet.
+    // - Set Polygon::first_polygon_corner_id and Polygon::corner_count,
+    //   Corner::point_id and Corner::polygon_id, and polygon_corners
+    //   entries for all allocated elements, then call reserve_point_corners().
+    auto make_points         (uint32_t count) -> Point_id;
+    auto make_polygons       (uint32_t count) -> Polygon_id;
+    auto make_corners        (uint32_t count) -> Corner_id;
+    auto make_polygon_corners(uint32_t count) -> Polygon_corner_id;
+
+    // Sets point corner reservations for all points from corners.
+    void reserve_point_corners();
+
     // Calculates the number of triangles as if all faces were triangulated
     [[nodiscard]] auto count_polygon_triangles() const -> std::size_t;
 
     [[nodiscard]] auto get_mesh_info() const -> Mesh_info;
 
+    // Approximate heap memory used by connectivity and attributes, in bytes
+    [[nodiscard]] auto get_memory_usage() const -> std::size_t;
+
     [[nodiscard]] auto point_attributes() -> Point_property_map_collection&
     {
         return m_point_property_map_collection;
@@ -833,6 +851,7 @@ public:
     Edge_polygon_id                 m_next_edge_polygon_id     {0};
     Polygon_id                      m_polygon_corner_polygon   {0};
     Edge_id                         m_edge_polygon_edge        {0};
+    Edge_index                      m_edge_index;
     Point_property_map_collection   m_point_property_map_collection;
     Corner_property_map_collection  m_corner_property_map_collection;
     Polygon_property_map_collection m_polygon_property_map_collection;
@@ -7,6 +7,8 @@
 
 #include <glm/glm.hpp>
 
+#include <algorithm>
+
 namespace erhe::geometry
 {
 
@@ -99,6 +101,10 @@ auto Geometry::make_edge(const Point_id a, const Point_id b) -> Edge_id
     edge.b = b;
     edge.first_edge_polygon_id = m_next_edge_polygon_id;
     edge.polygon_count = 0;
+    if (m_edge_index.get_indexed_count() == edge_id) {
+        m_edge_index.insert(a, b, edge_id);
+        m_edge_index.set_indexed_count(edge_id + 1);
+    }
     SPDLOG_LOGGER_TRACE(log, "\tmake_edge(a = {}, b = {}) edge_id = {}", a, b, edge_id);
     return edge_id;
 }
@@ -120,6 +126,81 @@ void Geometry::reserve_point_corner(const Point_id point_id, const Corner_id cor
     point.reserved_corner_count++;
 }
 
+auto Geometry::make_points(const uint32_t count) -> Point_id
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ++m_serial;
+
+    const Point_id first_point_id = m_next_point_id;
+    m_next_point_id += count;
+    if (m_next_point_id > points.size()) {
+        points.resize(m_next_point_id);
+    }
+    std::fill(points.begin() + first_point_id, points.begin() + m_next_point_id, Point{});
+    return first_point_id;
+}
+
+auto Geometry::make_polygons(const uint32_t count) -> Polygon_id
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ++m_serial;
+
+    const Polygon_id first_polygon_id = m_next_polygon_id;
+    m_next_polygon_id += count;
+    if (m_next_polygon_id > polygons.size()) {
+        polygons.resize(m_next_polygon_id);
+    }
+    std::fill(polygons.begin() + first_polygon_id, polygons.begin() + m_next_polygon_id, Polygon{});
+    return first_polygon_id;
+}
+
+auto Geometry::make_corners(const uint32_t count) -> Corner_id
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ++m_serial;
+
+    const Corner_id first_corner_id = m_next_corner_id;
+    m_next_corner_id += count;
+    if (m_next_corner_id > corners.size()) {
+        corners.resize(m_next_corner_id);
+    }
+    return first_corner_id;
+}
+
+auto Geometry::make_polygon_corners(const uint32_t count) -> Polygon_corner_id
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ++m_serial;
+
+    const Polygon_corner_id first_polygon_corner_id = m_next_polygon_corner_id;
+    m_next_polygon_corner_id += count;
+    if (m_next_polygon_corner_id > polygon_corners.size()) {
+        polygon_corners.resize(m_next_polygon_corner_id);
+    }
+    return first_polygon_corner_id;
+}
+
+void Geometry::reserve_point_corners()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ++m_serial;
+
+    for (Point_id point_id = 0; point_id < m_next_point_id; ++point_id) {
+        points[point_id].reserved_corner_count = 0;
+    }
+    for (Corner_id corner_id = 0; corner_id < m_next_corner_id; ++corner_id) {
+        const Point_id point_id = corners[corner_id].point_id;
+        ERHE_VERIFY(point_id < m_next_point_id);
+        ++points[point_id].reserved_corner_count;
+    }
+    m_next_point_corner_reserve = m_next_corner_id;
+}
+
 void Geometry::make_point_corners()
 {
     ERHE_PROFILE_FUNCTION();
@@ -8,52 +8,55 @@
 namespace erhe::geometry::operation
 {
 
-Ambo::Ambo(Geometry& source, Geometry& destination)
-    : Geometry_operation{source, destination}
+Ambo::Ambo(Geometry& source, Geometry& destination, erhe::concurrency::Thread_pool* thread_pool)
+    : Geometry_operation{source, destination, thread_pool}
 {
     ERHE_PROFILE_FUNCTION();
 
-    make_polygon_centroids();
-    make_edge_midpoints();
+    bulk_make_polygon_centroids();
+    bulk_make_edge_points();
+    bulk_make_point_sources();
 
     // New faces from old points, new face corner for each old point corner edge midpoint
-    {
-        ERHE_PROFILE_SCOPE("new faces from old points");
-        source.for_each_point_const([&](auto& i) {
-            Polygon_id new_polygon_id = destination.make_polygon();
-
-            i.point.for_each_corner_const(source, [&](auto& j) {
-                const Polygon_id src_polygon_id     = j.corner.polygon_id;
-                const Polygon&   src_polygon        = source.polygons[src_polygon_id];
-                const Corner_id  src_next_corner_id = src_polygon.next_corner(source, j.corner_id);
-                const Corner&    src_next_corner    = source.corners[src_next_corner_id];
-                const Point_id   edge_midpoint      = get_edge_new_point(j.corner.point_id, src_next_corner.point_id);
-                make_new_corner_from_point(new_polygon_id, edge_midpoint);
-            });
-        });
-    }
+    bulk_make_polygons(
+        source.get_point_count(),
+        [this, &source](const Point_id old_point_id, Polygon_writer& writer) {
+            const Point& old_point = source.points[old_point_id];
+            writer.make_polygon();
+            for (uint32_t i = 0; i < old_point.corner_count; ++i) {
+                const Corner_id corner_id     = source.point_corners[old_point.first_point_corner_id + i];
+                const Point_id  edge_midpoint = get_bulk_edge_point(corner_id);
+                if (edge_midpoint != s_invalid_id) {
+                    writer.make_corner_from_point(edge_midpoint);
+                }
+            }
+        }
+    );
 
     // New faces from old faces, new face corner for each old corner edge midpoint
-    {
-        ERHE_PROFILE_SCOPE("new faces from old faces");
-        source.for_each_polygon_const([&](auto& i) {
-            const Polygon_id new_polygon_id = destination.make_polygon();
-            i.polygon.for_each_corner_neighborhood_const(source, [&](auto& j) {
-                const Point_id edge_midpoint = get_edge_new_point(j.corner.point_id, j.next_corner.point_id);
-                make_new_corner_from_point(new_polygon_id, edge_midpoint);
-            });
-        });
-    }
-
-    post_processing();
+    bulk_make_polygons(
+        source.get_polygon_count(),
+        [this, &source](const Polygon_id old_polygon_id, Polygon_writer& writer) {
+            const Polygon& old_polygon = source.polygons[old_polygon_id];
+            writer.make_polygon();
+            for (uint32_t i = 0; i < old_polygon.corner_count; ++i) {
+                const Point_id edge_midpoint = get_bulk_edge_point(get_old_polygon_corner(old_polygon_id, i));
+                if (edge_midpoint != s_invalid_id) {
+                    writer.make_corner_from_point(edge_midpoint);
+                }
+            }
+        }
+    );
+
+    bulk_post_processing();
 }
 
-auto ambo(Geometry& source) -> Geometry
+auto ambo(Geometry& source, erhe::concurrency::Thread_pool* thread_pool) -> Geometry
 {
     return Geometry{
         fmt::format("ambo({})", source.name),
-        [&source](auto& result) {
-            Ambo operation{source, result};
+        [&source, thread_pool](auto& result) {
+            Ambo operation{source, result, thread_pool};
         }
     };
 }
@@ -5,6 +5,8 @@
 
 #include <gsl/assert>
 
+#include <vector>
+
 namespace erhe::geometry::operation
 {
 
@@ -23,124 +25,139 @@ namespace erhe::geometry::operation
 // For each corner in the old polygon, add one quad
 // (centroid, previous edge 'edge midpoint', corner, next edge 'edge midpoint')
 Catmull_clark_subdivision::Catmull_clark_subdivision(
-    Geometry& src,
-    Geometry& destination
+    Geometry&                       src,
+    Geometry&                       destination,
+    erhe::concurrency::Thread_pool* thread_pool
 )
-    : Geometry_operation{src, destination}
+    : Geometry_operation{src, destination, thread_pool}
 {
     ERHE_PROFILE_FUNCTION();
 
-    //                       (n-3)P
-    // Make initial P's with ------
-    //                          n
-    {
-        ERHE_PROFILE_SCOPE("initial points");
-
-        source.for_each_point_const([&](auto& i) {
-            const auto n = static_cast<float>(i.point.corner_count);
-            if (i.point.corner_count >= 3) {
-                // n = 0   -> centroid points, safe to skip
-                // n = 1,2 -> ?
-                // n = 3   -> ?
-                const float weight = (n - 3.0f) / n;
-                make_new_point_from_point(weight, i.point_id);
-            } else {
-                make_new_point_from_point(1.0f, i.point_id);
-            }
-        });
-    }
+    bulk_make_points_from_points();
+    bulk_make_edge_points();
+    bulk_make_polygon_centroids();
 
-    // Make new edge midpoints
-    // "average of two neighboring face points and original endpoints"
-    // Add midpoint (R) to each new end points
-    //   R = average R of all n edge midpoints for edges touching P
-    //  2R  we add both edge end points with weight 1 so total edge weight is 2
-    //  --
-    //   n
+    // Edges touching each old point, as offsets into point_edges
+    const uint32_t        old_point_count = source.get_point_count();
+    const uint32_t        old_edge_count  = source.get_edge_count();
+    std::vector<uint32_t> point_edge_offsets(static_cast<std::size_t>(old_point_count) + 1, 0);
+    std::vector<Edge_id>  point_edges(static_cast<std::size_t>(old_edge_count) * 2);
     {
-        ERHE_PROFILE_SCOPE("edge midpoints");
-
-        reserve_edge_to_new_points();
-        source.for_each_edge_const([&](auto& i) {
-            const Point& src_point_a  = source.points[i.edge.a];
-            const Point& src_point_b  = source.points[i.edge.b];
-            const auto   new_point_id = find_or_make_point_from_edge(i.edge.a, i.edge.b);
-            add_point_source(new_point_id, 1.0f, i.edge.a);
-            add_point_source(new_point_id, 1.0f, i.edge.b);
-
-            i.edge.for_each_polygon_const(source, [&](auto& j) {
-                const auto weight = 1.0f / static_cast<float>(j.polygon.corner_count);
-                add_polygon_centroid(new_point_id, weight, j.polygon_id);
-            });
-            const Point_id new_point_a_id = point_old_to_new.at(i.edge.a);
-            const Point_id new_point_b_id = point_old_to_new.at(i.edge.b);
-
-            const float n_a = static_cast<float>(src_point_a.corner_count);
-            const float n_b = static_cast<float>(src_point_b.corner_count);
-            Expects(n_a != 0.0f);
-            Expects(n_b != 0.0f);
-            const float weight_a = 1.0f / n_a;
-            const float weight_b = 1.0f / n_b;
-            add_point_source(new_point_a_id, weight_a, i.edge.a);
-            add_point_source(new_point_a_id, weight_a, i.edge.b);
-            add_point_source(new_point_b_id, weight_b, i.edge.a);
-            add_point_source(new_point_b_id, weight_b, i.edge.b);
-        });
-    }
+        ERHE_PROFILE_SCOPE("point edges");
 
-    {
-        ERHE_PROFILE_SCOPE("face points");
-
-        source.for_each_polygon_const([&](auto& i) {
-            const Polygon& src_polygon = source.polygons[i.polygon_id];
-
-            make_new_point_from_polygon_centroid(i.polygon_id);
-
-            // Add polygon centroids (F) to all corners' point sources
-            // F = average F of all n face points for faces touching P
-            //  F    <- because F is average of all centroids, it adds extra /n
-            // ---
-            //  n
-            i.polygon.for_each_corner_const(source, [&](auto& j)
-            {
-                const Point_id src_point_id = j.corner.point_id;
-                const Point&   src_point    = source.points[src_point_id];
-                const Point_id new_point_id = point_old_to_new[src_point_id];
-                const auto point_weight  = 1.0f / static_cast<float>(src_point.corner_count);
-                const auto corner_weight = 1.0f / static_cast<float>(src_polygon.corner_count);
-                add_polygon_centroid(new_point_id, point_weight * point_weight * corner_weight, i.polygon_id);
-            });
-        });
+        for (Edge_id edge_id = 0; edge_id < old_edge_count; ++edge_id) {
+            const Edge& edge = source.edges[edge_id];
+            ++point_edge_offsets[edge.a + 1];
+            ++point_edge_offsets[edge.b + 1];
+        }
+        for (uint32_t i = 0; i < old_point_count; ++i) {
+            point_edge_offsets[i + 1] += point_edge_offsets[i];
+        }
+        std::vector<uint32_t> cursor{point_edge_offsets.begin(), point_edge_offsets.end() - 1};
+        for (Edge_id edge_id = 0; edge_id < old_edge_count; ++edge_id) {
+            const Edge& edge = source.edges[edge_id];
+            point_edges[cursor[edge.a]++] = edge_id;
+            point_edges[cursor[edge.b]++] = edge_id;
+        }
     }
 
+    bulk_make_point_sources(
+        [this, &point_edge_offsets, &point_edges](
+            const Point_id            new_point,
+            Source_writer<Point_id>&  point_sources,
+            Source_writer<Corner_id>& point_corner_sources
+        ) {
+            if (bulk_points_from_points.contains(new_point)) {
+                //                   (n-3)P
+                // Initial P's with ------
+                //                      n
+                const Point_id old_point_id = new_point - bulk_points_from_points.first;
+                const Point&   old_point    = source.points[old_point_id];
+                const float    n            = static_cast<float>(old_point.corner_count);
+                if (old_point.corner_count >= 3) {
+                    // n = 0   -> centroid points, safe to skip
+                    // n = 1,2 -> ?
+                    // n = 3   -> ?
+                    point_sources.add((n - 3.0f) / n, old_point_id);
+                } else {
+                    point_sources.add(1.0f, old_point_id);
+                }
+
+                // R = average R of all n edge midpoints for edges touching P
+                //  2R  we add both edge end points with weight 1 so total edge weight is 2
+                //  --
+                //   n
+                for (uint32_t i = point_edge_offsets[old_point_id], end = point_edge_offsets[old_point_id + 1]; i < end; ++i) {
+                    const Edge& edge = source.edges[point_edges[i]];
+                    Expects(n != 0.0f);
+                    point_sources.add(1.0f / n, edge.a);
+                    point_sources.add(1.0f / n, edge.b);
+                }
+
+                // F = average F of all n face points for faces touching P
+                //  F    <- because F is average of all centroids, it adds extra /n
+                // ---
+                //  n
+                for (uint32_t i = 0; i < old_point.corner_count; ++i) {
+                    const Corner_id  corner_id     = source.point_corners[old_point.first_point_corner_id + i];
+                    const Polygon_id polygon_id    = source.corners[corner_id].polygon_id;
+                    const float      point_weight  = 1.0f / n;
+                    const float      corner_weight = 1.0f / static_cast<float>(source.polygons[polygon_id].corner_count);
+                    add_polygon_centroid_sources(polygon_id, point_weight * point_weight * corner_weight, point_sources, point_corner_sources);
+                }
+                return;
+            }
+
+            if (bulk_edge_points.contains(new_point)) {
+                // "average of two neighboring face points and original endpoints"
+                const Edge& edge = source.edges[new_point - bulk_edge_points.first];
+                point_sources.add(1.0f, edge.a);
+                point_sources.add(1.0f, edge.b);
+                for (uint32_t i = 0; i < edge.polygon_count; ++i) {
+                    const Polygon_id polygon_id = source.edge_polygons[edge.first_edge_polygon_id + i];
+                    const float      weight     = 1.0f / static_cast<float>(source.polygons[polygon_id].corner_count);
+                    add_polygon_centroid_sources(polygon_id, weight, point_sources, point_corner_sources);
+                }
+                return;
+            }
+
+            add_bulk_point_sources(new_point, point_sources, point_corner_sources);
+        }
+    );
+
     // Subdivide polygons, clone (and corners);
-    {
-        ERHE_PROFILE_SCOPE("subdivide");
-
-        source.for_each_polygon_const([&](auto& i) {
-            i.polygon.for_each_corner_neighborhood_const(source, [&](auto& j) {
-                const Point_id   previous_edge_midpoint = get_edge_new_point(j.prev_corner.point_id, j.corner.point_id);
-                const Point_id   next_edge_midpoint     = get_edge_new_point(j.corner.point_id,      j.next_corner.point_id);
-                const Polygon_id new_polygon_id         = make_new_polygon_from_polygon(i.polygon_id);
-                make_new_corner_from_polygon_centroid(new_polygon_id, i.polygon_id);
-                make_new_corner_from_point           (new_polygon_id, previous_edge_midpoint);
-                make_new_corner_from_corner          (new_polygon_id, j.corner_id);
-                make_new_corner_from_point           (new_polygon_id, next_edge_midpoint);
-            });
-        });
-    }
+    bulk_make_polygons(
+        source.get_polygon_count(),
+        [this](const Polygon_id old_polygon_id, Polygon_writer& writer) {
+            const Polygon& old_polygon = source.polygons[old_polygon_id];
+            for (uint32_t i = 0; i < old_polygon.corner_count; ++i) {
+                const Corner_id prev_corner_id         = get_old_polygon_corner(old_polygon_id, i + old_polygon.corner_count - 1);
+                const Corner_id corner_id              = get_old_polygon_corner(old_polygon_id, i);
+                const Point_id  previous_edge_midpoint = get_bulk_edge_point(prev_corner_id);
+                const Point_id  next_edge_midpoint     = get_bulk_edge_point(corner_id);
+                if ((previous_edge_midpoint == s_invalid_id) || (next_edge_midpoint == s_invalid_id)) {
+                    continue;
+                }
+                writer.make_polygon(old_polygon_id);
+                writer.make_corner_from_polygon_centroid(old_polygon_id);
+                writer.make_corner_from_point           (previous_edge_midpoint);
+                writer.make_corner_from_corner          (corner_id);
+                writer.make_corner_from_point           (next_edge_midpoint);
+            }
+        }
+    );
 
-    post_processing();
+    bulk_post_processing();
 
     log_catmull_clark->trace("Done");
 }
 
-auto catmull_clark_subdivision(Geometry& source) -> Geometry
+auto catmull_clark_subdivision(Geometry& source, erhe::concurrency::Thread_pool* thread_pool) -> Geometry
 {
     return Geometry{
         fmt::format("catmull_clark({})", source.name),
-        [&source](auto& result) {
-            Catmull_clark_subdivision operation{source, result};
+        [&source, thread_pool](auto& result) {
+            Catmull_clark_subdivision operation{source, result, thread_pool};
         }
     };
 }
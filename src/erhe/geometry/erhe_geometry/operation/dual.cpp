@@ -8,33 +8,45 @@
 namespace erhe::geometry::operation
 {
 
-Dual::Dual(Geometry& source, Geometry& destination, bool post_process)
-    : Geometry_operation{source, destination}
+Dual::Dual(
+    Geometry&                             source,
+    Geometry&                             destination,
+    const bool                            post_process,
+    erhe::concurrency::Thread_pool* const thread_pool
+)
+    : Geometry_operation{source, destination, thread_pool}
 {
     ERHE_PROFILE_FUNCTION();
 
-    make_polygon_centroids();
+    bulk_make_polygon_centroids();
+    bulk_make_point_sources();
 
     // New faces from old points, new face corner for each old point corner
-    source.for_each_point_const([&](auto& i) {
-        const Polygon_id new_polygon_id = destination.make_polygon();
-
-        i.point.for_each_corner_const(source, [&](auto& j) {
-            make_new_corner_from_polygon_centroid(new_polygon_id, j.corner.polygon_id);
-        });
-    });
+    bulk_make_polygons(
+        source.get_point_count(),
+        [this, &source](const Point_id old_point_id, Polygon_writer& writer) {
+            const Point& old_point = source.points[old_point_id];
+            writer.make_polygon();
+            for (uint32_t i = 0; i < old_point.corner_count; ++i) {
+                const Corner_id corner_id = source.point_corners[old_point.first_point_corner_id + i];
+                writer.make_corner_from_polygon_centroid(source.corners[corner_id].polygon_id);
+            }
+        }
+    );
 
     if (post_process) {
-        post_processing();
+        bulk_post_processing();
+    } else {
+        destination.reserve_point_corners();
     }
 }
 
-auto dual(Geometry& source) -> Geometry
+auto dual(Geometry& source, erhe::concurrency::Thread_pool* thread_pool) -> Geometry
 {
     return Geometry{
         fmt::format("dual({})", source.name),
-        [&source](auto& result) {
-            Dual operation{source, result};
+        [&source, thread_pool](auto& result) {
+            Dual operation{source, result, true, thread_pool};
         }
     };
 }
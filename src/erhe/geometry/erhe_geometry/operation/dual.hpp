@@ -11,14 +11,16 @@ class Dual
 {
 public:
     Dual(
-        Geometry& source,
-        Geometry& destination,
-        bool      post_process = true
+        Geometry&                       source,
+        Geometry&                       destination,
+        bool                            post_process = true,
+        erhe::concurrency::Thread_pool* thread_pool  = nullptr
     );
 };
 
 [[nodiscard]] auto dual(
-    erhe::geometry::Geometry& source
+    erhe::geometry::Geometry&       source,
+    erhe::concurrency::Thread_pool* thread_pool = nullptr
 ) -> erhe::geometry::Geometry;
 
 } // namespace erhe::geometry::operation
@@ -1,4 +1,5 @@
 #include "erhe_geometry/operation/geometry_operation.hpp"
+#include "erhe_concurrency/parallel_for.hpp"
 #include "erhe_geometry/geometry.hpp"
 #include "erhe_geometry/geometry_log.hpp"
 #include "erhe_profile/profile.hpp"
@@ -6,6 +7,9 @@
 
 #include <gsl/assert>
 
+#include <algorithm>
+#include <functional>
+
 namespace erhe::geometry::operation
 {
 
@@ -397,11 +401,7 @@ void Geometry_operation::add_point_source(
     //     new_point_id, weight, old_point_id
     // );
     // const erhe::log::Indenter scope_indent;
-    const std::size_t i = static_cast<std::size_t>(new_point_id);
-    if (new_point_sources.size() <= i) {
-        new_point_sources.resize(i + s_grow_size);
-    }
-    new_point_sources[i].emplace_back(point_weight, old_point_id);
+    new_point_sources.add(new_point_id, point_weight, old_point_id);
 }
 
 void Geometry_operation::add_point_corner_source(
@@ -415,11 +415,7 @@ void Geometry_operation::add_point_corner_source(
     //     new_point_id, weight, old_corner_id
     // );
     // const erhe::log::Indenter scope_indent;
-    const std::size_t i = static_cast<std::size_t>(new_point_id);
-    if (new_point_corner_sources.size() <= i) {
-        new_point_corner_sources.resize(i + s_grow_size);
-    }
-    new_point_corner_sources[new_point_id].emplace_back(corner_weight, old_corner_id);
+    new_point_corner_sources.add(new_point_id, corner_weight, old_corner_id);
 }
 
 void Geometry_operation::add_corner_source(
@@ -433,11 +429,7 @@ void Geometry_operation::add_corner_source(
     //     new_corner_id, weight, old_corner_id
     // );
     // const erhe::log::Indenter scope_indent;
-    const std::size_t i = static_cast<std::size_t>(new_corner_id);
-    if (new_corner_sources.size() <= i) {
-        new_corner_sources.resize(i + s_grow_size);
-    }
-    new_corner_sources[i].emplace_back(corner_weight, old_corner_id);
+    new_corner_sources.add(new_corner_id, corner_weight, old_corner_id);
 }
 
 void Geometry_operation::distribute_corner_sources(
@@ -451,10 +443,23 @@ void Geometry_operation::distribute_corner_sources(
     //     new_corner_id, weight, new_point_id
     // );
     // const erhe::log::Indenter scope_indent;
-    const auto point_corner_sources = new_point_corner_sources[new_point_id];
-    for (const auto& point_corner_source : point_corner_sources) {
-        const float     corner_weight = point_weight * point_corner_source.first;
-        const Corner_id corner_id     = point_corner_source.second;
+    // Operations add all point corner sources before making corners, so
+    // this normally builds only once
+    const std::size_t point_count = static_cast<std::size_t>(destination.get_point_count());
+    if (
+        (m_point_corner_source_count != new_point_corner_sources.source_count()) ||
+        (m_point_corner_sources.key_count() < point_count)
+    ) {
+        new_point_corner_sources.build(point_count, m_point_corner_sources);
+        m_point_corner_source_count = new_point_corner_sources.source_count();
+    }
+    const std::size_t i = static_cast<std::size_t>(new_point_id);
+    if (i >= m_point_corner_sources.key_count()) {
+        return;
+    }
+    for (uint32_t j = m_point_corner_sources.offsets[i], end = m_point_corner_sources.offsets[i + 1]; j < end; ++j) {
+        const float     corner_weight = point_weight * m_point_corner_sources.weights[j];
+        const Corner_id corner_id     = m_point_corner_sources.keys[j];
         add_corner_source(new_corner_id, corner_weight, corner_id);
     }
 }
@@ -470,11 +475,7 @@ void Geometry_operation::add_polygon_source(
     //     new_polygon_id, weight, old_polygon_id
     // );
     // const erhe::log::Indenter scope_indent;
-    const std::size_t i = static_cast<std::size_t>(new_polygon_id);
-    if (new_polygon_sources.size() <= i) {
-        new_polygon_sources.resize(i + s_grow_size);
-    }
-    new_polygon_sources[i].emplace_back(polygon_weight, old_polygon_id);
+    new_polygon_sources.add(new_polygon_id, polygon_weight, old_polygon_id);
 }
 
 void Geometry_operation::add_edge_source(
@@ -488,11 +489,7 @@ void Geometry_operation::add_edge_source(
     //     new_edge_id, weight, old_edge_id
     // );
     // const erhe::log::Indenter scope_indent;
-    const std::size_t i = static_cast<std::size_t>(new_edge_id);
-    if (new_edge_sources.size() <= i) {
-        new_edge_sources.resize(i + s_grow_size);
-    }
-    new_edge_sources[i].emplace_back(edge_weight, old_edge_id);
+    new_edge_sources.add(new_edge_id, edge_weight, old_edge_id);
 }
 
 void Geometry_operation::build_destination_edges_with_sourcing()
@@ -521,14 +518,468 @@ void Geometry_operation::interpolate_all_property_maps()
 {
     ERHE_PROFILE_FUNCTION();
 
-    new_point_sources  .resize(destination.get_point_count());
-    new_polygon_sources.resize(destination.get_polygon_count());
-    new_corner_sources .resize(destination.get_corner_count());
-    new_edge_sources   .resize(destination.get_edge_count());
-    source.point_attributes()  .interpolate(destination.point_attributes(),   new_point_sources);
-    source.polygon_attributes().interpolate(destination.polygon_attributes(), new_polygon_sources);
-    source.corner_attributes() .interpolate(destination.corner_attributes(),  new_corner_sources);
-    source.edge_attributes()   .interpolate(destination.edge_attributes(),    new_edge_sources);
+    if (new_point_sources.source_count() > 0) {
+        new_point_sources.build(destination.get_point_count(), point_sources);
+    }
+    if (new_polygon_sources.source_count() > 0) {
+        new_polygon_sources.build(destination.get_polygon_count(), polygon_sources);
+    }
+    if (new_corner_sources.source_count() > 0) {
+        new_corner_sources.build(destination.get_corner_count(), corner_sources);
+    }
+    if (new_edge_sources.source_count() > 0) {
+        new_edge_sources.build(destination.get_edge_count(), edge_sources);
+    }
+
+    // One task per property map, across all key types
+    std::vector<std::function<void()>> tasks;
+    const auto add_tasks = [&tasks](auto& source_attributes, auto& destination_attributes, const auto& sources) {
+        source_attributes.for_each_interpolation(
+            destination_attributes,
+            [&tasks, &sources](const auto* source_map, auto* destination_map) {
+                tasks.push_back(
+                    [source_map, destination_map, &sources]() {
+                        source_map->interpolate(destination_map, sources);
+                    }
+                );
+            }
+        );
+    };
+    add_tasks(source.point_attributes(),   destination.point_attributes(),   point_sources);
+    add_tasks(source.polygon_attributes(), destination.polygon_attributes(), polygon_sources);
+    add_tasks(source.corner_attributes(),  destination.corner_attributes(),  corner_sources);
+    add_tasks(source.edge_attributes(),    destination.edge_attributes(),    edge_sources);
+
+    erhe::concurrency::parallel_for(
+        thread_pool,
+        tasks.size(),
+        1,
+        [&tasks](const std::size_t begin, const std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                tasks[i]();
+            }
+        }
+    );
+}
+
+namespace {
+
+// Turns per element counts in offsets[1..count] into offsets
+void prefix_sum(std::vector<uint32_t>& offsets)
+{
+    uint64_t sum{0};
+    for (std::size_t i = 1, end = offsets.size(); i < end; ++i) {
+        sum += offsets[i];
+        offsets[i] = static_cast<uint32_t>(sum);
+    }
+    ERHE_VERIFY(sum <= std::numeric_limits<uint32_t>::max());
+}
+
+template <typename Key_type, typename Fn>
+void build_sources(
+    erhe::concurrency::Thread_pool*  thread_pool,
+    const std::size_t                key_count,
+    Interpolation_sources<Key_type>& out,
+    Fn&&                             fn
+)
+{
+    out.offsets.assign(key_count + 1, 0);
+    erhe::concurrency::parallel_for(
+        thread_pool, key_count, Geometry_operation::s_bulk_grain_size,
+        [&](const std::size_t begin, const std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                Source_writer<Key_type> counter;
+                fn(i, counter);
+                out.offsets[i + 1] = counter.get_count();
+            }
+        }
+    );
+    prefix_sum(out.offsets);
+    out.weights.resize(out.offsets.back());
+    out.keys   .resize(out.offsets.back());
+    erhe::concurrency::parallel_for(
+        thread_pool, key_count, Geometry_operation::s_bulk_grain_size,
+        [&](const std::size_t begin, const std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                const uint32_t          offset = out.offsets[i];
+                Source_writer<Key_type> writer{out.weights.data() + offset, out.keys.data() + offset};
+                fn(i, writer);
+                ERHE_VERIFY(offset + writer.get_count() == out.offsets[i + 1]);
+            }
+        }
+    );
+}
+
+}
+
+Polygon_writer::Polygon_writer(
+    Geometry_operation&     operation,
+    const Polygon_id        first_polygon_id,
+    const Corner_id         first_corner_id,
+    const Polygon_corner_id first_polygon_corner_id
+)
+    : m_operation              {&operation}
+    , m_first_polygon_id       {first_polygon_id}
+    , m_first_corner_id        {first_corner_id}
+    , m_first_polygon_corner_id{first_polygon_corner_id}
+{
+}
+
+void Polygon_writer::make_polygon(const Polygon_id old_polygon)
+{
+    if (m_operation != nullptr) {
+        const Polygon_id polygon_id = m_first_polygon_id + m_polygon_count;
+        Polygon&         polygon    = m_operation->destination.polygons[polygon_id];
+        polygon.first_polygon_corner_id = m_first_polygon_corner_id + m_corner_count;
+        polygon.corner_count            = 0;
+        m_operation->bulk_polygon_old_polygons[polygon_id] = old_polygon;
+    }
+    ++m_polygon_count;
+}
+
+void Polygon_writer::make_corner(const Point_id new_point, const Corner_id old_corner)
+{
+    ERHE_VERIFY(m_polygon_count > 0);
+    if (m_operation != nullptr) {
+        Geometry&        destination       = m_operation->destination;
+        const Polygon_id polygon_id        = m_first_polygon_id + m_polygon_count - 1;
+        const Corner_id  corner_id         = m_first_corner_id + m_corner_count;
+        Corner&          corner            = destination.corners[corner_id];
+        corner.point_id   = new_point;
+        corner.polygon_id = polygon_id;
+        destination.polygon_corners[m_first_polygon_corner_id + m_corner_count] = corner_id;
+        ++destination.polygons[polygon_id].corner_count;
+        m_operation->bulk_corner_old_corners[corner_id] = old_corner;
+    }
+    ++m_corner_count;
+}
+
+void Polygon_writer::make_corner_from_point(const Point_id new_point)
+{
+    make_corner(new_point, Geometry_operation::s_invalid_id);
+}
+
+void Polygon_writer::make_corner_from_corner(const Corner_id old_corner)
+{
+    const Point_id new_point = (m_operation != nullptr)
+        ? m_operation->point_old_to_new[m_operation->source.corners[old_corner].point_id]
+        : Geometry_operation::s_invalid_id;
+    make_corner(new_point, old_corner);
+}
+
+void Polygon_writer::make_corner_from_polygon_centroid(const Polygon_id old_polygon)
+{
+    const Point_id new_point = (m_operation != nullptr)
+        ? m_operation->old_polygon_centroid_to_new_points[old_polygon]
+        : Geometry_operation::s_invalid_id;
+    make_corner(new_point, Geometry_operation::s_invalid_id);
+}
+
+auto Polygon_writer::get_polygon_count() const -> uint32_t
+{
+    return m_polygon_count;
+}
+
+auto Polygon_writer::get_corner_count() const -> uint32_t
+{
+    return m_corner_count;
+}
+
+void Geometry_operation::build_old_corner_edges()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if ((source.get_edge_count() == 0) && (source.get_polygon_count() > 0)) {
+        source.build_edges();
+    }
+
+    old_corner_edges.assign(source.get_corner_count(), s_invalid_id);
+    erhe::concurrency::parallel_for(
+        thread_pool, source.get_edge_count(), s_bulk_grain_size,
+        [this](const std::size_t begin, const std::size_t end) {
+            for (std::size_t edge_id = begin; edge_id < end; ++edge_id) {
+                const Edge& edge = source.edges[edge_id];
+                for (uint32_t i = 0; i < edge.polygon_count; ++i) {
+                    const Polygon_id polygon_id = source.edge_polygons[edge.first_edge_polygon_id + i];
+                    const Polygon&   polygon    = source.polygons[polygon_id];
+                    for (uint32_t j = 0; j < polygon.corner_count; ++j) {
+                        const Corner_id corner_id      = source.polygon_corners[polygon.first_polygon_corner_id + j];
+                        const Corner_id next_corner_id = source.polygon_corners[polygon.first_polygon_corner_id + (j + 1) % polygon.corner_count];
+                        const Point_id  a              = source.corners[corner_id].point_id;
+                        const Point_id  b              = source.corners[next_corner_id].point_id;
+                        if (
+                            ((a == edge.a) && (b == edge.b)) ||
+                            ((a == edge.b) && (b == edge.a))
+                        ) {
+                            old_corner_edges[corner_id] = static_cast<Edge_id>(edge_id);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    );
+
+    // Operators skip corners without edge; report them once per operation
+    const auto missing_count = std::count(old_corner_edges.begin(), old_corner_edges.end(), s_invalid_id);
+    if (missing_count > 0) {
+        log_operation->error("{}: {} corners have no edge, edge points not found", source.name, missing_count);
+    }
+}
+
+void Geometry_operation::bulk_make_points_from_points()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const uint32_t point_count = source.get_point_count();
+    bulk_points_from_points.first = destination.make_points(point_count);
+    bulk_points_from_points.count = point_count;
+    point_old_to_new.resize(point_count);
+    for (uint32_t i = 0; i < point_count; ++i) {
+        point_old_to_new[i] = bulk_points_from_points.first + i;
+    }
+}
+
+void Geometry_operation::bulk_make_polygon_centroids()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const uint32_t polygon_count = source.get_polygon_count();
+    bulk_polygon_centroid_points.first = destination.make_points(polygon_count);
+    bulk_polygon_centroid_points.count = polygon_count;
+    old_polygon_centroid_to_new_points.resize(polygon_count);
+    for (uint32_t i = 0; i < polygon_count; ++i) {
+        old_polygon_centroid_to_new_points[i] = bulk_polygon_centroid_points.first + i;
+    }
+}
+
+void Geometry_operation::bulk_make_edge_points(const std::initializer_list<float> relative_positions)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ERHE_VERIFY(relative_positions.size() > 0);
+    if (old_corner_edges.empty()) {
+        build_old_corner_edges();
+    }
+    bulk_edge_positions.assign(relative_positions.begin(), relative_positions.end());
+    const uint32_t point_count = source.get_edge_count() * static_cast<uint32_t>(bulk_edge_positions.size());
+    bulk_edge_points.first = destination.make_points(point_count);
+    bulk_edge_points.count = point_count;
+}
+
+auto Geometry_operation::get_old_polygon_corner(const Polygon_id old_polygon_id, const uint32_t index) const -> Corner_id
+{
+    const Polygon& old_polygon = source.polygons[old_polygon_id];
+    return source.polygon_corners[old_polygon.first_polygon_corner_id + index % old_polygon.corner_count];
+}
+
+auto Geometry_operation::get_bulk_edge_point(const Corner_id old_corner, const uint32_t position) const -> Point_id
+{
+    const Edge_id edge_id = old_corner_edges[old_corner];
+    if (edge_id == s_invalid_id) {
+        return s_invalid_id;
+    }
+    const uint32_t split_count = static_cast<uint32_t>(bulk_edge_positions.size());
+    const Edge&    edge        = source.edges[edge_id];
+    const Point_id first       = bulk_edge_points.first + edge_id * split_count;
+    return (source.corners[old_corner].point_id == edge.a)
+        ? first + position
+        : first + split_count - 1 - position;
+}
+
+void Geometry_operation::add_polygon_centroid_sources(
+    const Polygon_id          old_polygon,
+    const float               weight,
+    Source_writer<Point_id>&  point_sources,
+    Source_writer<Corner_id>& point_corner_sources
+) const
+{
+    const Polygon& polygon = source.polygons[old_polygon];
+    for (uint32_t i = 0; i < polygon.corner_count; ++i) {
+        const Corner_id corner_id = source.polygon_corners[polygon.first_polygon_corner_id + i];
+        point_corner_sources.add(weight, corner_id);
+        point_sources       .add(weight, source.corners[corner_id].point_id);
+    }
+}
+
+void Geometry_operation::add_bulk_point_sources(
+    const Point_id            new_point,
+    Source_writer<Point_id>&  point_sources,
+    Source_writer<Corner_id>& point_corner_sources
+) const
+{
+    if (bulk_points_from_points.contains(new_point)) {
+        point_sources.add(1.0f, new_point - bulk_points_from_points.first);
+        return;
+    }
+
+    if (bulk_polygon_centroid_points.contains(new_point)) {
+        add_polygon_centroid_sources(new_point - bulk_polygon_centroid_points.first, 1.0f, point_sources, point_corner_sources);
+        return;
+    }
+
+    if (bulk_edge_points.contains(new_point)) {
+        const uint32_t split_count = static_cast<uint32_t>(bulk_edge_positions.size());
+        const uint32_t index       = new_point - bulk_edge_points.first;
+        const Edge_id  edge_id     = index / split_count;
+        const float    t           = bulk_edge_positions[index % split_count];
+        const Edge&    edge        = source.edges[edge_id];
+        point_sources.add(1.0f - t, edge.a);
+        point_sources.add(t,        edge.b);
+
+        // Corners of the edge in each edge polygon
+        for (uint32_t i = 0; i < edge.polygon_count; ++i) {
+            const Polygon_id polygon_id = source.edge_polygons[edge.first_edge_polygon_id + i];
+            const Polygon&   polygon    = source.polygons[polygon_id];
+            for (uint32_t j = 0; j < polygon.corner_count; ++j) {
+                const Corner_id corner_id = source.polygon_corners[polygon.first_polygon_corner_id + j];
+                if (old_corner_edges[corner_id] != edge_id) {
+                    continue;
+                }
+                const Corner_id next_corner_id = source.polygon_corners[polygon.first_polygon_corner_id + (j + 1) % polygon.corner_count];
+                const bool      corner_is_a    = source.corners[corner_id].point_id == edge.a;
+                point_corner_sources.add(1.0f - t, corner_is_a ? corner_id : next_corner_id);
+                point_corner_sources.add(t,        corner_is_a ? next_corner_id : corner_id);
+                break;
+            }
+        }
+    }
+}
+
+void Geometry_operation::bulk_make_point_sources(const Point_source_callback& callback)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const Point_source_callback add_sources = callback
+        ? callback
+        : [this](const Point_id new_point, Source_writer<Point_id>& point_sources, Source_writer<Corner_id>& point_corner_sources) {
+            add_bulk_point_sources(new_point, point_sources, point_corner_sources);
+        };
+
+    const uint32_t point_count = destination.get_point_count();
+    point_sources         .offsets.assign(static_cast<std::size_t>(point_count) + 1, 0);
+    m_point_corner_sources.offsets.assign(static_cast<std::size_t>(point_count) + 1, 0);
+    erhe::concurrency::parallel_for(
+        thread_pool, point_count, s_bulk_grain_size,
+        [&](const std::size_t begin, const std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                Source_writer<Point_id>  point_counter;
+                Source_writer<Corner_id> point_corner_counter;
+                add_sources(static_cast<Point_id>(i), point_counter, point_corner_counter);
+                point_sources         .offsets[i + 1] = point_counter.get_count();
+                m_point_corner_sources.offsets[i + 1] = point_corner_counter.get_count();
+            }
+        }
+    );
+    prefix_sum(point_sources.offsets);
+    prefix_sum(m_point_corner_sources.offsets);
+    point_sources         .weights.resize(point_sources.offsets.back());
+    point_sources         .keys   .resize(point_sources.offsets.back());
+    m_point_corner_sources.weights.resize(m_point_corner_sources.offsets.back());
+    m_point_corner_sources.keys   .resize(m_point_corner_sources.offsets.back());
+    erhe::concurrency::parallel_for(
+        thread_pool, point_count, s_bulk_grain_size,
+        [&](const std::size_t begin, const std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                const uint32_t point_offset        = point_sources.offsets[i];
+                const uint32_t point_corner_offset = m_point_corner_sources.offsets[i];
+                Source_writer<Point_id> point_writer{
+                    point_sources.weights.data() + point_offset,
+                    point_sources.keys   .data() + point_offset
+                };
+                Source_writer<Corner_id> point_corner_writer{
+                    m_point_corner_sources.weights.data() + point_corner_offset,
+                    m_point_corner_sources.keys   .data() + point_corner_offset
+                };
+                add_sources(static_cast<Point_id>(i), point_writer, point_corner_writer);
+                ERHE_VERIFY(point_offset        + point_writer       .get_count() == point_sources         .offsets[i + 1]);
+                ERHE_VERIFY(point_corner_offset + point_corner_writer.get_count() == m_point_corner_sources.offsets[i + 1]);
+            }
+        }
+    );
+    m_point_corner_source_count = new_point_corner_sources.source_count();
+}
+
+void Geometry_operation::bulk_make_polygons(const uint32_t producer_count, const Polygon_callback& callback)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    std::vector<uint32_t> polygon_offsets(static_cast<std::size_t>(producer_count) + 1, 0);
+    std::vector<uint32_t> corner_offsets (static_cast<std::size_t>(producer_count) + 1, 0);
+    erhe::concurrency::parallel_for(
+        thread_pool, producer_count, s_bulk_grain_size,
+        [&](const std::size_t begin, const std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                Polygon_writer counter;
+                callback(static_cast<uint32_t>(i), counter);
+                polygon_offsets[i + 1] = counter.get_polygon_count();
+                corner_offsets [i + 1] = counter.get_corner_count();
+            }
+        }
+    );
+    prefix_sum(polygon_offsets);
+    prefix_sum(corner_offsets);
+
+    const Polygon_id        first_polygon_id        = destination.make_polygons       (polygon_offsets.back());
+    const Corner_id         first_corner_id         = destination.make_corners        (corner_offsets.back());
+    const Polygon_corner_id first_polygon_corner_id = destination.make_polygon_corners(corner_offsets.back());
+    bulk_polygon_old_polygons.resize(destination.get_polygon_count(), s_invalid_id);
+    bulk_corner_old_corners  .resize(destination.get_corner_count(),  s_invalid_id);
+
+    erhe::concurrency::parallel_for(
+        thread_pool, producer_count, s_bulk_grain_size,
+        [&](const std::size_t begin, const std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                Polygon_writer writer{
+                    *this,
+                    first_polygon_id        + polygon_offsets[i],
+                    first_corner_id         + corner_offsets [i],
+                    first_polygon_corner_id + corner_offsets [i]
+                };
+                callback(static_cast<uint32_t>(i), writer);
+                ERHE_VERIFY(writer.get_polygon_count() == polygon_offsets[i + 1] - polygon_offsets[i]);
+                ERHE_VERIFY(writer.get_corner_count () == corner_offsets [i + 1] - corner_offsets [i]);
+            }
+        }
+    );
+}
+
+void Geometry_operation::bulk_post_processing()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    destination.reserve_point_corners();
+
+    // Corners made from old corners use the old corner as source, others
+    // inherit point corner sources of their point.
+    build_sources(
+        thread_pool, destination.get_corner_count(), corner_sources,
+        [this](const std::size_t corner_id, Source_writer<Corner_id>& writer) {
+            const Corner_id old_corner = bulk_corner_old_corners[corner_id];
+            if (old_corner != s_invalid_id) {
+                writer.add(1.0f, old_corner);
+                return;
+            }
+            const std::size_t point_id = destination.corners[corner_id].point_id;
+            if (point_id >= m_point_corner_sources.key_count()) {
+                return;
+            }
+            for (uint32_t i = m_point_corner_sources.offsets[point_id], end = m_point_corner_sources.offsets[point_id + 1]; i < end; ++i) {
+                writer.add(m_point_corner_sources.weights[i], m_point_corner_sources.keys[i]);
+            }
+        }
+    );
+    build_sources(
+        thread_pool, destination.get_polygon_count(), polygon_sources,
+        [this](const std::size_t polygon_id, Source_writer<Polygon_id>& writer) {
+            const Polygon_id old_polygon = bulk_polygon_old_polygons[polygon_id];
+            if (old_polygon != s_invalid_id) {
+                writer.add(1.0f, old_polygon);
+            }
+        }
+    );
+
+    post_processing();
 }
 
 } // namespace erhe::geometry::operation
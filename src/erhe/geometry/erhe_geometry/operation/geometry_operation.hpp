@@ -1,10 +1,16 @@
 #pragma once
 
+#include "erhe_geometry/property_map.hpp"
 #include "erhe_geometry/types.hpp"
 
+#include <functional>
+#include <limits>
 #include <set>
 #include <vector>
 
+namespace erhe::concurrency {
+    class Thread_pool;
+}
 namespace erhe::geometry
 {
     class Geometry;
@@ -13,36 +19,124 @@ namespace erhe::geometry
 namespace erhe::geometry::operation
 {
 
+class Geometry_operation;
+
+// Writes interpolation sources for one new key in two-phase construction.
+// Without arrays, only counts sources (first phase).
+template <typename Key_type>
+class Source_writer
+{
+public:
+    Source_writer() = default;
+    Source_writer(float* weights, Key_type* keys)
+        : m_weights{weights}
+        , m_keys   {keys}
+    {
+    }
+
+    void add(const float weight, const Key_type key)
+    {
+        if (m_weights != nullptr) {
+            m_weights[m_count] = weight;
+            m_keys   [m_count] = key;
+        }
+        ++m_count;
+    }
+
+    [[nodiscard]] auto get_count() const -> uint32_t
+    {
+        return m_count;
+    }
+
+private:
+    float*    m_weights{nullptr};
+    Key_type* m_keys   {nullptr};
+    uint32_t  m_count  {0};
+};
+
+// Makes polygons and corners of one producer (source element) for
+// Geometry_operation::bulk_make_polygons(). Without an operation, only
+// counts polygons and corners (first phase).
+class Polygon_writer
+{
+public:
+    Polygon_writer() = default;
+    Polygon_writer(
+        Geometry_operation& operation,
+        Polygon_id          first_polygon_id,
+        Corner_id           first_corner_id,
+        Polygon_corner_id   first_polygon_corner_id
+    );
+
+    // Starts a new polygon; following corners are added to it.
+    // Old polygon, if given, is set as source for the new polygon with weight 1.
+    void make_polygon(Polygon_id old_polygon = std::numeric_limits<Polygon_id>::max());
+
+    // Same as Geometry_operation::make_new_corner_from_*()
+    void make_corner_from_point           (Point_id   new_point);
+    void make_corner_from_corner          (Corner_id  old_corner);
+    void make_corner_from_polygon_centroid(Polygon_id old_polygon);
+
+    [[nodiscard]] auto get_polygon_count() const -> uint32_t;
+    [[nodiscard]] auto get_corner_count () const -> uint32_t;
+
+private:
+    void make_corner(Point_id new_point, Corner_id old_corner);
+
+    Geometry_operation* m_operation              {nullptr};
+    Polygon_id          m_first_polygon_id       {0};
+    Corner_id           m_first_corner_id        {0};
+    Polygon_corner_id   m_first_polygon_corner_id{0};
+    uint32_t            m_polygon_count          {0};
+    uint32_t            m_corner_count           {0};
+};
+
 class Geometry_operation
 {
 public:
+    // Property maps are interpolated concurrently when thread_pool is set
     Geometry_operation(
-        Geometry& source,
-        Geometry& destination
+        Geometry&                       source,
+        Geometry&                       destination,
+        erhe::concurrency::Thread_pool* thread_pool = nullptr
     )
         : source     {source}
         , destination{destination}
+        , thread_pool{thread_pool}
     {
     }
 
     static constexpr std::size_t s_grow_size = 4096;
-    Geometry&                                              source;
-    Geometry&                                              destination;
-    std::vector<Point_id  >                                point_old_to_new;
-    std::vector<Polygon_id>                                polygon_old_to_new;
-    std::vector<Corner_id >                                corner_old_to_new;
-    std::vector<Edge_id   >                                edge_old_to_new;
-    std::vector<Point_id  >                                old_polygon_centroid_to_new_points;
-    std::vector<std::vector<std::pair<float, Point_id  >>> new_point_sources;
-    std::vector<std::vector<std::pair<float, Corner_id >>> new_point_corner_sources;
-    std::vector<std::vector<std::pair<float, Corner_id >>> new_corner_sources;
-    std::vector<std::vector<std::pair<float, Polygon_id>>> new_polygon_sources;
-    std::vector<std::vector<std::pair<float, Edge_id   >>> new_edge_sources;
+    Geometry&                                      source;
+    Geometry&                                      destination;
+    erhe::concurrency::Thread_pool*                thread_pool;
+    std::vector<Point_id  >                        point_old_to_new;
+    std::vector<Polygon_id>                        polygon_old_to_new;
+    std::vector<Corner_id >                        corner_old_to_new;
+    std::vector<Edge_id   >                        edge_old_to_new;
+    std::vector<Point_id  >                        old_polygon_centroid_to_new_points;
+    Interpolation_source_builder<Point_id  >       new_point_sources;
+    Interpolation_source_builder<Corner_id >       new_point_corner_sources;
+    Interpolation_source_builder<Corner_id >       new_corner_sources;
+    Interpolation_source_builder<Polygon_id>       new_polygon_sources;
+    Interpolation_source_builder<Edge_id   >       new_edge_sources;
+
+    // Set by two-phase construction, otherwise built from new_*_sources
+    // in interpolate_all_property_maps()
+    Interpolation_sources<Point_id  >              point_sources;
+    Interpolation_sources<Corner_id >              corner_sources;
+    Interpolation_sources<Polygon_id>              polygon_sources;
+    Interpolation_sources<Edge_id   >              edge_sources;
 
 private:
     static constexpr std::size_t s_max_edge_point_slots = 300;
     std::vector<Point_id> m_old_edge_to_new_points;
 
+    // Built from new_point_corner_sources when distribute_corner_sources()
+    // first needs it, and rebuilt if more point corner sources are added
+    Interpolation_sources<Corner_id>               m_point_corner_sources;
+    std::size_t                                    m_point_corner_source_count{0};
+
 public:
     void post_processing           ();
     void make_points_from_points   ();
@@ -165,6 +259,91 @@ public:
     void build_destination_edges_with_sourcing();
 
     void interpolate_all_property_maps();
+
+    // Two-phase construction
+    //
+    // bulk_*() functions build the destination concurrently when thread_pool
+    // is set. Each first counts points, polygons, corners or sources made
+    // per source element, prefix sums the counts into id and source ranges,
+    // and then fills the disjoint ranges. Sources are written directly in
+    // Interpolation_sources layout.
+    //
+    // Call order:
+    // - bulk_make_points_from_points(), bulk_make_polygon_centroids() and
+    //   bulk_make_edge_points(), each at most once
+    // - bulk_make_point_sources()
+    // - bulk_make_polygons(), any number of times
+    // - bulk_post_processing()
+    static constexpr uint32_t    s_invalid_id      = std::numeric_limits<uint32_t>::max();
+    static constexpr std::size_t s_bulk_grain_size = 1024;
+
+    class Point_range
+    {
+    public:
+        [[nodiscard]] auto contains(const Point_id point_id) const -> bool
+        {
+            return (point_id >= first) && (point_id - first < count);
+        }
+
+        Point_id first{0};
+        uint32_t count{0};
+    };
+
+    using Point_source_callback = std::function<
+        void(Point_id new_point, Source_writer<Point_id>& point_sources, Source_writer<Corner_id>& point_corner_sources)
+    >;
+    using Polygon_callback = std::function<void(uint32_t producer, Polygon_writer& writer)>;
+
+    Point_range             bulk_points_from_points;
+    Point_range             bulk_polygon_centroid_points;
+    Point_range             bulk_edge_points;
+    std::vector<float>      bulk_edge_positions;       // Relative to Edge::a
+    std::vector<Edge_id>    old_corner_edges;          // Edge from corner to next corner, s_invalid_id if none
+    std::vector<Corner_id>  bulk_corner_old_corners;   // s_invalid_id: inherit point corner sources of corner point
+    std::vector<Polygon_id> bulk_polygon_old_polygons; // s_invalid_id: no polygon source
+
+    // Builds source edges if source has none
+    void build_old_corner_edges();
+
+    // New point for each old point, old polygon centroid, and each edge
+    // split position (relative_positions must be in ascending order)
+    void bulk_make_points_from_points();
+    void bulk_make_polygon_centroids ();
+    void bulk_make_edge_points       (std::initializer_list<float> relative_positions = { 0.5f });
+
+    // Index is taken modulo old polygon corner count
+    [[nodiscard]] auto get_old_polygon_corner(Polygon_id old_polygon, uint32_t index) const -> Corner_id;
+
+    // Position counts from old corner point towards next corner point.
+    // Returns s_invalid_id if corner has no edge.
+    [[nodiscard]] auto get_bulk_edge_point(Corner_id old_corner, uint32_t position = 0) const -> Point_id;
+
+    // Same sources as make_new_point_from_point() with weight 1,
+    // make_new_point_from_polygon_centroid() and make_edge_midpoints()
+    void add_bulk_point_sources(
+        Point_id                  new_point,
+        Source_writer<Point_id>&  point_sources,
+        Source_writer<Corner_id>& point_corner_sources
+    ) const;
+
+    // Same sources as add_polygon_centroid()
+    void add_polygon_centroid_sources(
+        Polygon_id                old_polygon,
+        float                     weight,
+        Source_writer<Point_id>&  point_sources,
+        Source_writer<Corner_id>& point_corner_sources
+    ) const;
+
+    // Callback, if given, replaces add_bulk_point_sources()
+    void bulk_make_point_sources(const Point_source_callback& callback = {});
+
+    // Callback is called twice for each producer in [0, producer_count),
+    // first for counting and then for filling; it must make the same
+    // polygons and corners both times.
+    void bulk_make_polygons(uint32_t producer_count, const Polygon_callback& callback);
+
+    // Makes corner and polygon sources, then post_processing()
+    void bulk_post_processing();
 };
 
 } // namespace namespace geometry
@@ -11,8 +11,8 @@
 namespace erhe::geometry::operation
 {
 
-Gyro::Gyro(Geometry& src, Geometry& destination)
-    : Geometry_operation{src, destination}
+Gyro::Gyro(Geometry& src, Geometry& destination, erhe::concurrency::Thread_pool* thread_pool)
+    : Geometry_operation{src, destination, thread_pool}
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -22,62 +22,48 @@ Gyro::Gyro(Geometry& src, Geometry& destination)
     // For each corner in the old polygon,
     // add one pentagon(centroid, previous edge midpoints 0 and 1, corner, next edge midpoint 0)
 
-    make_points_from_points();
-    make_polygon_centroids();
-    make_edge_midpoints(
+    bulk_make_points_from_points();
+    bulk_make_polygon_centroids();
+    bulk_make_edge_points(
         {
             1.0f / 3.0f,
             2.0f / 3.0f
         }
     );
+    bulk_make_point_sources();
 
-    source.for_each_polygon_const([&](auto& i) {
-        i.polygon.for_each_corner_neighborhood_const(source, [&](auto& j) {
-            const Point_id   a                        = j.prev_corner.point_id;
-            const Point_id   b                        = j.corner     .point_id;
-            const Point_id   c                        = j.next_corner.point_id;
-            const Polygon_id new_polygon_id           = make_new_polygon_from_polygon(i.polygon_id);
-            const Point_id   previous_edge_midpoint_0 = get_edge_new_point(a, b, 0, 2);
-            const Point_id   previous_edge_midpoint_1 = get_edge_new_point(a, b, 1, 2);
-            const Point_id   next_edge_midpoint_0     = get_edge_new_point(b, c, 0, 2);
-            if (previous_edge_midpoint_0 == std::numeric_limits<uint32_t>::max()) {
-                log_subdivide->warn("midpoint for edge {} {} [0] not found", a, b);
-                return;
+    bulk_make_polygons(
+        source.get_polygon_count(),
+        [this](const Polygon_id old_polygon_id, Polygon_writer& writer) {
+            const Polygon& old_polygon = source.polygons[old_polygon_id];
+            for (uint32_t i = 0; i < old_polygon.corner_count; ++i) {
+                const Corner_id prev_corner_id           = get_old_polygon_corner(old_polygon_id, i + old_polygon.corner_count - 1);
+                const Corner_id corner_id                = get_old_polygon_corner(old_polygon_id, i);
+                const Point_id  previous_edge_midpoint_0 = get_bulk_edge_point(prev_corner_id, 0);
+                const Point_id  previous_edge_midpoint_1 = get_bulk_edge_point(prev_corner_id, 1);
+                const Point_id  next_edge_midpoint_0     = get_bulk_edge_point(corner_id, 0);
+                if ((previous_edge_midpoint_0 == s_invalid_id) || (next_edge_midpoint_0 == s_invalid_id)) {
+                    continue;
+                }
+                writer.make_polygon(old_polygon_id);
+                writer.make_corner_from_point           (previous_edge_midpoint_0);
+                writer.make_corner_from_point           (previous_edge_midpoint_1);
+                writer.make_corner_from_corner          (corner_id);
+                writer.make_corner_from_point           (next_edge_midpoint_0);
+                writer.make_corner_from_polygon_centroid(old_polygon_id);
             }
-            if (previous_edge_midpoint_1 == std::numeric_limits<uint32_t>::max()) {
-                log_subdivide->warn("midpoint for edge {} {} [1] not found", a, b);
-                return;
-            }
-            if (next_edge_midpoint_0 == std::numeric_limits<uint32_t>::max()) {
-                log_subdivide->warn("midpoint for edge {} {} [0] not found", b, c);
-                return;
-            }
-            make_new_corner_from_point           (new_polygon_id, previous_edge_midpoint_0);
-            make_new_corner_from_point           (new_polygon_id, previous_edge_midpoint_1);
-            make_new_corner_from_corner          (new_polygon_id, j.corner_id);
-            make_new_corner_from_point           (new_polygon_id, next_edge_midpoint_0);
-            make_new_corner_from_polygon_centroid(new_polygon_id, i.polygon_id);
-            //log_subdivide.warn(
-            //    "Polygon {} = {} {} {} {} {}\n",
-            //    new_polygon_id,
-            //    previous_edge_midpoint_0,
-            //    previous_edge_midpoint_1,
-            //    source.corners[j.corner_id].point_id,
-            //    next_edge_midpoint_0,
-            //    old_polygon_centroid_to_new_points[i.polygon_id]
-            //);
-        });
-    });
+        }
+    );
 
-    post_processing();
+    bulk_post_processing();
 }
 
-auto gyro(Geometry& source) -> Geometry
+auto gyro(Geometry& source, erhe::concurrency::Thread_pool* thread_pool) -> Geometry
 {
     return Geometry{
         fmt::format("gyro({})", source.name),
-        [&source](auto& result) {
-            Gyro operation{source, result};
+        [&source, thread_pool](auto& result) {
+            Gyro operation{source, result, thread_pool};
         }
     };
 }
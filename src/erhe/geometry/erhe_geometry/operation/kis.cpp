@@ -8,32 +8,38 @@
 namespace erhe::geometry::operation
 {
 
-Kis::Kis(Geometry& src, Geometry& destination)
-    : Geometry_operation{src, destination}
+Kis::Kis(Geometry& src, Geometry& destination, erhe::concurrency::Thread_pool* thread_pool)
+    : Geometry_operation{src, destination, thread_pool}
 {
     ERHE_PROFILE_FUNCTION();
 
-    make_points_from_points();
-    make_polygon_centroids();
-
-    source.for_each_polygon_const([&](auto& i) {
-        i.polygon.for_each_corner_neighborhood_const(source, [&](auto& j) {
-            const Polygon_id new_polygon_id = destination.make_polygon();
-            make_new_corner_from_polygon_centroid(new_polygon_id, i.polygon_id);
-            make_new_corner_from_corner          (new_polygon_id, j.corner_id);
-            make_new_corner_from_corner          (new_polygon_id, j.next_corner_id);
-        });
-    });
+    bulk_make_points_from_points();
+    bulk_make_polygon_centroids();
+    bulk_make_point_sources();
+
+    // For each corner in the old polygon, add one triangle (centroid, corner, next corner)
+    bulk_make_polygons(
+        source.get_polygon_count(),
+        [this](const Polygon_id old_polygon_id, Polygon_writer& writer) {
+            const Polygon& old_polygon = source.polygons[old_polygon_id];
+            for (uint32_t i = 0; i < old_polygon.corner_count; ++i) {
+                writer.make_polygon();
+                writer.make_corner_from_polygon_centroid(old_polygon_id);
+                writer.make_corner_from_corner          (get_old_polygon_corner(old_polygon_id, i));
+                writer.make_corner_from_corner          (get_old_polygon_corner(old_polygon_id, i + 1));
+            }
+        }
+    );
 
-    post_processing();
+    bulk_post_processing();
 }
 
-auto kis(Geometry& source) -> Geometry
+auto kis(Geometry& source, erhe::concurrency::Thread_pool* thread_pool) -> Geometry
 {
     return Geometry{
         fmt::format("kis({})", source.name),
-        [&source](auto& result) {
-            Kis operation{source, result};
+        [&source, thread_pool](auto& result) {
+            Kis operation{source, result, thread_pool};
         }
     };
 }
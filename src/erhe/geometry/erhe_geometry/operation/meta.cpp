@@ -11,8 +11,8 @@
 namespace erhe::geometry::operation
 {
 
-Meta::Meta(Geometry& src, Geometry& destination)
-    : Geometry_operation{src, destination}
+Meta::Meta(Geometry& src, Geometry& destination, erhe::concurrency::Thread_pool* thread_pool)
+    : Geometry_operation{src, destination, thread_pool}
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -21,46 +21,45 @@ Meta::Meta(Geometry& src, Geometry& destination)
     // For each corner in the old polygon,
     // add two triangles (centroid, previous edge midpoint, corner), (centroid, corner, next edge midpoint)
 
-    make_points_from_points();
-    make_polygon_centroids();
-    make_edge_midpoints();
+    bulk_make_points_from_points();
+    bulk_make_polygon_centroids();
+    bulk_make_edge_points();
+    bulk_make_point_sources();
 
-    source.for_each_polygon_const([&](auto& i) {
-        i.polygon.for_each_corner_neighborhood_const(source, [&](auto& j) {
-            const Point_id   a                      = j.prev_corner.point_id;
-            const Point_id   b                      = j.corner     .point_id;
-            const Point_id   c                      = j.next_corner.point_id;
-            const Polygon_id new_polygon_id_a       = make_new_polygon_from_polygon(i.polygon_id);
-            const Polygon_id new_polygon_id_b       = make_new_polygon_from_polygon(i.polygon_id);
-            const Point_id   previous_edge_midpoint = get_edge_new_point(a, b);
-            const Point_id   next_edge_midpoint     = get_edge_new_point(b, c);
-            if (previous_edge_midpoint == std::numeric_limits<uint32_t>::max()) {
-                log_subdivide->warn("midpoint for edge {} {} not found", std::min(a, b), std::max(a, b));
-                return;
-            }
-            if (next_edge_midpoint == std::numeric_limits<uint32_t>::max()) {
-                log_subdivide->warn("midpoint for edge {} {} not found", std::min(b, c), std::max(b, c));
-                return;
-            }
-            make_new_corner_from_polygon_centroid(new_polygon_id_a, i.polygon_id);
-            make_new_corner_from_point           (new_polygon_id_a, previous_edge_midpoint);
-            make_new_corner_from_corner          (new_polygon_id_a, j.corner_id);
+    bulk_make_polygons(
+        source.get_polygon_count(),
+        [this](const Polygon_id old_polygon_id, Polygon_writer& writer) {
+            const Polygon& old_polygon = source.polygons[old_polygon_id];
+            for (uint32_t i = 0; i < old_polygon.corner_count; ++i) {
+                const Corner_id prev_corner_id         = get_old_polygon_corner(old_polygon_id, i + old_polygon.corner_count - 1);
+                const Corner_id corner_id              = get_old_polygon_corner(old_polygon_id, i);
+                const Point_id  previous_edge_midpoint = get_bulk_edge_point(prev_corner_id);
+                const Point_id  next_edge_midpoint     = get_bulk_edge_point(corner_id);
+                if ((previous_edge_midpoint == s_invalid_id) || (next_edge_midpoint == s_invalid_id)) {
+                    continue;
+                }
+                writer.make_polygon(old_polygon_id);
+                writer.make_corner_from_polygon_centroid(old_polygon_id);
+                writer.make_corner_from_point           (previous_edge_midpoint);
+                writer.make_corner_from_corner          (corner_id);
 
-            make_new_corner_from_polygon_centroid(new_polygon_id_b, i.polygon_id);
-            make_new_corner_from_corner          (new_polygon_id_b, j.corner_id);
-            make_new_corner_from_point           (new_polygon_id_b, next_edge_midpoint);
-        });
-    });
+                writer.make_polygon(old_polygon_id);
+                writer.make_corner_from_polygon_centroid(old_polygon_id);
+                writer.make_corner_from_corner          (corner_id);
+                writer.make_corner_from_point           (next_edge_midpoint);
+            }
+        }
+    );
 
-    post_processing();
+    bulk_post_processing();
 }
 
-auto meta(Geometry& source) -> Geometry
+auto meta(Geometry& source, erhe::concurrency::Thread_pool* thread_pool) -> Geometry
 {
     return Geometry{
         fmt::format("meta({})", source.name),
-        [&source](auto& result) {
-            Meta operation{source, result};
+        [&source, thread_pool](auto& result) {
+            Meta operation{source, result, thread_pool};
         }
     };
 }
@@ -22,57 +22,79 @@ namespace erhe::geometry::operation
 //  (2) S(p) := (1 - alpha_n) p + alpha_n 1/n SUM p_i
 //
 //  (6) alpha_n = (4 - 2 cos(2Pi/n)) / 9
-Sqrt3_subdivision::Sqrt3_subdivision(Geometry& src, Geometry& destination)
-    : Geometry_operation{src, destination}
+Sqrt3_subdivision::Sqrt3_subdivision(
+    Geometry&                       src,
+    Geometry&                       destination,
+    erhe::concurrency::Thread_pool* thread_pool
+)
+    : Geometry_operation{src, destination, thread_pool}
 {
     ERHE_PROFILE_FUNCTION();
 
-    source.for_each_point_const([&](auto& i) {
-        const float    alpha            = (4.0f - 2.0f * std::cos(2.0f * glm::pi<float>() / i.point.corner_count)) / 9.0f;
-        const float    alpha_per_n      = alpha / static_cast<float>(i.point.corner_count);
-        const float    alpha_complement = 1.0f - alpha;
-        const Point_id new_point        = make_new_point_from_point(alpha_complement, i.point_id);
-        add_point_ring(new_point, alpha_per_n, i.point_id);
-    });
+    bulk_make_points_from_points();
+    bulk_make_polygon_centroids();
+    build_old_corner_edges();
 
-    make_polygon_centroids();
-
-    source.for_each_polygon_const([&](auto& i) {
-        i.polygon.for_each_corner_neighborhood_const(source, [&](auto& j) {
-            const Point_id src_point_id      = j.corner.point_id;
-            const Point_id src_next_point_id = j.next_corner.point_id;
-
-            const auto edge_opt = source.find_edge(src_point_id, src_next_point_id);
-            if (!edge_opt.has_value()) {
+    bulk_make_point_sources(
+        [this](const Point_id new_point, Source_writer<Point_id>& point_sources, Source_writer<Corner_id>& point_corner_sources) {
+            if (!bulk_points_from_points.contains(new_point)) {
+                add_bulk_point_sources(new_point, point_sources, point_corner_sources);
                 return;
             }
-            const auto& edge = edge_opt.value();
-            Polygon_id opposite_polygon_id = i.polygon_id;
-            edge.for_each_polygon_const(source, [&](auto& k) {
-                if (k.polygon_id != i.polygon_id) {
-                    opposite_polygon_id = k.polygon_id;
-                    return k.break_iteration();
+            const Point_id old_point_id     = new_point - bulk_points_from_points.first;
+            const Point&   old_point        = source.points[old_point_id];
+            const float    alpha            = (4.0f - 2.0f * std::cos(2.0f * glm::pi<float>() / old_point.corner_count)) / 9.0f;
+            const float    alpha_per_n      = alpha / static_cast<float>(old_point.corner_count);
+            const float    alpha_complement = 1.0f - alpha;
+            point_sources.add(alpha_complement, old_point_id);
+            for (uint32_t i = 0; i < old_point.corner_count; ++i) {
+                const Corner_id ring_corner_id      = source.point_corners[old_point.first_point_corner_id + i];
+                const Polygon&  ring_polygon        = source.polygons[source.corners[ring_corner_id].polygon_id];
+                const Corner_id next_ring_corner_id = ring_polygon.next_corner(source, ring_corner_id);
+                point_sources.add(alpha_per_n, source.corners[next_ring_corner_id].point_id);
+            }
+        }
+    );
+
+    bulk_make_polygons(
+        source.get_polygon_count(),
+        [this](const Polygon_id old_polygon_id, Polygon_writer& writer) {
+            const Polygon& old_polygon = source.polygons[old_polygon_id];
+            for (uint32_t i = 0; i < old_polygon.corner_count; ++i) {
+                const Corner_id corner_id = get_old_polygon_corner(old_polygon_id, i);
+                const Edge_id   edge_id   = old_corner_edges[corner_id];
+                if (edge_id == s_invalid_id) {
+                    continue;
                 }
-            });
-            if (opposite_polygon_id == i.polygon_id) {
-                return;
+                const Edge& edge = source.edges[edge_id];
+                Polygon_id opposite_polygon_id = old_polygon_id;
+                for (uint32_t j = 0; j < edge.polygon_count; ++j) {
+                    const Polygon_id edge_polygon_id = source.edge_polygons[edge.first_edge_polygon_id + j];
+                    if (edge_polygon_id != old_polygon_id) {
+                        opposite_polygon_id = edge_polygon_id;
+                        break;
+                    }
+                }
+                if (opposite_polygon_id == old_polygon_id) {
+                    continue;
+                }
+                writer.make_polygon(old_polygon_id);
+                writer.make_corner_from_polygon_centroid(old_polygon_id);
+                writer.make_corner_from_corner          (corner_id);
+                writer.make_corner_from_polygon_centroid(opposite_polygon_id);
             }
-            const Polygon_id new_polygon_id = make_new_polygon_from_polygon(i.polygon_id);
-            make_new_corner_from_polygon_centroid(new_polygon_id, i.polygon_id);
-            make_new_corner_from_corner          (new_polygon_id, j.corner_id);
-            make_new_corner_from_polygon_centroid(new_polygon_id, opposite_polygon_id);
-        });
-    });
+        }
+    );
 
-    post_processing();
+    bulk_post_processing();
 }
 
-auto sqrt3_subdivision(Geometry& source) -> Geometry
+auto sqrt3_subdivision(Geometry& source, erhe::concurrency::Thread_pool* thread_pool) -> Geometry
 {
     return Geometry(
         fmt::format("sqrt3({})", source.name),
-        [&source](auto& result) {
-            Sqrt3_subdivision operation{source, result};
+        [&source, thread_pool](auto& result) {
+            Sqrt3_subdivision operation{source, result, thread_pool};
         }
     );
 }
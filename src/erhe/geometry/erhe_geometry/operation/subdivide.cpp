@@ -11,8 +11,8 @@
 namespace erhe::geometry::operation
 {
 
-Subdivide::Subdivide(Geometry& src, Geometry& destination)
-    : Geometry_operation{src, destination}
+Subdivide::Subdivide(Geometry& src, Geometry& destination, erhe::concurrency::Thread_pool* thread_pool)
+    : Geometry_operation{src, destination, thread_pool}
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -21,56 +21,41 @@ Subdivide::Subdivide(Geometry& src, Geometry& destination)
     // For each corner in the old polygon,
     // add one quad (centroid, previous edge midpoint, corner, next edge midpoint)
 
-    make_points_from_points();
-    make_polygon_centroids();
-    make_edge_midpoints();
+    bulk_make_points_from_points();
+    bulk_make_polygon_centroids();
+    bulk_make_edge_points();
+    bulk_make_point_sources();
 
-    source.for_each_polygon_const([&](auto& i) {
-        //if (src_polygon.corner_count == 3)
-        //{
-        //    Polygon_id new_polygon_id = make_new_polygon_from_polygon(src_polygon_id);
-        //    add_polygon_corners(new_polygon_id, src_polygon_id);
-        //    continue;
-        //}
-        i.polygon.for_each_corner_neighborhood_const(source, [&](auto& j) {
-            const Point_id   a                      = j.prev_corner.point_id;
-            const Point_id   b                      = j.corner     .point_id;
-            const Point_id   c                      = j.next_corner.point_id;
-            const Polygon_id new_polygon_id         = make_new_polygon_from_polygon(i.polygon_id);
-            const Point_id   previous_edge_midpoint = get_edge_new_point(a, b);
-            const Point_id   next_edge_midpoint     = get_edge_new_point(b, c);
-            if (previous_edge_midpoint == std::numeric_limits<uint32_t>::max()) {
-                log_subdivide->warn("midpoint for edge {} {} not found", std::min(a, b), std::max(a, b));
-                return;
+    bulk_make_polygons(
+        source.get_polygon_count(),
+        [this](const Polygon_id old_polygon_id, Polygon_writer& writer) {
+            const Polygon& old_polygon = source.polygons[old_polygon_id];
+            for (uint32_t i = 0; i < old_polygon.corner_count; ++i) {
+                const Corner_id prev_corner_id         = get_old_polygon_corner(old_polygon_id, i + old_polygon.corner_count - 1);
+                const Corner_id corner_id              = get_old_polygon_corner(old_polygon_id, i);
+                const Point_id  previous_edge_midpoint = get_bulk_edge_point(prev_corner_id);
+                const Point_id  next_edge_midpoint     = get_bulk_edge_point(corner_id);
+                if ((previous_edge_midpoint == s_invalid_id) || (next_edge_midpoint == s_invalid_id)) {
+                    continue;
+                }
+                writer.make_polygon(old_polygon_id);
+                writer.make_corner_from_point           (previous_edge_midpoint);
+                writer.make_corner_from_corner          (corner_id);
+                writer.make_corner_from_point           (next_edge_midpoint);
+                writer.make_corner_from_polygon_centroid(old_polygon_id);
             }
-            if (next_edge_midpoint == std::numeric_limits<uint32_t>::max()) {
-                log_subdivide->warn("midpoint for edge {} {} not found", std::min(b, c), std::max(b, c));
-                return;
-            }
-            make_new_corner_from_point           (new_polygon_id, previous_edge_midpoint);
-            make_new_corner_from_corner          (new_polygon_id, j.corner_id);
-            make_new_corner_from_point           (new_polygon_id, next_edge_midpoint);
-            make_new_corner_from_polygon_centroid(new_polygon_id, i.polygon_id);
-            //log_subdivide.warn(
-            //    "Polygon {} = {} {} {} {}\n",
-            //    new_polygon_id,
-            //    previous_edge_midpoint,
-            //    source.corners[j.corner_id].point_id,
-            //    next_edge_midpoint,
-            //    old_polygon_centroid_to_new_points[i.polygon_id]
-            //);
-        });
-    });
+        }
+    );
 
-    post_processing();
+    bulk_post_processing();
 }
 
-auto subdivide(Geometry& source) -> Geometry
+auto subdivide(Geometry& source, erhe::concurrency::Thread_pool* thread_pool) -> Geometry
 {
     return Geometry{
         fmt::format("subdivide({})", source.name),
-        [&source](auto& result) {
-            Subdivide operation{source, result};
+        [&source, thread_pool](auto& result) {
+            Subdivide operation{source, result, thread_pool};
         }
     };
 }
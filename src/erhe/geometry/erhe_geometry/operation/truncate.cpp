@@ -12,8 +12,8 @@
 namespace erhe::geometry::operation
 {
 
-Truncate::Truncate(Geometry& source, Geometry& destination)
-    : Geometry_operation{source, destination}
+Truncate::Truncate(Geometry& source, Geometry& destination, erhe::concurrency::Thread_pool* thread_pool)
+    : Geometry_operation{source, destination, thread_pool}
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -21,52 +21,54 @@ Truncate::Truncate(Geometry& source, Geometry& destination)
     const float t0 = 1.0f / 3.0f;
     const float t1 = 2.0f / 3.0f;
 
-    make_polygon_centroids();
-    make_edge_midpoints( {t0, t1} );
+    bulk_make_polygon_centroids();
+    bulk_make_edge_points( {t0, t1} );
+    bulk_make_point_sources();
 
     // New faces from old points, new face corner for each old point corner edge
     // 'midpoint' that is closest to the corner
-    source.for_each_point_const([&](auto& i) {
-        const Polygon_id new_polygon_id = destination.make_polygon();
-
-        i.point.for_each_corner_const(source, [&](auto& j) {
-            const Polygon&  src_polygon        = source.polygons[j.corner.polygon_id];
-            const Corner_id src_next_corner_id = src_polygon.next_corner(source, j.corner_id);
-            const Corner&   src_next_corner    = source.corners[src_next_corner_id];
-            Point_id        edge_midpoint      = get_edge_new_point(j.corner.point_id, src_next_corner.point_id);
-            if (src_next_corner.point_id > j.corner.point_id) {
-                edge_midpoint += 1;
+    bulk_make_polygons(
+        source.get_point_count(),
+        [this, &source](const Point_id old_point_id, Polygon_writer& writer) {
+            const Point& old_point = source.points[old_point_id];
+            writer.make_polygon();
+            for (uint32_t i = 0; i < old_point.corner_count; ++i) {
+                const Corner_id corner_id     = source.point_corners[old_point.first_point_corner_id + i];
+                const Point_id  edge_midpoint = get_bulk_edge_point(corner_id, 0);
+                if (edge_midpoint != s_invalid_id) {
+                    writer.make_corner_from_point(edge_midpoint);
+                }
             }
-            make_new_corner_from_point(new_polygon_id, edge_midpoint);
-        });
-    });
+        }
+    );
 
     // New faces from old faces, new face corner for each old corner edge 'midpoint'
-    source.for_each_polygon([&](auto& i) {
-        const Polygon_id new_polygon_id = destination.make_polygon();
-        i.polygon.for_each_corner_neighborhood(source, [&](auto& j) {
-            const Point_id edge_midpoint = get_edge_new_point(j.corner.point_id, j.next_corner.point_id);
-            const Point_id point_a       = edge_midpoint;
-            const Point_id point_b       = edge_midpoint + 1;
-            if (j.next_corner.point_id > j.corner.point_id) {
-                make_new_corner_from_point(new_polygon_id, point_b);
-                make_new_corner_from_point(new_polygon_id, point_a);
-            } else {
-                make_new_corner_from_point(new_polygon_id, point_a);
-                make_new_corner_from_point(new_polygon_id, point_b);
+    bulk_make_polygons(
+        source.get_polygon_count(),
+        [this, &source](const Polygon_id old_polygon_id, Polygon_writer& writer) {
+            const Polygon& old_polygon = source.polygons[old_polygon_id];
+            writer.make_polygon();
+            for (uint32_t i = 0; i < old_polygon.corner_count; ++i) {
+                const Corner_id corner_id = get_old_polygon_corner(old_polygon_id, i);
+                const Point_id  point_a   = get_bulk_edge_point(corner_id, 0);
+                const Point_id  point_b   = get_bulk_edge_point(corner_id, 1);
+                if (point_a != s_invalid_id) {
+                    writer.make_corner_from_point(point_a);
+                    writer.make_corner_from_point(point_b);
+                }
             }
-        });
-    });
+        }
+    );
 
-    post_processing();
+    bulk_post_processing();
 }
 
-auto truncate(Geometry& source) -> Geometry
+auto truncate(Geometry& source, erhe::concurrency::Thread_pool* thread_pool) -> Geometry
 {
     return Geometry(
         fmt::format("truncate({})", source.name),
-        [&source](auto& result) {
-            Truncate operation{source, result};
+        [&source, thread_pool](auto& result) {
+            Truncate operation{source, result, thread_pool};
         }
     );
 }
@@ -4,9 +4,11 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <typeinfo>
+#include <utility>
 #include <vector>
 
 namespace erhe::geometry
@@ -35,6 +37,44 @@ public:
     Interpolation_mode interpolation_mode;
 };
 
+// Interpolation sources for new keys in compressed sparse row layout.
+// Sources of new_key are (weights[i], keys[i]) for i in
+// [offsets[new_key], offsets[new_key + 1]).
+template <typename Key_type>
+class Interpolation_sources
+{
+public:
+    [[nodiscard]] auto key_count() const -> std::size_t;
+
+    void clear ();
+    void assign(const std::vector<std::vector<std::pair<float, Key_type>>>& key_new_to_olds);
+
+    std::vector<uint32_t> offsets; // key_count() + 1 entries
+    std::vector<float>    weights;
+    std::vector<Key_type> keys;
+};
+
+// Collects interpolation sources in any new key order, one append per
+// source, and builds Interpolation_sources in bulk. Sources of each new
+// key keep the order in which they were added.
+template <typename Key_type>
+class Interpolation_source_builder
+{
+public:
+    void clear       ();
+    void reserve     (std::size_t source_count);
+    void add         (Key_type new_key, float weight, Key_type old_key);
+    auto source_count() const -> std::size_t;
+
+    // Sources for new keys greater or equal to key_count are dropped
+    void build(std::size_t key_count, Interpolation_sources<Key_type>& out) const;
+
+private:
+    std::vector<Key_type> m_new_keys;
+    std::vector<float>    m_weights;
+    std::vector<Key_type> m_old_keys;
+};
+
 template <typename Key_type>
 class Property_map_base
 {
@@ -48,14 +88,20 @@ public:
     virtual void clear     () = 0;
     virtual auto empty     () const -> bool = 0;
     virtual auto size      () const -> std::size_t = 0;
+    virtual auto memory_usage() const -> std::size_t = 0; // Bytes allocated for values
     virtual auto has       (Key_type key) const -> bool = 0;
     virtual void trim      (std::size_t size) = 0;
     virtual void remap_keys(const std::vector<Key_type>& key_old_to_new) = 0;
 
     virtual void interpolate(
+        Property_map_base<Key_type>*           destination,
+        const Interpolation_sources<Key_type>& sources
+    ) const = 0;
+
+    void interpolate(
         Property_map_base<Key_type>*                                destination,
         const std::vector<std::vector<std::pair<float, Key_type>>>& key_new_to_olds
-    ) const = 0;
+    ) const;
 
     virtual void transform  (const glm::mat4 matrix) = 0;
     virtual void import_from(Property_map_base<Key_type>* source) = 0;
@@ -88,12 +134,14 @@ public:
     void clear     () final;
     auto empty     () const -> bool final;
     auto size      () const -> std::size_t final;
+    auto memory_usage() const -> std::size_t final;
     void trim      (std::size_t size) final;
     void remap_keys(const std::vector<Key_type>& key_new_to_old) final;
 
+    using Property_map_base<Key_type>::interpolate;
     void interpolate(
-        Property_map_base<Key_type>*                                destination,
-        const std::vector<std::vector<std::pair<float, Key_type>>>& key_new_to_olds
+        Property_map_base<Key_type>*           destination,
+        const Interpolation_sources<Key_type>& sources
     ) const final;
 
     void transform  (const glm::mat4 matrix) final;
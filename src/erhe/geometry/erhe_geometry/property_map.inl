@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <limits>
 #include <type_traits>
 
 #if !defined(ERHE_PROFILE_FUNCTION)
@@ -50,6 +51,13 @@ Property_map<Key_type, Value_type>::size() const -> std::size_t
     return values.size();
 }
 
+template <typename Key_type, typename Value_type>
+inline auto
+Property_map<Key_type, Value_type>::memory_usage() const -> std::size_t
+{
+    return values.capacity() * sizeof(Value_type) + present.capacity() / 8;
+}
+
 template <typename Key_type, typename Value_type>
 inline void
 Property_map<Key_type, Value_type>::trim(std::size_t size)
@@ -154,11 +162,143 @@ Property_map<Key_type, Value_type>::constructor(
     return base_ptr;
 }
 
+template <typename Key_type>
+inline auto
+Interpolation_sources<Key_type>::key_count() const -> std::size_t
+{
+    return offsets.empty() ? 0 : offsets.size() - 1;
+}
+
+template <typename Key_type>
+inline void
+Interpolation_sources<Key_type>::clear()
+{
+    offsets.clear();
+    weights.clear();
+    keys.clear();
+}
+
+template <typename Key_type>
+inline void
+Interpolation_sources<Key_type>::assign(
+    const std::vector<std::vector<std::pair<float, Key_type>>>& key_new_to_olds
+)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    std::size_t source_count{0};
+    for (const auto& old_keys : key_new_to_olds) {
+        source_count += old_keys.size();
+    }
+    ERHE_VERIFY(source_count <= std::numeric_limits<uint32_t>::max());
+
+    offsets.resize(key_new_to_olds.size() + 1);
+    weights.resize(source_count);
+    keys   .resize(source_count);
+    uint32_t offset{0};
+    for (std::size_t new_key = 0, end = key_new_to_olds.size(); new_key < end; ++new_key) {
+        offsets[new_key] = offset;
+        for (const auto& j : key_new_to_olds[new_key]) {
+            weights[offset] = j.first;
+            keys   [offset] = j.second;
+            ++offset;
+        }
+    }
+    offsets.back() = offset;
+}
+
+template <typename Key_type>
+inline void
+Interpolation_source_builder<Key_type>::clear()
+{
+    m_new_keys.clear();
+    m_weights .clear();
+    m_old_keys.clear();
+}
+
+template <typename Key_type>
+inline void
+Interpolation_source_builder<Key_type>::reserve(const std::size_t source_count)
+{
+    m_new_keys.reserve(source_count);
+    m_weights .reserve(source_count);
+    m_old_keys.reserve(source_count);
+}
+
+template <typename Key_type>
+inline void
+Interpolation_source_builder<Key_type>::add(
+    const Key_type new_key,
+    const float    weight,
+    const Key_type old_key
+)
+{
+    m_new_keys.push_back(new_key);
+    m_weights .push_back(weight);
+    m_old_keys.push_back(old_key);
+}
+
+template <typename Key_type>
+inline auto
+Interpolation_source_builder<Key_type>::source_count() const -> std::size_t
+{
+    return m_new_keys.size();
+}
+
+template <typename Key_type>
+inline void
+Interpolation_source_builder<Key_type>::build(
+    const std::size_t                key_count,
+    Interpolation_sources<Key_type>& out
+) const
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ERHE_VERIFY(m_new_keys.size() <= std::numeric_limits<uint32_t>::max());
+
+    // Counting sort by new key: count, exclusive prefix sum, stable scatter
+    out.offsets.assign(key_count + 1, 0);
+    for (const Key_type new_key : m_new_keys) {
+        const std::size_t i = static_cast<std::size_t>(new_key);
+        if (i < key_count) {
+            ++out.offsets[i + 1];
+        }
+    }
+    for (std::size_t i = 0; i < key_count; ++i) {
+        out.offsets[i + 1] += out.offsets[i];
+    }
+
+    const std::size_t source_count = out.offsets[key_count];
+    out.weights.resize(source_count);
+    out.keys   .resize(source_count);
+    std::vector<uint32_t> cursors{out.offsets.begin(), out.offsets.end() - 1};
+    for (std::size_t j = 0, end = m_new_keys.size(); j < end; ++j) {
+        const std::size_t i = static_cast<std::size_t>(m_new_keys[j]);
+        if (i < key_count) {
+            const uint32_t slot = cursors[i]++;
+            out.weights[slot] = m_weights[j];
+            out.keys   [slot] = m_old_keys[j];
+        }
+    }
+}
+
+template <typename Key_type>
+inline void
+Property_map_base<Key_type>::interpolate(
+    Property_map_base<Key_type>*                                destination,
+    const std::vector<std::vector<std::pair<float, Key_type>>>& key_new_to_olds
+) const
+{
+    Interpolation_sources<Key_type> sources;
+    sources.assign(key_new_to_olds);
+    interpolate(destination, sources);
+}
+
 template <typename Key_type, typename Value_type>
 inline void
 Property_map<Key_type, Value_type>::interpolate(
-    Property_map_base<Key_type>*                                destination_base,
-    const std::vector<std::vector<std::pair<float, Key_type>>>& key_new_to_olds
+    Property_map_base<Key_type>*           destination_base,
+    const Interpolation_sources<Key_type>& sources
 ) const
 {
     ERHE_PROFILE_FUNCTION();
@@ -174,42 +314,58 @@ Property_map<Key_type, Value_type>::interpolate(
         return;
     }
 
-    for (
-        std::size_t new_key = 0, end = key_new_to_olds.size();
-        new_key < end;
-        ++new_key
-    ) {
-        const std::vector<std::pair<float, Key_type>>& old_keys = key_new_to_olds[new_key];
+    const std::size_t key_count    = sources.key_count();
+    const std::size_t value_count  = values.size();
+    const std::size_t source_count = sources.keys.size();
+    if ((key_count == 0) || (value_count == 0)) {
+        return;
+    }
+
+    // Resolve presence of old values once per source. Missing sources get
+    // zero weight and read values[0], so the loops below do not branch.
+    std::vector<uint8_t> old_present(value_count);
+    for (std::size_t i = 0; i < value_count; ++i) {
+        old_present[i] = present[i] ? 1 : 0;
+    }
+    std::vector<float>    source_weights(source_count);
+    std::vector<Key_type> source_keys   (source_count);
+    for (std::size_t i = 0; i < source_count; ++i) {
+        const Key_type    old_key   = sources.keys[i];
+        const std::size_t old_index = static_cast<std::size_t>(old_key);
+        const bool        is_valid  = (old_index < value_count) && (old_present[old_index] != 0);
+        source_weights[i] = is_valid ? sources.weights[i] : 0.0f;
+        source_keys   [i] = is_valid ? old_key : Key_type{0};
+    }
+
+    if (destination->values.size() < key_count) {
+        destination->values .resize(key_count);
+        destination->present.resize(key_count);
+    }
+
+    const uint32_t*   offsets = sources.offsets.data();
+    const float*      weights = source_weights.data();
+    const Key_type*   keys    = source_keys.data();
+    const Value_type* olds    = values.data();
+    for (std::size_t new_key = 0; new_key < key_count; ++new_key) {
+        const std::size_t begin = offsets[new_key];
+        const std::size_t end   = offsets[new_key + 1];
 
-        SPDLOG_LOGGER_TRACE(log_interpolate, "\tkey = {} from", new_key);
         float sum_weights{0.0f};
-        for (auto j : old_keys) {
-            const Key_type old_key = j.second;
-            SPDLOG_LOGGER_TRACE(log_interpolate, "\t\told key {} weight {}", static_cast<unsigned int>(old_key), static_cast<float>(j.first));
-            if (has(old_key)) {
-                sum_weights += j.first;
-            }
+        for (std::size_t i = begin; i < end; ++i) {
+            sum_weights += weights[i];
         }
 
         if (sum_weights == 0.0f) {
-            SPDLOG_LOGGER_TRACE(log_interpolate, "\t\tzero sum");
+            SPDLOG_LOGGER_TRACE(log_interpolate, "\tkey = {} zero sum", new_key);
             continue;
         }
 
         Value_type new_value(0);
         // TODO
         if constexpr (!std::is_same_v<Value_type, glm::uvec4>) {
-            for (auto j : old_keys) {
-                const float    weight  = j.first;
-                const Key_type old_key = j.second;
-
-                if (has(old_key)) {
-                    const Value_type old_value = get(old_key);
-                    SPDLOG_LOGGER_TRACE(log_interpolate, "\told value {} weight {}", old_value, (weight / sum_weights));
-                    new_value += static_cast<Value_type>((weight / sum_weights) * static_cast<Value_type>(old_value));
-                } else {
-                    SPDLOG_LOGGER_TRACE(log_interpolate, "\told value not found");
-                }
+            const float inverse_sum_weights = 1.0f / sum_weights;
+            for (std::size_t i = begin; i < end; ++i) {
+                new_value += static_cast<Value_type>((weights[i] * inverse_sum_weights) * olds[keys[i]]);
             }
         }
 
@@ -217,7 +373,6 @@ Property_map<Key_type, Value_type>::interpolate(
         if constexpr (std::is_same_v<Value_type, glm::vec3>) {
             if (m_descriptor.interpolation_mode == Interpolation_mode::normalized) {
                 new_value = glm::normalize(new_value);
-                SPDLOG_LOGGER_TRACE(log_interpolate, "\tnormalized", new_value);
             }
         }
 
@@ -230,13 +385,13 @@ Property_map<Key_type, Value_type>::interpolate(
                     ),
                     new_value.z
                 };
-                SPDLOG_LOGGER_TRACE(log_interpolate, "\tnormalized vec3-float", new_value);
             }
         }
 
-        SPDLOG_LOGGER_TRACE(log_interpolate, "\tvalue = {}", new_value);
+        SPDLOG_LOGGER_TRACE(log_interpolate, "\tkey = {} value = {}", new_key, new_value);
 
-        destination->put(static_cast<Key_type>(new_key), new_value);
+        destination->values [new_key] = new_value;
+        destination->present[new_key] = true;
     }
 }
 
@@ -54,6 +54,8 @@ public:
 
     auto size() const -> size_t;
 
+    auto memory_usage() const -> size_t;
+
     template <typename Value_type>
     auto create(
         const Property_map_descriptor& descriptor
@@ -86,6 +88,19 @@ public:
         Property_map_collection<Key_type>&                          destination,
         const std::vector<std::vector<std::pair<float, Key_type>>>& key_new_to_olds
     );
+    void interpolate(
+        Property_map_collection<Key_type>&     destination,
+        const Interpolation_sources<Key_type>& sources
+    );
+
+    // Creates destination maps for maps which interpolate, and calls
+    // fn(source_map, destination_map) for each. Maps are independent
+    // of each other, so fn may interpolate them concurrently.
+    template <typename Fn>
+    void for_each_interpolation(
+        Property_map_collection<Key_type>& destination,
+        Fn&&                               fn
+    );
 
     void merge_to            (Property_map_collection<Key_type>& source, const glm::mat4 transform);
     auto clone               () -> Property_map_collection<Key_type>;
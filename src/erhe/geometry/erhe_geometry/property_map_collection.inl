@@ -38,6 +38,17 @@ Property_map_collection<Key_type>::size() const -> size_t
     return m_entries.size();
 }
 
+template <typename Key_type>
+inline auto
+Property_map_collection<Key_type>::memory_usage() const -> size_t
+{
+    size_t sum = 0;
+    for (const auto& entry : m_entries) {
+        sum += entry.value->memory_usage();
+    }
+    return sum;
+}
+
 template <typename Key_type>
 inline void
 Property_map_collection<Key_type>::insert(Property_map_base<Key_type>* map)
@@ -202,6 +213,37 @@ Property_map_collection<Key_type>::interpolate(
 {
     ERHE_PROFILE_FUNCTION();
 
+    Interpolation_sources<Key_type> sources;
+    sources.assign(key_new_to_olds);
+    interpolate(destination, sources);
+}
+
+template <typename Key_type>
+inline void
+Property_map_collection<Key_type>::interpolate(
+    Property_map_collection<Key_type>&     destination,
+    const Interpolation_sources<Key_type>& sources
+)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    for_each_interpolation(
+        destination,
+        [&sources](const Property_map_base<Key_type>* src_map, Property_map_base<Key_type>* destination_map) {
+            SPDLOG_LOGGER_TRACE(log_interpolate, "interpolating {}", src_map->descriptor().name);
+            src_map->interpolate(destination_map, sources);
+        }
+    );
+}
+
+template <typename Key_type>
+template <typename Fn>
+inline void
+Property_map_collection<Key_type>::for_each_interpolation(
+    Property_map_collection<Key_type>& destination,
+    Fn&&                               fn
+)
+{
     for (auto& entry : m_entries) {
         Property_map_base<Key_type>* src_map    = entry.value.get();
         const auto&                  descriptor = src_map->descriptor();
@@ -209,11 +251,8 @@ Property_map_collection<Key_type>::interpolate(
             continue;
         }
         Property_map_base<Key_type>* destination_map = src_map->constructor(descriptor);
-
-        SPDLOG_LOGGER_TRACE(log_interpolate, "interpolating {}", src_map->descriptor().name);
-        src_map->interpolate(destination_map, key_new_to_olds);
-
         destination.insert(destination_map);
+        fn(static_cast<const Property_map_base<Key_type>*>(src_map), destination_map);
     }
 }
 
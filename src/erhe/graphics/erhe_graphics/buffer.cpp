@@ -95,6 +95,7 @@ Buffer::Buffer(
     , m_target             {target}
     , m_capacity_byte_count{capacity_byte_count}
     , m_storage_mask       {storage_mask}
+    , m_allocator          {capacity_byte_count}
 {
     log_buffer->trace(
         "Buffer::Buffer(target = {}, capacity_byte_count = {}, storage_mask = {}) name = {}",
@@ -116,6 +117,7 @@ Buffer::Buffer(
     , m_target             {0}
     , m_capacity_byte_count{capacity_byte_count}
     , m_storage_mask       {storage_mask}
+    , m_allocator          {capacity_byte_count}
 {
     log_buffer->trace(
         "Buffer::Buffer(capacity_byte_count = {}, storage_mask = {}) name = {}",
@@ -137,6 +139,7 @@ Buffer::Buffer(
     , m_capacity_byte_count{capacity_byte_count}
     , m_storage_mask       {storage_mask}
     , m_access_mask        {access_mask}
+    , m_allocator          {capacity_byte_count}
 {
     log_buffer->trace(
         "Buffer::Buffer(capacity_byte_count = {}, storage_mask = {}, access_mask = {}) name = {}",
@@ -161,6 +164,7 @@ Buffer::Buffer(
     , m_capacity_byte_count{capacity_byte_count}
     , m_storage_mask       {storage_mask}
     , m_access_mask        {access_mask}
+    , m_allocator          {capacity_byte_count}
 {
     log_buffer->trace(
         "Buffer::Buffer(target = {}, capacity_byte_count = {}, storage_mask = {}, access_mask = {}) name = {}",
@@ -187,6 +191,7 @@ Buffer::Buffer(
     , m_capacity_byte_count{capacity_byte_count}
     , m_storage_mask       {storage_mask}
     , m_access_mask        {access_mask}
+    , m_allocator          {capacity_byte_count}
 {
     log_buffer->trace(
         "Buffer::Buffer(target = {}, capacity_byte_count = {}, storage_mask = {}, map_buffer_access_mask = {}) name = {} {}",
@@ -217,9 +222,9 @@ Buffer::Buffer(Buffer&& other) noexcept
     , m_debug_label           {std::move(other.m_debug_label)}
     , m_target                {other.m_target}
     , m_capacity_byte_count   {other.m_capacity_byte_count}
-    , m_next_free_byte        {other.m_next_free_byte}
     , m_storage_mask          {other.m_storage_mask}
     , m_access_mask           {other.m_access_mask}
+    , m_allocator             {std::move(other.m_allocator)}
     , m_map                   {other.m_map}
     , m_map_byte_offset       {other.m_map_byte_offset}
     , m_map_buffer_access_mask{other.m_map_buffer_access_mask}
@@ -234,7 +239,7 @@ auto Buffer::operator=(Buffer&& other) noexcept -> Buffer&
     m_debug_label            = std::move(other.m_debug_label);
     m_target                 = other.m_target;
     m_capacity_byte_count    = other.m_capacity_byte_count;
-    m_next_free_byte         = other.m_next_free_byte;
+    m_allocator              = std::move(other.m_allocator);
     m_storage_mask           = other.m_storage_mask;
     m_access_mask            = other.m_access_mask;
     m_map                    = other.m_map;
@@ -279,15 +284,36 @@ auto Buffer::allocate_bytes(
 
     const std::lock_guard<std::mutex> lock{m_allocate_mutex};
 
-    while ((m_next_free_byte % alignment) != 0) {
-        ++m_next_free_byte;
+    const std::optional<std::size_t> offset = m_allocator.allocate(byte_count, alignment);
+    if (!offset.has_value()) {
+        const auto statistics = m_allocator.get_statistics();
+        log_buffer->error(
+            "buffer {}: out of memory allocating {} bytes: free = {}, largest free range = {}, free ranges = {}",
+            gl_name(), byte_count, statistics.free_byte_count, statistics.largest_free_byte_count, statistics.free_range_count
+        );
     }
-    const auto offset = m_next_free_byte;
-    m_next_free_byte += byte_count;
-    ERHE_VERIFY(m_next_free_byte <= m_capacity_byte_count);
+    ERHE_VERIFY(offset.has_value());
 
-    log_buffer->trace("buffer {}: allocated {} bytes at offset {}", gl_name(), byte_count, offset);
-    return offset;
+    log_buffer->trace("buffer {}: allocated {} bytes at offset {}", gl_name(), byte_count, offset.value());
+    return offset.value();
+}
+
+void Buffer::free_bytes(const std::size_t byte_offset) noexcept
+{
+    const std::lock_guard<std::mutex> lock{m_allocate_mutex};
+
+    const bool ok = m_allocator.free(byte_offset);
+    if (!ok) {
+        log_buffer->error("buffer {}: free_bytes(): no allocation at offset {}", gl_name(), byte_offset);
+        return;
+    }
+    log_buffer->trace("buffer {}: freed allocation at offset {}", gl_name(), byte_offset);
+}
+
+auto Buffer::get_allocator_statistics() const noexcept -> Buffer_allocator::Statistics
+{
+    const std::lock_guard<std::mutex> lock{m_allocate_mutex};
+    return m_allocator.get_statistics();
 }
 
 auto Buffer::begin_write(const std::size_t byte_offset, std::size_t byte_count) noexcept -> gsl::span<std::byte>
@@ -618,7 +644,8 @@ void Buffer::flush_and_unmap_bytes(const std::size_t byte_count) noexcept
 
 auto Buffer::free_capacity_bytes() const noexcept -> std::size_t
 {
-    return m_capacity_byte_count - m_next_free_byte;
+    const std::lock_guard<std::mutex> lock{m_allocate_mutex};
+    return m_allocator.free_byte_count();
 }
 
 auto Buffer::capacity_byte_count() const noexcept -> std::size_t
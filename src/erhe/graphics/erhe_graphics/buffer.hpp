@@ -1,5 +1,6 @@
 #pragma once
 
+#include "erhe_graphics/buffer_allocator.hpp"
 #include "erhe_graphics/gl_objects.hpp"
 #include "erhe_graphics/span.hpp"
 
@@ -63,13 +64,15 @@ public:
     Buffer        (Buffer&& other) noexcept;
     auto operator=(Buffer&& other) noexcept -> Buffer&;
 
-    [[nodiscard]] auto map                () const          -> gsl::span<std::byte>;
-    [[nodiscard]] auto debug_label        () const noexcept -> const std::string&;
-    [[nodiscard]] auto capacity_byte_count() const noexcept -> std::size_t;
-    [[nodiscard]] auto allocate_bytes     (std::size_t byte_count, std::size_t alignment = 64) noexcept -> std::size_t;
-    [[nodiscard]] auto free_capacity_bytes() const noexcept -> std::size_t;
-    [[nodiscard]] auto target             () const noexcept -> gl::Buffer_target;
-    [[nodiscard]] auto gl_name            () const noexcept -> unsigned int;
+    [[nodiscard]] auto map                     () const          -> gsl::span<std::byte>;
+    [[nodiscard]] auto debug_label             () const noexcept -> const std::string&;
+    [[nodiscard]] auto capacity_byte_count     () const noexcept -> std::size_t;
+    [[nodiscard]] auto allocate_bytes          (std::size_t byte_count, std::size_t alignment = 64) noexcept -> std::size_t;
+    [[nodiscard]] auto free_capacity_bytes     () const noexcept -> std::size_t;
+    [[nodiscard]] auto get_allocator_statistics() const noexcept -> Buffer_allocator::Statistics;
+    [[nodiscard]] auto target                  () const noexcept -> gl::Buffer_target;
+    [[nodiscard]] auto gl_name                 () const noexcept -> unsigned int;
+    void free_bytes           (std::size_t byte_offset) noexcept; // releases range returned by allocate_bytes()
     void unmap                () noexcept;
     void flush_bytes          (std::size_t byte_offset, std::size_t byte_count) noexcept;
     void flush_and_unmap_bytes(std::size_t byte_count) noexcept;
@@ -119,10 +122,10 @@ private:
     std::string                m_debug_label;
     gl::Buffer_target          m_target             {gl::Buffer_target::array_buffer};
     std::size_t                m_capacity_byte_count{0};
-    std::size_t                m_next_free_byte     {0};
     gl::Buffer_storage_mask    m_storage_mask       {0};
     gl::Map_buffer_access_mask m_access_mask        {0};
-    std::mutex                 m_allocate_mutex;
+    Buffer_allocator           m_allocator;
+    mutable std::mutex         m_allocate_mutex;
 
     // Last MapBuffer
     gsl::span<std::byte>       m_map;
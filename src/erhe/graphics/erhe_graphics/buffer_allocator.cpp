@@ -0,0 +1,197 @@
+#include "erhe_graphics/buffer_allocator.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace erhe::graphics
+{
+
+auto Buffer_allocator::Statistics::fragmentation() const -> float
+{
+    if (free_byte_count == 0) {
+        return 0.0f;
+    }
+    return 1.0f - static_cast<float>(largest_free_byte_count) / static_cast<float>(free_byte_count);
+}
+
+Buffer_allocator::Buffer_allocator() = default;
+
+Buffer_allocator::Buffer_allocator(const std::size_t capacity_byte_count)
+    : m_capacity_byte_count{capacity_byte_count}
+{
+    reset();
+}
+
+void Buffer_allocator::reset()
+{
+    m_free_ranges.clear();
+    for (auto& bin : m_bins) {
+        bin.clear();
+    }
+    m_non_empty_bins = 0;
+    m_allocations.clear();
+    m_allocated_byte_count = 0;
+    if (m_capacity_byte_count > 0) {
+        insert_free_range(0, m_capacity_byte_count);
+    }
+}
+
+auto Buffer_allocator::get_bin(const std::size_t byte_count) -> std::size_t
+{
+    // Bin N holds ranges with byte count in [2^N, 2^(N+1))
+    return static_cast<std::size_t>(std::bit_width(byte_count)) - 1;
+}
+
+auto Buffer_allocator::find_non_empty_bin(const std::size_t bin) const -> std::size_t
+{
+    if (bin >= bin_count) {
+        return bin_count;
+    }
+    const uint64_t mask = m_non_empty_bins & (~uint64_t{0} << bin);
+    return (mask != 0) ? static_cast<std::size_t>(std::countr_zero(mask)) : bin_count;
+}
+
+void Buffer_allocator::insert_free_range(const std::size_t offset, const std::size_t byte_count)
+{
+    const std::size_t bin = get_bin(byte_count);
+    m_free_ranges.emplace(offset, byte_count);
+    m_bins[bin].emplace(byte_count, offset);
+    m_non_empty_bins |= uint64_t{1} << bin;
+}
+
+void Buffer_allocator::remove_free_range(const std::map<std::size_t, std::size_t>::iterator i)
+{
+    const std::size_t bin = get_bin(i->second);
+    m_bins[bin].erase({i->second, i->first});
+    if (m_bins[bin].empty()) {
+        m_non_empty_bins &= ~(uint64_t{1} << bin);
+    }
+    m_free_ranges.erase(i);
+}
+
+auto Buffer_allocator::allocate(
+    const std::size_t byte_count,
+    const std::size_t alignment
+) -> std::optional<std::size_t>
+{
+    if ((byte_count == 0) || (alignment == 0)) {
+        return {};
+    }
+
+    // Worst case alignment padding is alignment - 1 bytes. Every range in
+    // bin N with 2^N >= padded size fits, so the smallest range of the
+    // lowest such non-empty bin is taken without looking at other ranges.
+    const std::size_t padded_byte_count = byte_count + alignment - 1;
+    if (padded_byte_count < byte_count) {
+        return {}; // overflow
+    }
+    std::optional<std::size_t> found_offset;
+    const std::size_t fit_bin = static_cast<std::size_t>(std::bit_width(padded_byte_count - 1));
+    const std::size_t bin     = find_non_empty_bin(fit_bin);
+    if (bin < bin_count) {
+        found_offset = m_bins[bin].begin()->second;
+    } else {
+        // Near exhaustion: ranges in the lower bins may still fit, depending
+        // on the alignment padding of their offset. Ranges smaller than
+        // byte_count are skipped through the size order of the bin.
+        for (
+            std::size_t lower_bin = find_non_empty_bin(get_bin(byte_count));
+            (lower_bin < fit_bin) && !found_offset.has_value();
+            lower_bin = find_non_empty_bin(lower_bin + 1)
+        ) {
+            const Bin& ranges = m_bins[lower_bin];
+            for (auto i = ranges.lower_bound({byte_count, 0}); i != ranges.end(); ++i) {
+                const auto [range_byte_count, offset] = *i;
+                const std::size_t aligned_offset = ((offset + alignment - 1) / alignment) * alignment;
+                if ((aligned_offset - offset) + byte_count <= range_byte_count) {
+                    found_offset = offset;
+                    break;
+                }
+            }
+        }
+    }
+    if (!found_offset.has_value()) {
+        return {};
+    }
+
+    const auto        i                = m_free_ranges.find(found_offset.value());
+    const std::size_t range_offset     = i->first;
+    const std::size_t range_byte_count = i->second;
+    remove_free_range(i);
+
+    const std::size_t aligned_offset   = ((range_offset + alignment - 1) / alignment) * alignment;
+    const std::size_t used_byte_count  = (aligned_offset - range_offset) + byte_count;
+    if (used_byte_count < range_byte_count) {
+        insert_free_range(range_offset + used_byte_count, range_byte_count - used_byte_count);
+    }
+
+    m_allocations.emplace(aligned_offset, Allocation{range_offset, used_byte_count});
+    m_allocated_byte_count      += used_byte_count;
+    m_peak_allocated_byte_count  = std::max(m_peak_allocated_byte_count, m_allocated_byte_count);
+    m_high_water_mark            = std::max(m_high_water_mark, range_offset + used_byte_count);
+    return aligned_offset;
+}
+
+auto Buffer_allocator::free(const std::size_t offset) -> bool
+{
+    const auto allocation_i = m_allocations.find(offset);
+    if (allocation_i == m_allocations.end()) {
+        return false;
+    }
+    std::size_t range_offset     = allocation_i->second.range_offset;
+    std::size_t range_byte_count = allocation_i->second.range_byte_count;
+    m_allocations.erase(allocation_i);
+    m_allocated_byte_count -= range_byte_count;
+
+    // Coalesce with following free range
+    const auto next = m_free_ranges.lower_bound(range_offset);
+    if ((next != m_free_ranges.end()) && (next->first == range_offset + range_byte_count)) {
+        range_byte_count += next->second;
+        remove_free_range(next);
+    }
+
+    // Coalesce with preceding free range
+    auto prev = m_free_ranges.lower_bound(range_offset);
+    if (prev != m_free_ranges.begin()) {
+        --prev;
+        if (prev->first + prev->second == range_offset) {
+            range_offset      = prev->first;
+            range_byte_count += prev->second;
+            remove_free_range(prev);
+        }
+    }
+
+    insert_free_range(range_offset, range_byte_count);
+    return true;
+}
+
+auto Buffer_allocator::capacity_byte_count() const -> std::size_t
+{
+    return m_capacity_byte_count;
+}
+
+auto Buffer_allocator::free_byte_count() const -> std::size_t
+{
+    return m_capacity_byte_count - m_allocated_byte_count;
+}
+
+auto Buffer_allocator::get_statistics() const -> Statistics
+{
+    Statistics statistics{
+        .capacity_byte_count       = m_capacity_byte_count,
+        .allocated_byte_count      = m_allocated_byte_count,
+        .free_byte_count           = free_byte_count(),
+        .largest_free_byte_count   = 0,
+        .free_range_count          = m_free_ranges.size(),
+        .allocation_count          = m_allocations.size(),
+        .high_water_mark           = m_high_water_mark,
+        .peak_allocated_byte_count = m_peak_allocated_byte_count
+    };
+    if (m_non_empty_bins != 0) {
+        const std::size_t highest_bin = bin_count - 1 - static_cast<std::size_t>(std::countl_zero(m_non_empty_bins));
+        statistics.largest_free_byte_count = m_bins[highest_bin].rbegin()->first;
+    }
+    return statistics;
+}
+
+} // namespace erhe::graphics
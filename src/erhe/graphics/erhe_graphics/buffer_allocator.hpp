@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+namespace erhe::graphics
+{
+
+// Sub-allocator for ranges of a fixed size buffer.
+//
+// Free ranges are kept in an offset ordered map, which is used to coalesce
+// neighbouring free ranges when a range is freed. Free ranges are also
+// binned by power of two size class, ordered by size within a bin, and a
+// bitmask tracks non-empty bins. Allocation takes the smallest range of the
+// lowest non-empty bin in which every range fits the request including
+// worst case alignment padding. Only when there is no such bin, the ranges
+// of the bins below it which are large enough are checked one by one.
+//
+// Buffer_allocator does not touch any GPU resources and is not thread
+// safe; erhe::graphics::Buffer wraps it with a mutex.
+class Buffer_allocator
+{
+public:
+    class Statistics
+    {
+    public:
+        std::size_t capacity_byte_count      {0};
+        std::size_t allocated_byte_count     {0}; // including alignment padding
+        std::size_t free_byte_count          {0};
+        std::size_t largest_free_byte_count  {0};
+        std::size_t free_range_count         {0};
+        std::size_t allocation_count         {0};
+        std::size_t high_water_mark          {0}; // highest end offset ever allocated
+        std::size_t peak_allocated_byte_count{0};
+
+        // 0.0 when all free space is one range, approaches 1.0 as free
+        // space gets split to many small ranges
+        [[nodiscard]] auto fragmentation() const -> float;
+    };
+
+    Buffer_allocator();
+    explicit Buffer_allocator(std::size_t capacity_byte_count);
+
+    // Returns byte offset of allocated range, or empty if there is no free
+    // range large enough
+    [[nodiscard]] auto allocate(std::size_t byte_count, std::size_t alignment) -> std::optional<std::size_t>;
+
+    // Releases range previously returned by allocate(). Returns false if
+    // offset is not an allocation.
+    auto free(std::size_t offset) -> bool;
+
+    // Releases all allocations
+    void reset();
+
+    [[nodiscard]] auto capacity_byte_count() const -> std::size_t;
+    [[nodiscard]] auto free_byte_count    () const -> std::size_t;
+    [[nodiscard]] auto get_statistics     () const -> Statistics;
+
+private:
+    static constexpr std::size_t bin_count = 64;
+
+    using Bin = std::set<std::pair<std::size_t, std::size_t>>; // (byte count, offset)
+
+    class Allocation
+    {
+    public:
+        std::size_t range_offset;    // start of range, before alignment padding
+        std::size_t range_byte_count;
+    };
+
+    [[nodiscard]] static auto get_bin(std::size_t byte_count) -> std::size_t;
+
+    // Lowest non-empty bin at or above bin, bin_count if none
+    [[nodiscard]] auto find_non_empty_bin(std::size_t bin) const -> std::size_t;
+
+    void insert_free_range(std::size_t offset, std::size_t byte_count);
+    void remove_free_range(std::map<std::size_t, std::size_t>::iterator i);
+
+    std::size_t                                   m_capacity_byte_count      {0};
+    std::size_t                                   m_allocated_byte_count     {0};
+    std::size_t                                   m_high_water_mark          {0};
+    std::size_t                                   m_peak_allocated_byte_count{0};
+    std::map<std::size_t, std::size_t>            m_free_ranges;                // offset -> byte count
+    std::array<Bin, bin_count>                    m_bins;                       // free ranges by size class
+    uint64_t                                      m_non_empty_bins           {0}; // bit per bin
+    std::unordered_map<std::size_t, Allocation>   m_allocations;                // aligned offset -> allocation
+};
+
+} // namespace erhe::graphics
@@ -1 +1,104 @@
 #include "erhe_hash/hash.hpp"
+
+#include <bit>
+#include <cstring>
+
+namespace erhe::hash
+{
+
+namespace {
+
+constexpr uint64_t xxh64_prime_1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t xxh64_prime_2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t xxh64_prime_3 = 0x165667B19E3779F9ull;
+constexpr uint64_t xxh64_prime_4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t xxh64_prime_5 = 0x27D4EB2F165667C5ull;
+
+// Little endian hosts only, like the rest of erhe
+inline auto read_u64(const uint8_t* p) -> uint64_t
+{
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline auto read_u32(const uint8_t* p) -> uint32_t
+{
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline auto xxh64_round(uint64_t accumulator, const uint64_t input) -> uint64_t
+{
+    accumulator += input * xxh64_prime_2;
+    accumulator  = std::rotl(accumulator, 31);
+    accumulator *= xxh64_prime_1;
+    return accumulator;
+}
+
+inline auto xxh64_merge_round(uint64_t accumulator, const uint64_t value) -> uint64_t
+{
+    accumulator ^= xxh64_round(0, value);
+    accumulator  = accumulator * xxh64_prime_1 + xxh64_prime_4;
+    return accumulator;
+}
+
+} // anonymous namespace
+
+auto xxh64(const void* data, const std::size_t byte_count, const uint64_t seed) -> uint64_t
+{
+    const uint8_t*       p   = static_cast<const uint8_t*>(data);
+    const uint8_t* const end = p + byte_count;
+    uint64_t             h64;
+
+    if (byte_count >= 32) {
+        const uint8_t* const limit = end - 32;
+        uint64_t v1 = seed + xxh64_prime_1 + xxh64_prime_2;
+        uint64_t v2 = seed + xxh64_prime_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - xxh64_prime_1;
+        do {
+            v1 = xxh64_round(v1, read_u64(p +  0));
+            v2 = xxh64_round(v2, read_u64(p +  8));
+            v3 = xxh64_round(v3, read_u64(p + 16));
+            v4 = xxh64_round(v4, read_u64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h64 = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+        h64 = xxh64_merge_round(h64, v1);
+        h64 = xxh64_merge_round(h64, v2);
+        h64 = xxh64_merge_round(h64, v3);
+        h64 = xxh64_merge_round(h64, v4);
+    } else {
+        h64 = seed + xxh64_prime_5;
+    }
+
+    h64 += static_cast<uint64_t>(byte_count);
+
+    while (p + 8 <= end) {
+        h64 ^= xxh64_round(0, read_u64(p));
+        h64  = std::rotl(h64, 27) * xxh64_prime_1 + xxh64_prime_4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h64 ^= static_cast<uint64_t>(read_u32(p)) * xxh64_prime_1;
+        h64  = std::rotl(h64, 23) * xxh64_prime_2 + xxh64_prime_3;
+        p += 4;
+    }
+    while (p < end) {
+        h64 ^= static_cast<uint64_t>(*p) * xxh64_prime_5;
+        h64  = std::rotl(h64, 11) * xxh64_prime_1;
+        ++p;
+    }
+
+    h64 ^= h64 >> 33;
+    h64 *= xxh64_prime_2;
+    h64 ^= h64 >> 29;
+    h64 *= xxh64_prime_3;
+    h64 ^= h64 >> 32;
+    return h64;
+}
+
+} // namespace erhe::hash
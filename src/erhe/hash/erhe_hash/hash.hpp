@@ -26,6 +26,15 @@ static const uint64_t c_seed  = 0xcbf29ce484222325;
     return seed;
 }
 
+// XXH64 over a whole buffer. Four independent accumulator lanes consume
+// 32 byte stripes, which is much faster than the byte at a time hash()
+// above for bulk data such as vertex and index buffers.
+[[nodiscard]] auto xxh64(
+    const void*       data,
+    const std::size_t byte_count,
+    uint64_t          seed = 0
+) -> uint64_t;
+
 [[nodiscard]] inline auto hash(const float value, const uint64_t seed = c_seed) -> uint64_t
 {
     return hash(&value, sizeof(float), seed);
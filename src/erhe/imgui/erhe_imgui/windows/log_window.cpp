@@ -6,12 +6,13 @@
 #include "erhe_commands/commands.hpp"
 
 #include "erhe_profile/profile.hpp"
-#include "erhe_time/timestamp.hpp"
+#include "erhe_log/timestamp.hpp"
 
 #include <imgui/imgui.h>
 #include <mini/ini.h>
 
 #include <algorithm>
+#include <limits>
 
 namespace erhe::imgui
 {
@@ -90,45 +91,90 @@ auto get_log_level_color(const spdlog::level::level_enum level) -> uint32_t
     return ImGui::ColorConvertFloat4ToU32(get_log_level_color_vec4(level));
 }
 
-void Logs::log_entry(erhe::log::Entry& entry)
+void Logs::collect_rows(
+    const erhe::log::Store_log_sink& sink,
+    const uint64_t                   first_serial,
+    const uint64_t                   last_serial,
+    const std::size_t                max_count,
+    const bool                       reverse
+)
 {
-    if (m_paused && (entry.serial > m_pause_serial)) {
+    ERHE_PROFILE_FUNCTION();
+
+    m_row_serials.clear();
+    if (first_serial > last_serial) {
         return;
     }
-    if (entry.level < m_min_level_to_show) {
-        return;
+    const uint64_t count = std::min<uint64_t>(last_serial - first_serial + 1, max_count);
+    const uint64_t begin = reverse ? last_serial - count + 1 : first_serial;
+    const uint64_t end   = begin + count;
+    for (uint64_t serial = begin; serial != end; ++serial) {
+        if (m_paused && (serial > m_pause_serial)) {
+            break;
+        }
+        if (!sink.get_entry(serial, m_row_entry, false)) {
+            continue;
+        }
+        if (m_row_entry.level < m_min_level_to_show) {
+            continue;
+        }
+        m_row_serials.push_back(serial);
+    }
+    if (reverse) {
+        std::reverse(m_row_serials.begin(), m_row_serials.end());
+    }
+}
+
+void Logs::log_rows(const erhe::log::Store_log_sink& sink, std::unordered_set<uint64_t>& selected)
+{
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(m_row_serials.size()));
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            if (!sink.get_entry(m_row_serials[row], m_row_entry)) {
+                // Overwritten since rows were collected
+                ImGui::TableNextRow();
+                continue;
+            }
+            log_entry(sink, selected);
+        }
     }
+    clipper.End();
+
+    if (!m_last_on_top && m_follow && !m_paused) {
+        ImGui::SetScrollY(ImGui::GetScrollMaxY());
+    }
+}
+
+void Logs::log_entry(const erhe::log::Store_log_sink& sink, std::unordered_set<uint64_t>& selected)
+{
+    const erhe::log::Entry& entry = m_row_entry;
 
     ImGui::TableNextRow();
     if (ImGui::TableSetColumnIndex(0)) {
         ImGui::TextColored(
             ImVec4{0.7f, 0.7f, 0.7f, 1.0f},
             "%s",
-            entry.timestamp.c_str()
+            erhe::log::timestamp_short(entry.timestamp_ns).c_str()
         );
     }
     if (ImGui::TableSetColumnIndex(1)) {
-        ImGui::TextUnformatted(entry.logger.c_str());
+        const std::string_view logger_name = sink.get_logger_name(entry.logger_id);
+        ImGui::TextUnformatted(logger_name.data(), logger_name.data() + logger_name.size());
     }
     if (ImGui::TableSetColumnIndex(2)) {
         ImGui::PushStyleColor(ImGuiCol_Text, get_log_level_color(entry.level));
         ImGui::PushID(static_cast<int>(entry.serial));
-        if (ImGui::Selectable(entry.message.c_str(), entry.selected)) {
-            entry.selected = !entry.selected;
+        const bool is_selected = selected.contains(entry.serial);
+        if (ImGui::Selectable(entry.message.c_str(), is_selected)) {
+            if (is_selected) {
+                selected.erase(entry.serial);
+            } else {
+                selected.insert(entry.serial);
+            }
         }
-        //if (entry.repeat_count > 0)
-        //{
-        //    ImGui::TextColored(
-        //        ImVec4{0.55f, 0.55f, 0.55f, 1.0f},
-        //        "Message repeated %u times",
-        //        entry.repeat_count
-        //    );
-        //}
         ImGui::PopID();
         ImGui::PopStyleColor();
-        if (!m_last_on_top && m_follow && !m_paused) {
-            ImGui::SetScrollHereY();
-        }
     }
 }
 
@@ -286,12 +332,16 @@ void Logs::tail_log_imgui()
     const auto trim_size = static_cast<size_t>(m_tail_buffer_trim_size);
     tail->trim(trim_size);
 
-    auto& tail_entries = tail->get_log();
-
-    const auto visible_count = (std::min)(
+    const uint64_t first_serial = tail->get_first_serial();
+    std::erase_if(m_tail_selected, [first_serial](const uint64_t serial) { return serial < first_serial; });
+    collect_rows(
+        *tail.get(),
+        first_serial,
+        tail->get_serial(),
         static_cast<size_t>(m_tail_buffer_show_size),
-        tail_entries.size()
+        m_last_on_top
     );
+
     ImGui::TableNextRow();
     if (ImGui::TableSetColumnIndex(0)) {
         ImGui::PushFont(m_imgui_renderer.mono_font());
@@ -305,15 +355,7 @@ void Logs::tail_log_imgui()
             ImGui::TableSetupColumn("Logger",    ImGuiTableColumnFlags_WidthFixed, 140.0f);
             ImGui::TableSetupColumn("Message",   ImGuiTableColumnFlags_WidthFixed, 4000.0f - 140.0f - 170.0f);
             ImGui::TableHeadersRow();
-            if (m_last_on_top) {
-                for (auto i = tail_entries.rbegin(), end = tail_entries.rbegin() + visible_count; i != end; ++i) {
-                    log_entry(*i);
-                }
-            } else {
-                for (auto i = tail_entries.begin(), end = tail_entries.begin() + visible_count; i != end; ++i) {
-                    log_entry(*i);
-                }
-            }
+            log_rows(*tail.get(), m_tail_selected);
             ImGui::EndTable();
         }
         ImGui::PopStyleVar();
@@ -326,7 +368,10 @@ void Logs::frame_log_imgui()
 {
     auto& frame = erhe::log::get_frame_store_log();
 
-    auto& frame_entries = frame->get_log();
+    const uint64_t last_serial = frame->get_serial();
+    m_frame_selected.clear();
+    collect_rows(*frame.get(), frame->get_first_serial(), last_serial, std::numeric_limits<std::size_t>::max(), false);
+
     ImGui::PushFont(m_imgui_renderer.mono_font());
     ImGui::PushStyleVar(ImGuiStyleVar_CellPadding, ImVec2{0.0f, 0.0f});
     const ImVec2 outer_size{-FLT_MIN, 0.0f};
@@ -338,16 +383,15 @@ void Logs::frame_log_imgui()
         ImGui::TableSetupColumn("Logger",    ImGuiTableColumnFlags_WidthFixed, 140.0f);
         ImGui::TableSetupColumn("Message",   ImGuiTableColumnFlags_WidthFixed, 4000.0f - 140.0f - 170.0f);
         ImGui::TableHeadersRow();
-        for (auto& entry : frame_entries) {
-            log_entry(entry);
-        }
+        log_rows(*frame.get(), m_frame_selected);
         ImGui::EndTable();
     }
     ImGui::PopStyleVar();
 
     ImGui::PopFont();
 
-    frame_entries.clear();
+    // Entries logged while drawing are kept for next frame
+    frame->trim(static_cast<std::size_t>(frame->get_serial() - last_serial));
 }
 
 } // namespace erhe::imgui
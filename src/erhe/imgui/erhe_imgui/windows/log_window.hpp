@@ -9,7 +9,7 @@
 
 #include <spdlog/sinks/sink.h>
 
-#include <deque>
+#include <unordered_set>
 #include <vector>
 
 namespace spdlog::level {
@@ -52,7 +52,9 @@ public:
 
 private:
     void save_settings();
-    void log_entry(erhe::log::Entry& entry);
+    void collect_rows(const erhe::log::Store_log_sink& sink, uint64_t first_serial, uint64_t last_serial, std::size_t max_count, bool reverse);
+    void log_rows    (const erhe::log::Store_log_sink& sink, std::unordered_set<uint64_t>& selected);
+    void log_entry   (const erhe::log::Store_log_sink& sink, std::unordered_set<uint64_t>& selected);
 
     Imgui_renderer&           m_imgui_renderer;
     Logs_toggle_pause_command m_toggle_pause_command;
@@ -63,6 +65,13 @@ private:
     bool                      m_follow           {false};
     uint64_t                  m_pause_serial     {0};
     spdlog::level::level_enum m_min_level_to_show{spdlog::level::trace};
+
+    // Serials of rows passing filters; only rows visible in the
+    // window have their message copied and timestamp formatted.
+    std::vector<uint64_t>        m_row_serials;
+    erhe::log::Entry             m_row_entry;
+    std::unordered_set<uint64_t> m_tail_selected;
+    std::unordered_set<uint64_t> m_frame_selected;
 };
 
 class Log_settings_window : public Imgui_window
@@ -478,7 +478,67 @@ void Performance_window::imgui()
     for (auto& plot : m_gpu_timer_plots) {
         plot.imgui();
     }
+#if defined(ERHE_PROFILE_LIBRARY_BUILTIN)
+    zones_imgui();
+#endif
 #endif
 }
 
+#if defined(ERHE_PROFILE_LIBRARY_BUILTIN)
+void Performance_window::zones_imgui()
+{
+#if defined(ERHE_GUI_LIBRARY_IMGUI)
+    ERHE_PROFILE_FUNCTION();
+
+    // Zones which ended since previous frame
+    if (!m_pause) {
+        erhe::profile::collect_zone_summary(m_zone_summary);
+    }
+
+    if (!ImGui::CollapsingHeader("Zones")) {
+        return;
+    }
+    if (ImGui::Button("Export Chrome Trace")) {
+        const char* path = "erhe_trace.json";
+        if (erhe::profile::write_chrome_trace(path)) {
+            log_performance->info("Wrote {}", path);
+        } else {
+            log_performance->error("Writing {} failed", path);
+        }
+    }
+
+    const ImGuiTableFlags flags = ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY;
+    const ImVec2 outer_size{0.0f, ImGui::GetTextLineHeightWithSpacing() * 20.0f};
+    if (!ImGui::BeginTable("zones", 4, flags, outer_size)) {
+        return;
+    }
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Zone",  ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Count", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+    ImGui::TableSetupColumn("Total", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+    ImGui::TableSetupColumn("Max",   ImGuiTableColumnFlags_WidthFixed, 80.0f);
+    ImGui::TableHeadersRow();
+
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(m_zone_summary.size()));
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            const erhe::profile::Zone_summary& zone = m_zone_summary[row];
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::TextUnformatted(zone.name);
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%llu", static_cast<unsigned long long>(zone.count));
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%.3f ms", static_cast<double>(zone.total_ns) / 1000000.0);
+            ImGui::TableSetColumnIndex(3);
+            ImGui::Text("%.3f ms", static_cast<double>(zone.max_ns) / 1000000.0);
+        }
+    }
+    clipper.End();
+    ImGui::EndTable();
+#endif
+}
+#endif
+
 } // namespace erhe::imgui
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "erhe_imgui/imgui_window.hpp"
+#include "erhe_profile/profile.hpp"
 
 #include <imgui/imgui.h>
 
@@ -109,10 +110,17 @@ public:
     void imgui() override;
 
 private:
+#if defined(ERHE_PROFILE_LIBRARY_BUILTIN)
+    void zones_imgui();
+#endif
+
     Frame_time_plot             m_frame_time_plot;
     std::vector<Gpu_timer_plot> m_gpu_timer_plots;
     std::vector<Cpu_timer_plot> m_cpu_timer_plots;
     bool                        m_pause{false};
+#if defined(ERHE_PROFILE_LIBRARY_BUILTIN)
+    std::vector<erhe::profile::Zone_summary> m_zone_summary;
+#endif
 };
 
 } // namespace editor
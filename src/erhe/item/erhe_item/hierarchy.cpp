@@ -12,6 +12,23 @@ namespace erhe
 
 using namespace erhe::item;
 
+auto Hierarchy::get_subtree_serial() const -> uint64_t
+{
+    return m_subtree_serial;
+}
+
+void Hierarchy::bump_subtree_serial()
+{
+    ++m_subtree_serial;
+    for (auto parent = m_parent.lock(); parent; parent = parent->m_parent.lock()) {
+        ++parent->m_subtree_serial;
+    }
+}
+
+void Hierarchy::handle_item_update()
+{
+    bump_subtree_serial();
+}
 
 Hierarchy::Hierarchy()           = default;
 Hierarchy::~Hierarchy() noexcept = default;
@@ -239,6 +256,7 @@ void Hierarchy::handle_add_child(
 
     position = std::min(m_children.size(), position);
     m_children.insert(m_children.begin() + position, child);
+    bump_subtree_serial();
 }
 
 void Hierarchy::handle_remove_child(
@@ -257,6 +275,7 @@ void Hierarchy::handle_remove_child(
     if (i != m_children.end()) {
         log->trace("Removing child '{}' from '{}'", child->describe(), describe());
         m_children.erase(i, m_children.end());
+        bump_subtree_serial();
     } else {
         log->error(
             "child '{}' cannot be removed from parent '{}': child not found",
@@ -323,6 +342,8 @@ auto Hierarchy::get_children() const -> const std::vector<std::shared_ptr<Hierar
 
 auto Hierarchy::get_mutable_children() -> std::vector<std::shared_ptr<Hierarchy>>&
 {
+    // Caller may reorder children
+    bump_subtree_serial();
     return m_children;
 }
 
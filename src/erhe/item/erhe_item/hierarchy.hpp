@@ -34,6 +34,7 @@ public:
     [[nodiscard]] static auto get_static_type() -> uint64_t{ return 0; }
     [[nodiscard]] auto get_type     () const -> uint64_t          override { return get_static_type(); }
     [[nodiscard]] auto get_type_name() const -> std::string_view  override { return static_type_name; }
+    void handle_item_update() override;
 
     virtual void set_parent          (const std::shared_ptr<Hierarchy>& parent);
     virtual void set_parent          (const std::shared_ptr<Hierarchy>& parent, std::size_t position);
@@ -63,6 +64,12 @@ public:
     void trace                          ();
     void for_each                       (const std::function<bool(Hierarchy& hierarchy)>& fun);
 
+    // Incremented when children are added, removed or reordered, or when
+    // name or flags change, in this hierarchy or any of its descendants.
+    // Lets views of hierarchies skip unchanged subtrees.
+    [[nodiscard]] auto get_subtree_serial() const -> uint64_t;
+    void bump_subtree_serial();
+
     template <typename T>
     void for_each(const std::function<bool(const T& item)>& fun) const
     {
@@ -82,6 +89,7 @@ protected:
     std::weak_ptr<Hierarchy>                m_parent{};
     std::vector<std::shared_ptr<Hierarchy>> m_children;
     std::size_t                             m_depth {0};
+    uint64_t                                m_subtree_serial{1};
 };
 
 } // namespace erhe
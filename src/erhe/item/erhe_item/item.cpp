@@ -140,6 +140,7 @@ void Item_base::set_flag_bits(const uint64_t mask, const bool value)
 
     if (m_flag_bits != old_flag_bits) {
         handle_flag_bits_update(old_flag_bits, m_flag_bits);
+        handle_item_update();
     }
 }
 
@@ -217,6 +218,7 @@ void Item_base::set_name(const std::string_view name)
 {
     m_name = name;
     m_label = fmt::format("{}##{}", name, get_id());
+    handle_item_update();
 }
 
 auto Item_base::describe(int level) const -> std::string
@@ -239,6 +239,9 @@ public:
         static_cast<void>(new_flag_bits);
     }
 
+    // Called after name or flag bits have changed
+    virtual void handle_item_update() {}
+
     [[nodiscard]] auto get_id                      () const -> std::size_t;
     [[nodiscard]] auto get_flag_bits               () const -> uint64_t;
     [[nodiscard]] auto is_no_transform_update      () const -> bool;
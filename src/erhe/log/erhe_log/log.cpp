@@ -1,7 +1,6 @@
 #include "erhe_log/log.hpp"
 #include "erhe_configuration/configuration.hpp"
-//#include "erhe_hash/hash.hpp"
-#include "erhe_log/timestamp.hpp"
+#include "erhe_hash/hash.hpp"
 #include "erhe_verify/verify.hpp"
 
 #include <spdlog/sinks/base_sink.h>
@@ -18,6 +17,8 @@
 #   include <unistd.h>
 #endif
 
+#include <algorithm>
+#include <chrono>
 #include <vector>
 
 namespace erhe::log
@@ -42,45 +43,212 @@ void console_init()
 #endif
 }
 
-Store_log_sink::Store_log_sink()
+namespace {
+
+auto next_power_of_two(const std::size_t value) -> std::size_t
+{
+    std::size_t result = 1;
+    while (result < value) {
+        result = result << 1;
+    }
+    return result;
+}
+
+// Arena bytes are copied with relaxed atomic accesses, because readers may
+// copy bytes which a producer is overwriting; readers detect that afterwards.
+void store_bytes(std::atomic<char>* const destination, const char* const source, const std::size_t size)
+{
+    for (std::size_t i = 0; i < size; ++i) {
+        destination[i].store(source[i], std::memory_order_relaxed);
+    }
+}
+
+void load_bytes(char* const destination, const std::atomic<char>* const source, const std::size_t size)
+{
+    for (std::size_t i = 0; i < size; ++i) {
+        destination[i] = source[i].load(std::memory_order_relaxed);
+    }
+}
+
+auto slot_checksum(
+    const uint64_t                  serial,
+    const int64_t                   timestamp_ns,
+    const uint64_t                  message_offset,
+    const uint32_t                  message_size,
+    const uint32_t                  logger_id,
+    const spdlog::level::level_enum level,
+    const uint64_t                  message_hash
+) -> uint64_t
+{
+    uint64_t seed = erhe::hash::c_seed;
+    seed = erhe::hash::hash(&serial,         sizeof(serial),         seed);
+    seed = erhe::hash::hash(&timestamp_ns,   sizeof(timestamp_ns),   seed);
+    seed = erhe::hash::hash(&message_offset, sizeof(message_offset), seed);
+    seed = erhe::hash::hash(&message_size,   sizeof(message_size),   seed);
+    seed = erhe::hash::hash(&logger_id,      sizeof(logger_id),      seed);
+    seed = erhe::hash::hash(&level,          sizeof(level),          seed);
+    seed = erhe::hash::hash(&message_hash,   sizeof(message_hash),   seed);
+    return seed;
+}
+
+}
+
+Store_log_sink::Store_log_sink(const std::size_t capacity, const std::size_t arena_size)
+    : m_slots     (next_power_of_two(capacity))
+    , m_arena     (next_power_of_two(arena_size))
+    , m_slot_mask {m_slots.size() - 1}
+    , m_arena_mask{m_arena.size() - 1}
 {
 }
 
 auto Store_log_sink::get_serial() const -> uint64_t
 {
-    return m_serial;
+    return m_serial.load(std::memory_order_acquire);
+}
+
+auto Store_log_sink::get_first_serial() const -> uint64_t
+{
+    const uint64_t latest   = m_serial.load(std::memory_order_acquire);
+    const uint64_t capacity = m_slots.size();
+    const uint64_t oldest   = (latest >= capacity) ? latest - capacity + 1 : 1;
+    return std::max(oldest, m_trim_serial.load(std::memory_order_relaxed) + 1);
+}
+
+auto Store_log_sink::get_entry(const uint64_t serial, Entry& entry, const bool with_message) const -> bool
+{
+    if ((serial < get_first_serial()) || (serial > get_serial())) {
+        return false;
+    }
+
+    const Slot& slot = m_slots[serial & m_slot_mask];
+    if (slot.serial.load(std::memory_order_acquire) != serial) {
+        return false;
+    }
+    const int64_t                   timestamp_ns   = slot.timestamp_ns  .load(std::memory_order_relaxed);
+    const uint64_t                  message_offset = slot.message_offset.load(std::memory_order_relaxed);
+    const uint32_t                  message_size   = slot.message_size  .load(std::memory_order_relaxed);
+    const uint32_t                  logger_id      = slot.logger_id     .load(std::memory_order_relaxed);
+    const spdlog::level::level_enum level          = slot.level         .load(std::memory_order_relaxed);
+    const uint64_t                  message_hash   = slot.message_hash  .load(std::memory_order_relaxed);
+    const uint64_t                  checksum       = slot.checksum      .load(std::memory_order_relaxed);
+    if (with_message) {
+        // Size is from some producer even if the slot is being rewritten, so
+        // it is at most a quarter of the arena
+        entry.message.resize(message_size);
+        const std::size_t begin      = message_offset & m_arena_mask;
+        const std::size_t first_size = std::min<std::size_t>(message_size, m_arena.size() - begin);
+        load_bytes(entry.message.data(), m_arena.data() + begin, first_size);
+        load_bytes(entry.message.data() + first_size, m_arena.data(), message_size - first_size);
+    }
+
+    // Detect slot or message bytes being overwritten while copying. If any
+    // copied value was written by a later producer, the fence makes that
+    // producer's slot and arena claims visible to the loads below.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.serial.load(std::memory_order_relaxed) != serial) {
+        return false;
+    }
+    if (with_message && (m_arena_head.load(std::memory_order_acquire) > message_offset + m_arena.size())) {
+        return false;
+    }
+
+    // Detect a stalled producer which overwrote the entry after it was published
+    if (checksum != slot_checksum(serial, timestamp_ns, message_offset, message_size, logger_id, level, message_hash)) {
+        return false;
+    }
+    if (with_message && (erhe::hash::xxh64(entry.message.data(), message_size) != message_hash)) {
+        return false;
+    }
+    entry.serial       = serial;
+    entry.timestamp_ns = timestamp_ns;
+    entry.logger_id    = logger_id;
+    entry.level        = level;
+    return true;
+}
+
+auto Store_log_sink::get_logger_name(const uint32_t logger_id) const -> std::string_view
+{
+    if (logger_id >= s_max_logger_count) {
+        return {};
+    }
+    const Logger_name& logger_name = m_logger_names[logger_id];
+    if (!logger_name.ready.load(std::memory_order_acquire)) {
+        return {};
+    }
+    return logger_name.name;
 }
 
-auto Store_log_sink::get_log() -> std::deque<Entry>&
+void Store_log_sink::trim(const std::size_t count)
 {
-    return m_entries;
+    const uint64_t latest = m_serial.load(std::memory_order_acquire);
+    if (latest <= count) {
+        return;
+    }
+    const uint64_t trim_serial = latest - count;
+    if (trim_serial > m_trim_serial.load(std::memory_order_relaxed)) {
+        m_trim_serial.store(trim_serial, std::memory_order_relaxed);
+    }
 }
 
-void Store_log_sink::trim(const std::size_t trim_size)
+auto Store_log_sink::intern_logger_name(const std::string_view name) -> uint32_t
 {
-    if (m_entries.size() > trim_size) {
-        const auto trim_count = m_entries.size() - trim_size;
-        m_entries.erase(
-            m_entries.begin(),
-            m_entries.begin() + trim_count
-        );
-        assert(m_entries.size() == trim_size);
+    // Open addressing by name hash; names are never removed. Distinct names
+    // with equal hash would share the id, which is acceptable for display.
+    std::size_t hash = std::hash<std::string_view>{}(name);
+    if (hash == 0) {
+        hash = 1;
     }
+    for (std::size_t i = 0; i < s_max_logger_count; ++i) {
+        const std::size_t index       = (hash + i) % s_max_logger_count;
+        Logger_name&      logger_name = m_logger_names[index];
+        std::size_t       slot_hash   = logger_name.hash.load(std::memory_order_acquire);
+        if (slot_hash == 0) {
+            if (logger_name.hash.compare_exchange_strong(slot_hash, hash, std::memory_order_acq_rel)) {
+                logger_name.name = std::string{name};
+                logger_name.ready.store(true, std::memory_order_release);
+                return static_cast<uint32_t>(index);
+            }
+            // Lost the race; slot_hash now holds the winner hash
+        }
+        if (slot_hash == hash) {
+            return static_cast<uint32_t>(index);
+        }
+    }
+    return static_cast<uint32_t>(s_max_logger_count);
 }
 
 void Store_log_sink::sink_it_(const spdlog::details::log_msg& msg)
 {
-    ++m_serial;
-    m_entries.push_back(
-        Entry{
-            .serial       = m_serial,
-            .timestamp    = erhe::log::timestamp_short(),
-            .message      = std::string{msg.payload.begin(), msg.payload.end()},
-            .logger       = std::string{msg.logger_name.begin(), msg.logger_name.end()},
-            .repeat_count = 0,
-            .level        = msg.level,
-        }
+    const uint32_t logger_id = intern_logger_name(std::string_view{msg.logger_name.data(), msg.logger_name.size()});
+
+    // Claim and fill message bytes; very long messages are truncated
+    const std::size_t message_size   = std::min(msg.payload.size(), m_arena.size() / 4);
+    const uint64_t    message_offset = m_arena_head.fetch_add(message_size, std::memory_order_relaxed);
+    const std::size_t begin          = message_offset & m_arena_mask;
+    const std::size_t first_size     = std::min(message_size, m_arena.size() - begin);
+    // Orders the claim before the byte stores, for readers re-validating
+    std::atomic_thread_fence(std::memory_order_release);
+    store_bytes(m_arena.data() + begin, msg.payload.data(), first_size);
+    store_bytes(m_arena.data(), msg.payload.data() + first_size, message_size - first_size);
+
+    // Claim and publish slot
+    const uint64_t serial       = m_serial.fetch_add(1, std::memory_order_acq_rel) + 1;
+    const int64_t  timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(msg.time.time_since_epoch()).count();
+    const uint64_t message_hash = erhe::hash::xxh64(msg.payload.data(), message_size);
+    const uint64_t checksum     = slot_checksum(
+        serial, timestamp_ns, message_offset, static_cast<uint32_t>(message_size), logger_id, msg.level, message_hash
     );
+    Slot& slot = m_slots[serial & m_slot_mask];
+    slot.serial.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timestamp_ns  .store(timestamp_ns,                         std::memory_order_relaxed);
+    slot.message_offset.store(message_offset,                       std::memory_order_relaxed);
+    slot.message_size  .store(static_cast<uint32_t>(message_size), std::memory_order_relaxed);
+    slot.logger_id     .store(logger_id,                            std::memory_order_relaxed);
+    slot.level         .store(msg.level,                            std::memory_order_relaxed);
+    slot.message_hash  .store(message_hash,                         std::memory_order_relaxed);
+    slot.checksum      .store(checksum,                             std::memory_order_relaxed);
+    slot.serial.store(serial, std::memory_order_release);
 }
 
 void Store_log_sink::flush_()
@@ -2,11 +2,15 @@
 
 #include <fmt/core.h>
 #include <spdlog/spdlog.h>
+#include <spdlog/details/null_mutex.h>
 #include <spdlog/sinks/base_sink.h>
 
-#include <deque>
+#include <array>
+#include <atomic>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace erhe::log
 {
@@ -22,24 +26,49 @@ auto make_frame_logger(const std::string& name) -> std::shared_ptr<spdlog::logge
 class Entry
 {
 public:
-    uint64_t                  serial  {0};
-    bool                      selected{false};
-    std::string               timestamp;
-    std::string               message;
-    std::string               logger;
-    unsigned int              repeat_count{0};
+    uint64_t                  serial      {0};
+    int64_t                   timestamp_ns{0}; // std::chrono::system_clock, see timestamp_short()
+    uint32_t                  logger_id   {0}; // see Store_log_sink::get_logger_name()
     spdlog::level::level_enum level       {2/*spdlog::level::level_enum::SPDLOG_LEVEL_INFO*/};
+    std::string               message;         // reused by Store_log_sink::get_entry()
 };
 
-// Sink that keeps log entries in deqeue
+// Sink that keeps latest log entries in fixed capacity ring buffer.
+//
+// Producers do not lock: a slot is claimed by incrementing the serial, and
+// message bytes are copied to a byte ring (arena) claimed the same way.
+// Each slot is published seqlock style, so readers detect and skip slots
+// which are being written or have been overwritten. A producer which stalls
+// while the ring or the arena wraps can still overwrite a newer entry after
+// it was published; entries carry a checksum of their fields and message,
+// so readers reject such entries instead of returning them torn. Logger
+// names are interned once to small ids, and timestamps are kept raw and
+// formatted only when displayed.
 class Store_log_sink final
-    : public spdlog::sinks::base_sink<std::mutex>
+    : public spdlog::sinks::base_sink<spdlog::details::null_mutex>
 {
 public:
-    Store_log_sink();
+    static constexpr std::size_t s_default_capacity   {16384};
+    static constexpr std::size_t s_default_arena_size {1024 * 1024};
+    static constexpr std::size_t s_max_logger_count   {1024};
 
-    [[nodiscard]] auto get_serial() const -> uint64_t;
-    [[nodiscard]] auto get_log   () -> std::deque<Entry>&;
+    // Capacities are rounded up to power of two
+    explicit Store_log_sink(
+        std::size_t capacity   = s_default_capacity,
+        std::size_t arena_size = s_default_arena_size
+    );
+
+    // Serial of the latest entry; entries have serials first..latest
+    [[nodiscard]] auto get_serial      () const -> uint64_t;
+    [[nodiscard]] auto get_first_serial() const -> uint64_t;
+
+    // Returns false if entry with the serial is trimmed, overwritten or
+    // still being written. Message is copied only if with_message is set.
+    [[nodiscard]] auto get_entry(uint64_t serial, Entry& entry, bool with_message = true) const -> bool;
+
+    [[nodiscard]] auto get_logger_name(uint32_t logger_id) const -> std::string_view;
+
+    // Hides all but latest count entries
     void trim(std::size_t count);
 
 protected:
@@ -47,8 +76,38 @@ protected:
     void flush_  ()                                    override;
 
 private:
-    uint64_t          m_serial{0};
-    std::deque<Entry> m_entries;
+    class Slot
+    {
+    public:
+        // Fields other than serial are accessed relaxed; serial orders them
+        std::atomic<uint64_t>                  serial        {0}; // 0 while being written
+        std::atomic<int64_t>                   timestamp_ns  {0};
+        std::atomic<uint64_t>                  message_offset{0}; // unwrapped arena position
+        std::atomic<uint32_t>                  message_size  {0};
+        std::atomic<uint32_t>                  logger_id     {0};
+        std::atomic<spdlog::level::level_enum> level         {spdlog::level::info};
+        std::atomic<uint64_t>                  message_hash  {0};
+        std::atomic<uint64_t>                  checksum      {0}; // of serial and fields above
+    };
+
+    class Logger_name
+    {
+    public:
+        std::atomic<std::size_t> hash {0}; // 0 for free
+        std::atomic<bool>        ready{false};
+        std::string              name;
+    };
+
+    [[nodiscard]] auto intern_logger_name(std::string_view name) -> uint32_t;
+
+    std::vector<Slot>                           m_slots;
+    std::vector<std::atomic<char>>              m_arena; // readers may copy bytes being overwritten
+    std::array<Logger_name, s_max_logger_count> m_logger_names;
+    std::size_t                                 m_slot_mask  {0};
+    std::size_t                                 m_arena_mask {0};
+    std::atomic<uint64_t>                       m_serial     {0};
+    std::atomic<uint64_t>                       m_arena_head {0};
+    std::atomic<uint64_t>                       m_trim_serial{0};
 };
 
 [[nodiscard]] auto get_tail_store_log () -> const std::shared_ptr<Store_log_sink>&;
@@ -70,4 +70,27 @@ auto timestamp_short() -> std::string
     );
 }
 
+auto timestamp_short(const int64_t system_clock_ns) -> std::string
+{
+    const int64_t     ns_per_second = 1000000000;
+    const std::time_t seconds       = static_cast<std::time_t>(system_clock_ns / ns_per_second);
+    const int64_t     nanoseconds   = system_clock_ns % ns_per_second;
+
+    struct tm time;
+#if defined (_WIN32) // _MSC_VER
+    localtime_s(&time, &seconds);
+#else
+    localtime_r(&seconds, &time);
+#endif
+
+    // Write time
+    return fmt::format(
+        "{:02}:{:02}:{:02}.{:03d} ",
+        time.tm_hour,
+        time.tm_min,
+        time.tm_sec,
+        nanoseconds / 1000000
+    );
+}
+
 }
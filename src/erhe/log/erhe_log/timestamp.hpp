@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 namespace erhe::log
@@ -8,4 +9,7 @@ namespace erhe::log
 auto timestamp      () -> std::string;
 auto timestamp_short() -> std::string;
 
+// Formats std::chrono::system_clock time given in nanoseconds since epoch
+auto timestamp_short(int64_t system_clock_ns) -> std::string;
+
 }
@@ -1,49 +1,324 @@
 #pragma once
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
-#include <queue>
+#include <utility>
 #include <vector>
 
 namespace erhe::message_bus
 {
 
+// Identifies a receiver for remove_receiver(). 0 is never a valid handle.
+using Receiver_handle = uint64_t;
 
-//// TODO use something like https://github.com/TheWisp/signals instead
+// Statistics of one message kind, see Message_bus::set_statistics_kinds()
+class Message_bus_statistics
+{
+public:
+    uint64_t sent_count          {0}; // send_message() calls
+    uint64_t queued_count        {0}; // queue_message() calls
+    uint64_t coalesced_count     {0}; // queued messages merged into an earlier queued message
+    uint64_t dispatch_count      {0}; // messages delivered to receivers
+    uint64_t receiver_call_count {0};
+    uint64_t dispatch_time_ns    {0}; // total time spent in receivers, only with timing enabled
+    uint64_t max_dispatch_time_ns{0}; // slowest single message, only with timing enabled
+
+    void add(const Message_bus_statistics& other)
+    {
+        sent_count           += other.sent_count;
+        queued_count         += other.queued_count;
+        coalesced_count      += other.coalesced_count;
+        dispatch_count       += other.dispatch_count;
+        receiver_call_count  += other.receiver_call_count;
+        dispatch_time_ns     += other.dispatch_time_ns;
+        max_dispatch_time_ns  = std::max(max_dispatch_time_ns, other.max_dispatch_time_ns);
+    }
+};
+
+// Receivers are plain function pointers with a context pointer, or owned
+// std::function objects. Queued messages are kept in two reusable vectors,
+// so steady state queue / update does not allocate. Optionally, queued
+// messages with the same coalesce key are merged until the next update().
+// Statistics are kept per message kind; dispatch timing reads the clock
+// twice per message and is off unless enabled with set_timing_enabled().
 template <typename Message_type>
 class Message_bus
 {
 public:
-    void add_receiver(std::function<void(Message_type&)> message_receiver)
+    using Receiver_function = void (*)(void* context, Message_type& message);
+
+    // Returns 0 for messages that are never coalesced
+    using Coalesce_key_function = uint64_t (*)(const Message_type& message);
+
+    // Merges incoming into queued. When not set, incoming replaces queued.
+    using Coalesce_merge_function = void (*)(Message_type& queued, const Message_type& incoming);
+
+    // Returns statistics kind of message, less than kind count
+    using Kind_function = std::size_t (*)(const Message_type& message);
+
+    auto add_receiver(const Receiver_function function, void* const context) -> Receiver_handle
+    {
+        const Receiver_handle handle = ++m_last_handle;
+        m_receivers.push_back(
+            Receiver{
+                .function = function,
+                .context  = context,
+                .handle   = handle
+            }
+        );
+        return handle;
+    }
+
+    auto add_receiver(std::function<void(Message_type&)> message_receiver) -> Receiver_handle
+    {
+        auto owned = std::make_unique<std::function<void(Message_type&)>>(std::move(message_receiver));
+        void* const context = owned.get();
+        const Receiver_handle handle = add_receiver(
+            [](void* const function_context, Message_type& message) {
+                (*static_cast<std::function<void(Message_type&)>*>(function_context))(message);
+            },
+            context
+        );
+        m_receivers.back().owned_function = std::move(owned);
+        return handle;
+    }
+
+    // Safe to call from a receiver; the receiver is not called after this returns
+    void remove_receiver(const Receiver_handle handle)
+    {
+        for (Receiver& receiver : m_receivers) {
+            if (receiver.handle == handle) {
+                receiver.function = nullptr;
+                m_has_removed_receivers = true;
+                break;
+            }
+        }
+        if (m_dispatch_depth == 0) {
+            compact_receivers();
+        }
+    }
+
+    void set_coalescing(
+        const Coalesce_key_function   key_function,
+        const Coalesce_merge_function merge_function = nullptr
+    )
+    {
+        m_coalesce_key_function   = key_function;
+        m_coalesce_merge_function = merge_function;
+    }
+
+    // Without a kind function, all messages are counted as kind 0
+    // Not to be called from a receiver
+    void set_statistics_kinds(const Kind_function kind_function, const std::size_t kind_count)
     {
-        m_receivers.push_back(message_receiver);
+        m_kind_function = kind_function;
+        m_statistics.assign(std::max(std::size_t{1}, kind_count), Message_bus_statistics{});
     }
 
-    void send_message(Message_type message)
+    void set_timing_enabled(const bool enabled)
     {
-        for (auto iter = m_receivers.begin(); iter != m_receivers.end(); iter++) {
-            (*iter)(message);
+        m_timing_enabled = enabled;
+    }
+
+    [[nodiscard]] auto is_timing_enabled() const -> bool
+    {
+        return m_timing_enabled;
+    }
+
+    void send_message(Message_type& message)
+    {
+        Message_bus_statistics& statistics = get_kind_statistics(message);
+        ++statistics.sent_count;
+        dispatch(message, statistics);
+    }
+
+    void send_message(Message_type&& message)
+    {
+        send_message(message);
+    }
+
+    void queue_message(Message_type&& message)
+    {
+        Message_bus_statistics& statistics = get_kind_statistics(message);
+        ++statistics.queued_count;
+        const uint64_t key = (m_coalesce_key_function != nullptr) ? m_coalesce_key_function(message) : 0;
+        if (key != 0) {
+            std::size_t* const queued_index = find_or_insert_coalesce_key(key, m_queue.size());
+            if (*queued_index != m_queue.size()) {
+                ++statistics.coalesced_count;
+                Message_type& queued = m_queue[*queued_index];
+                if (m_coalesce_merge_function != nullptr) {
+                    m_coalesce_merge_function(queued, message);
+                } else {
+                    queued = std::move(message);
+                }
+                return;
+            }
         }
+        m_queue.push_back(std::move(message));
     }
 
-    void queue_message(Message_type message)
+    void queue_message(const Message_type& message)
     {
-        m_messages.push(message);
+        queue_message(Message_type{message});
     }
 
+    // Dispatches queued messages, including messages queued by receivers
     void update()
     {
-        while (!m_messages.empty()) {
-            for (auto iter = m_receivers.begin(); iter != m_receivers.end(); iter++) {
-                (*iter)(m_messages.front());
+        while (!m_queue.empty()) {
+            std::swap(m_queue, m_dispatch_queue);
+            clear_coalesce_keys();
+            for (Message_type& message : m_dispatch_queue) {
+                dispatch(message, get_kind_statistics(message));
             }
-            m_messages.pop();
+            m_dispatch_queue.clear();
         }
     }
 
+    // Indexed by message kind
+    [[nodiscard]] auto get_statistics() const -> const std::vector<Message_bus_statistics>&
+    {
+        return m_statistics;
+    }
+
+    [[nodiscard]] auto get_total_statistics() const -> Message_bus_statistics
+    {
+        Message_bus_statistics total;
+        for (const Message_bus_statistics& statistics : m_statistics) {
+            total.add(statistics);
+        }
+        return total;
+    }
+
+    void reset_statistics()
+    {
+        std::fill(m_statistics.begin(), m_statistics.end(), Message_bus_statistics{});
+    }
+
 private:
-    std::vector<std::function<void (Message_type&)>> m_receivers;
-    std::queue<Message_type>                         m_messages;
+    class Receiver
+    {
+    public:
+        Receiver_function                                   function      {nullptr};
+        void*                                               context       {nullptr};
+        Receiver_handle                                     handle        {0};
+        std::unique_ptr<std::function<void(Message_type&)>> owned_function{};
+    };
+
+    auto get_kind_statistics(const Message_type& message) -> Message_bus_statistics&
+    {
+        const std::size_t kind = (m_kind_function != nullptr) ? m_kind_function(message) : 0;
+        return m_statistics[std::min(kind, m_statistics.size() - 1)];
+    }
+
+    void dispatch(Message_type& message, Message_bus_statistics& statistics)
+    {
+        const auto start_time = m_timing_enabled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+
+        // Receivers added during dispatch do not see this message
+        ++m_dispatch_depth;
+        const std::size_t receiver_count = m_receivers.size();
+        for (std::size_t i = 0; i < receiver_count; ++i) {
+            // Copy before the call, add_receiver() may reallocate m_receivers
+            const Receiver_function function = m_receivers[i].function;
+            void* const             context  = m_receivers[i].context;
+            if (function != nullptr) {
+                function(context, message);
+                ++statistics.receiver_call_count;
+            }
+        }
+        --m_dispatch_depth;
+        if ((m_dispatch_depth == 0) && m_has_removed_receivers) {
+            compact_receivers();
+        }
+
+        ++statistics.dispatch_count;
+        if (m_timing_enabled) {
+            const auto     end_time = std::chrono::steady_clock::now();
+            const uint64_t time_ns  = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count()
+            );
+            statistics.dispatch_time_ns     += time_ns;
+            statistics.max_dispatch_time_ns = std::max(statistics.max_dispatch_time_ns, time_ns);
+        }
+    }
+
+    void compact_receivers()
+    {
+        m_receivers.erase(
+            std::remove_if(
+                m_receivers.begin(),
+                m_receivers.end(),
+                [](const Receiver& receiver) { return receiver.function == nullptr; }
+            ),
+            m_receivers.end()
+        );
+        m_has_removed_receivers = false;
+    }
+
+    // Open addressing table from coalesce key to m_queue index. Returns the
+    // slot value, which is set to index if key was not present.
+    auto find_or_insert_coalesce_key(const uint64_t key, const std::size_t index) -> std::size_t*
+    {
+        if ((m_coalesce_key_count + 1) * 2 > m_coalesce_keys.size()) {
+            grow_coalesce_keys();
+        }
+        const std::size_t mask = m_coalesce_keys.size() - 1;
+        for (std::size_t slot = ((key * 0x9e3779b97f4a7c15ull) >> 32) & mask;; slot = (slot + 1) & mask) {
+            if (m_coalesce_keys[slot] == key) {
+                return &m_coalesce_indices[slot];
+            }
+            if (m_coalesce_keys[slot] == 0) {
+                m_coalesce_keys   [slot] = key;
+                m_coalesce_indices[slot] = index;
+                ++m_coalesce_key_count;
+                return &m_coalesce_indices[slot];
+            }
+        }
+    }
+
+    void grow_coalesce_keys()
+    {
+        std::vector<uint64_t>    old_keys    = std::move(m_coalesce_keys);
+        std::vector<std::size_t> old_indices = std::move(m_coalesce_indices);
+        const std::size_t capacity = std::max(std::size_t{16}, old_keys.size() * 2);
+        m_coalesce_keys   .assign(capacity, 0);
+        m_coalesce_indices.assign(capacity, 0);
+        m_coalesce_key_count = 0;
+        for (std::size_t i = 0, end = old_keys.size(); i < end; ++i) {
+            if (old_keys[i] != 0) {
+                find_or_insert_coalesce_key(old_keys[i], old_indices[i]);
+            }
+        }
+    }
+
+    void clear_coalesce_keys()
+    {
+        if (m_coalesce_key_count > 0) {
+            std::fill(m_coalesce_keys.begin(), m_coalesce_keys.end(), 0);
+            m_coalesce_key_count = 0;
+        }
+    }
+
+    std::vector<Receiver>               m_receivers;
+    Receiver_handle                     m_last_handle            {0};
+    int                                 m_dispatch_depth         {0};
+    bool                                m_has_removed_receivers  {false};
+    std::vector<Message_type>           m_queue;
+    std::vector<Message_type>           m_dispatch_queue;
+    Coalesce_key_function               m_coalesce_key_function  {nullptr};
+    Coalesce_merge_function             m_coalesce_merge_function{nullptr};
+    std::vector<uint64_t>               m_coalesce_keys;
+    std::vector<std::size_t>            m_coalesce_indices;
+    std::size_t                         m_coalesce_key_count     {0};
+    Kind_function                       m_kind_function          {nullptr};
+    bool                                m_timing_enabled         {false};
+    std::vector<Message_bus_statistics> m_statistics             {Message_bus_statistics{}};
 };
 
 }
@@ -2,6 +2,9 @@
 #include "erhe_net/net_log.hpp"
 #include "erhe_net/net_os.hpp"
 #include "erhe_net/select_sockets.hpp"
+#if defined(ERHE_OS_LINUX)
+#   include "erhe_net/epoll_sockets.hpp"
+#endif
 
 
 namespace erhe::net
@@ -15,7 +18,10 @@ Client::~Client()
 }
 
 Client::Client(Client&& other) noexcept
-    : m_socket{std::move(other.m_socket)}
+    : m_socket       {std::move(other.m_socket)}
+#if defined(ERHE_OS_LINUX)
+    , m_epoll_sockets{std::move(other.m_epoll_sockets)}
+#endif
 {
     log_client->trace("Client move constructor");
 }
@@ -23,19 +29,41 @@ Client::Client(Client&& other) noexcept
 auto Client::operator=(Client&& other) noexcept -> Client&
 {
     log_client->trace("Client move assignment");
-    m_socket = std::move(other.m_socket);
+    m_socket        = std::move(other.m_socket);
+#if defined(ERHE_OS_LINUX)
+    m_epoll_sockets = std::move(other.m_epoll_sockets);
+#endif
     return *this;
 }
 
 auto Client::connect(const char* address, const int port) -> bool
 {
-    return m_socket.connect(address, port);
+    if (!m_socket.connect(address, port)) {
+        return false;
+    }
+#if defined(ERHE_OS_LINUX)
+    // A new epoll set for each connection, since socket fd may be reused
+    m_epoll_sockets = std::make_unique<Epoll_sockets>();
+    if (!m_epoll_sockets->is_valid() || !m_epoll_sockets->add(m_socket.get_socket(), nullptr)) {
+        log_client->warn("epoll is not available, using select()");
+        m_epoll_sockets.reset();
+    }
+    if (!m_epoll_sockets && !Select_sockets::is_selectable(m_socket.get_socket())) {
+        log_client->warn("select() cannot handle this connection");
+        disconnect();
+        return false;
+    }
+#endif
+    return true;
 }
 
 void Client::disconnect()
 {
     log_socket->trace("Socket move assignment");
     m_socket.close();
+#if defined(ERHE_OS_LINUX)
+    m_epoll_sockets.reset();
+#endif
 }
 
 auto Client::poll(const int timeout_ms) -> bool
@@ -43,6 +71,53 @@ auto Client::poll(const int timeout_ms) -> bool
     if (m_socket.get_state() == Socket::State::CLOSED) {
         return true; // NOP
     }
+#if defined(ERHE_OS_LINUX)
+    if (m_epoll_sockets) {
+        return poll_epoll(timeout_ms);
+    }
+#endif
+    return poll_select(timeout_ms);
+}
+
+#if defined(ERHE_OS_LINUX)
+auto Client::poll_epoll(const int timeout_ms) -> bool
+{
+    // Do not block while there is remaining work from earlier edges
+    const int wait_res = m_epoll_sockets->wait(m_socket.has_readiness_work() ? 0 : timeout_ms);
+    if (wait_res == SOCKET_ERROR) {
+        log_client->trace("client epoll_wait() returned error {}", get_net_last_error_message());
+        return false; // TODO
+    }
+    for (const epoll_event& event : m_epoll_sockets->get_events()) {
+        m_socket.add_readiness(
+            Epoll_sockets::is_readable(event),
+            Epoll_sockets::is_writable(event),
+            Epoll_sockets::is_error   (event)
+        );
+    }
+    if (!m_socket.has_readiness_work()) {
+        return true; // NOP
+    }
+
+    switch (m_socket.get_state()) {
+        case Socket::State::CLIENT_CONNECTING: {
+            m_socket.post_poll_connect();
+            break;
+        }
+        case Socket::State::CONNECTED: {
+            m_socket.post_poll_send_recv();
+            break;
+        }
+        default: {
+        }
+    }
+
+    return true;
+}
+#endif
+
+auto Client::poll_select(const int timeout_ms) -> bool
+{
     Select_sockets select_sockets;
 
     m_socket.pre_select(select_sockets);
@@ -2,9 +2,13 @@
 
 #include "erhe_net/socket.hpp"
 
+#include <memory>
+
 namespace erhe::net
 {
 
+class Epoll_sockets;
+
 class Client
 {
 public:
@@ -23,7 +27,15 @@ public:
     auto get_state          () -> Socket::State;
 
 private:
-    Socket m_socket;
+#if defined(ERHE_OS_LINUX)
+    auto poll_epoll (int timeout_ms) -> bool;
+#endif
+    auto poll_select(int timeout_ms) -> bool;
+
+    Socket                         m_socket;
+#if defined(ERHE_OS_LINUX)
+    std::unique_ptr<Epoll_sockets> m_epoll_sockets;
+#endif
 };
 
 } // namespace erhe::net
@@ -0,0 +1,86 @@
+#include "erhe_net/epoll_sockets.hpp"
+#include "erhe_net/net_log.hpp"
+
+namespace erhe::net
+{
+
+Epoll_sockets::Epoll_sockets()
+    : m_epoll_fd{epoll_create1(EPOLL_CLOEXEC)}
+{
+    if (m_epoll_fd == -1) {
+        log_net->error("epoll_create1() failed with error {}", get_net_last_error_message());
+    }
+    m_events.reserve(s_max_events);
+}
+
+Epoll_sockets::~Epoll_sockets() noexcept
+{
+    if (m_epoll_fd != -1) {
+        ::close(m_epoll_fd);
+    }
+}
+
+auto Epoll_sockets::is_valid() const -> bool
+{
+    return m_epoll_fd != -1;
+}
+
+auto Epoll_sockets::add(const SOCKET socket, Socket* const user_data) -> bool
+{
+    epoll_event event{};
+    event.events   = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.ptr = user_data;
+    const int result = epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, socket, &event);
+    if (result == -1) {
+        log_net->error("epoll_ctl(EPOLL_CTL_ADD) failed with error {}", get_net_last_error_message());
+        return false;
+    }
+    return true;
+}
+
+void Epoll_sockets::remove(const SOCKET socket)
+{
+    // Closing a socket removes it automatically; this is for sockets kept open
+    const int result = epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, socket, nullptr);
+    if (result == -1) {
+        log_net->warn("epoll_ctl(EPOLL_CTL_DEL) failed with error {}", get_net_last_error_message());
+    }
+}
+
+auto Epoll_sockets::wait(const int timeout_ms) -> int
+{
+    m_events.resize(s_max_events);
+    const int result = epoll_wait(m_epoll_fd, m_events.data(), s_max_events, timeout_ms);
+    if (result < 0) {
+        m_events.clear();
+        if (get_net_last_error() == EINTR) {
+            return 0;
+        }
+        return SOCKET_ERROR;
+    }
+    m_events.resize(static_cast<std::size_t>(result));
+    return result;
+}
+
+auto Epoll_sockets::get_events() const -> const std::vector<epoll_event>&
+{
+    return m_events;
+}
+
+auto Epoll_sockets::is_readable(const epoll_event& event) -> bool
+{
+    // Hangup and errors are reported by recv()
+    return (event.events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0;
+}
+
+auto Epoll_sockets::is_writable(const epoll_event& event) -> bool
+{
+    return (event.events & EPOLLOUT) != 0;
+}
+
+auto Epoll_sockets::is_error(const epoll_event& event) -> bool
+{
+    return (event.events & EPOLLERR) != 0;
+}
+
+}
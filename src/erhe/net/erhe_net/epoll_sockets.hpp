@@ -0,0 +1,48 @@
+#pragma once
+
+#include "erhe_net/net_os.hpp"
+
+#include <sys/epoll.h>
+
+#include <vector>
+
+namespace erhe::net
+{
+
+class Socket;
+
+// Edge triggered epoll set. Sockets are registered once for both read and
+// write readiness and stay registered until closed. Since readiness is
+// reported only as edges, owner keeps sockets with remaining work in its
+// own ready list until socket operations report EWOULDBLOCK.
+class Epoll_sockets
+{
+public:
+    static constexpr int s_max_events{1024};
+
+    Epoll_sockets();
+    ~Epoll_sockets() noexcept;
+    Epoll_sockets (const Epoll_sockets&) = delete;
+    void operator=(const Epoll_sockets&) = delete;
+    Epoll_sockets (Epoll_sockets&&)      = delete;
+    void operator=(Epoll_sockets&&)      = delete;
+
+    // user_data is returned in epoll_event::data.ptr
+    auto add   (SOCKET socket, Socket* user_data) -> bool;
+    void remove(SOCKET socket);
+
+    // Returns number of events, or SOCKET_ERROR
+    auto wait      (int timeout_ms) -> int;
+    auto get_events() const -> const std::vector<epoll_event>&;
+    auto is_valid  () const -> bool;
+
+    [[nodiscard]] static auto is_readable(const epoll_event& event) -> bool;
+    [[nodiscard]] static auto is_writable(const epoll_event& event) -> bool;
+    [[nodiscard]] static auto is_error   (const epoll_event& event) -> bool;
+
+private:
+    int                      m_epoll_fd{-1};
+    std::vector<epoll_event> m_events;
+};
+
+}
@@ -3,6 +3,8 @@
 #include <string.h>
 
 #include <fmt/format.h>
+
+#include <algorithm>
  
 namespace erhe::net
 {
@@ -187,9 +189,24 @@ auto is_error_busy(const int error_code) -> bool
     }
 }
 
+auto send_segments(const SOCKET socket, const Send_segment* const segments, const std::size_t segment_count) -> int
+{
+    iovec iov[s_max_send_segments];
+    const std::size_t count = (std::min)(segment_count, s_max_send_segments);
+    for (std::size_t i = 0; i < count; ++i) {
+        iov[i].iov_base = const_cast<uint8_t*>(segments[i].data);
+        iov[i].iov_len  = segments[i].length;
+    }
+    msghdr message{};
+    message.msg_iov    = iov;
+    message.msg_iovlen = count;
+    return static_cast<int>(::sendmsg(socket, &message, MSG_NOSIGNAL));
+}
+
+// FD_SETSIZE only limits select(), see Select_sockets::is_selectable()
 auto is_socket_good(const SOCKET socket) -> bool
 {
-    return (socket >= 0) && (socket <= FD_SETSIZE);
+    return socket >= 0;
 }
 
 auto set_socket_option(
@@ -213,7 +230,7 @@ auto set_socket_option(
             if (flags == -1) {
                 return false;
             }
-            flags = (value != 0) ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+            flags = (value != 0) ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
             result = fcntl(socket, F_SETFL, flags);
             break;
         }
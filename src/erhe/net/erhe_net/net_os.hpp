@@ -19,6 +19,7 @@ static constexpr int ERHE_NET_ERROR_CODE_CONNECTED = WSAEISCONN;
 #   include <sys/select.h>
 #   include <sys/socket.h>
 #   include <sys/types.h>
+#   include <sys/uio.h>
 #   include <unistd.h>
 
 // For now, pretent Windows like API... TODO fix
@@ -33,6 +34,8 @@ static constexpr int    SD_BOTH        = SHUT_RDWR;
 inline auto closesocket(const SOCKET s) -> int { return close(s); }
 #endif
 
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <string>
 
@@ -64,6 +67,19 @@ auto c_str(Socket_option) -> const char*;
 auto set_socket_option(SOCKET socket, Socket_option option, int value) -> bool;
 auto get_socket_option(SOCKET socket, Socket_option option) -> std::optional<int>;
 
+// Scatter-gather send; all segments are sent with a single system call.
+// Returns number of bytes sent, or SOCKET_ERROR.
+class Send_segment
+{
+public:
+    const uint8_t* data  {nullptr};
+    std::size_t    length{0};
+};
+
+static constexpr std::size_t s_max_send_segments{64};
+
+auto send_segments(SOCKET socket, const Send_segment* segments, std::size_t segment_count) -> int;
+
 auto initialize_net() -> bool;
 
 }
@@ -3,6 +3,7 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
 #include <cstdio>
 
 namespace erhe::net
@@ -184,6 +185,22 @@ auto is_error_busy(const int error_code) -> bool
     }
 }
 
+auto send_segments(const SOCKET socket, const Send_segment* const segments, const std::size_t segment_count) -> int
+{
+    WSABUF buffers[s_max_send_segments];
+    const std::size_t count = (std::min)(segment_count, s_max_send_segments);
+    for (std::size_t i = 0; i < count; ++i) {
+        buffers[i].buf = reinterpret_cast<CHAR*>(const_cast<uint8_t*>(segments[i].data));
+        buffers[i].len = static_cast<ULONG>(segments[i].length);
+    }
+    DWORD sent_byte_count{0};
+    const int result = WSASend(socket, buffers, static_cast<DWORD>(count), &sent_byte_count, 0, nullptr, nullptr);
+    if (result == SOCKET_ERROR) {
+        return SOCKET_ERROR;
+    }
+    return static_cast<int>(sent_byte_count);
+}
+
 auto is_socket_good(const SOCKET socket) -> bool
 {
     return socket != INVALID_SOCKET;
@@ -0,0 +1,46 @@
+#include "erhe_net/packet.hpp"
+
+#include <cstring>
+
+namespace erhe::net
+{
+
+Packet_header::Packet_header() = default;
+
+Packet_header::Packet_header(const uint32_t length)
+    : magic {erhe_header_magic_u32}
+    , length{length}
+{
+}
+
+Shared_payload::Shared_payload(const uint8_t* const data, const std::size_t length)
+{
+    const Packet_header header{static_cast<uint32_t>(length)};
+    m_bytes.resize(sizeof(Packet_header) + length);
+    std::memcpy(m_bytes.data(), &header, sizeof(Packet_header));
+    if (length > 0) {
+        std::memcpy(m_bytes.data() + sizeof(Packet_header), data, length);
+    }
+}
+
+auto Shared_payload::data() const -> const uint8_t*
+{
+    return m_bytes.data();
+}
+
+auto Shared_payload::size() const -> std::size_t
+{
+    return m_bytes.size();
+}
+
+auto Shared_payload::payload_size() const -> std::size_t
+{
+    return m_bytes.size() - sizeof(Packet_header);
+}
+
+auto make_shared_payload(const char* const data, const std::size_t length) -> std::shared_ptr<const Shared_payload>
+{
+    return std::make_shared<const Shared_payload>(reinterpret_cast<const uint8_t*>(data), length);
+}
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace erhe::net
+{
+
+//                                            E  r  h  e
+constexpr uint32_t erhe_header_magic_u32 = 0x45'72'68'65u;
+constexpr int      u32_byte_count        = sizeof(uint32_t);
+constexpr int      header_byte_count     = 2 * u32_byte_count;
+
+class Packet_header
+{
+public:
+    Packet_header();
+    explicit Packet_header(uint32_t length);
+
+    uint32_t magic {0};
+    uint32_t length{0};
+};
+
+// Immutable packet, including the header, which can be queued by reference
+// to any number of sockets. Used for broadcast, so that the message is not
+// copied to the send buffer of each client.
+class Shared_payload
+{
+public:
+    Shared_payload(const uint8_t* data, std::size_t length);
+
+    [[nodiscard]] auto data        () const -> const uint8_t*;
+    [[nodiscard]] auto size        () const -> std::size_t; // including header
+    [[nodiscard]] auto payload_size() const -> std::size_t; // excluding header
+
+private:
+    std::vector<uint8_t> m_bytes;
+};
+
+[[nodiscard]] auto make_shared_payload(const char* data, std::size_t length) -> std::shared_ptr<const Shared_payload>;
+
+}
@@ -1,5 +1,6 @@
 #include "erhe_net/ring_buffer.hpp"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
 
@@ -7,8 +8,8 @@ namespace erhe::net
 {
 
 Ring_buffer::Ring_buffer(const std::size_t capacity)
+    : m_buffer{std::make_unique_for_overwrite<uint8_t[]>(capacity)}
 {
-    m_buffer.resize(capacity);
     m_max_size = capacity;
     reset();
 }
@@ -65,32 +66,23 @@ auto Ring_buffer::size() const -> std::size_t
     return m_max_size + m_write_offset - m_read_offset;
 }
 
+// Moves readable bytes to the start of the buffer, so that they can be
+// consumed without wrap.
 void Ring_buffer::rotate()
 {
+    const std::size_t readable_byte_count = size();
     rotate(m_read_offset);
+    m_read_offset  = 0;
+    m_write_offset = readable_byte_count % m_max_size;
 }
 
 void Ring_buffer::rotate(std::size_t rotate_amount)
 {
-    size_t count  = 0;
-    size_t offset = 0;
-
-    while (count < m_max_size) {
-        size_t  to_index   = offset;
-        uint8_t tmp        = m_buffer[to_index];
-        size_t  from_index = (to_index + rotate_amount) % m_max_size;
-
-        while (from_index != offset) {
-            m_buffer[to_index] = m_buffer[from_index];
-            to_index   = from_index;
-            from_index = (to_index + rotate_amount) % m_max_size;
-            ++count;
-        }
-
-        m_buffer[to_index] = tmp;
-        ++count;
-        ++offset;
-    }
+    std::rotate(
+        m_buffer.get(),
+        m_buffer.get() + rotate_amount % m_max_size,
+        m_buffer.get() + m_max_size
+    );
 }
 
 auto Ring_buffer::size_available_for_write() const -> std::size_t
@@ -125,6 +117,9 @@ auto Ring_buffer::begin_produce(
 
 void Ring_buffer::end_produce(const std::size_t write_byte_count)
 {
+    if (write_byte_count == 0) {
+        return; // Nothing produced; empty buffer must not become full
+    }
     m_write_offset = (m_write_offset + write_byte_count) % m_max_size;
     m_full = (m_write_offset == m_read_offset);
 }
@@ -174,6 +169,11 @@ void Ring_buffer::end_consume(std::size_t byte_count)
     m_full        = false;
 }
 
+auto Ring_buffer::data() const -> const uint8_t*
+{
+    return m_buffer.get();
+}
+
 auto Ring_buffer::read(uint8_t* dst, const std::size_t byte_count) -> std::size_t
 {
     const std::size_t can_read_count = std::min(size_available_for_read(), byte_count);
@@ -1,7 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
-#include <vector>
+#include <memory>
 
 namespace erhe::net
 {
@@ -40,6 +41,9 @@ public:
     ) -> const uint8_t*;
     void end_consume             (std::size_t byte_count);
 
+    // Start of storage, where readable bytes continue after wrap
+    auto data                    () const -> const uint8_t*;
+
     auto read                    (uint8_t* dst, std::size_t byte_count) -> std::size_t;
     auto peek                    (uint8_t* dst, std::size_t byte_count) -> std::size_t;
 
@@ -49,11 +53,13 @@ public:
     void rotate                  (std::size_t amount);
 
 private:
-    std::vector<uint8_t> m_buffer;
-    std::size_t          m_read_offset {0};
-    std::size_t          m_write_offset{0};
-    std::size_t          m_max_size    {0};
-    bool                 m_full        {false};
+    // Not value initialized, so pages are only committed once written to.
+    // Each connection has two 4 MB buffers, most of which idle connections never touch.
+    std::unique_ptr<uint8_t[]> m_buffer;
+    std::size_t                m_read_offset {0};
+    std::size_t                m_write_offset{0};
+    std::size_t                m_max_size    {0};
+    bool                       m_full        {false};
 };
 
 }
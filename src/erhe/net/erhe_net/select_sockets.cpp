@@ -27,23 +27,36 @@ auto Select_sockets::has_except() const -> bool
     return (flags & flag_except) == flag_except;
 }
 
+auto Select_sockets::is_selectable(const SOCKET socket) -> bool
+{
+#if defined(ERHE_OS_LINUX)
+    // fd_set is a bitmask indexed by file descriptor
+    return (socket >= 0) && (socket < FD_SETSIZE);
+#else
+    return socket != INVALID_SOCKET;
+#endif
+}
+
 auto Select_sockets::has_read(const SOCKET socket) const -> bool
 {
-    return FD_ISSET(socket, &read_fds) == TRUE;
+    return is_selectable(socket) && FD_ISSET(socket, &read_fds) == TRUE;
 }
 
 auto Select_sockets::has_write(const SOCKET socket) const -> bool
 {
-    return FD_ISSET(socket, &write_fds) == TRUE;
+    return is_selectable(socket) && FD_ISSET(socket, &write_fds) == TRUE;
 }
 
 auto Select_sockets::has_except(const SOCKET socket) const -> bool
 {
-    return FD_ISSET(socket, &except_fds) == TRUE;
+    return is_selectable(socket) && FD_ISSET(socket, &except_fds) == TRUE;
 }
 
 void Select_sockets::set_read(const SOCKET socket)
 {
+    if (!is_selectable(socket)) {
+        return;
+    }
     FD_SET(socket, &read_fds);
     nfds = std::max(nfds, static_cast<int>(socket + 1));
     flags = flags | flag_read;
@@ -51,6 +64,9 @@ void Select_sockets::set_read(const SOCKET socket)
 
 void Select_sockets::set_write(const SOCKET socket)
 {
+    if (!is_selectable(socket)) {
+        return;
+    }
     FD_SET(socket, &write_fds );
     nfds = std::max(nfds, static_cast<int>(socket + 1));
     flags = flags | flag_write;
@@ -58,6 +74,9 @@ void Select_sockets::set_write(const SOCKET socket)
 
 void Select_sockets::set_except(const SOCKET socket)
 {
+    if (!is_selectable(socket)) {
+        return;
+    }
     FD_SET(socket, &except_fds);
     nfds = std::max(nfds, static_cast<int>(socket + 1));
     flags = flags | flag_except;
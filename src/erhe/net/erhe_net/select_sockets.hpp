@@ -25,6 +25,10 @@ public:
     void set_except(SOCKET socket);
     auto select    (int timeout_ms) -> int;
 
+    // False for sockets which cannot be put into fd_set. Those are
+    // ignored by set_*() and never reported by has_*().
+    [[nodiscard]] static auto is_selectable(SOCKET socket) -> bool;
+
     unsigned int flags{0};
     int          nfds{0};
     FD_SET       read_fds;
@@ -1,11 +1,16 @@
 #include "erhe_net/server.hpp"
 #include "erhe_net/net_log.hpp"
+#include "erhe_net/packet.hpp"
 #include "erhe_net/select_sockets.hpp"
+#if defined(ERHE_OS_LINUX)
+#   include "erhe_net/epoll_sockets.hpp"
+#endif
 
 #include "erhe_verify/verify.hpp"
 
 #include <fmt/format.h>
 
+#include <algorithm>
 
 namespace erhe::net
 {
@@ -18,9 +23,17 @@ Server::~Server()
 }
 
 Server::Server(Server&& other) noexcept
-    : m_listen_socket  {std::move(other.m_listen_socket)}
-    , m_receive_handler{std::move(other.m_receive_handler)}
-    , m_clients        {std::move(other.m_clients)}
+    : m_listen_socket        {std::move(other.m_listen_socket)}
+    , m_receive_handler      {std::move(other.m_receive_handler)}
+    , m_clients              {std::move(other.m_clients)}
+    , m_client_accept_numbers{std::move(other.m_client_accept_numbers)}
+    , m_has_closed_clients   {other.m_has_closed_clients}
+    , m_accepted_count       {other.m_accepted_count}
+#if defined(ERHE_OS_LINUX)
+    , m_epoll_sockets        {std::move(other.m_epoll_sockets)}
+    , m_ready                {std::move(other.m_ready)}
+    , m_next_ready           {std::move(other.m_next_ready)}
+#endif
 {
     log_server->trace("Server move constructor");
 }
@@ -28,15 +41,40 @@ Server::Server(Server&& other) noexcept
 auto Server::operator=(Server&& other) noexcept -> Server&
 {
     log_server->trace("Server move assignment");
-    m_listen_socket   = std::move(other.m_listen_socket);
-    m_receive_handler = std::move(other.m_receive_handler);
-    m_clients         = std::move(other.m_clients);
+    m_listen_socket         = std::move(other.m_listen_socket);
+    m_receive_handler       = std::move(other.m_receive_handler);
+    m_clients               = std::move(other.m_clients);
+    m_client_accept_numbers = std::move(other.m_client_accept_numbers);
+    m_has_closed_clients    = other.m_has_closed_clients;
+    m_accepted_count        = other.m_accepted_count;
+#if defined(ERHE_OS_LINUX)
+    m_epoll_sockets         = std::move(other.m_epoll_sockets);
+    m_ready                 = std::move(other.m_ready);
+    m_next_ready            = std::move(other.m_next_ready);
+#endif
     return *this;
 }
 
-auto Server::listen(const char* address, const int port) -> bool
+auto Server::listen(const char* address, const int port, const bool use_epoll) -> bool
 {
-    return m_listen_socket.bind(address, port);
+    if (!m_listen_socket.bind(address, port)) {
+        return false;
+    }
+#if defined(ERHE_OS_LINUX)
+    if (!use_epoll) {
+        m_epoll_sockets.reset();
+        return true;
+    }
+    // Listen socket is registered with nullptr user data
+    m_epoll_sockets = std::make_unique<Epoll_sockets>();
+    if (!m_epoll_sockets->is_valid() || !m_epoll_sockets->add(m_listen_socket.get_socket(), nullptr)) {
+        log_server->warn("epoll is not available, using select()");
+        m_epoll_sockets.reset();
+    }
+#else
+    static_cast<void>(use_epoll);
+#endif
+    return true;
 }
 
 auto Server::poll(const int timeout_ms) -> bool
@@ -45,12 +83,49 @@ auto Server::poll(const int timeout_ms) -> bool
         return true; // NOP
     }
 
+#if defined(ERHE_OS_LINUX)
+    if (m_epoll_sockets) {
+        return poll_epoll(timeout_ms);
+    }
+#endif
+    return poll_select(timeout_ms);
+}
+
+void Server::add_client(Socket&& socket)
+{
+    log_net->info("new client is connecting to server");
+    socket.set_receive_handler(m_receive_handler);
+    m_clients.push_back(std::make_unique<Socket>(std::move(socket)));
+    m_client_accept_numbers.push_back(m_accepted_count);
+    ++m_accepted_count;
+}
+
+void Server::remove_closed_clients()
+{
+    m_has_closed_clients = false;
+    std::size_t keep_count = 0;
+    for (std::size_t i = 0, end = m_clients.size(); i < end; ++i) {
+        if (m_clients[i]->get_state() == Socket::State::CLOSED) {
+            continue;
+        }
+        if (keep_count != i) {
+            m_clients              [keep_count] = std::move(m_clients[i]);
+            m_client_accept_numbers[keep_count] = m_client_accept_numbers[i];
+        }
+        ++keep_count;
+    }
+    m_clients              .resize(keep_count);
+    m_client_accept_numbers.resize(keep_count);
+}
+
+auto Server::poll_select(const int timeout_ms) -> bool
+{
     Select_sockets select_sockets;
 
     // Collect fds for select
     m_listen_socket.pre_select(select_sockets);
     for (auto& client : m_clients) {
-        client.pre_select(select_sockets);
+        client->pre_select(select_sockets);
     }
 
     // Call select() to find out if there is work to do
@@ -62,39 +137,146 @@ auto Server::poll(const int timeout_ms) -> bool
 
     // Perform send and receive for client sockets, collect closed sockets
     for (auto& client : m_clients) {
-        client.post_select_send_recv(select_sockets);
+        client->post_select_send_recv(select_sockets);
     }
 
-    // Remove closed sockets
-    m_clients.erase(
-        std::remove_if(
-            m_clients.begin(),
-            m_clients.end(),
-            [](Socket& client) {
-                return client.get_state() == Socket::State::CLOSED;
-            }
-        ),
-        m_clients.end()
-    );
+    remove_closed_clients();
 
     // Check for new clients
     auto new_socket = m_listen_socket.post_select_listen(select_sockets);
     if (new_socket.has_value()) {
-        log_net->info("new client is connecting to server");
-        new_socket.value().set_receive_handler(m_receive_handler);
-        m_clients.push_back(std::move(new_socket.value()));
+        if (!Select_sockets::is_selectable(new_socket.value().get_socket())) {
+            // Socket destructor closes the connection
+            log_net->warn("server select() cannot handle more connections, rejecting new client");
+            return true;
+        }
+        add_client(std::move(new_socket.value()));
     }
 
     return true;
 }
 
+#if defined(ERHE_OS_LINUX)
+void Server::accept_clients()
+{
+    while (m_listen_socket.has_readiness_work()) {
+        auto new_socket = m_listen_socket.post_poll_listen();
+        if (!new_socket.has_value()) {
+            break;
+        }
+        add_client(std::move(new_socket.value()));
+        Socket* client = m_clients.back().get();
+        if (!m_epoll_sockets->add(client->get_socket(), client)) {
+            client->close();
+            m_has_closed_clients = true;
+            continue;
+        }
+        // Edge for data which arrived before registration may be missed
+        client->add_readiness(true, true, false);
+        m_ready.push_back(client);
+    }
+}
+
+auto Server::poll_epoll(const int timeout_ms) -> bool
+{
+    // Do not block while there is remaining work from earlier edges
+    const int wait_res = m_epoll_sockets->wait(m_ready.empty() ? timeout_ms : 0);
+    if (wait_res == SOCKET_ERROR) {
+        log_net->trace("server epoll_wait() returned error {}", get_net_last_error_message());
+        return false; // TODO
+    }
+
+    for (const epoll_event& event : m_epoll_sockets->get_events()) {
+        Socket* socket = static_cast<Socket*>(event.data.ptr);
+        if (socket == nullptr) {
+            m_listen_socket.add_readiness(Epoll_sockets::is_readable(event), false, false);
+            continue;
+        }
+        socket->add_readiness(
+            Epoll_sockets::is_readable(event),
+            Epoll_sockets::is_writable(event),
+            Epoll_sockets::is_error   (event)
+        );
+        m_ready.push_back(socket);
+    }
+
+    accept_clients();
+
+    // Sockets can be both in the ready list and reported by events
+    std::sort(m_ready.begin(), m_ready.end());
+    m_ready.erase(std::unique(m_ready.begin(), m_ready.end()), m_ready.end());
+
+    // Only touch clients which have work, keep those which did not drain
+    m_next_ready.clear();
+    for (Socket* client : m_ready) {
+        static_cast<void>(client->post_poll_send_recv());
+        if (client->get_state() == Socket::State::CLOSED) {
+            m_has_closed_clients = true;
+            continue;
+        }
+        if (client->has_readiness_work()) {
+            m_next_ready.push_back(client);
+        }
+    }
+    std::swap(m_ready, m_next_ready);
+
+    if (m_has_closed_clients) {
+        // Closed sockets have been removed from the epoll set by close()
+        m_ready.erase(
+            std::remove_if(
+                m_ready.begin(),
+                m_ready.end(),
+                [](const Socket* client) {
+                    return client->get_state() == Socket::State::CLOSED;
+                }
+            ),
+            m_ready.end()
+        );
+        remove_closed_clients();
+    }
+
+    return true;
+}
+#endif
+
 auto Server::broadcast(const std::string& message) -> bool
+{
+    // Clients share the payload instead of each copying the message
+    return broadcast(make_shared_payload(message.data(), message.length()));
+}
+
+auto Server::broadcast(const std::shared_ptr<const Shared_payload>& payload) -> bool
+{
+    return broadcast(payload, 0, m_accepted_count);
+}
+
+auto Server::broadcast(
+    const std::shared_ptr<const Shared_payload>& payload,
+    const uint64_t                               first_accepted,
+    const uint64_t                               end_accepted
+) -> bool
 {
     std::size_t error_count = 0;
-    for (auto& client : m_clients) {
-        if (!client.send(message.data(), static_cast<int>(message.length()))) {
+    for (std::size_t i = 0, end = m_clients.size(); i < end; ++i) {
+        const uint64_t accept_number = m_client_accept_numbers[i];
+        if ((accept_number < first_accepted) || (accept_number >= end_accepted)) {
+            continue;
+        }
+        auto& client = m_clients[i];
+        if (client->get_state() != Socket::State::CONNECTED) {
+            continue; // Closed by earlier broadcast, removed in next poll()
+        }
+        if (!client->send(payload)) {
             ++error_count;
+            m_has_closed_clients = m_has_closed_clients || (client->get_state() == Socket::State::CLOSED);
+            continue;
+        }
+#if defined(ERHE_OS_LINUX)
+        // Data queued to a writable socket needs a pass through the ready list
+        if (m_epoll_sockets && client->has_readiness_work()) {
+            m_ready.push_back(client.get());
         }
+#endif
     }
     return error_count == 0;
 }
@@ -108,6 +290,13 @@ void Server::disconnect()
 {
     m_listen_socket.close();
     m_clients.clear();
+    m_client_accept_numbers.clear();
+    m_has_closed_clients = false;
+#if defined(ERHE_OS_LINUX)
+    m_epoll_sockets.reset();
+    m_ready.clear();
+    m_next_ready.clear();
+#endif
 }
 
 auto Server::get_state() const -> Socket::State
@@ -120,4 +309,23 @@ auto Server::get_client_count() const -> std::size_t
     return m_clients.size();
 }
 
+auto Server::get_accepted_count() const -> uint64_t
+{
+    return m_accepted_count;
+}
+
+auto Server::get_statistics() const -> Socket_statistics
+{
+    Socket_statistics sum;
+    for (const auto& client : m_clients) {
+        const Socket_statistics& statistics = client->get_statistics();
+        sum.bytes_queued       += statistics.bytes_queued;
+        sum.bytes_sent         += statistics.bytes_sent;
+        sum.send_syscalls      += statistics.send_syscalls;
+        sum.copies_avoided     += statistics.copies_avoided;
+        sum.copy_bytes_avoided += statistics.copy_bytes_avoided;
+    }
+    return sum;
+}
+
 }
@@ -2,9 +2,15 @@
 
 #include "erhe_net/socket.hpp"
 
+#include <memory>
+#include <vector>
+
 namespace erhe::net
 {
 
+class Epoll_sockets;
+class Shared_payload;
+
 class Server
 {
 public:
@@ -16,17 +22,41 @@ public:
     auto operator=(Server&& other) noexcept -> Server&;
 
     auto broadcast          (const std::string& message) -> bool;
+    auto broadcast          (const std::shared_ptr<const Shared_payload>& payload) -> bool;
+    // Sends only to clients accepted as first_accepted .. end_accepted - 1, see get_accepted_count()
+    auto broadcast          (const std::shared_ptr<const Shared_payload>& payload, uint64_t first_accepted, uint64_t end_accepted) -> bool;
     void set_receive_handler(Receive_handler receive_handler);
     void disconnect         ();
-    auto listen             (const char* address, int port) -> bool;
+    auto listen             (const char* address, int port, bool use_epoll = true) -> bool; // use_epoll = false forces select()
     auto poll               (int timeout_ms) -> bool;
     auto get_state          () const -> Socket::State;
     auto get_client_count   () const -> std::size_t;
+    auto get_accepted_count () const -> uint64_t; // clients accepted since construction
+    auto get_statistics     () const -> Socket_statistics; // sum over connected clients
 
 private:
-    Socket              m_listen_socket;
-    Receive_handler     m_receive_handler;
-    std::vector<Socket> m_clients;
+#if defined(ERHE_OS_LINUX)
+    auto poll_epoll         (int timeout_ms) -> bool;
+    void accept_clients     ();
+#endif
+    auto poll_select        (int timeout_ms) -> bool;
+    void add_client         (Socket&& socket);
+    void remove_closed_clients();
+
+    Socket                               m_listen_socket;
+    Receive_handler                      m_receive_handler;
+    std::vector<std::unique_ptr<Socket>> m_clients;
+    std::vector<uint64_t>                m_client_accept_numbers; // parallel to m_clients
+    bool                                 m_has_closed_clients{false};
+    uint64_t                             m_accepted_count{0};
+
+#if defined(ERHE_OS_LINUX)
+    // Clients are kept in the ready list until they run out of work, since
+    // edge triggered epoll reports readiness only once.
+    std::unique_ptr<Epoll_sockets>       m_epoll_sockets;
+    std::vector<Socket*>                 m_ready;
+    std::vector<Socket*>                 m_next_ready;
+#endif
 };
 
 }
@@ -1,6 +1,7 @@
 #include "erhe_net/socket.hpp"
 #include "erhe_net/net_os.hpp"
 #include "erhe_net/net_log.hpp"
+#include "erhe_net/packet.hpp"
 #include "erhe_net/select_sockets.hpp"
 #include "erhe_verify/verify.hpp"
 
@@ -10,21 +11,6 @@
 namespace erhe::net
 {
 
-//                                            E  r  h  e
-constexpr uint32_t erhe_header_magic_u32 = 0x45'72'68'65u;
-constexpr int      u32_byte_count        = sizeof(uint32_t);
-constexpr int      header_byte_count     = 2 * u32_byte_count;
-
-class Packet_header
-{
-public:
-    Packet_header();
-    explicit Packet_header(uint32_t length);
-
-    uint32_t magic {0};
-    uint32_t length{0};
-};
-
 auto c_str(const Socket::State state) -> const char*
 {
     switch (state) {
@@ -36,14 +22,6 @@ auto c_str(const Socket::State state) -> const char*
     };
 }
 
-Packet_header::Packet_header() = default;
-
-Packet_header::Packet_header(const uint32_t length)
-    : magic {erhe_header_magic_u32}
-    , length{length}
-{
-}
-
 Socket::Socket()
 {
     log_socket->trace("Socket default constructor");
@@ -86,8 +64,14 @@ Socket::Socket(Socket&& other) noexcept
     , m_address        {std::move(other.m_address)}
     , m_state          {other.m_state}
     , m_send_buffer    {std::move(other.m_send_buffer)}
+    , m_send_queue     {std::move(other.m_send_queue)}
+    , m_send_queue_size{other.m_send_queue_size}
     , m_receive_buffer {std::move(other.m_receive_buffer)}
     , m_receive_handler{std::move(other.m_receive_handler)}
+    , m_statistics     {other.m_statistics}
+    , m_readable       {other.m_readable}
+    , m_writable       {other.m_writable}
+    , m_error          {other.m_error}
 {
     log_socket->trace("Socket move constructor");
     other.m_socket    = INVALID_SOCKET;
@@ -104,8 +88,14 @@ auto Socket::operator=(Socket&& other) noexcept -> Socket&
     m_address         = std::move(other.m_address);
     m_state           = other.m_state;
     m_send_buffer     = std::move(other.m_send_buffer);
+    m_send_queue      = std::move(other.m_send_queue);
+    m_send_queue_size = other.m_send_queue_size;
     m_receive_buffer  = std::move(other.m_receive_buffer);
     m_receive_handler = std::move(other.m_receive_handler);
+    m_statistics      = other.m_statistics;
+    m_readable        = other.m_readable;
+    m_writable        = other.m_writable;
+    m_error           = other.m_error;
     other.m_socket    = INVALID_SOCKET;
     other.m_state     = State::CLOSED;
     other.m_addr_info = nullptr;
@@ -115,11 +105,16 @@ auto Socket::operator=(Socket&& other) noexcept -> Socket&
 void Socket::close()
 {
     set_state(State::CLOSED);
+    m_readable = false;
+    m_writable = false;
+    m_error    = false;
     if (m_addr_info != nullptr) {
         freeaddrinfo(m_addr_info);
         m_addr_info = nullptr;
     }
     m_send_buffer.reset();
+    m_send_queue.clear();
+    m_send_queue_size = 0;
     m_receive_buffer.reset();
     if (is_socket_good(m_socket)) {
         log_socket->info("Closing socket");
@@ -226,7 +221,7 @@ auto Socket::bind(const char* const address, const int port) -> bool
         return false;
     }
 
-    const int backlog = 8;
+    const int backlog = SOMAXCONN;
     const int listen_res = listen(m_socket, backlog);
     if (listen_res == SOCKET_ERROR) {
         log_socket->error("listen() failed with error {}", get_net_last_error_message());
@@ -241,54 +236,105 @@ auto Socket::bind(const char* const address, const int port) -> bool
     return true;
 }
 
-// Attempts to send some or all of the data queued in send buffer.
+// Attempts to send some or all of the data queued in send queue.
+// Send buffer segments (up to two when the ring buffer wraps around) and
+// shared payloads are gathered to a single send call.
 // Returns true if no error, returns false in case of error.
 auto Socket::send_pending() -> bool
 {
     ERHE_VERIFY(m_state == State::CONNECTED);
     ERHE_VERIFY(m_send_buffer);
 
-    // Loop (at most) twice, for the case where the ring buffer
-    // wraps around, in which case two send() calls are needed.
     for (;;) {
-        if (m_send_buffer->empty()) {
+        if (m_send_queue.empty()) {
             return true;
         }
 
         std::size_t          can_send_byte_count_before_wrap{0};
         std::size_t          can_send_byte_count_after_wrap {0};
-        const uint8_t* const read_pointer    = m_send_buffer->begin_consume(can_send_byte_count_before_wrap, can_send_byte_count_after_wrap);
-        const int            send_result     = ::send(m_socket, reinterpret_cast<const char*>(read_pointer), static_cast<int>(can_send_byte_count_before_wrap), 0);
-        const int            sent_byte_count = (std::max)(0, send_result);
-        if (can_send_byte_count_after_wrap > 0) {
-            log_socket->info("send() before wrap {} bytes, after wrap {} bytes", can_send_byte_count_before_wrap, can_send_byte_count_after_wrap);
+        const uint8_t* const read_pointer = m_send_buffer->begin_consume(can_send_byte_count_before_wrap, can_send_byte_count_after_wrap);
+        m_send_buffer->end_consume(0);
+
+        // Gather segments in send queue order
+        Send_segment segments[s_max_send_segments];
+        std::size_t  segment_count   {0};
+        std::size_t  ring_offset     {0};
+        std::size_t  total_byte_count{0};
+        for (const Send_item& item : m_send_queue) {
+            if (segment_count == s_max_send_segments) {
+                break;
+            }
+            if (item.payload) {
+                segments[segment_count++] = Send_segment{
+                    .data   = item.payload->data() + item.payload->size() - item.byte_count,
+                    .length = item.byte_count
+                };
+                total_byte_count += item.byte_count;
+                continue;
+            }
+            std::size_t remaining_byte_count = item.byte_count;
+            if (ring_offset < can_send_byte_count_before_wrap) {
+                const std::size_t length = (std::min)(remaining_byte_count, can_send_byte_count_before_wrap - ring_offset);
+                segments[segment_count++] = Send_segment{.data = read_pointer + ring_offset, .length = length};
+                remaining_byte_count -= length;
+                ring_offset          += length;
+                total_byte_count     += length;
+            }
+            if ((remaining_byte_count > 0) && (segment_count < s_max_send_segments)) {
+                const std::size_t after_wrap_offset = ring_offset - can_send_byte_count_before_wrap;
+                segments[segment_count++] = Send_segment{.data = m_send_buffer->data() + after_wrap_offset, .length = remaining_byte_count};
+                ring_offset      += remaining_byte_count;
+                total_byte_count += remaining_byte_count;
+            }
         }
+
+        const int send_result = send_segments(m_socket, segments, segment_count);
+        ++m_statistics.send_syscalls;
         if (send_result < 0) {
-            m_send_buffer->end_consume(0);
             const int error_code = get_net_last_error();
             if (is_error_fatal(error_code))
             {
                 log_socket->error(
-                    "send({} bytes) failed with error {}",
-                    can_send_byte_count_before_wrap,
+                    "send({} bytes in {} segments) failed with error {}",
+                    total_byte_count,
+                    segment_count,
                     get_net_error_message(error_code)
                 );
                 close();
                 return false;
             }
+            m_writable = false;
             return true;
         }
-        m_send_buffer->end_consume(sent_byte_count);
-        if (
-            (sent_byte_count < can_send_byte_count_before_wrap) ||
-            (can_send_byte_count_after_wrap == 0)
-        ) {
+        const std::size_t sent_byte_count = static_cast<std::size_t>(send_result);
+        m_statistics.bytes_sent += sent_byte_count;
+        consume_sent(sent_byte_count);
+        if (sent_byte_count < total_byte_count) {
+            m_writable = false; // Socket send buffer is full
             break;
         }
     }
     return true;
 }
 
+void Socket::consume_sent(std::size_t byte_count)
+{
+    m_send_queue_size -= byte_count;
+    while (byte_count > 0) {
+        ERHE_VERIFY(!m_send_queue.empty());
+        Send_item&        item  = m_send_queue.front();
+        const std::size_t count = (std::min)(byte_count, item.byte_count);
+        if (!item.payload) {
+            m_send_buffer->end_consume(count);
+        }
+        item.byte_count -= count;
+        byte_count      -= count;
+        if (item.byte_count == 0) {
+            m_send_queue.pop_front();
+        }
+    }
+}
+
 // Sends a packet. Returns true if there was no error, false if there was an error.
 auto Socket::send(const char* const data, const int length) -> bool
 {
@@ -305,7 +351,6 @@ auto Socket::send(const char* const data, const int length) -> bool
         // Check again how much fits
         can_write_count = m_send_buffer->size_available_for_write();
         if (can_write_count < sizeof(Packet_header) + length) {
-            m_send_buffer->end_produce(0);
             log_socket->warn("message ({} bytes) does not fit to send queue ({} bytes free)", length, can_write_count);
             return false;
         }
@@ -320,10 +365,53 @@ auto Socket::send(const char* const data, const int length) -> bool
     const auto payload_byte_write_count = m_send_buffer->write(reinterpret_cast<const uint8_t*>(data), static_cast<size_t>(length));
     ERHE_VERIFY(payload_byte_write_count == length);
 
+    // Consecutive copied packets share one send queue entry
+    const std::size_t byte_count = sizeof(Packet_header) + static_cast<std::size_t>(length);
+    if (m_send_queue.empty() || m_send_queue.back().payload) {
+        m_send_queue.push_back(Send_item{.payload = {}, .byte_count = byte_count});
+    } else {
+        m_send_queue.back().byte_count += byte_count;
+    }
+    m_send_queue_size         += byte_count;
+    m_statistics.bytes_queued += byte_count;
+
     // Try to send some or all of the queued send buffer
     return send_pending();
 }
 
+// Queues a shared packet by reference. The queued size is limited to the
+// send buffer capacity, so that slow receivers do not grow memory use.
+auto Socket::send(const std::shared_ptr<const Shared_payload>& payload) -> bool
+{
+    ERHE_VERIFY(m_state == State::CONNECTED);
+    ERHE_VERIFY(payload);
+
+    const std::size_t byte_count = payload->size();
+    if (m_send_queue_size + byte_count > m_send_buffer->max_size()) {
+        const auto send_pending_result = send_pending();
+        if (!send_pending_result) {
+            return false;
+        }
+        if (m_send_queue_size + byte_count > m_send_buffer->max_size()) {
+            log_socket->warn("message ({} bytes) does not fit to send queue ({} bytes queued)", payload->payload_size(), m_send_queue_size);
+            return false;
+        }
+    }
+
+    m_send_queue.push_back(Send_item{.payload = payload, .byte_count = byte_count});
+    m_send_queue_size               += byte_count;
+    m_statistics.bytes_queued       += byte_count;
+    m_statistics.copies_avoided     += 1;
+    m_statistics.copy_bytes_avoided += byte_count;
+
+    return send_pending();
+}
+
+auto Socket::get_statistics() const -> const Socket_statistics&
+{
+    return m_statistics;
+}
+
 auto Socket::receive_packet_length() -> uint32_t
 {
     ERHE_VERIFY(m_state == State::CONNECTED);
@@ -366,7 +454,8 @@ auto Socket::recv() -> bool
                 close();
                 return false;
             }
-            return true; // non-fatal error
+            m_readable = false;
+            return true; // non-fatal error, would block
         }
         m_receive_buffer->end_produce(received_byte_count);
         if (recv_result == 0) {
@@ -411,10 +500,11 @@ auto Socket::recv() -> bool
             m_receive_buffer->end_consume(header_byte_count + next_packet_length);
         }
 
-        if (
-            (received_byte_count < can_receive_byte_count_before_wrap) ||
-            (can_receive_byte_count_after_wrap == 0)
-        ) {
+        if (received_byte_count < can_receive_byte_count_before_wrap) {
+            m_readable = false; // Short read, socket receive buffer is drained
+            break;
+        }
+        if (can_receive_byte_count_after_wrap == 0) {
             break;
         }
     }
@@ -454,13 +544,41 @@ void Socket::pre_select(Select_sockets& select_sockets)
 // returns false in case of error, true if ok
 auto Socket::post_select_send_recv(Select_sockets& select_sockets) -> bool
 {
-    if (select_sockets.has_write(m_socket)) {
+    // select() is level triggered, so readiness is replaced, not accumulated
+    m_readable = select_sockets.has_read (m_socket);
+    m_writable = select_sockets.has_write(m_socket);
+    m_error    = false;
+    return post_poll_send_recv();
+}
+
+void Socket::add_readiness(const bool readable, const bool writable, const bool error)
+{
+    m_readable = m_readable || readable;
+    m_writable = m_writable || writable;
+    m_error    = m_error    || error;
+}
+
+auto Socket::has_readiness_work() const -> bool
+{
+    switch (m_state) {
+        case State::CLOSED:            return false;
+        case State::SERVER_LISTENING:  return m_readable;
+        case State::CLIENT_CONNECTING: return m_writable || m_error;
+        case State::CONNECTED:         return m_readable || (m_writable && has_pending_writes());
+        default:                       return false;
+    }
+}
+
+// returns false in case of error, true if ok
+auto Socket::post_poll_send_recv() -> bool
+{
+    if (m_writable) {
         const bool send_ok = send_pending();
         if (!send_ok) {
             return false;
         }
     }
-    if (select_sockets.has_read(m_socket)) {
+    if (m_readable && (m_state == State::CONNECTED)) {
         const bool recv_ok = recv();
         if (!recv_ok) {
             return false;
@@ -518,7 +636,17 @@ auto Socket::connect() -> bool
 // returns false in case of error, true if ok
 auto Socket::post_select_connect(Select_sockets& select_sockets) -> bool
 {
-    if (select_sockets.has_except(m_socket)) {
+    m_readable = false;
+    m_writable = select_sockets.has_write (m_socket);
+    m_error    = select_sockets.has_except(m_socket);
+    return post_poll_connect();
+}
+
+// returns false in case of error, true if ok
+auto Socket::post_poll_connect() -> bool
+{
+    if (m_error) {
+        m_error = false;
         // connection attempt failed. retry
         connect();
 
@@ -534,8 +662,7 @@ auto Socket::post_select_connect(Select_sockets& select_sockets) -> bool
         return false;
     }
 
-    const bool is_writable = select_sockets.has_write(m_socket);
-    if (is_writable) {
+    if (m_writable) {
         // man connect:
         // > After select(2) indicates writability, use getsockopt(2) to read the SO_ERROR option at
         // > level SOL_SOCKET to determine whether connect() completed successfully (SO_ERROR is zero)
@@ -567,26 +694,38 @@ auto Socket::post_select_connect(Select_sockets& select_sockets) -> bool
 
 auto Socket::post_select_listen(Select_sockets& select_sockets) -> std::optional<Socket>
 {
-    if (select_sockets.has_read(m_socket)) {
-        log_socket->info("Server post_select_listen() has readable socket");
+    m_readable = select_sockets.has_read(m_socket);
+    return post_poll_listen();
+}
 
-        sockaddr_in  address{};
-        socklen_t    len        = sizeof(address);
-        const SOCKET accept_res = ::accept(m_socket, reinterpret_cast<sockaddr*>(&address), &len);
-        if (!is_socket_good(accept_res)) {
-            const int error_code = get_net_last_error();
-            if (!is_error_busy(error_code)) {
-                log_socket->warn("Server accept() failed with error {}", get_net_error_message(error_code));
-                return {};
-            }
-        } else {
-            // TODO check if already added
-            // TODO set buffer sizes
-            log_socket->info("Server accept(): new connection");
-            return Socket{accept_res, address};
+// Accepts at most one connection. Readiness is cleared unless a connection
+// was accepted, so callers can loop while has_readiness_work().
+auto Socket::post_poll_listen() -> std::optional<Socket>
+{
+    if (!m_readable) {
+        return {};
+    }
+    m_readable = false;
+
+    sockaddr_in  address{};
+    socklen_t    len        = sizeof(address);
+    const SOCKET accept_res = ::accept(m_socket, reinterpret_cast<sockaddr*>(&address), &len);
+    if (!is_socket_good(accept_res)) {
+        const int error_code = get_net_last_error();
+        if (!is_error_busy(error_code)) {
+            log_socket->warn("Server accept() failed with error {}", get_net_error_message(error_code));
         }
+        return {};
+    }
+
+    // TODO check if already added
+    // TODO set buffer sizes
+    log_socket->info("Server accept(): new connection");
+    m_readable = true; // There may be more pending connections
+    if (!set_socket_option(accept_res, Socket_option::NonBlocking, true)) {
+        log_socket->warn("Server accept(): setting non-blocking failed");
     }
-    return {};
+    return Socket{accept_res, address};
 }
 
 }
@@ -3,6 +3,7 @@
 #include "erhe_net/ring_buffer.hpp"
 #include "erhe_net/net_os.hpp"
 
+#include <deque>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -15,6 +16,17 @@ namespace erhe::net
 using Receive_handler = std::function<void(const uint8_t* data, std::size_t length)>;
 
 class Select_sockets;
+class Shared_payload;
+
+class Socket_statistics
+{
+public:
+    uint64_t bytes_queued      {0}; // copied and shared
+    uint64_t bytes_sent        {0};
+    uint64_t send_syscalls     {0};
+    uint64_t copies_avoided    {0}; // shared payloads queued by reference
+    uint64_t copy_bytes_avoided{0};
+};
 
 class Socket
 {
@@ -42,24 +54,45 @@ public:
     auto get_socket          () const -> SOCKET                { return m_socket; }
     auto get_sockaddr_in     () const -> const sockaddr_in&    { return m_address_in; }
     auto get_address_string  () const -> const std::string&    { return m_address; }
-    auto get_send_buffer_size() const -> size_t                { return m_send_buffer ? m_send_buffer->size() : 0; }
+    auto get_send_buffer_size() const -> size_t                { return m_send_queue_size; }
     auto send                (const char* data, int length) -> bool;
+    auto send                (const std::shared_ptr<const Shared_payload>& payload) -> bool;
     auto send_pending        () -> bool;
     auto recv                () -> bool;
     auto get_receive_buffer  () -> Ring_buffer* { return m_receive_buffer.get(); }
     void close               ();
-    auto has_pending_writes  () -> bool         { return m_send_buffer ? !m_send_buffer->empty() : false; }
+    auto has_pending_writes  () const -> bool   { return !m_send_queue.empty(); }
+    auto get_statistics      () const -> const Socket_statistics&;
 
     void pre_select           (Select_sockets& select_sockets);
     auto post_select_send_recv(Select_sockets& select_sockets) -> bool;
     auto post_select_connect  (Select_sockets& select_sockets) -> bool;
     auto post_select_listen   (Select_sockets& select_sockets) -> std::optional<Socket>;
 
+    // Readiness reported by select() or epoll. Readiness is cleared when
+    // socket operations report that they would block, so edge triggered
+    // readiness is not lost while there is remaining work.
+    void add_readiness     (bool readable, bool writable, bool error);
+    auto has_readiness_work() const -> bool;
+    auto post_poll_send_recv() -> bool;
+    auto post_poll_connect  () -> bool;
+    auto post_poll_listen   () -> std::optional<Socket>;
+
     auto connect(const char* address, int port) -> bool; // for client
     auto bind   (const char* address, int port) -> bool; // for server
 
 private:
+    // Send queue entry; bytes from send buffer if payload is nullptr,
+    // otherwise the last byte_count bytes of payload.
+    class Send_item
+    {
+    public:
+        std::shared_ptr<const Shared_payload> payload;
+        std::size_t                           byte_count{0};
+    };
+
     auto connect              () -> bool;
+    void consume_sent         (std::size_t byte_count);
     void set_state            (State state);
     void on_state_changed     (State old_state, State new_state);
     auto receive_packet_length() -> uint32_t;
@@ -70,8 +103,14 @@ private:
     std::string                  m_address;
     State                        m_state     {State::CLOSED};
     std::unique_ptr<Ring_buffer> m_send_buffer;
+    std::deque<Send_item>        m_send_queue;
+    std::size_t                  m_send_queue_size{0}; // bytes
     std::unique_ptr<Ring_buffer> m_receive_buffer;
     Receive_handler              m_receive_handler;
+    Socket_statistics            m_statistics;
+    bool                         m_readable  {false};
+    bool                         m_writable  {false};
+    bool                         m_error     {false};
 };
 
 auto c_str(const Socket::State state) -> const char*;
@@ -131,18 +131,21 @@ IWorld::~IWorld() noexcept
 {
 }
 
-auto IWorld::create() -> IWorld*
+auto IWorld::create(erhe::concurrency::Thread_pool* thread_pool) -> IWorld*
 {
+    static_cast<void>(thread_pool);
     return new Bullet_world();
 }
 
-auto IWorld::create_shared() -> std::shared_ptr<IWorld>
+auto IWorld::create_shared(erhe::concurrency::Thread_pool* thread_pool) -> std::shared_ptr<IWorld>
 {
+    static_cast<void>(thread_pool);
     return std::make_shared<Bullet_world>();
 }
 
-auto IWorld::create_unique() -> std::unique_ptr<IWorld>
+auto IWorld::create_unique(erhe::concurrency::Thread_pool* thread_pool) -> std::unique_ptr<IWorld>
 {
+    static_cast<void>(thread_pool);
     return std::make_unique<Bullet_world>();
 }
 
@@ -191,6 +194,33 @@ void Bullet_world::remove_rigid_body(IRigid_body* rigid_body)
     m_bullet_dynamics_world.removeRigidBody(bullet_rigid_body->get_bullet_rigid_body());
 }
 
+void Bullet_world::add_rigid_bodies(const gsl::span<IRigid_body* const> rigid_bodies)
+{
+    // Bullet has no batch insertion; the dbvt broadphase is rebalanced
+    // incrementally, see optimize_broad_phase()
+    for (IRigid_body* rigid_body : rigid_bodies) {
+        add_rigid_body(rigid_body);
+    }
+}
+
+void Bullet_world::remove_rigid_bodies(const gsl::span<IRigid_body* const> rigid_bodies)
+{
+    for (IRigid_body* rigid_body : rigid_bodies) {
+        remove_rigid_body(rigid_body);
+    }
+}
+
+void Bullet_world::optimize_broad_phase()
+{
+    m_bullet_broadphase_interface.optimize();
+}
+
+void Bullet_world::get_active_body_transforms(Rigid_body_transforms& out)
+{
+    // Not supported, bullet rigid bodies do not have owners
+    out.clear();
+}
+
 void Bullet_world::add_constraint(IConstraint* constraint)
 {
     // log_physics.info("add_constraint()\n");
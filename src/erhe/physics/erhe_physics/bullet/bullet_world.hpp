@@ -61,10 +61,14 @@ public:
     void set_gravity            (const glm::vec3 gravity) override;
     void add_rigid_body         (IRigid_body* rigid_body) override;
     void remove_rigid_body      (IRigid_body* rigid_body) override;
+    void add_rigid_bodies       (gsl::span<IRigid_body* const> rigid_bodies) override;
+    void remove_rigid_bodies    (gsl::span<IRigid_body* const> rigid_bodies) override;
+    void optimize_broad_phase   ()                        override;
     void add_constraint         (IConstraint* constraint) override;
     void remove_constraint      (IConstraint* constraint) override;
     void set_debug_drawer       (IDebug_draw* debug_draw) override;
     void debug_draw             ()                        override;
+    void get_active_body_transforms(Rigid_body_transforms& out) override;
 
 private:
     Debug_draw_adapter                  m_debug_draw_adapter;
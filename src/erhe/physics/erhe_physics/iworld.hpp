@@ -2,12 +2,17 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtx/quaternion.hpp>
+#include <gsl/span>
 
 #include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
+namespace erhe::concurrency {
+    class Thread_pool;
+}
+
 namespace erhe::physics
 {
 
@@ -16,14 +21,38 @@ class IDebug_draw;
 class IRigid_body;
 class IRigid_body_create_info;
 
+// Structure of arrays of rigid body transforms, see IWorld::get_active_body_transforms()
+class Rigid_body_transforms
+{
+public:
+    void clear()
+    {
+        rigid_bodies.clear();
+        owners      .clear();
+        positions   .clear();
+        rotations   .clear();
+    }
+
+    [[nodiscard]] auto size() const -> std::size_t
+    {
+        return rigid_bodies.size();
+    }
+
+    std::vector<IRigid_body*> rigid_bodies;
+    std::vector<void*>        owners;    // IRigid_body::get_owner()
+    std::vector<glm::vec3>    positions; // world space
+    std::vector<glm::quat>    rotations; // world space
+};
+
 class IWorld
 {
 public:
     virtual ~IWorld() noexcept;
 
-    [[nodiscard]] static auto create       () -> IWorld*;
-    [[nodiscard]] static auto create_shared() -> std::shared_ptr<IWorld>;
-    [[nodiscard]] static auto create_unique() -> std::unique_ptr<IWorld>;
+    // When thread_pool is set, backends run their jobs on it instead of own threads
+    [[nodiscard]] static auto create       (erhe::concurrency::Thread_pool* thread_pool = nullptr) -> IWorld*;
+    [[nodiscard]] static auto create_shared(erhe::concurrency::Thread_pool* thread_pool = nullptr) -> std::shared_ptr<IWorld>;
+    [[nodiscard]] static auto create_unique(erhe::concurrency::Thread_pool* thread_pool = nullptr) -> std::unique_ptr<IWorld>;
 
     [[nodiscard]] virtual auto create_rigid_body       (
         const IRigid_body_create_info& create_info,
@@ -44,6 +73,9 @@ public:
     virtual void update_fixed_step      (double dt)                                      = 0;
     virtual void add_rigid_body         (IRigid_body* rigid_body)                        = 0;
     virtual void remove_rigid_body      (IRigid_body* rigid_body)                        = 0;
+    virtual void add_rigid_bodies       (gsl::span<IRigid_body* const> rigid_bodies)    = 0;
+    virtual void remove_rigid_bodies    (gsl::span<IRigid_body* const> rigid_bodies)    = 0;
+    virtual void optimize_broad_phase   ()                                               = 0;
     virtual void add_constraint         (IConstraint* constraint)                        = 0;
     virtual void remove_constraint      (IConstraint* constraint)                        = 0;
     virtual void set_gravity            (const glm::vec3& gravity)                       = 0;
@@ -53,6 +85,9 @@ public:
     virtual void set_on_body_activated  (std::function<void(IRigid_body*)> callback)     = 0;
     virtual void set_on_body_deactivated(std::function<void(IRigid_body*)> callback)     = 0;
     virtual void for_each_active_body   (std::function<void(IRigid_body*)> callback)     = 0;
+
+    // Replaces contents of out with transforms of active dynamic rigid bodies
+    virtual void get_active_body_transforms(Rigid_body_transforms& out)                  = 0;
 };
 
 } // namespace erhe::physics
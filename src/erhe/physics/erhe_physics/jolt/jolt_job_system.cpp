@@ -0,0 +1,118 @@
+#include "erhe_physics/jolt/jolt_job_system.hpp"
+#include "erhe_concurrency/thread_pool.hpp"
+
+#include <chrono>
+#include <thread>
+
+namespace erhe::physics
+{
+
+Jolt_job_system::Jolt_job_system(
+    erhe::concurrency::Thread_pool& thread_pool,
+    const unsigned int              max_jobs,
+    const unsigned int              max_barriers
+)
+    : JPH::JobSystemWithBarrier{max_barriers}
+    , m_thread_pool            {thread_pool}
+{
+    m_jobs.Init(max_jobs, max_jobs);
+}
+
+Jolt_job_system::~Jolt_job_system() noexcept
+{
+    // Thread pool tasks hold references to jobs, which point back to this
+    while (m_tasks_in_flight.load(std::memory_order_acquire) > 0) {
+        std::this_thread::yield();
+    }
+}
+
+auto Jolt_job_system::GetMaxConcurrency() const -> int
+{
+    // Workers plus the thread waiting on barriers
+    return m_thread_pool.size() + 1;
+}
+
+auto Jolt_job_system::CreateJob(
+    const char*         inName,
+    const JPH::ColorArg inColor,
+    const JobFunction&  inJobFunction,
+    const JPH::uint32   inNumDependencies
+) -> JobHandle
+{
+    JPH::uint32 index{Available_jobs::cInvalidObjectIndex};
+    for (;;) {
+        index = m_jobs.ConstructObject(inName, inColor, this, inJobFunction, inNumDependencies);
+        if (index != Available_jobs::cInvalidObjectIndex) {
+            break;
+        }
+        // Out of jobs; wait for running jobs to be freed
+        std::this_thread::sleep_for(std::chrono::microseconds{100});
+    }
+    m_job_count.fetch_add(1, std::memory_order_relaxed);
+
+    Job* const job = &m_jobs.Get(index);
+    JobHandle handle{job};
+    if (inNumDependencies == 0) {
+        QueueJob(job);
+    }
+    return handle;
+}
+
+void Jolt_job_system::QueueJob(Job* const inJob)
+{
+    // Reference is released by execute()
+    inJob->AddRef();
+    m_tasks_in_flight.fetch_add(1, std::memory_order_relaxed);
+    m_thread_pool.enqueue(
+        [this, inJob]() {
+            execute(inJob);
+        }
+    );
+}
+
+void Jolt_job_system::QueueJobs(Job** const inJobs, const JPH::uint inNumJobs)
+{
+    for (JPH::uint i = 0; i < inNumJobs; ++i) {
+        QueueJob(inJobs[i]);
+    }
+}
+
+void Jolt_job_system::FreeJob(Job* const inJob)
+{
+    m_jobs.DestructObject(inJob);
+}
+
+void Jolt_job_system::execute(Job* const job)
+{
+    // Barrier waits may have executed the job already; Execute() is then a no-op
+    if (!job->IsDone()) {
+        const auto start_time = std::chrono::steady_clock::now();
+        job->Execute();
+        const auto end_time   = std::chrono::steady_clock::now();
+        m_worker_job_count.fetch_add(1, std::memory_order_relaxed);
+        m_worker_job_ns.fetch_add(
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count()),
+            std::memory_order_relaxed
+        );
+    }
+    job->Release();
+    m_tasks_in_flight.fetch_sub(1, std::memory_order_release);
+}
+
+auto Jolt_job_system::get_statistics() const -> Jolt_job_statistics
+{
+    return Jolt_job_statistics{
+        .job_count        = m_job_count       .load(std::memory_order_relaxed),
+        .worker_job_count = m_worker_job_count.load(std::memory_order_relaxed),
+        .worker_job_ns    = m_worker_job_ns   .load(std::memory_order_relaxed)
+    };
+}
+
+void Jolt_job_system::reset_statistics()
+{
+    m_job_count       .store(0, std::memory_order_relaxed);
+    m_worker_job_count.store(0, std::memory_order_relaxed);
+    m_worker_job_ns   .store(0, std::memory_order_relaxed);
+}
+
+} // namespace erhe::physics
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/FixedSizeFreeList.h>
+#include <Jolt/Core/JobSystemWithBarrier.h>
+
+#include <atomic>
+#include <cstdint>
+
+namespace erhe::concurrency {
+    class Thread_pool;
+}
+
+namespace erhe::physics
+{
+
+class Jolt_job_statistics
+{
+public:
+    uint64_t job_count       {0}; // jobs created
+    uint64_t worker_job_count{0}; // jobs executed by thread pool workers
+    uint64_t worker_job_ns   {0}; // time spent executing jobs in thread pool workers
+};
+
+// Runs Jolt jobs as tasks of an erhe::concurrency::Thread_pool, so physics
+// shares workers with the rest of the application instead of owning threads.
+// Jobs which are not yet picked up by workers when a barrier is waited on
+// are executed by the waiting thread.
+class Jolt_job_system
+    : public JPH::JobSystemWithBarrier
+{
+public:
+    Jolt_job_system(
+        erhe::concurrency::Thread_pool& thread_pool,
+        unsigned int                    max_jobs,
+        unsigned int                    max_barriers
+    );
+    ~Jolt_job_system() noexcept override;
+
+    // Implements JPH::JobSystem
+    auto GetMaxConcurrency() const -> int override;
+    auto CreateJob        (const char* inName, JPH::ColorArg inColor, const JobFunction& inJobFunction, JPH::uint32 inNumDependencies = 0) -> JobHandle override;
+
+    // Public API
+    [[nodiscard]] auto get_statistics() const -> Jolt_job_statistics;
+    void reset_statistics();
+
+protected:
+    // Implements JPH::JobSystem
+    void QueueJob (Job* inJob) override;
+    void QueueJobs(Job** inJobs, JPH::uint inNumJobs) override;
+    void FreeJob  (Job* inJob) override;
+
+private:
+    using Available_jobs = JPH::FixedSizeFreeList<Job>;
+
+    void execute(Job* job);
+
+    erhe::concurrency::Thread_pool& m_thread_pool;
+    Available_jobs                  m_jobs;
+    std::atomic<int>                m_tasks_in_flight {0};
+    std::atomic<uint64_t>           m_job_count       {0};
+    std::atomic<uint64_t>           m_worker_job_count{0};
+    std::atomic<uint64_t>           m_worker_job_ns   {0};
+};
+
+} // namespace erhe::physics
@@ -1,17 +1,24 @@
 #include "erhe_physics/jolt/jolt_world.hpp"
+#include "erhe_concurrency/thread_pool.hpp"
+#include "erhe_configuration/configuration.hpp"
 #include "erhe_log/log_glm.hpp"
 #include "erhe_physics/jolt/jolt_constraint.hpp"
 #include "erhe_physics/jolt/jolt_rigid_body.hpp"
 #include "erhe_physics/jolt/glm_conversions.hpp"
 #include "erhe_physics/idebug_draw.hpp"
 #include "erhe_physics/physics_log.hpp"
+#include "erhe_profile/profile.hpp"
 #include "erhe_verify/verify.hpp"
 
 #include <Jolt/RegisterTypes.h>
 #include <Jolt/Core/Factory.h>
+#include <Jolt/Core/JobSystemThreadPool.h>
 #include <Jolt/Physics/Body/Body.h>
 
+#include <algorithm>
+#include <chrono>
 #include <cstdarg>
+#include <thread>
 
 namespace erhe::physics
 {
@@ -155,19 +162,19 @@ IWorld::~IWorld() noexcept
 {
 }
 
-auto IWorld::create() -> IWorld*
+auto IWorld::create(erhe::concurrency::Thread_pool* thread_pool) -> IWorld*
 {
-    return new Jolt_world();
+    return new Jolt_world(thread_pool);
 }
 
-auto IWorld::create_shared() -> std::shared_ptr<IWorld>
+auto IWorld::create_shared(erhe::concurrency::Thread_pool* thread_pool) -> std::shared_ptr<IWorld>
 {
-    return std::make_shared<Jolt_world>();
+    return std::make_shared<Jolt_world>(thread_pool);
 }
 
-auto IWorld::create_unique() -> std::unique_ptr<IWorld>
+auto IWorld::create_unique(erhe::concurrency::Thread_pool* thread_pool) -> std::unique_ptr<IWorld>
 {
-    return std::make_unique<Jolt_world>();
+    return std::make_unique<Jolt_world>(thread_pool);
 }
 
 //// void register_empty_shape();
@@ -189,14 +196,44 @@ Jolt_world::Initialize_first::Initialize_first()
     ////register_empty_shape();
 }
 
-Jolt_world::Jolt_world()
-    : m_temp_allocator{10 * 1024 * 1024}
-    , m_job_system    {JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, 10}
+Jolt_world::Config::Config()
 {
+    auto ini = erhe::configuration::get_ini("erhe.ini", "physics");
+    std::size_t temp_allocator_megabytes = temp_allocator_size / (1024 * 1024);
+    ini->get("temp_allocator_size", temp_allocator_megabytes);
+    int job_threads = static_cast<int>(job_thread_count);
+    ini->get("job_threads",         job_threads);
+    job_thread_count = static_cast<unsigned int>(std::max(0, job_threads));
+    int max_body_count = static_cast<int>(max_bodies);
+    ini->get("max_bodies",          max_body_count);
+    max_bodies = static_cast<unsigned int>(std::max(1, max_body_count));
+    temp_allocator_size = std::max(std::size_t{1}, temp_allocator_megabytes) * 1024 * 1024;
+}
+
+Jolt_world::Jolt_world(erhe::concurrency::Thread_pool* const thread_pool)
+    : m_temp_allocator{static_cast<JPH::uint>(m_config.temp_allocator_size)}
+{
+    if (thread_pool != nullptr) {
+        auto job_system = std::make_unique<Jolt_job_system>(*thread_pool, JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers);
+        m_pool_job_system = job_system.get();
+        m_job_system = std::move(job_system);
+    } else {
+        const unsigned int thread_count = (m_config.job_thread_count > 0)
+            ? m_config.job_thread_count
+            : std::max(std::thread::hardware_concurrency(), 2U) - 1;
+        m_job_system = std::make_unique<JPH::JobSystemThreadPool>(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, static_cast<int>(thread_count));
+    }
+    log_physics->info(
+        "Jolt job system: {}, max concurrency {}, temp allocator {} MB",
+        (thread_pool != nullptr) ? "shared thread pool" : "own threads",
+        m_job_system->GetMaxConcurrency(),
+        m_config.temp_allocator_size / (1024 * 1024)
+    );
+
     //m_debug_renderer              = std::make_unique<Jolt_debug_renderer             >();
     m_broad_phase_layer_interface = std::make_unique<Broad_phase_layer_interface_impl>();
     m_physics_system.Init(
-        cMaxBodies,
+        m_config.max_bodies,
         cNumBodyMutexes,
         cMaxBodyPairs,
         cMaxContactConstraints,
@@ -227,13 +264,38 @@ void Jolt_world::update_fixed_step(const double dt)
     // int inCollisionSteps, 
     // TempAllocator *inTempAllocator, 
     // JobSystem *inJobSystem
+    if (m_pool_job_system != nullptr) {
+        m_pool_job_system->reset_statistics();
+    }
+    const auto start_time = std::chrono::steady_clock::now();
     m_physics_system.Update(
         static_cast<float>(dt),
         cCollisionSteps,
         //cIntegrationSubSteps,
         &m_temp_allocator,
-        &m_job_system
+        m_job_system.get()
     );
+    const auto end_time = std::chrono::steady_clock::now();
+
+    ++m_step_statistics.step_count;
+    m_step_statistics.step_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count()
+    );
+    if (m_pool_job_system != nullptr) {
+        m_step_statistics.jobs = m_pool_job_system->get_statistics();
+    }
+    log_physics_frame->trace(
+        "step {} us, {} jobs, {} on workers taking {} us",
+        m_step_statistics.step_ns / 1000,
+        m_step_statistics.jobs.job_count,
+        m_step_statistics.jobs.worker_job_count,
+        m_step_statistics.jobs.worker_job_ns / 1000
+    );
+}
+
+auto Jolt_world::get_step_statistics() const -> const Jolt_step_statistics&
+{
+    return m_step_statistics;
 }
 
 auto Jolt_world::describe() const -> std::vector<std::string>
@@ -252,6 +314,12 @@ auto Jolt_world::describe() const -> std::vector<std::string>
     out.push_back(fmt::format("num kinematic = {}",        body_stats.mNumBodiesKinematic));
     out.push_back(fmt::format("num static = {}",           body_stats.mNumBodiesStatic));
     out.push_back(fmt::format("num bodies = {}",           body_stats.mNumBodies));
+    out.push_back(fmt::format("step time = {} us",         m_step_statistics.step_ns / 1000));
+    if (m_pool_job_system != nullptr) {
+        out.push_back(fmt::format("step jobs = {}",            m_step_statistics.jobs.job_count));
+        out.push_back(fmt::format("step worker jobs = {}",     m_step_statistics.jobs.worker_job_count));
+        out.push_back(fmt::format("step worker time = {} us",  m_step_statistics.jobs.worker_job_ns / 1000));
+    }
     return out;
 }
 
@@ -319,6 +387,97 @@ void Jolt_world::remove_rigid_body(IRigid_body* rigid_body)
     }
 }
 
+void Jolt_world::add_rigid_bodies(const gsl::span<IRigid_body* const> rigid_bodies)
+{
+    // Single broad phase insertion for the whole batch, instead of one
+    // AddBody() per body which fragments the broad phase tree.
+    m_batch_body_ids.clear();
+    m_batch_body_ids.reserve(rigid_bodies.size());
+    for (IRigid_body* rigid_body : rigid_bodies) {
+        auto* jolt_rigid_body = reinterpret_cast<Jolt_rigid_body*>(rigid_body);
+        ERHE_VERIFY(jolt_rigid_body != nullptr);
+
+        auto* jolt_body = jolt_rigid_body->get_jolt_body();
+        ERHE_VERIFY(jolt_body != nullptr);
+        if (jolt_body == &JPH::Body::sFixedToWorld) {
+            continue;
+        }
+
+#ifndef NDEBUG
+        const auto i = std::find(m_rigid_bodies.begin(), m_rigid_bodies.end(), jolt_rigid_body);
+        if (i != m_rigid_bodies.end()) {
+            log_physics->error("rigid body {} already in world", rigid_body->get_debug_label());
+            continue;
+        }
+#endif
+        m_batch_body_ids.push_back(jolt_body->GetID());
+        m_rigid_bodies.push_back(jolt_rigid_body);
+    }
+    if (m_batch_body_ids.empty()) {
+        return;
+    }
+
+    auto&      body_interface = m_physics_system.GetBodyInterface();
+    const int  count          = static_cast<int>(m_batch_body_ids.size());
+    const auto add_state      = body_interface.AddBodiesPrepare(m_batch_body_ids.data(), count);
+    body_interface.AddBodiesFinalize(m_batch_body_ids.data(), count, add_state, JPH::EActivation::DontActivate);
+
+    log_physics->trace("added {} rigid bodies (total {})", count, m_physics_system.GetNumBodies());
+}
+
+void Jolt_world::remove_rigid_bodies(const gsl::span<IRigid_body* const> rigid_bodies)
+{
+    std::vector<Jolt_rigid_body*> removed;
+    removed.reserve(rigid_bodies.size());
+    m_batch_body_ids.clear();
+    m_batch_body_ids.reserve(rigid_bodies.size());
+    for (IRigid_body* rigid_body : rigid_bodies) {
+        auto* jolt_rigid_body = reinterpret_cast<Jolt_rigid_body*>(rigid_body);
+        ERHE_VERIFY(jolt_rigid_body != nullptr);
+
+        auto* jolt_body = jolt_rigid_body->get_jolt_body();
+        ERHE_VERIFY(jolt_body != nullptr);
+        if (jolt_body == &JPH::Body::sFixedToWorld) {
+            continue;
+        }
+        removed.push_back(jolt_rigid_body);
+    }
+    std::sort(removed.begin(), removed.end());
+    removed.erase(std::unique(removed.begin(), removed.end()), removed.end());
+
+    // One pass over m_rigid_bodies; only bodies actually in the world are
+    // passed to RemoveBodies()
+    const auto i = std::remove_if(
+        m_rigid_bodies.begin(),
+        m_rigid_bodies.end(),
+        [this, &removed](Jolt_rigid_body* jolt_rigid_body) {
+            if (!std::binary_search(removed.begin(), removed.end(), jolt_rigid_body)) {
+                return false;
+            }
+            m_batch_body_ids.push_back(jolt_rigid_body->get_jolt_body()->GetID());
+            return true;
+        }
+    );
+    m_rigid_bodies.erase(i, m_rigid_bodies.end());
+    if (m_batch_body_ids.size() != removed.size()) {
+        log_physics->error("{} rigid bodies not in world", removed.size() - m_batch_body_ids.size());
+    }
+    if (m_batch_body_ids.empty()) {
+        return;
+    }
+
+    auto& body_interface = m_physics_system.GetBodyInterface();
+    body_interface.RemoveBodies(m_batch_body_ids.data(), static_cast<int>(m_batch_body_ids.size()));
+
+    log_physics->trace("removed {} rigid bodies (total {})", m_batch_body_ids.size(), m_physics_system.GetNumBodies());
+}
+
+void Jolt_world::optimize_broad_phase()
+{
+    log_physics->trace("optimize broad phase");
+    m_physics_system.OptimizeBroadPhase();
+}
+
 void Jolt_world::add_constraint(IConstraint* constraint)
 {
     log_physics->trace("add constraint");
@@ -417,6 +576,35 @@ void Jolt_world::for_each_active_body(std::function<void(IRigid_body*)> callback
     }
 }
 
+void Jolt_world::get_active_body_transforms(Rigid_body_transforms& out)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    out.clear();
+
+    const JPH::BodyID*                  active_rigid_bodies     = m_physics_system.GetActiveBodiesUnsafe(JPH::EBodyType::RigidBody);
+    const JPH::uint32                   active_rigid_body_count = m_physics_system.GetNumActiveBodies(JPH::EBodyType::RigidBody);
+    const JPH::BodyLockInterfaceNoLock& body_lock_interface     = m_physics_system.GetBodyLockInterfaceNoLock();
+    out.rigid_bodies.reserve(active_rigid_body_count);
+    out.owners      .reserve(active_rigid_body_count);
+    out.positions   .reserve(active_rigid_body_count);
+    out.rotations   .reserve(active_rigid_body_count);
+    for (JPH::uint32 i = 0; i < active_rigid_body_count; ++i) {
+        const JPH::Body* body = body_lock_interface.TryGetBody(active_rigid_bodies[i]);
+        if ((body == nullptr) || !body->IsDynamic()) {
+            continue;
+        }
+        Jolt_rigid_body* jolt_rigid_body = reinterpret_cast<Jolt_rigid_body*>(body->GetUserData());
+        if (jolt_rigid_body == nullptr) {
+            continue;
+        }
+        out.rigid_bodies.push_back(jolt_rigid_body);
+        out.owners      .push_back(jolt_rigid_body->get_owner());
+        out.positions   .push_back(from_jolt(body->GetPosition()));
+        out.rotations   .push_back(from_jolt(body->GetRotation()));
+    }
+}
+
 void Jolt_world::OnBodyActivated(
     const JPH::BodyID& inBodyID,
     JPH::uint64        inBodyUserData
@@ -1,10 +1,11 @@
 #pragma once
 
 #include "erhe_physics/iworld.hpp"
+#include "erhe_physics/jolt/jolt_job_system.hpp"
 
 #include <Jolt/Jolt.h>
 #include <Jolt/Core/TempAllocator.h>
-#include <Jolt/Core/JobSystemThreadPool.h>
+#include <Jolt/Core/JobSystem.h>
 #include <Jolt/Physics/PhysicsSystem.h>
 #include <Jolt/Physics/Collision/BroadPhase/BroadPhaseLayer.h>
 #include <Jolt/Physics/Collision/ContactListener.h>
@@ -39,6 +40,14 @@ static constexpr uint8_t NUM_LAYERS    = 3u;
 
 };
 
+class Jolt_step_statistics
+{
+public:
+    uint64_t            step_count{0};
+    uint64_t            step_ns   {0}; // duration of the latest PhysicsSystem::Update()
+    Jolt_job_statistics jobs;          // jobs of the latest step, only when using shared thread pool
+};
+
 class Jolt_collision_filter
     : public JPH::ObjectVsBroadPhaseLayerFilter
     , public JPH::ObjectLayerPairFilter
@@ -56,7 +65,7 @@ class Jolt_world
     , public JPH::ContactListener
 {
 public:
-    Jolt_world();
+    explicit Jolt_world(erhe::concurrency::Thread_pool* thread_pool);
     virtual ~Jolt_world() noexcept override;
 
     // Implements IWorld
@@ -79,6 +88,9 @@ public:
     void set_gravity         (const glm::vec3& gravity)           override;
     void add_rigid_body      (IRigid_body* rigid_body)            override;
     void remove_rigid_body   (IRigid_body* rigid_body)            override;
+    void add_rigid_bodies    (gsl::span<IRigid_body* const> rigid_bodies) override;
+    void remove_rigid_bodies (gsl::span<IRigid_body* const> rigid_bodies) override;
+    void optimize_broad_phase()                                   override;
     void add_constraint      (IConstraint* constraint)            override;
     void remove_constraint   (IConstraint* constraint)            override;
     void set_debug_drawer    (IDebug_draw* debug_draw)            override;
@@ -88,6 +100,7 @@ public:
     void set_on_body_activated  (std::function<void(IRigid_body*)> callback) override;
     void set_on_body_deactivated(std::function<void(IRigid_body*)> callback) override;
     void for_each_active_body   (std::function<void(IRigid_body*)> callback) override;
+    void get_active_body_transforms(Rigid_body_transforms& out)              override;
 
     // Implements BodyActivationListener
     void OnBodyActivated  (const JPH::BodyID& inBodyID, JPH::uint64 inBodyUserData) override;
@@ -105,6 +118,7 @@ public:
 
     // Public API
     [[nodiscard]] auto get_physics_system() -> JPH::PhysicsSystem&;
+    [[nodiscard]] auto get_step_statistics() const -> const Jolt_step_statistics&;
 
 private:
     class Initialize_first
@@ -114,7 +128,17 @@ private:
     };
     Initialize_first m_initialize_first;
 
-    static constexpr unsigned int cMaxBodies             = 1024 * 32;
+    class Config
+    {
+    public:
+        Config();
+
+        std::size_t  temp_allocator_size{10 * 1024 * 1024};
+        unsigned int job_thread_count   {0}; // only used without thread pool, 0 selects from hardware concurrency
+        unsigned int max_bodies         {1024 * 32};
+    };
+    const Config m_config;
+
     static constexpr unsigned int cNumBodyMutexes        = 0;
     static constexpr unsigned int cMaxBodyPairs          = 1024 * 8;
     static constexpr unsigned int cMaxContactConstraints = 1024;
@@ -123,7 +147,9 @@ private:
     const Jolt_collision_filter                    m_collision_filter;
 
     JPH::TempAllocatorImpl                         m_temp_allocator;
-    JPH::JobSystemThreadPool                       m_job_system;
+    Jolt_job_system*                               m_pool_job_system{nullptr}; // when using shared thread pool
+    std::unique_ptr<JPH::JobSystem>                m_job_system;
+    Jolt_step_statistics                           m_step_statistics;
     std::unique_ptr<JPH::BroadPhaseLayerInterface> m_broad_phase_layer_interface;
     JPH::PhysicsSystem                             m_physics_system;
     //std::unique_ptr<Jolt_debug_renderer>           m_debug_renderer;
@@ -133,6 +159,7 @@ private:
 
     std::vector<Jolt_rigid_body*>                  m_rigid_bodies;
     std::vector<Jolt_constraint*>                  m_constraints;
+    std::vector<JPH::BodyID>                       m_batch_body_ids;
 
     std::vector<std::shared_ptr<ICollision_shape>> m_collision_shapes;
 
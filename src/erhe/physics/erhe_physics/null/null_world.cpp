@@ -7,21 +7,26 @@
 
 #include "erhe_profile/profile.hpp"
 
+#include <algorithm>
+
 namespace erhe::physics
 {
 
-auto IWorld::create() -> IWorld*
+auto IWorld::create(erhe::concurrency::Thread_pool* thread_pool) -> IWorld*
 {
+    static_cast<void>(thread_pool);
     return new Null_world();
 }
 
-auto IWorld::create_shared() -> std::shared_ptr<IWorld>
+auto IWorld::create_shared(erhe::concurrency::Thread_pool* thread_pool) -> std::shared_ptr<IWorld>
 {
+    static_cast<void>(thread_pool);
     return std::make_shared<Null_world>();
 }
 
-auto IWorld::create_unique() -> std::unique_ptr<IWorld>
+auto IWorld::create_unique(erhe::concurrency::Thread_pool* thread_pool) -> std::unique_ptr<IWorld>
 {
+    static_cast<void>(thread_pool);
     return std::make_unique<Null_world>();
 }
 
@@ -55,6 +60,35 @@ void Null_world::remove_rigid_body(IRigid_body* rigid_body)
     );
 }
 
+void Null_world::add_rigid_bodies(const gsl::span<IRigid_body* const> rigid_bodies)
+{
+    m_rigid_bodies.insert(m_rigid_bodies.end(), rigid_bodies.begin(), rigid_bodies.end());
+}
+
+void Null_world::remove_rigid_bodies(const gsl::span<IRigid_body* const> rigid_bodies)
+{
+    m_rigid_bodies.erase(
+        std::remove_if(
+            m_rigid_bodies.begin(),
+            m_rigid_bodies.end(),
+            [rigid_bodies](IRigid_body* rigid_body) {
+                return std::find(rigid_bodies.begin(), rigid_bodies.end(), rigid_body) != rigid_bodies.end();
+            }
+        ),
+        m_rigid_bodies.end()
+    );
+}
+
+void Null_world::optimize_broad_phase()
+{
+}
+
+void Null_world::get_active_body_transforms(Rigid_body_transforms& out)
+{
+    // Null world never simulates, so there are no active bodies
+    out.clear();
+}
+
 void Null_world::add_constraint(IConstraint* constraint)
 {
     m_constraints.push_back(constraint);
@@ -17,16 +17,20 @@ public:
     virtual ~Null_world() noexcept override;
 
     // Implements IWorld
-    void update_fixed_step(const double dt)          override;
-    void set_gravity      (const glm::vec3& gravity) override;
-    auto get_gravity      () const -> glm::vec3      override;
-    void add_rigid_body   (IRigid_body* rigid_body)  override;
-    void remove_rigid_body(IRigid_body* rigid_body)  override;
-    void add_constraint   (IConstraint* constraint)  override;
-    void remove_constraint(IConstraint* constraint)  override;
-    void set_debug_drawer (IDebug_draw* debug_draw)  override;
-    void debug_draw       ()                         override;
-    void sanity_check     ()                         override;
+    void update_fixed_step   (const double dt)                              override;
+    void set_gravity         (const glm::vec3& gravity)                     override;
+    auto get_gravity         () const -> glm::vec3                          override;
+    void add_rigid_body      (IRigid_body* rigid_body)                      override;
+    void remove_rigid_body   (IRigid_body* rigid_body)                      override;
+    void add_rigid_bodies    (gsl::span<IRigid_body* const> rigid_bodies)   override;
+    void remove_rigid_bodies (gsl::span<IRigid_body* const> rigid_bodies)   override;
+    void optimize_broad_phase()                                             override;
+    void add_constraint      (IConstraint* constraint)                      override;
+    void remove_constraint   (IConstraint* constraint)                      override;
+    void set_debug_drawer    (IDebug_draw* debug_draw)                      override;
+    void debug_draw          ()                                             override;
+    void sanity_check        ()                                             override;
+    void get_active_body_transforms(Rigid_body_transforms& out)             override;
 
 private:
     glm::vec3                 m_gravity        {0.0f};
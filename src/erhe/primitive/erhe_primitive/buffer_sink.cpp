@@ -53,6 +53,16 @@ auto Gl_buffer_sink::allocate_index_buffer(
     };
 }
 
+void Gl_buffer_sink::free_vertex_buffer(const Buffer_range& buffer_range)
+{
+    m_vertex_buffer.free_bytes(buffer_range.byte_offset);
+}
+
+void Gl_buffer_sink::free_index_buffer(const Buffer_range& buffer_range)
+{
+    m_index_buffer.free_bytes(buffer_range.byte_offset);
+}
+
 void Gl_buffer_sink::enqueue_index_data(std::size_t offset, std::vector<uint8_t>&& data) const
 {
     m_buffer_transfer_queue.enqueue(
@@ -127,6 +137,14 @@ auto Raytrace_buffer_sink::allocate_index_buffer(
     };
 }
 
+void Raytrace_buffer_sink::free_vertex_buffer(const Buffer_range&)
+{
+}
+
+void Raytrace_buffer_sink::free_index_buffer(const Buffer_range&)
+{
+}
+
 void Raytrace_buffer_sink::enqueue_index_data(std::size_t offset, std::vector<uint8_t>&& data) const
 {
     auto buffer_span = m_index_buffer.span();
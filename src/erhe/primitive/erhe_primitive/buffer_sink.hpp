@@ -38,6 +38,10 @@ public:
         std::size_t index_element_size
     ) -> Buffer_range = 0;
 
+    // Releases ranges returned by allocate_vertex_buffer() / allocate_index_buffer()
+    virtual void free_vertex_buffer(const Buffer_range& buffer_range) = 0;
+    virtual void free_index_buffer (const Buffer_range& buffer_range) = 0;
+
     virtual void enqueue_index_data (std::size_t offset, std::vector<uint8_t>&& data) const = 0;
     virtual void enqueue_vertex_data(std::size_t offset, std::vector<uint8_t>&& data) const = 0;
     virtual void buffer_ready       (Vertex_buffer_writer& writer) const = 0;
@@ -64,6 +68,9 @@ public:
         std::size_t index_element_size
     ) -> Buffer_range override;
 
+    void free_vertex_buffer(const Buffer_range& buffer_range) override;
+    void free_index_buffer (const Buffer_range& buffer_range) override;
+
     void enqueue_index_data (std::size_t offset, std::vector<uint8_t>&& data) const override;
     void enqueue_vertex_data(std::size_t offset, std::vector<uint8_t>&& data) const override;
     void buffer_ready       (Vertex_buffer_writer& writer) const                    override;
@@ -94,6 +101,10 @@ public:
         std::size_t index_element_size
     ) -> Buffer_range override;
 
+    // Raytrace buffers are allocated per geometry and released with it
+    void free_vertex_buffer(const Buffer_range& buffer_range) override;
+    void free_index_buffer (const Buffer_range& buffer_range) override;
+
     void enqueue_index_data (std::size_t offset, std::vector<uint8_t>&& data) const override;
     void enqueue_vertex_data(std::size_t offset, std::vector<uint8_t>&& data) const override;
     void buffer_ready       (Vertex_buffer_writer& writer) const                    override;
@@ -342,10 +342,19 @@ void Vertex_buffer_writer::write(
     const Vertex_attribute_info& attribute,
     const glm::vec2              value
 )
+{
+    write_at(vertex_write_offset, attribute, value);
+}
+
+void Vertex_buffer_writer::write_at(
+    const std::size_t            vertex_offset,
+    const Vertex_attribute_info& attribute,
+    const glm::vec2              value
+)
 {
     write_low(
         vertex_data_span.subspan(
-            vertex_write_offset + attribute.offset,
+            vertex_offset + attribute.offset,
             attribute.size
         ),
         attribute.data_type,
@@ -357,10 +366,19 @@ void Vertex_buffer_writer::write(
     const Vertex_attribute_info& attribute,
     const glm::vec3              value
 )
+{
+    write_at(vertex_write_offset, attribute, value);
+}
+
+void Vertex_buffer_writer::write_at(
+    const std::size_t            vertex_offset,
+    const Vertex_attribute_info& attribute,
+    const glm::vec3              value
+)
 {
     write_low(
         vertex_data_span.subspan(
-            vertex_write_offset + attribute.offset,
+            vertex_offset + attribute.offset,
             attribute.size
         ),
         attribute.data_type,
@@ -372,10 +390,19 @@ void Vertex_buffer_writer::write(
     const Vertex_attribute_info& attribute,
     const glm::vec4              value
 )
+{
+    write_at(vertex_write_offset, attribute, value);
+}
+
+void Vertex_buffer_writer::write_at(
+    const std::size_t            vertex_offset,
+    const Vertex_attribute_info& attribute,
+    const glm::vec4              value
+)
 {
     write_low(
         vertex_data_span.subspan(
-            vertex_write_offset + attribute.offset,
+            vertex_offset + attribute.offset,
             attribute.size
         ),
         attribute.data_type,
@@ -387,10 +414,19 @@ void Vertex_buffer_writer::write(
     const Vertex_attribute_info& attribute,
     const uint32_t               value
 )
+{
+    write_at(vertex_write_offset, attribute, value);
+}
+
+void Vertex_buffer_writer::write_at(
+    const std::size_t            vertex_offset,
+    const Vertex_attribute_info& attribute,
+    const uint32_t               value
+)
 {
     write_low(
         vertex_data_span.subspan(
-            vertex_write_offset + attribute.offset,
+            vertex_offset + attribute.offset,
             attribute.size
         ),
         attribute.data_type,
@@ -402,10 +438,19 @@ void Vertex_buffer_writer::write(
     const Vertex_attribute_info& attribute,
     const glm::uvec4             value
 )
+{
+    write_at(vertex_write_offset, attribute, value);
+}
+
+void Vertex_buffer_writer::write_at(
+    const std::size_t            vertex_offset,
+    const Vertex_attribute_info& attribute,
+    const glm::uvec4             value
+)
 {
     write_low(
         vertex_data_span.subspan(
-            vertex_write_offset + attribute.offset,
+            vertex_offset + attribute.offset,
             attribute.size
         ),
         attribute.data_type,
@@ -421,19 +466,29 @@ void Vertex_buffer_writer::move(const std::size_t relative_offset)
 void Index_buffer_writer::write_corner(const uint32_t v0)
 {
     //trace_fmt(log_primitive_builder, "point {}\n", v0);
-    write_low(corner_point_index_data_span.subspan(corner_point_indices_written * index_type_size, index_type_size), index_type, v0);
+    write_corner_at(corner_point_indices_written, v0);
     ++corner_point_indices_written;
 }
 
+void Index_buffer_writer::write_corner_at(const std::size_t index_offset, const uint32_t v0)
+{
+    write_low(corner_point_index_data_span.subspan(index_offset * index_type_size, index_type_size), index_type, v0);
+}
+
 void Index_buffer_writer::write_triangle(const uint32_t v0, const uint32_t v1, const uint32_t v2)
 {
     //trace_fmt(log_primitive_builder, "triangle {}, {}, {}\n", v0, v1, v2);
-    write_low(triangle_fill_index_data_span.subspan((triangle_indices_written + 0) * index_type_size, index_type_size), index_type, v0);
-    write_low(triangle_fill_index_data_span.subspan((triangle_indices_written + 1) * index_type_size, index_type_size), index_type, v1);
-    write_low(triangle_fill_index_data_span.subspan((triangle_indices_written + 2) * index_type_size, index_type_size), index_type, v2);
+    write_triangle_at(triangle_indices_written, v0, v1, v2);
     triangle_indices_written += 3;
 }
 
+void Index_buffer_writer::write_triangle_at(const std::size_t index_offset, const uint32_t v0, const uint32_t v1, const uint32_t v2)
+{
+    write_low(triangle_fill_index_data_span.subspan((index_offset + 0) * index_type_size, index_type_size), index_type, v0);
+    write_low(triangle_fill_index_data_span.subspan((index_offset + 1) * index_type_size, index_type_size), index_type, v1);
+    write_low(triangle_fill_index_data_span.subspan((index_offset + 2) * index_type_size, index_type_size), index_type, v2);
+}
+
 void Index_buffer_writer::write_edge(const uint32_t v0, const uint32_t v1)
 {
     //trace_fmt(log_primitive_builder, "edge {}, {}\n", v0, v1);
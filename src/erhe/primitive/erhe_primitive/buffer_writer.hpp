@@ -40,6 +40,14 @@ public:
     void write(const Vertex_attribute_info& attribute, const glm::uvec4 value);
     void move (const std::size_t relative_offset);
 
+    // Writes at explicit byte offset, without using or updating vertex_write_offset.
+    // Writes to disjoint vertices can be done concurrently.
+    void write_at(const std::size_t vertex_offset, const Vertex_attribute_info& attribute, const glm::vec2  value);
+    void write_at(const std::size_t vertex_offset, const Vertex_attribute_info& attribute, const glm::vec3  value);
+    void write_at(const std::size_t vertex_offset, const Vertex_attribute_info& attribute, const glm::vec4  value);
+    void write_at(const std::size_t vertex_offset, const Vertex_attribute_info& attribute, const uint32_t   value);
+    void write_at(const std::size_t vertex_offset, const Vertex_attribute_info& attribute, const glm::uvec4 value);
+
     [[nodiscard]] auto start_offset() -> std::size_t;
 
     Build_context&            build_context;
@@ -68,6 +76,11 @@ public:
     void write_edge    (const uint32_t v0, const uint32_t v1);
     void write_centroid(const uint32_t v0);
 
+    // Writes at explicit index offset, without using or updating written counters.
+    // Writes to disjoint indices can be done concurrently.
+    void write_corner_at  (const std::size_t index_offset, const uint32_t v0);
+    void write_triangle_at(const std::size_t index_offset, const uint32_t v0, const uint32_t v1, const uint32_t v2);
+
     [[nodiscard]] auto start_offset  () -> std::size_t;
 
     Build_context&               build_context;
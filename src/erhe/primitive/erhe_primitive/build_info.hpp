@@ -4,6 +4,9 @@
 
 #include <glm/glm.hpp>
 
+namespace erhe::concurrency {
+    class Thread_pool;
+}
 namespace erhe::graphics {
     class Vertex_attribute_mappings;
 }
@@ -30,6 +33,7 @@ public:
     Normal_style                               normal_style             {Normal_style::corner_normals};
     erhe::graphics::Vertex_attribute_mappings* vertex_attribute_mappings{nullptr};
     bool                                       autocolor                {false};
+    erhe::concurrency::Thread_pool*            thread_pool              {nullptr}; // Parallel polygon fill when set
 };
 
 } // namespace erhe::primitive
@@ -1,8 +1,68 @@
 #include "erhe_primitive/geometry_mesh.hpp"
+#include "erhe_primitive/buffer_sink.hpp"
+
+#include <utility>
 
 namespace erhe::primitive
 {
 
+Geometry_mesh::Geometry_mesh() = default;
+
+Geometry_mesh::~Geometry_mesh() noexcept
+{
+    release_buffers();
+}
+
+Geometry_mesh::Geometry_mesh(Geometry_mesh&& other) noexcept
+    : bounding_box              {other.bounding_box}
+    , bounding_sphere           {other.bounding_sphere}
+    , triangle_fill_indices     {other.triangle_fill_indices}
+    , edge_line_indices         {other.edge_line_indices}
+    , corner_point_indices      {other.corner_point_indices}
+    , polygon_centroid_indices  {other.polygon_centroid_indices}
+    , vertex_buffer_range       {other.vertex_buffer_range}
+    , index_buffer_range        {other.index_buffer_range}
+    , buffer_sink               {std::exchange(other.buffer_sink, nullptr)}
+    , primitive_id_to_polygon_id{std::move(other.primitive_id_to_polygon_id)}
+    , corner_to_vertex_id       {std::move(other.corner_to_vertex_id)}
+{
+}
+
+Geometry_mesh& Geometry_mesh::operator=(Geometry_mesh&& other) noexcept
+{
+    if (this != &other) {
+        release_buffers();
+        bounding_box               = other.bounding_box;
+        bounding_sphere            = other.bounding_sphere;
+        triangle_fill_indices      = other.triangle_fill_indices;
+        edge_line_indices          = other.edge_line_indices;
+        corner_point_indices       = other.corner_point_indices;
+        polygon_centroid_indices   = other.polygon_centroid_indices;
+        vertex_buffer_range        = other.vertex_buffer_range;
+        index_buffer_range         = other.index_buffer_range;
+        buffer_sink                = std::exchange(other.buffer_sink, nullptr);
+        primitive_id_to_polygon_id = std::move(other.primitive_id_to_polygon_id);
+        corner_to_vertex_id        = std::move(other.corner_to_vertex_id);
+    }
+    return *this;
+}
+
+void Geometry_mesh::release_buffers()
+{
+    if (buffer_sink == nullptr) {
+        return;
+    }
+    if (vertex_buffer_range.count > 0) {
+        buffer_sink->free_vertex_buffer(vertex_buffer_range);
+    }
+    if (index_buffer_range.count > 0) {
+        buffer_sink->free_index_buffer(index_buffer_range);
+    }
+    vertex_buffer_range = {};
+    index_buffer_range  = {};
+    buffer_sink         = nullptr;
+}
+
 auto Geometry_mesh::base_vertex() const -> uint32_t
 {
     return static_cast<uint32_t>(vertex_buffer_range.byte_offset / vertex_buffer_range.element_size);
@@ -20,9 +20,21 @@ namespace erhe::geometry {
 namespace erhe::primitive
 {
 
+class Buffer_sink;
+
 class Geometry_mesh
 {
 public:
+    Geometry_mesh();
+    ~Geometry_mesh() noexcept;
+    Geometry_mesh(const Geometry_mesh&) = delete;
+    Geometry_mesh& operator=(const Geometry_mesh&) = delete;
+    Geometry_mesh(Geometry_mesh&& other) noexcept;
+    Geometry_mesh& operator=(Geometry_mesh&& other) noexcept;
+
+    // Returns vertex and index buffer ranges to buffer_sink
+    void release_buffers();
+
     [[nodiscard]] auto base_vertex() const -> uint32_t;
     [[nodiscard]] auto base_index () const -> uint32_t;
     [[nodiscard]] auto index_range(const Primitive_mode primitive_mode) const -> Index_range;
@@ -38,6 +50,10 @@ public:
     Buffer_range vertex_buffer_range     {};
     Buffer_range index_buffer_range      {};
 
+    // When set, buffer ranges are released to buffer_sink when this
+    // Geometry_mesh is destroyed. Buffer_sink must outlive the mesh.
+    Buffer_sink* buffer_sink{nullptr};
+
     // TODO These make Geometry_mesh expensive to copy
     std::vector<uint32_t> primitive_id_to_polygon_id;
     std::vector<uint32_t> corner_to_vertex_id;
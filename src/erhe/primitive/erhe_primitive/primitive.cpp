@@ -81,6 +81,8 @@ Geometry_raytrace::Geometry_raytrace(
         build_info,
         erhe::primitive::Normal_style::none
     );
+    // buffer_sink above is a temporary; rt buffers are released with rt_vertex_buffer / rt_index_buffer
+    rt_geometry_mesh.buffer_sink = nullptr;
 
     rt_geometry = erhe::raytrace::IGeometry::create_unique(
         geometry.name + "_triangle_geometry",
@@ -163,7 +165,7 @@ Geometry_primitive::Geometry_primitive(
     Geometry_mesh&& gl_geometry_mesh
 )
     : normal_style    {erhe::primitive::Normal_style::corner_normals}
-    , gl_geometry_mesh{gl_geometry_mesh}
+    , gl_geometry_mesh{std::move(gl_geometry_mesh)}
 {
 }
 
@@ -204,5 +206,36 @@ void Geometry_primitive::build_from_geometry(
     raytrace         = Geometry_raytrace{*source_geometry.get()};
 }
 
+auto Geometry_primitive::has_buffers() const -> bool
+{
+    return gl_geometry_mesh.vertex_buffer_range.count > 0;
+}
+
+namespace {
+
+auto get_geometry_mesh_memory_usage(const Geometry_mesh& geometry_mesh) -> std::size_t
+{
+    const Buffer_range& vertex_range = geometry_mesh.vertex_buffer_range;
+    const Buffer_range& index_range  = geometry_mesh.index_buffer_range;
+    return
+        vertex_range.count * vertex_range.element_size +
+        index_range .count * index_range .element_size +
+        geometry_mesh.primitive_id_to_polygon_id.capacity() * sizeof(uint32_t) +
+        geometry_mesh.corner_to_vertex_id       .capacity() * sizeof(uint32_t);
+}
+
+}
+
+auto Geometry_primitive::get_memory_usage() const -> std::size_t
+{
+    std::size_t sum =
+        get_geometry_mesh_memory_usage(gl_geometry_mesh) +
+        get_geometry_mesh_memory_usage(raytrace.rt_geometry_mesh);
+    if (source_geometry) {
+        sum += source_geometry->get_memory_usage();
+    }
+    return sum;
+}
+
 
 } // namespace erhe::primitive
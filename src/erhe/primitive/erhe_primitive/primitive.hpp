@@ -59,6 +59,12 @@ public:
         const Normal_style normal_style
     );
 
+    // True when buffers have been built, false for source geometry only
+    [[nodiscard]] auto has_buffers() const -> bool;
+
+    // Approximate memory used by source geometry and built buffers, in bytes
+    [[nodiscard]] auto get_memory_usage() const -> std::size_t;
+
     std::shared_ptr<erhe::geometry::Geometry> source_geometry {};
     Normal_style                              normal_style    {Normal_style::none};
     Geometry_mesh                             gl_geometry_mesh{};
@@ -7,6 +7,7 @@
 #include "erhe_primitive/index_range.hpp"
 #include "erhe_primitive/primitive_log.hpp"
 #include "erhe_primitive/geometry_mesh.hpp"
+#include "erhe_concurrency/parallel_for.hpp"
 #include "erhe_geometry/geometry.hpp"
 #include "erhe_geometry/property_map.hpp"
 #include "erhe_gl/enum_string_functions.hpp"
@@ -18,6 +19,9 @@
 
 #include <glm/glm.hpp>
 
+#include <mutex>
+#include <vector>
+
 namespace erhe::primitive
 {
 
@@ -42,6 +46,13 @@ using vec4 = glm::vec4;
 using uvec4 = glm::uvec4;
 using mat4 = glm::mat4;
 
+namespace {
+
+// Polygons per parallel fill range
+constexpr std::size_t s_parallel_fill_grain_size = 1024;
+
+}
+
 
 Build_context_root::Build_context_root(
     const erhe::geometry::Geometry& geometry,
@@ -273,6 +284,10 @@ void Primitive_builder::build(Geometry_mesh* geometry_mesh)
         m_geometry.name
     );
 
+    // Release ranges from a previous build before allocating new ones
+    geometry_mesh->release_buffers();
+    geometry_mesh->buffer_sink = &m_build_info.buffer_info.buffer_sink;
+
     Build_context build_context{
         m_geometry,
         m_build_info,
@@ -280,10 +295,12 @@ void Primitive_builder::build(Geometry_mesh* geometry_mesh)
         geometry_mesh
     };
 
+    // Polygon fill writes the corner vertices, which are always allocated
+    // and used by the other primitive types. Triangles are only written
+    // when fill_triangles is set.
+    build_context.build_polygon_fill();
+
     const Primitive_types& primitive_types = m_build_info.primitive_types;
-    if (primitive_types.fill_triangles) {
-        build_context.build_polygon_fill();
-    }
 
     if (primitive_types.edge_lines) {
         build_context.build_edge_lines();
@@ -316,7 +333,21 @@ Build_context::~Build_context() noexcept
     ERHE_VERIFY(vertex_index == root.total_vertex_count);
 }
 
-void Build_context::build_polygon_id()
+Polygon_fill_worker::Polygon_fill_worker(Build_context& build_context)
+    : build_context{build_context}
+    , root         {build_context.root}
+    , property_maps{build_context.property_maps}
+    , normal_style {build_context.normal_style}
+{
+}
+
+template <typename T>
+void Polygon_fill_worker::write(const Vertex_attribute_info& attribute, const T value)
+{
+    build_context.vertex_writer.write_at(vertex_index * root.vertex_stride, attribute, value);
+}
+
+void Polygon_fill_worker::build_polygon_id()
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -325,16 +356,16 @@ void Build_context::build_polygon_id()
     ////     erhe::graphics::g_instance->info.use_integer_polygon_ids &&
     ////     root.attributes.attribute_id_uint.is_valid()
     //// ) {
-    ////     vertex_writer.write(root.attributes.attribute_id_uint, polygon_index);
+    ////     write(root.attributes.attribute_id_uint, polygon_index);
     //// }
 
     if (root.attributes.id_vec3.is_valid()) {
         const vec3 v = erhe::math::vec3_from_uint(polygon_index);
-        vertex_writer.write(root.attributes.id_vec3, v);
+        write(root.attributes.id_vec3, v);
     }
 }
 
-auto Build_context::get_polygon_normal() -> vec3
+auto Polygon_fill_worker::get_polygon_normal() -> vec3
 {
     vec3 polygon_normal{0.0f, 1.0f, 0.0f};
     if (property_maps.polygon_normals != nullptr) {
@@ -344,7 +375,7 @@ auto Build_context::get_polygon_normal() -> vec3
     return polygon_normal;
 }
 
-void Build_context::build_vertex_position()
+void Polygon_fill_worker::build_vertex_position()
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -354,7 +385,7 @@ void Build_context::build_vertex_position()
 
     Expects(property_maps.point_locations != nullptr);
     const vec3 position = property_maps.point_locations->get(point_id);
-    vertex_writer.write(root.attributes.position, position);
+    write(root.attributes.position, position);
 
     SPDLOG_LOGGER_TRACE(
         log_primitive_builder,
@@ -363,7 +394,7 @@ void Build_context::build_vertex_position()
     );
 }
 
-void Build_context::build_vertex_normal()
+void Polygon_fill_worker::build_vertex_normal()
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -400,19 +431,19 @@ void Build_context::build_vertex_normal()
             }
 
             case Normal_style::corner_normals: {
-                vertex_writer.write(root.attributes.normal, normal);
+                write(root.attributes.normal, normal);
                 SPDLOG_LOGGER_TRACE(log_primitive_builder, "point {} corner {} normal {}", point_id, corner_id, normal);
                 break;
             }
 
             case Normal_style::point_normals: {
-                vertex_writer.write(root.attributes.normal, point_normal);
+                write(root.attributes.normal, point_normal);
                 SPDLOG_LOGGER_TRACE(log_primitive_builder, "point {} corner {} point normal {}", point_id, corner_id, point_normal);
                 break;
             }
 
             case Normal_style::polygon_normals: {
-                vertex_writer.write(root.attributes.normal, polygon_normal);
+                write(root.attributes.normal, polygon_normal);
                 SPDLOG_LOGGER_TRACE(log_primitive_builder, "point {} corner {} polygon normal {}", point_id, corner_id, polygon_normal);
                 break;
             }
@@ -424,7 +455,7 @@ void Build_context::build_vertex_normal()
     }
 
     // if (features.normal_flat && root.attributes.normal_flat.is_valid()) {
-    //     vertex_writer.write(root.attributes.normal_flat, polygon_normal);
+    //     write(root.attributes.normal_flat, polygon_normal);
     //     SPDLOG_LOGGER_TRACE(log_primitive_builder, "point {} corner {} flat polygon normal {}", point_id, corner_id, polygon_normal);
     // }
     // 
@@ -443,11 +474,11 @@ void Build_context::build_vertex_normal()
             }
         }
     
-        vertex_writer.write(root.attributes.normal_smooth, smooth_point_normal);
+        write(root.attributes.normal_smooth, smooth_point_normal);
     }
 }
 
-void Build_context::build_vertex_tangent()
+void Polygon_fill_worker::build_vertex_tangent()
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -479,10 +510,10 @@ void Build_context::build_vertex_tangent()
         used_fallback_tangent = true;
     }
 
-    vertex_writer.write(root.attributes.tangent, tangent);
+    write(root.attributes.tangent, tangent);
 }
 
-void Build_context::build_vertex_bitangent()
+void Polygon_fill_worker::build_vertex_bitangent()
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -513,10 +544,10 @@ void Build_context::build_vertex_bitangent()
         used_fallback_bitangent = true;
     }
 
-    vertex_writer.write(root.attributes.bitangent, bitangent);
+    write(root.attributes.bitangent, bitangent);
 }
 
-void Build_context::build_vertex_texcoord()
+void Polygon_fill_worker::build_vertex_texcoord()
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -547,10 +578,10 @@ void Build_context::build_vertex_texcoord()
         used_fallback_texcoord = true;
     }
 
-    vertex_writer.write(root.attributes.texcoord, texcoord);
+    write(root.attributes.texcoord, texcoord);
 }
 
-void Build_context::build_vertex_joint_indices()
+void Polygon_fill_worker::build_vertex_joint_indices()
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -561,7 +592,7 @@ void Build_context::build_vertex_joint_indices()
     const uvec4 joint_indices = (property_maps.point_joint_indices != nullptr)
         ? property_maps.point_joint_indices->get(point_id)
         : uvec4{0u, 0u, 0u, 0u};
-    vertex_writer.write(root.attributes.joint_indices, joint_indices);
+    write(root.attributes.joint_indices, joint_indices);
 
     SPDLOG_LOGGER_TRACE(
         log_primitive_builder,
@@ -570,7 +601,7 @@ void Build_context::build_vertex_joint_indices()
     );
 }
 
-void Build_context::build_vertex_joint_weights()
+void Polygon_fill_worker::build_vertex_joint_weights()
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -581,7 +612,7 @@ void Build_context::build_vertex_joint_weights()
     const vec4 joint_weights = (property_maps.point_joint_weights != nullptr)
         ? property_maps.point_joint_weights->get(point_id)
         : vec4{1.0f, 0.0f, 0.0f, 0.0f};
-    vertex_writer.write(root.attributes.joint_weights, joint_weights);
+    write(root.attributes.joint_weights, joint_weights);
 
     SPDLOG_LOGGER_TRACE(
         log_primitive_builder,
@@ -610,7 +641,7 @@ void Build_context::build_vertex_joint_weights()
 //
 // }
 
-void Build_context::build_vertex_color(const uint32_t /*polygon_corner_count*/)
+void Polygon_fill_worker::build_vertex_color(const uint32_t /*polygon_corner_count*/)
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -655,10 +686,10 @@ void Build_context::build_vertex_color(const uint32_t /*polygon_corner_count*/)
     //    //}
     //}
 
-    vertex_writer.write(root.attributes.color, color);
+    write(root.attributes.color, color);
 }
 
-void Build_context::build_vertex_aniso_control()
+void Polygon_fill_worker::build_vertex_aniso_control()
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -701,7 +732,7 @@ void Build_context::build_vertex_aniso_control()
 #endif
     }
 
-    vertex_writer.write(root.attributes.aniso_control, value);
+    write(root.attributes.aniso_control, value);
 }
 
 void Build_context::build_centroid_position()
@@ -740,18 +771,18 @@ void Build_context::build_centroid_normal()
     // }
 }
 
-void Build_context::build_corner_point_index()
+void Polygon_fill_worker::build_corner_point_index()
 {
     if (root.build_info.primitive_types.corner_points) {
-        index_writer.write_corner(vertex_index);
+        build_context.index_writer.write_corner_at(vertex_index, vertex_index);
     }
 }
 
-void Build_context::build_triangle_fill_index()
+void Polygon_fill_worker::build_triangle_fill_index()
 {
     if (root.build_info.primitive_types.fill_triangles) {
         if (previous_index != first_index) {
-            index_writer.write_triangle(first_index, vertex_index, previous_index);
+            build_context.index_writer.write_triangle_at(3 * primitive_index, first_index, vertex_index, previous_index);
             root.geometry_mesh->primitive_id_to_polygon_id[primitive_index] = polygon_id;
             ++primitive_index;
         }
@@ -760,38 +791,24 @@ void Build_context::build_triangle_fill_index()
     previous_index = vertex_index;
 }
 
-void Build_context::build_polygon_fill()
+void Polygon_fill_worker::fill(
+    const Polygon_id polygon_id_begin,
+    const Polygon_id polygon_id_end,
+    const uint32_t   first_vertex_index,
+    const uint32_t   first_primitive_index
+)
 {
     ERHE_PROFILE_FUNCTION();
 
-    // TODO property_maps.corner_indices needs to be setup
-    //      also if edge lines are wanted.
-
-    property_maps.corner_indices->clear();
-
-    vertex_index  = 0;
-    polygon_index = 0;
-
-    //const bool any_normal_feature = root.build_info.format.features.normal =
-    //    root.build_info.format.features.normal      ||
-    //    root.build_info.format.features.normal_flat ||
-    //    root.build_info.format.features.normal_smooth;
+    vertex_index    = first_vertex_index;
+    primitive_index = first_primitive_index;
+    polygon_index   = polygon_id_begin;
 
-    const Polygon_id polygon_id_end = root.geometry.get_polygon_count();
-    root.geometry_mesh->corner_to_vertex_id.resize(root.geometry.get_corner_count());
-    for (polygon_id = 0; polygon_id < polygon_id_end; ++polygon_id) {
+    for (polygon_id = polygon_id_begin; polygon_id < polygon_id_end; ++polygon_id) {
         const Polygon& polygon = root.geometry.polygons[polygon_id];
         first_index    = vertex_index;
         previous_index = first_index;
 
-        if (property_maps.polygon_ids_uint32 != nullptr) {
-            property_maps.polygon_ids_uint32->put(polygon_id, polygon_index);
-        }
-
-        if (property_maps.polygon_ids_vector3 != nullptr) {
-            property_maps.polygon_ids_vector3->put(polygon_id, erhe::math::vec3_from_uint(polygon_index));
-        }
-
         const Polygon_corner_id polyon_corner_id_end = polygon.first_polygon_corner_id + polygon.corner_count;
         for (
             polygon_corner_id = polygon.first_polygon_corner_id;
@@ -815,18 +832,39 @@ void Build_context::build_polygon_fill()
             build_vertex_joint_indices();
             build_vertex_joint_weights();
 
-            // Indices
-            property_maps.corner_indices->put(corner_id, vertex_index);
-
             build_corner_point_index();
             build_triangle_fill_index();
 
-            vertex_writer.move(root.vertex_stride);
             ++vertex_index;
         }
 
         ++polygon_index;
     }
+}
+
+void Build_context::build_polygon_fill()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    // TODO property_maps.corner_indices needs to be setup
+    //      also if edge lines are wanted.
+
+    root.geometry_mesh->corner_to_vertex_id.resize(root.geometry.get_corner_count());
+
+    if ((root.build_info.thread_pool != nullptr) && (root.geometry.get_polygon_count() > s_parallel_fill_grain_size)) {
+        build_polygon_fill_parallel();
+    } else {
+        build_polygon_fill_serial();
+    }
+
+    // Continue vertex and index writes after polygon fill
+    vertex_writer.vertex_write_offset = static_cast<std::size_t>(vertex_index) * root.vertex_stride;
+    if (root.build_info.primitive_types.corner_points) {
+        index_writer.corner_point_indices_written = vertex_index;
+    }
+    index_writer.triangle_indices_written = 3 * static_cast<std::size_t>(triangle_count);
+
+    put_polygon_fill_properties();
 
     if (used_fallback_smooth_normal) {
         log_primitive_builder->warn("Warning: Used fallback smooth normal");
@@ -842,6 +880,100 @@ void Build_context::build_polygon_fill()
     }
 }
 
+void Build_context::build_polygon_fill_serial()
+{
+    Polygon_fill_worker worker{*this};
+    worker.fill(0, root.geometry.get_polygon_count(), 0, 0);
+
+    vertex_index                = worker.vertex_index;
+    triangle_count              = worker.primitive_index;
+    used_fallback_smooth_normal = worker.used_fallback_smooth_normal;
+    used_fallback_tangent       = worker.used_fallback_tangent;
+    used_fallback_bitangent     = worker.used_fallback_bitangent;
+    used_fallback_texcoord      = worker.used_fallback_texcoord;
+}
+
+void Build_context::build_polygon_fill_parallel()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    // Prefix sums of corner and triangle counts give each polygon its
+    // first vertex and first triangle, so polygon ranges can be filled
+    // independently. Triangle counts must match build_triangle_fill_index().
+    const bool       fill_triangles = root.build_info.primitive_types.fill_triangles;
+    const Polygon_id polygon_count  = root.geometry.get_polygon_count();
+    std::vector<uint32_t> polygon_first_vertex  (static_cast<std::size_t>(polygon_count) + 1);
+    std::vector<uint32_t> polygon_first_triangle(static_cast<std::size_t>(polygon_count) + 1);
+    polygon_first_vertex  [0] = 0;
+    polygon_first_triangle[0] = 0;
+    for (polygon_id = 0; polygon_id < polygon_count; ++polygon_id) {
+        const uint32_t corner_count           = root.geometry.polygons[polygon_id].corner_count;
+        const uint32_t polygon_triangle_count = (fill_triangles && (corner_count > 2)) ? corner_count - 2 : 0;
+        polygon_first_vertex  [polygon_id + 1] = polygon_first_vertex  [polygon_id] + corner_count;
+        polygon_first_triangle[polygon_id + 1] = polygon_first_triangle[polygon_id] + polygon_triangle_count;
+    }
+
+    std::mutex fallback_mutex;
+    erhe::concurrency::parallel_for(
+        root.build_info.thread_pool,
+        polygon_count,
+        s_parallel_fill_grain_size,
+        [&](const std::size_t begin, const std::size_t end) {
+            Polygon_fill_worker worker{*this};
+            worker.fill(
+                static_cast<Polygon_id>(begin),
+                static_cast<Polygon_id>(end),
+                polygon_first_vertex  [begin],
+                polygon_first_triangle[begin]
+            );
+            ERHE_VERIFY(worker.vertex_index    == polygon_first_vertex  [end]);
+            ERHE_VERIFY(worker.primitive_index == polygon_first_triangle[end]);
+
+            const std::lock_guard<std::mutex> lock{fallback_mutex};
+            used_fallback_smooth_normal = used_fallback_smooth_normal || worker.used_fallback_smooth_normal;
+            used_fallback_tangent       = used_fallback_tangent       || worker.used_fallback_tangent;
+            used_fallback_bitangent     = used_fallback_bitangent     || worker.used_fallback_bitangent;
+            used_fallback_texcoord      = used_fallback_texcoord      || worker.used_fallback_texcoord;
+        }
+    );
+
+    vertex_index   = polygon_first_vertex  [polygon_count];
+    triangle_count = polygon_first_triangle[polygon_count];
+}
+
+// Property_map::put() may resize, so properties are put serially after fill
+void Build_context::put_polygon_fill_properties()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    property_maps.corner_indices->clear();
+
+    const auto& corner_to_vertex_id = root.geometry_mesh->corner_to_vertex_id;
+    const Polygon_id polygon_id_end = root.geometry.get_polygon_count();
+    for (polygon_id = 0; polygon_id < polygon_id_end; ++polygon_id) {
+        const Polygon& polygon = root.geometry.polygons[polygon_id];
+
+        // polygon_index matches polygon_id
+        if (property_maps.polygon_ids_uint32 != nullptr) {
+            property_maps.polygon_ids_uint32->put(polygon_id, polygon_id);
+        }
+
+        if (property_maps.polygon_ids_vector3 != nullptr) {
+            property_maps.polygon_ids_vector3->put(polygon_id, erhe::math::vec3_from_uint(polygon_id));
+        }
+
+        const Polygon_corner_id polyon_corner_id_end = polygon.first_polygon_corner_id + polygon.corner_count;
+        for (
+            Polygon_corner_id polygon_corner_id = polygon.first_polygon_corner_id;
+            polygon_corner_id < polyon_corner_id_end;
+            ++polygon_corner_id
+        ) {
+            const Corner_id corner_id = root.geometry.polygon_corners[polygon_corner_id];
+            property_maps.corner_indices->put(corner_id, corner_to_vertex_id[corner_id]);
+        }
+    }
+}
+
 void Build_context::build_edge_lines()
 {
     ERHE_PROFILE_FUNCTION();
@@ -95,6 +95,58 @@ public:
     Build_context_root root;
 
 private:
+    friend class Polygon_fill_worker;
+
+    void build_polygon_fill_serial  ();
+    void build_polygon_fill_parallel();
+    void put_polygon_fill_properties();
+
+    void build_centroid_position ();
+    void build_centroid_normal   ();
+
+    erhe::geometry::Polygon_id        polygon_id       {0};
+    uint32_t                          vertex_index     {0}; // primitive vertex index
+    uint32_t                          triangle_count   {0};
+    Normal_style                      normal_style     {Normal_style::none};
+    Vertex_buffer_writer              vertex_writer;
+    Index_buffer_writer               index_writer;
+    Property_maps                     property_maps;
+
+    bool used_fallback_smooth_normal{false};
+    bool used_fallback_tangent      {false};
+    bool used_fallback_bitangent    {false};
+    bool used_fallback_texcoord     {false};
+};
+
+/// Fills vertex and index data for a range of polygons.
+///
+/// The first vertex and primitive index of the range are given, and all
+/// writes go to explicit offsets, so workers for disjoint polygon ranges
+/// can run concurrently.
+class Polygon_fill_worker
+{
+public:
+    explicit Polygon_fill_worker(Build_context& build_context);
+
+    void fill(
+        erhe::geometry::Polygon_id polygon_id_begin,
+        erhe::geometry::Polygon_id polygon_id_end,
+        uint32_t                   first_vertex_index,
+        uint32_t                   first_primitive_index
+    );
+
+    uint32_t vertex_index   {0}; // primitive vertex index    .
+    uint32_t primitive_index{0}; // triangle (TODO quad) index
+
+    bool used_fallback_smooth_normal{false};
+    bool used_fallback_tangent      {false};
+    bool used_fallback_bitangent    {false};
+    bool used_fallback_texcoord     {false};
+
+private:
+    template <typename T>
+    void write(const Vertex_attribute_info& attribute, const T value);
+
     void build_polygon_id        ();
 
     [[nodiscard]] auto get_polygon_normal() -> glm::vec3;
@@ -109,30 +161,20 @@ private:
     void build_vertex_joint_indices();
     void build_vertex_joint_weights();
 
-    void build_centroid_position ();
-    void build_centroid_normal   ();
-
     void build_corner_point_index ();
     void build_triangle_fill_index();
 
+    Build_context&                    build_context;
+    const Build_context_root&         root;
+    const Property_maps&              property_maps;
+    const Normal_style                normal_style;
     erhe::geometry::Polygon_id        polygon_id       {0};
     erhe::geometry::Polygon_corner_id polygon_corner_id{0};
     erhe::geometry::Point_id          point_id         {0};
     erhe::geometry::Corner_id         corner_id        {0};
-    uint32_t                          vertex_index     {0}; // primitive vertex index    .
     uint32_t                          first_index      {0}; // primitive first index      . These make triangle primitive
     uint32_t                          previous_index   {0}; // primitive previous index  .
     uint32_t                          polygon_index    {0};
-    uint32_t                          primitive_index  {0}; // triangle (TODO quad) index
-    Normal_style                      normal_style     {Normal_style::none};
-    Vertex_buffer_writer              vertex_writer;
-    Index_buffer_writer               index_writer;
-    Property_maps                     property_maps;
-
-    bool used_fallback_smooth_normal{false};
-    bool used_fallback_tangent      {false};
-    bool used_fallback_bitangent    {false};
-    bool used_fallback_texcoord     {false};
 };
 
 class Primitive_builder final
@@ -66,6 +66,20 @@
 #   define ERHE_PROFILE_GPU_CONTEXT
 #   define ERHE_PROFILE_FRAME_END
 
+#elif defined(ERHE_PROFILE_LIBRARY_BUILTIN)
+#   include "erhe_profile/profile_recorder.hpp"
+#   define ERHE_PROFILE_CONCAT(x,y) ERHE_PROFILE_CONCAT_INDIRECT(x,y)
+#   define ERHE_PROFILE_CONCAT_INDIRECT(x,y) x##y
+#   define ERHE_PROFILE_FUNCTION() erhe::profile::Zone_scope ERHE_PROFILE_CONCAT(erhe_profile_zone_,__LINE__){__FUNCTION__}
+#   define ERHE_PROFILE_SCOPE(erhe_profile_id) erhe::profile::Zone_scope ERHE_PROFILE_CONCAT(erhe_profile_zone_,__LINE__){erhe_profile_id}
+#   define ERHE_PROFILE_COLOR(erhe_profile_id, erhe_profile_color) erhe::profile::Zone_scope ERHE_PROFILE_CONCAT(erhe_profile_zone_,__LINE__){erhe_profile_id}
+#   define ERHE_PROFILE_DATA(erhe_profile_id, erhe_profile_data, erhe_profile_data_length) static_cast<void>(erhe_profile_id);
+#   define ERHE_PROFILE_MESSAGE(erhe_profile_message, erhe_profile_message_length) static_cast<void>(erhe_profile_message);
+#   define ERHE_PROFILE_MESSAGE_LITERAL(erhe_profile_message) static_cast<void>(erhe_profile_message);
+#   define ERHE_PROFILE_GPU_SCOPE(erhe_profile_id) static_cast<void>(erhe_profile_id);
+#   define ERHE_PROFILE_GPU_CONTEXT
+#   define ERHE_PROFILE_FRAME_END erhe::profile::end_frame();
+
 #else
 #   define ERHE_PROFILE_FUNCTION();
 #   define ERHE_PROFILE_SCOPE(erhe_profile_id) static_cast<void>(erhe_profile_id);
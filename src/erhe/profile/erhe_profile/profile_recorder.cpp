@@ -0,0 +1,345 @@
+#include "erhe_profile/profile_recorder.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace erhe::profile
+{
+
+namespace {
+
+auto now_ns() -> int64_t
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+// Maps ticks to steady_clock nanoseconds, using a reference point taken at
+// startup and a fresh one taken for each conversion batch.
+class Tick_scale
+{
+public:
+    Tick_scale(const int64_t reference_ticks, const int64_t reference_ns)
+        : m_reference_ticks{reference_ticks}
+        , m_reference_ns   {reference_ns}
+    {
+        const int64_t ticks = read_ticks();
+        const int64_t ns    = now_ns();
+        m_ns_per_tick = (ticks > reference_ticks)
+            ? static_cast<double>(ns - reference_ns) / static_cast<double>(ticks - reference_ticks)
+            : 1.0;
+    }
+
+    [[nodiscard]] auto to_ns(const int64_t ticks) const -> int64_t
+    {
+        return m_reference_ns + static_cast<int64_t>(static_cast<double>(ticks - m_reference_ticks) * m_ns_per_tick);
+    }
+    [[nodiscard]] auto duration_to_ns(const int64_t ticks) const -> int64_t
+    {
+        return static_cast<int64_t>(static_cast<double>(ticks) * m_ns_per_tick);
+    }
+
+private:
+    int64_t m_reference_ticks{0};
+    int64_t m_reference_ns   {0};
+    double  m_ns_per_tick    {1.0};
+};
+
+class Thread_summary_state
+{
+public:
+    uint64_t                position{0};
+    std::vector<Zone_event> stack;
+};
+
+class Recorder
+{
+public:
+    static constexpr std::size_t s_frame_capacity{1024};
+
+    const int64_t                                    reference_ticks{read_ticks()};
+    const int64_t                                    reference_ns   {now_ns()};
+
+    std::mutex                                       buffers_mutex;
+    std::vector<std::unique_ptr<Thread_zone_buffer>> buffers;
+    std::vector<Thread_zone_buffer*>                 free_buffers; // of exited threads
+
+    std::atomic<uint64_t>                            frame_count{0};
+    std::array<int64_t, s_frame_capacity>            frame_end_times{};
+
+    std::mutex                                       summary_mutex;
+    std::vector<Thread_summary_state>                summary_states;
+    std::vector<Zone_event>                          summary_events;
+    std::unordered_map<const char*, Zone_summary>    summary_zones;
+};
+
+auto get_recorder() -> Recorder&
+{
+    static Recorder recorder;
+    return recorder;
+}
+
+thread_local bool t_thread_exited{false};
+
+// Releases the buffer of the thread when the thread exits
+class Thread_exit final
+{
+public:
+    ~Thread_exit() noexcept
+    {
+        Thread_zone_buffer* buffer = t_thread_zone_buffer;
+        t_thread_zone_buffer = nullptr;
+        t_thread_exited      = true;
+        if (buffer == nullptr) {
+            return;
+        }
+        Recorder& recorder = get_recorder();
+        const std::lock_guard<std::mutex> lock{recorder.buffers_mutex};
+        recorder.free_buffers.push_back(buffer);
+    }
+};
+
+auto get_buffers() -> std::vector<Thread_zone_buffer*>
+{
+    Recorder& recorder = get_recorder();
+    const std::lock_guard<std::mutex> lock{recorder.buffers_mutex};
+    std::vector<Thread_zone_buffer*> result;
+    result.reserve(recorder.buffers.size());
+    for (const auto& buffer : recorder.buffers) {
+        result.push_back(buffer.get());
+    }
+    return result;
+}
+
+void write_json_string(std::ofstream& out, const char* text)
+{
+    out << '"';
+    for (const char* c = text; *c != '\0'; ++c) {
+        switch (*c) {
+            case '"':  out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            default:   out << *c;     break;
+        }
+    }
+    out << '"';
+}
+
+void write_json_time(std::ofstream& out, const int64_t time_ns)
+{
+    // Chrome trace timestamps are in microseconds
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.3f", static_cast<double>(time_ns) / 1000.0);
+    out << buffer;
+}
+
+}
+
+Thread_zone_buffer::Thread_zone_buffer(const uint32_t thread_index)
+    : m_thread_index{thread_index}
+{
+}
+
+auto Thread_zone_buffer::read(uint64_t& position, std::vector<Zone_event>& out) const -> bool
+{
+    const uint64_t end   = m_write.load(std::memory_order_acquire);
+    uint64_t       begin = position;
+    bool           lost  = false;
+    if (end - begin > s_capacity) {
+        begin = end - s_capacity;
+        lost  = true;
+    }
+    const std::size_t out_begin = out.size();
+    for (uint64_t i = begin; i < end; ++i) {
+        out.push_back(m_events[i & (s_capacity - 1)]);
+    }
+
+    // Drop events which the owning thread overwrote while they were copied
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t after = m_write.load(std::memory_order_relaxed);
+    if (after - begin > s_capacity) {
+        const uint64_t overwritten = std::min<uint64_t>(after - begin - s_capacity, end - begin);
+        out.erase(
+            out.begin() + out_begin,
+            out.begin() + out_begin + static_cast<std::ptrdiff_t>(overwritten)
+        );
+        lost = true;
+    }
+    position = end;
+    return !lost;
+}
+
+auto Thread_zone_buffer::get_thread_index() const -> uint32_t
+{
+    return m_thread_index;
+}
+
+auto register_thread() -> Thread_zone_buffer*
+{
+    // Zones from thread_local destructors which run after Thread_exit are not recorded
+    if (t_thread_exited) {
+        return nullptr;
+    }
+    thread_local Thread_exit thread_exit;
+
+    Recorder& recorder = get_recorder();
+    const std::lock_guard<std::mutex> lock{recorder.buffers_mutex};
+    if (!recorder.free_buffers.empty()) {
+        // Zones of the previous owner have all ended, so the buffer can continue as is
+        t_thread_zone_buffer = recorder.free_buffers.back();
+        recorder.free_buffers.pop_back();
+        return t_thread_zone_buffer;
+    }
+    const uint32_t thread_index = static_cast<uint32_t>(recorder.buffers.size());
+    recorder.buffers.push_back(std::make_unique<Thread_zone_buffer>(thread_index));
+    t_thread_zone_buffer = recorder.buffers.back().get();
+    return t_thread_zone_buffer;
+}
+
+void set_recording(const bool enabled)
+{
+    g_zone_recording.store(enabled, std::memory_order_relaxed);
+}
+
+void end_frame()
+{
+    Recorder& recorder = get_recorder();
+    const uint64_t frame = recorder.frame_count.load(std::memory_order_relaxed);
+    recorder.frame_end_times[frame % Recorder::s_frame_capacity] = now_ns();
+    recorder.frame_count.store(frame + 1, std::memory_order_release);
+}
+
+auto get_frame_count() -> uint64_t
+{
+    return get_recorder().frame_count.load(std::memory_order_acquire);
+}
+
+void collect_zone_summary(std::vector<Zone_summary>& out)
+{
+    Recorder& recorder = get_recorder();
+    const std::vector<Thread_zone_buffer*> buffers = get_buffers();
+
+    const Tick_scale tick_scale{recorder.reference_ticks, recorder.reference_ns};
+
+    const std::lock_guard<std::mutex> lock{recorder.summary_mutex};
+    recorder.summary_states.resize(buffers.size());
+    recorder.summary_zones.clear();
+    for (Thread_zone_buffer* buffer : buffers) {
+        Thread_summary_state& state = recorder.summary_states[buffer->get_thread_index()];
+        recorder.summary_events.clear();
+        if (!buffer->read(state.position, recorder.summary_events)) {
+            // Begin events of open zones may have been lost
+            state.stack.clear();
+        }
+        for (const Zone_event& event : recorder.summary_events) {
+            if (event.name != nullptr) {
+                state.stack.push_back(event);
+                continue;
+            }
+            if (state.stack.empty()) {
+                continue;
+            }
+            const Zone_event begin = state.stack.back();
+            state.stack.pop_back();
+            const int64_t duration_ns = tick_scale.duration_to_ns(event.ticks - begin.ticks);
+            Zone_summary& zone = recorder.summary_zones[begin.name];
+            zone.name      = begin.name;
+            zone.count    += 1;
+            zone.total_ns += duration_ns;
+            zone.max_ns    = std::max(zone.max_ns, duration_ns);
+        }
+    }
+
+    out.clear();
+    for (const auto& i : recorder.summary_zones) {
+        out.push_back(i.second);
+    }
+    std::sort(
+        out.begin(),
+        out.end(),
+        [](const Zone_summary& lhs, const Zone_summary& rhs) {
+            return lhs.total_ns > rhs.total_ns;
+        }
+    );
+}
+
+auto write_chrome_trace(const std::string& path) -> bool
+{
+    Recorder& recorder = get_recorder();
+    const std::vector<Thread_zone_buffer*> buffers = get_buffers();
+
+    std::ofstream out{path, std::ios::out | std::ios::trunc};
+    if (!out) {
+        return false;
+    }
+
+    // Timestamps are written relative to the oldest buffered event
+    const Tick_scale tick_scale{recorder.reference_ticks, recorder.reference_ns};
+    std::vector<std::vector<Zone_event>> thread_events(buffers.size());
+    int64_t time_origin = now_ns();
+    for (std::size_t i = 0, end = buffers.size(); i < end; ++i) {
+        uint64_t position{0};
+        static_cast<void>(buffers[i]->read(position, thread_events[i]));
+        if (!thread_events[i].empty()) {
+            time_origin = std::min(time_origin, tick_scale.to_ns(thread_events[i].front().ticks));
+        }
+    }
+
+    out << "{\"traceEvents\":[\n";
+    bool first = true;
+    const auto separator = [&out, &first]() {
+        if (!first) {
+            out << ",\n";
+        }
+        first = false;
+    };
+
+    for (std::size_t i = 0, end = buffers.size(); i < end; ++i) {
+        const uint32_t tid = buffers[i]->get_thread_index();
+        separator();
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+            << ",\"args\":{\"name\":\"Thread " << tid << "\"}}";
+
+        // End events of zones which began before the oldest buffered event are skipped
+        std::size_t depth{0};
+        for (const Zone_event& event : thread_events[i]) {
+            if (event.name == nullptr) {
+                if (depth == 0) {
+                    continue;
+                }
+                --depth;
+            } else {
+                ++depth;
+            }
+            separator();
+            out << "{\"ph\":\"" << ((event.name != nullptr) ? 'B' : 'E') << "\",\"pid\":1,\"tid\":" << tid << ",\"ts\":";
+            write_json_time(out, tick_scale.to_ns(event.ticks) - time_origin);
+            if (event.name != nullptr) {
+                out << ",\"name\":";
+                write_json_string(out, event.name);
+            }
+            out << '}';
+        }
+    }
+
+    const uint64_t frame_count = recorder.frame_count.load(std::memory_order_acquire);
+    const uint64_t first_frame = (frame_count > Recorder::s_frame_capacity) ? frame_count - Recorder::s_frame_capacity : 0;
+    for (uint64_t frame = first_frame; frame < frame_count; ++frame) {
+        const int64_t time_ns = recorder.frame_end_times[frame % Recorder::s_frame_capacity];
+        if (time_ns < time_origin) {
+            continue;
+        }
+        separator();
+        out << "{\"name\":\"Frame " << frame << "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":";
+        write_json_time(out, time_ns - time_origin);
+        out << '}';
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+} // namespace erhe::profile
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+#   else
+#       include <x86intrin.h>
+#   endif
+#endif
+
+namespace erhe::profile
+{
+
+// Built-in zone recorder, used when ERHE_PROFILE_LIBRARY_BUILTIN is defined.
+//
+// Each thread records zone begin and end events to its own fixed size ring
+// buffer. Recording does not lock or allocate; it only reads the time stamp
+// counter and writes one event. Readers (summary, trace export) copy events
+// and discard those which were overwritten while copying. Buffers are not
+// freed while the recorder is alive; when a thread exits, its buffer is
+// handed to the next registering thread, so the buffer count is bounded by
+// the peak number of threads.
+
+// Time stamp counter on x86-64, steady_clock nanoseconds elsewhere.
+// Readers convert ticks to nanoseconds with a calibrated scale.
+[[nodiscard]] inline auto read_ticks() -> int64_t
+{
+#if defined(_M_X64) || defined(__x86_64__)
+    return static_cast<int64_t>(__rdtsc());
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+#endif
+}
+
+class Zone_event
+{
+public:
+    int64_t     ticks{0};       // read_ticks()
+    const char* name {nullptr}; // nullptr for zone end; must have static storage
+};
+
+class Thread_zone_buffer final
+{
+public:
+    static constexpr std::size_t s_capacity{32768}; // power of two
+
+    explicit Thread_zone_buffer(uint32_t thread_index);
+
+    void push(const char* name)
+    {
+        const uint64_t write = m_write.load(std::memory_order_relaxed);
+        m_events[write & (s_capacity - 1)] = Zone_event{
+            .ticks = read_ticks(),
+            .name  = name
+        };
+        m_write.store(write + 1, std::memory_order_release);
+    }
+
+    // Appends events from position to latest to out and advances position.
+    // Returns false if some events were lost since position.
+    auto read(uint64_t& position, std::vector<Zone_event>& out) const -> bool;
+
+    [[nodiscard]] auto get_thread_index() const -> uint32_t;
+
+private:
+    uint32_t                           m_thread_index{0};
+    std::atomic<uint64_t>              m_write       {0};
+    std::array<Zone_event, s_capacity> m_events;
+};
+
+// Returns nullptr for a thread which has already released its buffer.
+// Buffers of exited threads are reused by new threads.
+[[nodiscard]] auto register_thread() -> Thread_zone_buffer*;
+
+inline thread_local Thread_zone_buffer* t_thread_zone_buffer{nullptr};
+inline std::atomic<bool>                g_zone_recording    {true};
+
+[[nodiscard]] inline auto get_thread_zone_buffer() -> Thread_zone_buffer*
+{
+    Thread_zone_buffer* buffer = t_thread_zone_buffer;
+    if (buffer == nullptr) [[unlikely]] {
+        buffer = register_thread();
+    }
+    return buffer;
+}
+
+class Zone_scope final
+{
+public:
+    explicit Zone_scope(const char* name)
+        : m_buffer{
+            g_zone_recording.load(std::memory_order_relaxed)
+                ? get_thread_zone_buffer()
+                : nullptr
+        }
+    {
+        if (m_buffer != nullptr) {
+            m_buffer->push(name);
+        }
+    }
+    ~Zone_scope() noexcept
+    {
+        if (m_buffer != nullptr) {
+            m_buffer->push(nullptr);
+        }
+    }
+    Zone_scope    (const Zone_scope&) = delete;
+    void operator=(const Zone_scope&) = delete;
+    Zone_scope    (Zone_scope&&)      = delete;
+    void operator=(Zone_scope&&)      = delete;
+
+private:
+    Thread_zone_buffer* m_buffer;
+};
+
+class Zone_summary
+{
+public:
+    const char* name    {nullptr};
+    uint64_t    count   {0};
+    int64_t     total_ns{0}; // inclusive
+    int64_t     max_ns  {0};
+};
+
+void set_recording(bool enabled);
+void end_frame    ();
+
+[[nodiscard]] auto get_frame_count() -> uint64_t;
+
+// Aggregates zones which ended since previous call, sorted by total time.
+// Calling once per frame gives per frame timings.
+void collect_zone_summary(std::vector<Zone_summary>& out);
+
+// Writes currently buffered zones and frame markers of all threads as
+// Chrome trace event JSON (chrome://tracing, Perfetto).
+auto write_chrome_trace(const std::string& path) -> bool;
+
+} // namespace erhe::profile
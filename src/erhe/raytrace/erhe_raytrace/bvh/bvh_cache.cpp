@@ -0,0 +1,331 @@
+#if defined(_MSC_VER)
+#   pragma warning(push)
+#   pragma warning(disable : 4702) // unreachable code
+#   pragma warning(disable : 4714) // marked as __forceinline not inlined
+#endif
+
+#include "erhe_raytrace/bvh/bvh_cache.hpp"
+#include "erhe_raytrace/raytrace_log.hpp"
+
+#include "erhe_configuration/configuration.hpp"
+#include "erhe_file/file.hpp"
+#include "erhe_file/mapped_file.hpp"
+#include "erhe_hash/hash.hpp"
+#include "erhe_profile/profile.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+namespace erhe::raytrace
+{
+
+namespace {
+
+// Bump when the file layout or the meaning of its contents changes
+constexpr uint32_t c_format_version = 1;
+constexpr uint32_t c_magic          = 0x48564245u; // 'EBVH'
+
+using Bvh = bvh::v2::Bvh<Bvh_node>;
+
+static_assert(std::is_trivially_copyable_v<Bvh_node>);
+
+class File_header
+{
+public:
+    uint32_t magic;
+    uint32_t format_version;
+    uint64_t key;
+    uint64_t config_hash;
+    uint32_t node_size;
+    uint32_t prim_id_size;
+    uint64_t node_count;
+    uint64_t prim_id_count;
+};
+static_assert(sizeof(File_header) == 48);
+
+auto read_config() -> Bvh_cache_config
+{
+    Bvh_cache_config config;
+    auto ini = erhe::configuration::get_ini("erhe.ini", "raytrace");
+    std::size_t disk_budget_megabytes = config.disk_budget_bytes / (1024 * 1024);
+    std::string quality = "high";
+    ini->get("bvh_cache",           config.enabled);
+    ini->get("bvh_cache_directory", config.directory);
+    ini->get("bvh_cache_size",      disk_budget_megabytes);
+    ini->get("bvh_quality",         quality);
+    config.disk_budget_bytes = disk_budget_megabytes * 1024 * 1024;
+    quality = erhe::configuration::to_lower(quality);
+    if (quality == "low") {
+        config.quality = Bvh_builder::Quality::Low;
+    } else if (quality == "medium") {
+        config.quality = Bvh_builder::Quality::Medium;
+    } else {
+        config.quality = Bvh_builder::Quality::High;
+    }
+    return config;
+}
+
+auto get_config_hash() -> uint64_t
+{
+    static const uint64_t config_hash = []() {
+        const Bvh_builder::Config builder_config = Bvh_cache::builder_config();
+        const uint64_t values[] = {
+            c_format_version,
+            static_cast<uint64_t>(builder_config.quality),
+            static_cast<uint64_t>(builder_config.min_leaf_size),
+            static_cast<uint64_t>(builder_config.max_leaf_size),
+            sizeof(Bvh_node),
+            sizeof(std::size_t)
+        };
+        return erhe::hash::xxh64(values, sizeof(values), 0);
+    }();
+    return config_hash;
+}
+
+auto get_path(const uint64_t key) -> std::filesystem::path
+{
+    return std::filesystem::path{Bvh_cache::get_config().directory} / fmt::format("{:016x}.bvh", key);
+}
+
+// Matches names written by get_path() only. Temporary files of saves in
+// progress and files not written by the cache are never counted or evicted.
+auto is_cache_file_name(const std::filesystem::path& path) -> bool
+{
+    const std::string name = path.filename().string();
+    if ((name.size() != 16 + 4) || (name.compare(16, 4, ".bvh") != 0)) {
+        return false;
+    }
+    return std::all_of(
+        name.begin(),
+        name.begin() + 16,
+        [](const char c) {
+            return ((c >= '0') && (c <= '9')) || ((c >= 'a') && (c <= 'f'));
+        }
+    );
+}
+
+// Unique per process and save, so that concurrent saves of the same key
+// do not write to the same temporary file
+auto get_temp_path(const uint64_t key) -> std::filesystem::path
+{
+    static const uint64_t        s_salt = (static_cast<uint64_t>(std::random_device{}()) << 32) ^ std::random_device{}();
+    static std::atomic<uint64_t> s_counter{0};
+    return std::filesystem::path{Bvh_cache::get_config().directory} / fmt::format("{:016x}.{:016x}.{}.tmp", key, s_salt, s_counter.fetch_add(1));
+}
+
+// Approximate size of cache files. Scanned from disk on first use
+// and whenever it goes over budget, otherwise maintained from saves.
+std::mutex  s_disk_usage_mutex;
+bool        s_disk_usage_scanned{false};
+std::size_t s_disk_usage_bytes  {0};
+
+class Cache_file
+{
+public:
+    std::filesystem::path           path;
+    std::size_t                     byte_count;
+    std::filesystem::file_time_type time;
+};
+
+auto scan_cache_files(std::vector<Cache_file>& files) -> std::size_t
+{
+    std::size_t total_byte_count{0};
+    std::error_code error_code;
+    std::filesystem::directory_iterator i{Bvh_cache::get_config().directory, error_code};
+    if (error_code) {
+        return 0;
+    }
+    for (const auto& entry : i) {
+        if (!entry.is_regular_file(error_code) || !is_cache_file_name(entry.path())) {
+            continue;
+        }
+        const std::size_t byte_count = static_cast<std::size_t>(entry.file_size(error_code));
+        if (error_code) {
+            continue;
+        }
+        const auto time = entry.last_write_time(error_code);
+        if (error_code) {
+            continue;
+        }
+        files.push_back(Cache_file{entry.path(), byte_count, time});
+        total_byte_count += byte_count;
+    }
+    return total_byte_count;
+}
+
+void evict_locked()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const std::size_t budget = Bvh_cache::get_config().disk_budget_bytes;
+    std::vector<Cache_file> files;
+    s_disk_usage_bytes   = scan_cache_files(files);
+    s_disk_usage_scanned = true;
+    if (s_disk_usage_bytes <= budget) {
+        return;
+    }
+
+    std::sort(
+        files.begin(),
+        files.end(),
+        [](const Cache_file& lhs, const Cache_file& rhs) {
+            return lhs.time < rhs.time;
+        }
+    );
+    for (const Cache_file& file : files) {
+        if (s_disk_usage_bytes <= budget) {
+            break;
+        }
+        std::error_code error_code;
+        if (std::filesystem::remove(file.path, error_code)) {
+            log_geometry->trace("BVH cache evicted {}", erhe::file::to_string(file.path));
+            s_disk_usage_bytes -= file.byte_count;
+        }
+    }
+}
+
+} // anonymous namespace
+
+auto Bvh_cache::get_config() -> const Bvh_cache_config&
+{
+    static const Bvh_cache_config config = read_config();
+    return config;
+}
+
+auto Bvh_cache::builder_config() -> Bvh_builder::Config
+{
+    Bvh_builder::Config config;
+    config.quality = get_config().quality;
+    return config;
+}
+
+auto Bvh_cache::make_key(const void* triangle_data, const std::size_t byte_count) -> uint64_t
+{
+    ERHE_PROFILE_FUNCTION();
+
+    return erhe::hash::xxh64(triangle_data, byte_count, get_config_hash());
+}
+
+auto Bvh_cache::load(Bvh& bvh, const uint64_t key) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (!get_config().enabled) {
+        return false;
+    }
+
+    const std::filesystem::path path = get_path(key);
+    erhe::file::Mapped_file file{path};
+    if (!file.is_valid() || (file.byte_count() < sizeof(File_header))) {
+        return false;
+    }
+
+    File_header header;
+    std::memcpy(&header, file.data(), sizeof(File_header));
+    if (
+        (header.magic          != c_magic         ) ||
+        (header.format_version != c_format_version) ||
+        (header.key            != key             ) ||
+        (header.config_hash    != get_config_hash()) ||
+        (header.node_size      != sizeof(Bvh_node)) ||
+        (header.prim_id_size   != sizeof(std::size_t))
+    ) {
+        log_geometry->warn("BVH cache file {} is stale or invalid", erhe::file::to_string(path));
+        return false;
+    }
+
+    const std::size_t node_bytes    = static_cast<std::size_t>(header.node_count)    * sizeof(Bvh_node);
+    const std::size_t prim_id_bytes = static_cast<std::size_t>(header.prim_id_count) * sizeof(std::size_t);
+    if (file.byte_count() != sizeof(File_header) + node_bytes + prim_id_bytes) {
+        log_geometry->warn("BVH cache file {} has unexpected size", erhe::file::to_string(path));
+        return false;
+    }
+
+    const std::byte* node_data    = file.data() + sizeof(File_header);
+    const std::byte* prim_id_data = node_data + node_bytes;
+    bvh.nodes   .resize(static_cast<std::size_t>(header.node_count));
+    bvh.prim_ids.resize(static_cast<std::size_t>(header.prim_id_count));
+    std::memcpy(bvh.nodes   .data(), node_data,    node_bytes);
+    std::memcpy(bvh.prim_ids.data(), prim_id_data, prim_id_bytes);
+
+    // Refresh file time for least recently used eviction
+    std::error_code error_code;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error_code);
+    return true;
+}
+
+auto Bvh_cache::save(const Bvh& bvh, const uint64_t key) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (!get_config().enabled) {
+        return false;
+    }
+
+    const File_header header{
+        .magic          = c_magic,
+        .format_version = c_format_version,
+        .key            = key,
+        .config_hash    = get_config_hash(),
+        .node_size      = sizeof(Bvh_node),
+        .prim_id_size   = sizeof(std::size_t),
+        .node_count     = bvh.nodes.size(),
+        .prim_id_count  = bvh.prim_ids.size()
+    };
+    const std::size_t node_bytes    = bvh.nodes   .size() * sizeof(Bvh_node);
+    const std::size_t prim_id_bytes = bvh.prim_ids.size() * sizeof(std::size_t);
+
+    const std::filesystem::path path = get_path(key);
+    std::error_code error_code;
+    std::filesystem::create_directories(path.parent_path(), error_code);
+    if (error_code) {
+        log_geometry->warn("BVH cache directory {} could not be created: {}", erhe::file::to_string(path.parent_path()), error_code.message());
+        return false;
+    }
+
+    // Write to a temporary file in the same directory and rename it into
+    // place, so that concurrent loads never see a partially written file.
+    const std::filesystem::path temp_path = get_temp_path(key);
+    {
+        std::ofstream out{temp_path, std::ofstream::binary | std::ofstream::trunc};
+        if (!out) {
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header),             sizeof(File_header));
+        out.write(reinterpret_cast<const char*>(bvh.nodes   .data()), static_cast<std::streamsize>(node_bytes));
+        out.write(reinterpret_cast<const char*>(bvh.prim_ids.data()), static_cast<std::streamsize>(prim_id_bytes));
+        out.close();
+        if (!out) {
+            std::filesystem::remove(temp_path, error_code);
+            return false;
+        }
+    }
+    std::filesystem::rename(temp_path, path, error_code);
+    if (error_code) {
+        log_geometry->warn("BVH cache file {} could not be replaced: {}", erhe::file::to_string(path), error_code.message());
+        std::filesystem::remove(temp_path, error_code);
+        return false;
+    }
+
+    const std::lock_guard<std::mutex> lock{s_disk_usage_mutex};
+    s_disk_usage_bytes += sizeof(File_header) + node_bytes + prim_id_bytes;
+    if (!s_disk_usage_scanned || (s_disk_usage_bytes > get_config().disk_budget_bytes)) {
+        evict_locked();
+    }
+    return true;
+}
+
+} // namespace erhe::raytrace
+
+#if defined(_MSC_VER)
+#   pragma warning(pop)
+#endif
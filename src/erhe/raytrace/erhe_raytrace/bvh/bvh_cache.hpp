@@ -0,0 +1,58 @@
+#pragma once
+
+#if defined(_MSC_VER)
+#   pragma warning(push)
+#   pragma warning(disable : 4702) // unreachable code
+#   pragma warning(disable : 4714) // marked as __forceinline not inlined
+#endif
+
+#include <bvh/v2/bvh.h>
+#include <bvh/v2/default_builder.h>
+#include <bvh/v2/node.h>
+
+#include <cstdint>
+#include <string>
+
+namespace erhe::raytrace
+{
+
+using Bvh_node    = bvh::v2::Node<float, 3>;
+using Bvh_builder = bvh::v2::DefaultBuilder<Bvh_node>;
+
+class Bvh_cache_config
+{
+public:
+    bool                 enabled          {true};
+    std::string          directory        {"cache/bvh"};
+    std::size_t          disk_budget_bytes{256 * 1024 * 1024};
+    Bvh_builder::Quality quality          {Bvh_builder::Quality::High};
+};
+
+// On disk cache of built BVHs.
+//
+// Cache files are keyed by a hash of the triangle data, seeded with a hash
+// of the builder configuration and the cache file format version, so that
+// changing either of those never loads a stale tree. Files are loaded with
+// a read-only memory mapping and bulk copied into the BVH arrays. Files are
+// written to a temporary file and renamed into place. Total size of cache
+// files is kept under disk_budget_bytes by deleting least recently used
+// cache files; a cache hit refreshes the file time. Temporary files and
+// other files in the cache directory are not counted or deleted.
+class Bvh_cache
+{
+public:
+    [[nodiscard]] static auto get_config   () -> const Bvh_cache_config&;
+    [[nodiscard]] static auto builder_config() -> Bvh_builder::Config;
+
+    // Returns cache key for triangle data (tightly packed, 9 floats per triangle)
+    [[nodiscard]] static auto make_key(const void* triangle_data, std::size_t byte_count) -> uint64_t;
+
+    static auto load(bvh::v2::Bvh<Bvh_node>& bvh, uint64_t key) -> bool;
+    static auto save(const bvh::v2::Bvh<Bvh_node>& bvh, uint64_t key) -> bool;
+};
+
+} // namespace erhe::raytrace
+
+#if defined(_MSC_VER)
+#   pragma warning(pop)
+#endif
@@ -7,64 +7,28 @@
 #include <fmt/chrono.h>
 
 #include "erhe_raytrace/bvh/bvh_geometry.hpp"
+#include "erhe_raytrace/bvh/bvh_cache.hpp"
 #include "erhe_raytrace/bvh/bvh_instance.hpp"
 #include "erhe_raytrace/bvh/glm_conversions.hpp"
 #include "erhe_raytrace/ibuffer.hpp"
 #include "erhe_raytrace/raytrace_log.hpp"
 #include "erhe_raytrace/ray.hpp"
 
-#include "erhe_hash/hash.hpp"
 #include "erhe_profile/profile.hpp"
 #include "erhe_time/timer.hpp"
+#include "erhe_verify/verify.hpp"
 
 #include <bvh/v2/bvh.h>
 #include <bvh/v2/default_builder.h>
-#include <bvh/v2/executor.h>
 #include <bvh/v2/node.h>
 #include <bvh/v2/ray.h>
 #include <bvh/v2/stack.h>
-#include <bvh/v2/thread_pool.h>
 
-#include <fstream>
+#include <array>
 
 namespace erhe::raytrace
 {
 
-using Bvh = bvh::v2::Bvh<bvh::v2::Node<float, 3>>;
-
-auto save_bvh(const Bvh& bvh, const uint64_t hash_code) -> bool
-{
-    std::string file_name = fmt::format("cache/bvh/{}", hash_code);
-    std::ofstream out{file_name, std::ofstream::binary};
-    if (!out) {
-        return false;
-    }
-
-    try {
-        bvh::v2::StdOutputStream stream{out};
-        bvh.serialize(stream);
-        return true;
-    } catch (...) {
-        return false;
-    }
-}
-
-auto load_bvh(Bvh& bvh, const uint64_t hash_code) -> bool
-{
-    std::string file_name = fmt::format("cache/bvh/{}", hash_code);
-    std::ifstream in{file_name, std::ofstream::binary};
-    if (!in) {
-        return false;
-    }
-    try {
-        bvh::v2::StdInputStream stream{in};
-        bvh = Bvh::deserialize(stream);
-        return true;
-    } catch (...) {
-        return false;
-    }
-}
-
 auto IGeometry::create(
     const std::string_view debug_label,
     const Geometry_type    geometry_type
@@ -110,10 +74,6 @@ using PrecomputedTri = bvh::v2::PrecomputedTri<Scalar>;
 
 static constexpr bool should_permute = false; //// TODO
 
-// TODO Are these ok here?
-bvh::v2::ThreadPool thread_pool;
-bvh::v2::ParallelExecutor executor{thread_pool};
-
 void Bvh_geometry::commit()
 {
     ERHE_PROFILE_FUNCTION();
@@ -160,8 +120,9 @@ void Bvh_geometry::commit()
         const std::size_t triangle_count = index_buffer_info->item_count;
 
         std::vector<Tri> tris;
+        tris.reserve(triangle_count);
 
-        uint64_t hash_code{0xcbf29ce484222325};
+        uint64_t hash_code{0};
         std::vector<BBox> bboxes(triangle_count);
         std::vector<Vec3> centers(triangle_count);
         {
@@ -172,21 +133,17 @@ void Bvh_geometry::commit()
                 const uint32_t i1 = *reinterpret_cast<const uint32_t*>(raw_index_ptr + i * index_buffer_info->byte_stride + 1 * sizeof(uint32_t));
                 const uint32_t i2 = *reinterpret_cast<const uint32_t*>(raw_index_ptr + i * index_buffer_info->byte_stride + 2 * sizeof(uint32_t));
 
-                const float p0_x = *reinterpret_cast<const float*>(raw_vertex_ptr + i0 * index_buffer_info->byte_stride + 0 * sizeof(float));
-                const float p0_y = *reinterpret_cast<const float*>(raw_vertex_ptr + i0 * index_buffer_info->byte_stride + 1 * sizeof(float));
-                const float p0_z = *reinterpret_cast<const float*>(raw_vertex_ptr + i0 * index_buffer_info->byte_stride + 2 * sizeof(float));
-
-                const float p1_x = *reinterpret_cast<const float*>(raw_vertex_ptr + i1 * index_buffer_info->byte_stride + 0 * sizeof(float));
-                const float p1_y = *reinterpret_cast<const float*>(raw_vertex_ptr + i1 * index_buffer_info->byte_stride + 1 * sizeof(float));
-                const float p1_z = *reinterpret_cast<const float*>(raw_vertex_ptr + i1 * index_buffer_info->byte_stride + 2 * sizeof(float));
+                const float p0_x = *reinterpret_cast<const float*>(raw_vertex_ptr + i0 * vertex_buffer_info->byte_stride + 0 * sizeof(float));
+                const float p0_y = *reinterpret_cast<const float*>(raw_vertex_ptr + i0 * vertex_buffer_info->byte_stride + 1 * sizeof(float));
+                const float p0_z = *reinterpret_cast<const float*>(raw_vertex_ptr + i0 * vertex_buffer_info->byte_stride + 2 * sizeof(float));
 
-                const float p2_x = *reinterpret_cast<const float*>(raw_vertex_ptr + i2 * index_buffer_info->byte_stride + 0 * sizeof(float));
-                const float p2_y = *reinterpret_cast<const float*>(raw_vertex_ptr + i2 * index_buffer_info->byte_stride + 1 * sizeof(float));
-                const float p2_z = *reinterpret_cast<const float*>(raw_vertex_ptr + i2 * index_buffer_info->byte_stride + 2 * sizeof(float));
+                const float p1_x = *reinterpret_cast<const float*>(raw_vertex_ptr + i1 * vertex_buffer_info->byte_stride + 0 * sizeof(float));
+                const float p1_y = *reinterpret_cast<const float*>(raw_vertex_ptr + i1 * vertex_buffer_info->byte_stride + 1 * sizeof(float));
+                const float p1_z = *reinterpret_cast<const float*>(raw_vertex_ptr + i1 * vertex_buffer_info->byte_stride + 2 * sizeof(float));
 
-                hash_code = erhe::hash::hash(p0_x, p0_y, p0_z, hash_code);
-                hash_code = erhe::hash::hash(p1_x, p1_y, p1_z, hash_code);
-                hash_code = erhe::hash::hash(p2_x, p2_y, p2_z, hash_code);
+                const float p2_x = *reinterpret_cast<const float*>(raw_vertex_ptr + i2 * vertex_buffer_info->byte_stride + 0 * sizeof(float));
+                const float p2_y = *reinterpret_cast<const float*>(raw_vertex_ptr + i2 * vertex_buffer_info->byte_stride + 1 * sizeof(float));
+                const float p2_z = *reinterpret_cast<const float*>(raw_vertex_ptr + i2 * vertex_buffer_info->byte_stride + 2 * sizeof(float));
 
                 const bvh::v2::Tri<float, 3> triangle{
                     Vec3{p0_x, p0_y, p0_z},
@@ -197,54 +154,50 @@ void Bvh_geometry::commit()
                 bboxes[i] = triangle.get_bbox();
                 centers[i] = triangle.get_center();
             }
+        }
+        {
+            ERHE_PROFILE_SCOPE("hash");
+            static_assert(sizeof(Tri) == 9 * sizeof(float));
+            hash_code = Bvh_cache::make_key(tris.data(), tris.size() * sizeof(Tri));
             log_geometry->trace("BVH hash for {} : {:x}", debug_label(), hash_code);
         }
 
-        const bool load_ok = load_bvh(m_bvh, hash_code);
+        const bool load_ok = Bvh_cache::load(m_bvh, hash_code);
         if (!load_ok) {
-            typename bvh::v2::DefaultBuilder<Node>::Config config;
-            //config.quality = bvh::v2::DefaultBuilder<Node>::Quality::High;
-            config.quality = bvh::v2::DefaultBuilder<Node>::Quality::Low;
+            const typename bvh::v2::DefaultBuilder<Node>::Config config = Bvh_cache::builder_config();
 
             {
                 ERHE_PROFILE_SCOPE("bvh build");
                 erhe::time::Timer timer{m_debug_label.c_str()};
 
+                // Single threaded; commit() may itself run as a task on the
+                // application thread pool, one geometry per task.
                 timer.begin();
-                m_bvh = bvh::v2::DefaultBuilder<Node>::build(
-                    thread_pool,
-                    bboxes,
-                    centers,
-                    config
-                );
+                m_bvh = bvh::v2::DefaultBuilder<Node>::build(bboxes, centers, config);
                 timer.end();
 
                 const auto time = std::chrono::duration_cast<std::chrono::milliseconds>(timer.duration().value()).count();
                 log_geometry->trace("BVH build {} in {} ms", debug_label(), time);
             }
 
-            const bool save_ok = save_bvh(m_bvh, hash_code);
-            if (!save_ok) {
+            const bool save_ok = Bvh_cache::save(m_bvh, hash_code);
+            if (!save_ok && Bvh_cache::get_config().enabled) {
                 log_geometry->warn("BVH save failed, hash = {}", hash_code);
             }
         }
 
 
+        m_bounding_box = m_bvh.nodes.empty() ? BBox::make_empty() : m_bvh.get_root().get_bbox();
+
         // This precomputes some data to speed up traversal further.
         {
             ERHE_PROFILE_SCOPE("bvh precompute");
             m_precomputed_triangles.clear();
             m_precomputed_triangles.resize(tris.size());
-            executor.for_each(
-                0,
-                tris.size(),
-                [&] (const size_t begin, const size_t end) {
-                    for (size_t i = begin; i < end; ++i) {
-                        auto j = should_permute ? m_bvh.prim_ids[i] : i;
-                        m_precomputed_triangles[i] = tris[j];
-                    }
-                }
-            );
+            for (size_t i = 0, end = tris.size(); i < end; ++i) {
+                auto j = should_permute ? m_bvh.prim_ids[i] : i;
+                m_precomputed_triangles[i] = tris[j];
+            }
         }
     }
 
@@ -364,11 +317,93 @@ auto Bvh_geometry::intersect_instance(
     return false;
 }
 
+auto Bvh_geometry::intersect_packet(
+    Bvh_ray_packet&                 packet,
+    const Bvh_ray_packet::Lane_mask lanes,
+    Bvh_instance*                   instance
+) -> Bvh_ray_packet::Lane_mask
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (!m_enabled || m_bvh.nodes.empty()) {
+        return 0;
+    }
+    const Bvh_ray_packet::Lane_mask mask_lanes = packet.mask_test(m_mask, lanes);
+    if (mask_lanes == 0) {
+        return 0;
+    }
+
+    const auto transform = (instance != nullptr)
+        ? instance->get_transform()
+        : glm::mat4{1.0};
+
+    static constexpr size_t stack_size = 64;
+
+    // Each stack entry carries the lanes which entered the node
+    class Stack_entry
+    {
+    public:
+        size_t                    node_index;
+        Bvh_ray_packet::Lane_mask lanes;
+    };
+    std::array<Stack_entry, stack_size> stack;
+    size_t                              stack_top{0};
+
+    Bvh_ray_packet::Lane_mask hit_lanes{0};
+    stack[stack_top++] = Stack_entry{0, mask_lanes};
+    while (stack_top > 0) {
+        const Stack_entry entry = stack[--stack_top];
+        const Node& node = m_bvh.nodes[entry.node_index];
+        const Bvh_ray_packet::Lane_mask node_lanes = packet.intersect_bbox(node.get_bbox(), entry.lanes);
+        if (node_lanes == 0) {
+            continue;
+        }
+        const size_t first_id = node.index.first_id();
+        if (!node.is_leaf()) {
+            ERHE_VERIFY(stack_top + 2 <= stack_size);
+            stack[stack_top++] = Stack_entry{first_id + 1, node_lanes};
+            stack[stack_top++] = Stack_entry{first_id,     node_lanes};
+            continue;
+        }
+        for (size_t i = first_id, end = first_id + node.index.prim_count(); i < end; ++i) {
+            const size_t triangle_index = should_permute ? i : m_bvh.prim_ids[i];
+            const PrecomputedTri& triangle = m_precomputed_triangles[triangle_index];
+            for_each_lane(
+                node_lanes,
+                [&](const std::size_t lane) {
+                    bvh::v2::Ray<Scalar, 3> bvh_ray{
+                        Vec3{packet.origin_x   [lane], packet.origin_y   [lane], packet.origin_z   [lane]},
+                        Vec3{packet.direction_x[lane], packet.direction_y[lane], packet.direction_z[lane]},
+                        packet.t_near[lane],
+                        packet.t_far [lane]
+                    };
+                    if (auto triangle_hit = triangle.intersect(bvh_ray)) {
+                        packet.t_far[lane] = bvh_ray.tmax;
+                        Hit& hit = *packet.hits[lane];
+                        hit.triangle_id = static_cast<unsigned int>(triangle_index);
+                        hit.uv          = glm::vec2{triangle_hit->first, triangle_hit->second};
+                        hit.normal      = glm::vec3{transform * glm::vec4{from_bvh(triangle.n), 0.0f}};
+                        hit.instance    = instance;
+                        hit.geometry    = this;
+                        hit_lanes |= (Bvh_ray_packet::Lane_mask{1} << lane);
+                    }
+                }
+            );
+        }
+    }
+    return hit_lanes;
+}
+
 /// auto Bvh_geometry::get_sphere() const -> const erhe::math::Bounding_sphere&
 /// {
 ///     return m_bounding_sphere;
 /// }
 
+auto Bvh_geometry::get_bounding_box() const -> const bvh::v2::BBox<float, 3>&
+{
+    return m_bounding_box;
+}
+
 auto Bvh_geometry::get_mask() const -> uint32_t
 {
     return m_mask;
@@ -6,6 +6,7 @@
 #   pragma warning(disable : 4714) // marked as __forceinline not inlined
 #endif
 
+#include "erhe_raytrace/bvh/bvh_ray_packet.hpp"
 #include "erhe_raytrace/igeometry.hpp"
 
 #include <glm/glm.hpp>
@@ -58,6 +59,14 @@ public:
     // Bvh_geometry public API
     auto intersect_instance(Ray& ray, Hit& hit, Bvh_instance* instance) -> bool;
 
+    // Traces the given lanes of packet; returns lanes which hit this geometry
+    auto intersect_packet(
+        Bvh_ray_packet&           packet,
+        Bvh_ray_packet::Lane_mask lanes,
+        Bvh_instance*             instance
+    ) -> Bvh_ray_packet::Lane_mask;
+    [[nodiscard]] auto get_bounding_box() const -> const bvh::v2::BBox<float, 3>&;
+
 private:
     class Buffer_info
     {
@@ -82,6 +91,7 @@ private:
 
     std::vector<bvh::v2::PrecomputedTri<float>> m_precomputed_triangles;
     bvh::v2::Bvh<bvh::v2::Node<float, 3>>       m_bvh;
+    bvh::v2::BBox<float, 3>                     m_bounding_box{bvh::v2::BBox<float, 3>::make_empty()};
 };
 
 }
@@ -1,6 +1,7 @@
 #include "erhe_raytrace/bvh/bvh_instance.hpp"
 #include "erhe_log/log_glm.hpp"
 #include "erhe_raytrace/bvh/bvh_scene.hpp"
+#include "erhe_raytrace/bvh/glm_conversions.hpp"
 #include "erhe_raytrace/iscene.hpp"
 #include "erhe_raytrace/ray.hpp"
 #include "erhe_raytrace/raytrace_log.hpp"
@@ -38,6 +39,50 @@ Bvh_instance::~Bvh_instance() noexcept
 
 void Bvh_instance::commit()
 {
+    update_world_bounding_box();
+}
+
+void Bvh_instance::update_world_bounding_box()
+{
+    using BBox = bvh::v2::BBox<float, 3>;
+
+    if (m_owner_scene != nullptr) {
+        m_owner_scene->set_instance_bounds_dirty();
+    }
+
+    m_world_bounding_box = BBox::make_empty();
+    if (m_scene == nullptr) {
+        return;
+    }
+    const auto* bvh_scene = reinterpret_cast<const Bvh_scene*>(m_scene);
+    const BBox& local_bounding_box = bvh_scene->get_bounding_box();
+    if (!is_valid(local_bounding_box)) {
+        return;
+    }
+
+    // Transform the eight corners of the scene space box
+    const glm::vec3 local_min = from_bvh(local_bounding_box.min);
+    const glm::vec3 local_max = from_bvh(local_bounding_box.max);
+    for (unsigned int corner = 0; corner < 8; ++corner) {
+        const glm::vec4 local_corner{
+            ((corner & 1u) != 0) ? local_max.x : local_min.x,
+            ((corner & 2u) != 0) ? local_max.y : local_min.y,
+            ((corner & 4u) != 0) ? local_max.z : local_min.z,
+            1.0f
+        };
+        const glm::vec3 world_corner = glm::vec3{m_transform * local_corner};
+        m_world_bounding_box.extend(to_bvh(world_corner));
+    }
+}
+
+auto Bvh_instance::get_world_bounding_box() const -> const bvh::v2::BBox<float, 3>&
+{
+    return m_world_bounding_box;
+}
+
+void Bvh_instance::set_owner_scene(Bvh_scene* owner_scene)
+{
+    m_owner_scene = owner_scene;
 }
 
 void Bvh_instance::enable()
@@ -61,11 +106,13 @@ void Bvh_instance::set_transform(const glm::mat4 transform)
 {
     //log_frame->trace("Bvh_instance::set_transform {}", m_debug_label);
     m_transform = transform;
+    update_world_bounding_box();
 }
 
 void Bvh_instance::set_scene(IScene* scene)
 {
     m_scene = scene;
+    update_world_bounding_box();
 }
 
 void Bvh_instance::set_mask(const uint32_t mask)
@@ -103,6 +150,34 @@ auto Bvh_instance::intersect(Ray& ray, Hit& hit) -> bool
     return is_hit;
 }
 
+auto Bvh_instance::intersect_packet(
+    Bvh_ray_packet&                 packet,
+    const Bvh_ray_packet::Lane_mask lanes
+) -> Bvh_ray_packet::Lane_mask
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (!m_enabled) {
+        return 0;
+    }
+    const Bvh_ray_packet::Lane_mask mask_lanes = packet.mask_test(m_mask, lanes);
+    if (mask_lanes == 0) {
+        return 0;
+    }
+
+    const auto inverse_transform = glm::inverse(get_transform());
+    Bvh_ray_packet local_packet = packet.transform(inverse_transform);
+    auto* bvh_scene = reinterpret_cast<Bvh_scene*>(get_scene());
+    const Bvh_ray_packet::Lane_mask hit_lanes = bvh_scene->intersect_instance_packet(local_packet, mask_lanes, this);
+    for_each_lane(
+        hit_lanes,
+        [&](const std::size_t lane) {
+            packet.t_far[lane] = local_packet.t_far[lane];
+        }
+    );
+    return hit_lanes;
+}
+
 #if 0
 void Bvh_instance::collect_spheres(
     std::vector<bvh::Sphere<float>>& spheres,
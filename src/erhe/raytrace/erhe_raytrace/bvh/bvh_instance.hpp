@@ -1,9 +1,12 @@
 #pragma once
 
+#include "erhe_raytrace/bvh/bvh_ray_packet.hpp"
 #include "erhe_raytrace/iinstance.hpp"
 
 #include <glm/glm.hpp>
 
+#include <bvh/v2/bbox.h>
+
 #include <string>
 
 namespace erhe::raytrace
@@ -35,14 +38,27 @@ public:
 
     // Bvh_instance public API
     auto intersect(Ray& ray, Hit& hit) -> bool;
+    auto intersect_packet(Bvh_ray_packet& packet, Bvh_ray_packet::Lane_mask lanes) -> Bvh_ray_packet::Lane_mask;
+
+    // World space bounds of the instanced scene, updated by commit(), set_transform()
+    // and set_scene(). Changes mark the owner scene instance bounds dirty.
+    [[nodiscard]] auto get_world_bounding_box() const -> const bvh::v2::BBox<float, 3>&;
+
+    // Scene this instance is attached to, maintained by Bvh_scene attach() and detach()
+    void set_owner_scene(Bvh_scene* owner_scene);
 
 private:
-    glm::mat4   m_transform{1.0f};
-    bool        m_enabled  {true};
-    IScene*     m_scene    {nullptr};
-    uint32_t    m_mask     {0xffffffffu};
-    void*       m_user_data{nullptr};
+    void update_world_bounding_box();
+
+    glm::mat4   m_transform  {1.0f};
+    bool        m_enabled    {true};
+    IScene*     m_scene      {nullptr}; // instanced scene
+    Bvh_scene*  m_owner_scene{nullptr}; // scene this instance is attached to
+    uint32_t    m_mask       {0xffffffffu};
+    void*       m_user_data  {nullptr};
     std::string m_debug_label;
+
+    bvh::v2::BBox<float, 3> m_world_bounding_box{bvh::v2::BBox<float, 3>::make_empty()};
 };
 
 }
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "erhe_raytrace/ray.hpp"
+
+#include <bvh/v2/bbox.h>
+#include <glm/glm.hpp>
+#include <gsl/span>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace erhe::raytrace
+{
+
+// Structure of arrays ray packet used by the bvh backend to trace several
+// rays through one BVH traversal. Per lane loops over the fixed size arrays
+// are written so that the compiler can vectorize them (4 lanes for SSE,
+// 8 lanes for AVX).
+//
+// Lanes are selected with bit masks; bit N set means lane N takes part.
+template <std::size_t Width>
+class Ray_packet
+{
+public:
+    static_assert(Width <= 32);
+
+    static constexpr std::size_t width = Width;
+    using Lane_mask = uint32_t;
+
+    static constexpr Lane_mask all_lanes = (Width == 32)
+        ? 0xffffffffu
+        : ((1u << Width) - 1u);
+
+    std::array<float,    Width> origin_x           {};
+    std::array<float,    Width> origin_y           {};
+    std::array<float,    Width> origin_z           {};
+    std::array<float,    Width> direction_x        {};
+    std::array<float,    Width> direction_y        {};
+    std::array<float,    Width> direction_z        {};
+    std::array<float,    Width> inverse_direction_x{};
+    std::array<float,    Width> inverse_direction_y{};
+    std::array<float,    Width> inverse_direction_z{};
+    std::array<float,    Width> t_near             {};
+    std::array<float,    Width> t_far              {};
+    std::array<uint32_t, Width> ray_mask           {};
+    std::array<Hit*,     Width> hits               {};
+    Lane_mask                   active             {0};
+
+    // Loads up to Width rays; lanes beyond rays.size() are left inactive
+    void load(gsl::span<const Ray> rays, gsl::span<Hit> in_hits)
+    {
+        const std::size_t count = std::min(std::min(rays.size(), in_hits.size()), Width);
+        active = 0;
+        for (std::size_t lane = 0; lane < count; ++lane) {
+            const Ray& ray = rays[lane];
+            origin_x   [lane] = ray.origin.x;
+            origin_y   [lane] = ray.origin.y;
+            origin_z   [lane] = ray.origin.z;
+            direction_x[lane] = ray.direction.x;
+            direction_y[lane] = ray.direction.y;
+            direction_z[lane] = ray.direction.z;
+            t_near     [lane] = ray.t_near;
+            t_far      [lane] = ray.t_far;
+            ray_mask   [lane] = ray.mask;
+            hits       [lane] = &in_hits[lane];
+            active |= (Lane_mask{1} << lane);
+        }
+        update_inverse_directions();
+    }
+
+    // Writes back t_far, which is shortened by hits like in IScene::intersect()
+    void store_t_far(gsl::span<Ray> rays) const
+    {
+        const std::size_t count = std::min(rays.size(), Width);
+        for (std::size_t lane = 0; lane < count; ++lane) {
+            rays[lane].t_far = t_far[lane];
+        }
+    }
+
+    // Returns packet with origins and directions transformed by matrix.
+    // t_near and t_far are preserved, matching Ray::transform().
+    [[nodiscard]] auto transform(const glm::mat4& m) const -> Ray_packet
+    {
+        Ray_packet result = *this;
+        for (std::size_t lane = 0; lane < Width; ++lane) {
+            const float ox = origin_x[lane];
+            const float oy = origin_y[lane];
+            const float oz = origin_z[lane];
+            const float dx = direction_x[lane];
+            const float dy = direction_y[lane];
+            const float dz = direction_z[lane];
+            result.origin_x   [lane] = m[0][0] * ox + m[1][0] * oy + m[2][0] * oz + m[3][0];
+            result.origin_y   [lane] = m[0][1] * ox + m[1][1] * oy + m[2][1] * oz + m[3][1];
+            result.origin_z   [lane] = m[0][2] * ox + m[1][2] * oy + m[2][2] * oz + m[3][2];
+            result.direction_x[lane] = m[0][0] * dx + m[1][0] * dy + m[2][0] * dz;
+            result.direction_y[lane] = m[0][1] * dx + m[1][1] * dy + m[2][1] * dz;
+            result.direction_z[lane] = m[0][2] * dx + m[1][2] * dy + m[2][2] * dz;
+        }
+        result.update_inverse_directions();
+        return result;
+    }
+
+    // Lanes which pass the given geometry / instance mask
+    [[nodiscard]] auto mask_test(const uint32_t mask, const Lane_mask lanes) const -> Lane_mask
+    {
+        Lane_mask result = 0;
+        for (std::size_t lane = 0; lane < Width; ++lane) {
+            if ((ray_mask[lane] & mask) != 0) {
+                result |= (Lane_mask{1} << lane);
+            }
+        }
+        return result & lanes;
+    }
+
+    // Slab test of all lanes against bbox; returns lanes which hit within [t_near, t_far]
+    [[nodiscard]] auto intersect_bbox(const bvh::v2::BBox<float, 3>& bbox, const Lane_mask lanes) const -> Lane_mask
+    {
+        std::array<bool, Width> lane_hit;
+        for (std::size_t lane = 0; lane < Width; ++lane) {
+            const float tx0 = (bbox.min[0] - origin_x[lane]) * inverse_direction_x[lane];
+            const float tx1 = (bbox.max[0] - origin_x[lane]) * inverse_direction_x[lane];
+            const float ty0 = (bbox.min[1] - origin_y[lane]) * inverse_direction_y[lane];
+            const float ty1 = (bbox.max[1] - origin_y[lane]) * inverse_direction_y[lane];
+            const float tz0 = (bbox.min[2] - origin_z[lane]) * inverse_direction_z[lane];
+            const float tz1 = (bbox.max[2] - origin_z[lane]) * inverse_direction_z[lane];
+            const float t_entry = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), t_near[lane]));
+            const float t_exit  = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), t_far [lane]));
+            lane_hit[lane] = t_entry <= t_exit;
+        }
+        Lane_mask result = 0;
+        for (std::size_t lane = 0; lane < Width; ++lane) {
+            if (lane_hit[lane]) {
+                result |= (Lane_mask{1} << lane);
+            }
+        }
+        return result & lanes;
+    }
+
+private:
+    [[nodiscard]] static auto safe_inverse(const float x) -> float
+    {
+        return (std::abs(x) <= std::numeric_limits<float>::epsilon())
+            ? std::copysign(1.0f / std::numeric_limits<float>::epsilon(), x)
+            : 1.0f / x;
+    }
+
+    void update_inverse_directions()
+    {
+        for (std::size_t lane = 0; lane < Width; ++lane) {
+            inverse_direction_x[lane] = safe_inverse(direction_x[lane]);
+            inverse_direction_y[lane] = safe_inverse(direction_y[lane]);
+            inverse_direction_z[lane] = safe_inverse(direction_z[lane]);
+        }
+    }
+};
+
+// Packet width used by the bvh backend. 8 matches AVX registers; 4 is
+// a better fit for SSE only targets.
+static constexpr std::size_t bvh_packet_width = 8;
+
+using Bvh_ray_packet = Ray_packet<bvh_packet_width>;
+
+// Calls fn(lane) for each set bit in lanes
+template <typename Fn>
+inline void for_each_lane(uint32_t lanes, Fn&& fn)
+{
+    while (lanes != 0) {
+        const std::size_t lane = static_cast<std::size_t>(std::countr_zero(lanes));
+        fn(lane);
+        lanes &= lanes - 1u;
+    }
+}
+
+} // namespace erhe::raytrace
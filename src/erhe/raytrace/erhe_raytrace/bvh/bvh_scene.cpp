@@ -8,12 +8,21 @@
 #include "erhe_log/log_glm.hpp"
 #include "erhe_raytrace/bvh/bvh_geometry.hpp"
 #include "erhe_raytrace/bvh/bvh_instance.hpp"
+#include "erhe_raytrace/bvh/glm_conversions.hpp"
 #include "erhe_raytrace/iinstance.hpp"
 #include "erhe_raytrace/raytrace_log.hpp"
 #include "erhe_raytrace/ray.hpp"
 #include "erhe_profile/profile.hpp"
 #include "erhe_verify/verify.hpp"
 
+#include <bvh/v2/default_builder.h>
+#include <bvh/v2/ray.h>
+#include <bvh/v2/stack.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
 namespace erhe::raytrace
 {
 
@@ -40,6 +49,9 @@ Bvh_scene::Bvh_scene(const std::string_view debug_label)
 
 Bvh_scene::~Bvh_scene() noexcept
 {
+    for (const auto& instance : m_instances) {
+        instance->set_owner_scene(nullptr);
+    }
     log_scene->trace("Destroyed Bvh_scene '{}'", m_debug_label);
 }
 
@@ -78,6 +90,8 @@ void Bvh_scene::attach(IInstance* instance)
 #endif
     {
         m_instances.push_back(bvh_instance);
+        bvh_instance->set_owner_scene(this);
+        m_instance_bvh_dirty = true;
     }
 }
 
@@ -110,30 +124,295 @@ void Bvh_scene::detach(IInstance* instance)
         log_scene->error("raytrace instance not in scene");
     } else {
         m_instances.erase(i, m_instances.end());
+        bvh_instance->set_owner_scene(nullptr);
+        m_instance_bvh_dirty = true;
     }
 }
 
 void Bvh_scene::commit()
 {
-    // TODO
+    ERHE_PROFILE_FUNCTION();
+
+    if (m_instance_bvh_dirty) {
+        build_instance_bvh();
+    } else {
+        refit_instance_bvh();
+    }
+
+    m_bounding_box = BBox::make_empty();
+    for (const auto& geometry : m_geometries) {
+        const BBox& geometry_bounding_box = geometry->get_bounding_box();
+        if (is_valid(geometry_bounding_box)) {
+            m_bounding_box.extend(geometry_bounding_box);
+        }
+    }
+    if (!m_instance_bvh.nodes.empty()) {
+        m_bounding_box.extend(m_instance_bvh.get_root().get_bbox());
+    }
 }
 
-auto Bvh_scene::intersect(Ray& ray, Hit& hit) -> bool
+void Bvh_scene::build_instance_bvh()
 {
-    log_frame->trace(
-        "Bvh_scene {} intersect mask = {:04x} instances = {}, geometries = {}, ray origin = {}, direction = {}",
-        m_debug_label, ray.mask, m_instances.size(), m_geometries.size(), ray.origin, ray.direction
+    ERHE_PROFILE_FUNCTION();
+
+    m_instance_bvh = bvh::v2::Bvh<Node>{};
+    m_bvh_instances.clear();
+    m_unbounded_instances.clear();
+
+    std::vector<BBox>                   bboxes;
+    std::vector<bvh::v2::Vec<float, 3>> centers;
+    bboxes .reserve(m_instances.size());
+    centers.reserve(m_instances.size());
+    m_bvh_instances.reserve(m_instances.size());
+    for (const auto& instance : m_instances) {
+        const BBox& world_bounding_box = instance->get_world_bounding_box();
+        if (!is_valid(world_bounding_box)) {
+            m_unbounded_instances.push_back(instance);
+            continue;
+        }
+        m_bvh_instances.push_back(instance);
+        bboxes .push_back(world_bounding_box);
+        centers.push_back(world_bounding_box.get_center());
+    }
+
+    if (!m_bvh_instances.empty()) {
+        typename bvh::v2::DefaultBuilder<Node>::Config config;
+        config.quality = bvh::v2::DefaultBuilder<Node>::Quality::Low;
+        m_instance_bvh = bvh::v2::DefaultBuilder<Node>::build(bboxes, centers, config);
+    }
+
+    log_scene->trace(
+        "Bvh_scene {} built instance BVH: {} instances, {} unbounded, {} nodes",
+        m_debug_label, m_bvh_instances.size(), m_unbounded_instances.size(), m_instance_bvh.nodes.size()
     );
 
+    m_instance_bvh_dirty    = false;
+    m_instance_bounds_dirty = false;
+}
+
+void Bvh_scene::refit_instance_bvh()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    m_instance_bounds_dirty = false;
+
+    // Instances which have gained or lost bounds since the last build
+    // change the set of primitives in the BVH, which requires a rebuild.
+    for (const auto& instance : m_unbounded_instances) {
+        if (is_valid(instance->get_world_bounding_box())) {
+            build_instance_bvh();
+            return;
+        }
+    }
+    for (const auto& instance : m_bvh_instances) {
+        if (!is_valid(instance->get_world_bounding_box())) {
+            build_instance_bvh();
+            return;
+        }
+    }
+
+    if (!m_instance_bvh.nodes.empty()) {
+        refit_instance_node(0);
+    }
+}
+
+auto Bvh_scene::refit_instance_node(const std::size_t node_index) -> BBox
+{
+    Node& node = m_instance_bvh.nodes[node_index];
+    BBox bbox = BBox::make_empty();
+    const std::size_t first_id = node.index.first_id();
+    if (node.is_leaf()) {
+        const std::size_t prim_count = node.index.prim_count();
+        for (std::size_t i = first_id, end = first_id + prim_count; i < end; ++i) {
+            const Bvh_instance* instance = m_bvh_instances[m_instance_bvh.prim_ids[i]];
+            bbox.extend(instance->get_world_bounding_box());
+        }
+    } else {
+        bbox.extend(refit_instance_node(first_id));
+        bbox.extend(refit_instance_node(first_id + 1));
+    }
+    node.set_bbox(bbox);
+    return bbox;
+}
+
+auto Bvh_scene::intersect_instances(Ray& ray, Hit& hit) -> bool
+{
     ERHE_PROFILE_FUNCTION();
 
     bool is_hit = false;
-    for (const auto& instance : m_instances) {
+
+    // Without an up to date top-level BVH, fall back to testing every instance
+    if (m_instance_bvh_dirty) {
+        for (const auto& instance : m_instances) {
+            const bool instance_is_hit = instance->intersect(ray, hit);
+            if (instance_is_hit) {
+                is_hit = true;
+            }
+        }
+        return is_hit;
+    }
+    if (m_instance_bounds_dirty) {
+        refit_instance_bvh();
+    }
+
+    for (const auto& instance : m_unbounded_instances) {
         const bool instance_is_hit = instance->intersect(ray, hit);
         if (instance_is_hit) {
             is_hit = true;
         }
     }
+
+    if (m_instance_bvh.nodes.empty()) {
+        return is_hit;
+    }
+
+    bvh::v2::Ray<float, 3> bvh_ray{
+        to_bvh(ray.origin),
+        to_bvh(ray.direction),
+        ray.t_near,
+        ray.t_far
+    };
+
+    static constexpr std::size_t stack_size           = 64;
+    static constexpr bool        use_robust_traversal = false;
+
+    bvh::v2::SmallStack<bvh::v2::Bvh<Node>::Index, stack_size> stack;
+    m_instance_bvh.intersect<false, use_robust_traversal>(
+        bvh_ray,
+        m_instance_bvh.get_root().index,
+        stack,
+        [&] (const std::size_t begin, const std::size_t end)
+        {
+            for (std::size_t i = begin; i < end; ++i) {
+                Bvh_instance* instance = m_bvh_instances[m_instance_bvh.prim_ids[i]];
+                ray.t_far = bvh_ray.tmax;
+                const bool instance_is_hit = instance->intersect(ray, hit);
+                if (instance_is_hit) {
+                    is_hit = true;
+                    // Shrink ray so that remaining nodes behind this hit get culled
+                    bvh_ray.tmax = ray.t_far;
+                }
+            }
+            return false;
+        }
+    );
+    ray.t_far = bvh_ray.tmax;
+    return is_hit;
+}
+
+auto Bvh_scene::intersect_instances_packet(
+    Bvh_ray_packet&                 packet,
+    const Bvh_ray_packet::Lane_mask lanes
+) -> Bvh_ray_packet::Lane_mask
+{
+    ERHE_PROFILE_FUNCTION();
+
+    Bvh_ray_packet::Lane_mask hit_lanes{0};
+
+    if (m_instance_bvh_dirty) {
+        for (const auto& instance : m_instances) {
+            hit_lanes |= instance->intersect_packet(packet, lanes);
+        }
+        return hit_lanes;
+    }
+    if (m_instance_bounds_dirty) {
+        refit_instance_bvh();
+    }
+
+    for (const auto& instance : m_unbounded_instances) {
+        hit_lanes |= instance->intersect_packet(packet, lanes);
+    }
+
+    if (m_instance_bvh.nodes.empty()) {
+        return hit_lanes;
+    }
+
+    static constexpr std::size_t stack_size = 64;
+
+    class Stack_entry
+    {
+    public:
+        std::size_t               node_index;
+        Bvh_ray_packet::Lane_mask lanes;
+    };
+    std::array<Stack_entry, stack_size> stack;
+    std::size_t                         stack_top{0};
+
+    stack[stack_top++] = Stack_entry{0, lanes};
+    while (stack_top > 0) {
+        const Stack_entry entry = stack[--stack_top];
+        const Node& node = m_instance_bvh.nodes[entry.node_index];
+        const Bvh_ray_packet::Lane_mask node_lanes = packet.intersect_bbox(node.get_bbox(), entry.lanes);
+        if (node_lanes == 0) {
+            continue;
+        }
+        const std::size_t first_id = node.index.first_id();
+        if (!node.is_leaf()) {
+            ERHE_VERIFY(stack_top + 2 <= stack_size);
+            stack[stack_top++] = Stack_entry{first_id + 1, node_lanes};
+            stack[stack_top++] = Stack_entry{first_id,     node_lanes};
+            continue;
+        }
+        for (std::size_t i = first_id, end = first_id + node.index.prim_count(); i < end; ++i) {
+            Bvh_instance* instance = m_bvh_instances[m_instance_bvh.prim_ids[i]];
+            hit_lanes |= instance->intersect_packet(packet, node_lanes);
+        }
+    }
+    return hit_lanes;
+}
+
+auto Bvh_scene::intersect_instance_packet(
+    Bvh_ray_packet&                 packet,
+    const Bvh_ray_packet::Lane_mask lanes,
+    Bvh_instance*                   in_instance
+) -> Bvh_ray_packet::Lane_mask
+{
+    if (in_instance == nullptr) {
+        return intersect_instances_packet(packet, lanes);
+    }
+
+    Bvh_ray_packet::Lane_mask hit_lanes{0};
+    for (const auto& geometry : m_geometries) {
+        hit_lanes |= geometry->intersect_packet(packet, lanes, in_instance);
+    }
+    return hit_lanes;
+}
+
+auto Bvh_scene::intersect_batch(gsl::span<Ray> rays, gsl::span<Hit> hits) -> std::size_t
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ERHE_VERIFY(rays.size() == hits.size());
+
+    std::size_t hit_count{0};
+    Bvh_ray_packet packet;
+    for (std::size_t offset = 0; offset < rays.size(); offset += Bvh_ray_packet::width) {
+        const std::size_t count = std::min(Bvh_ray_packet::width, rays.size() - offset);
+        gsl::span<Ray> packet_rays = rays.subspan(offset, count);
+        gsl::span<Hit> packet_hits = hits.subspan(offset, count);
+        std::fill(packet_hits.begin(), packet_hits.end(), Hit{});
+        packet.load(packet_rays, packet_hits);
+
+        Bvh_ray_packet::Lane_mask hit_lanes = intersect_instances_packet(packet, packet.active);
+        for (const auto& geometry : m_geometries) {
+            hit_lanes |= geometry->intersect_packet(packet, packet.active, nullptr);
+        }
+        packet.store_t_far(packet_rays);
+        hit_count += static_cast<std::size_t>(std::popcount(hit_lanes));
+    }
+    return hit_count;
+}
+
+auto Bvh_scene::intersect(Ray& ray, Hit& hit) -> bool
+{
+    log_frame->trace(
+        "Bvh_scene {} intersect mask = {:04x} instances = {}, geometries = {}, ray origin = {}, direction = {}",
+        m_debug_label, ray.mask, m_instances.size(), m_geometries.size(), ray.origin, ray.direction
+    );
+
+    ERHE_PROFILE_FUNCTION();
+
+    bool is_hit = intersect_instances(ray, hit);
     for (const auto& geometry : m_geometries) {
         const bool geometry_is_hit = geometry->intersect_instance(ray, hit, nullptr);
         if (geometry_is_hit) {
@@ -145,25 +424,30 @@ auto Bvh_scene::intersect(Ray& ray, Hit& hit) -> bool
 
 auto Bvh_scene::intersect_instance(Ray& ray, Hit& hit, Bvh_instance* in_instance) -> bool
 {
-    bool is_hit = false;
     if (in_instance == nullptr) {
-        for (const auto& instance : m_instances) {
-            const bool instance_is_hit = instance->intersect(ray, hit);
-            if (instance_is_hit) {
-                is_hit = true;
-            }
-        }
-    } else {
-        for (const auto& geometry : m_geometries) {
-            const bool geometry_is_hit = geometry->intersect_instance(ray, hit, in_instance);
-            if (geometry_is_hit) {
-                is_hit = true;
-            }
+        return intersect_instances(ray, hit);
+    }
+
+    bool is_hit = false;
+    for (const auto& geometry : m_geometries) {
+        const bool geometry_is_hit = geometry->intersect_instance(ray, hit, in_instance);
+        if (geometry_is_hit) {
+            is_hit = true;
         }
     }
     return is_hit;
 }
 
+auto Bvh_scene::get_bounding_box() const -> const bvh::v2::BBox<float, 3>&
+{
+    return m_bounding_box;
+}
+
+void Bvh_scene::set_instance_bounds_dirty()
+{
+    m_instance_bounds_dirty = true;
+}
+
 auto Bvh_scene::debug_label() const -> std::string_view
 {
     return m_debug_label;
@@ -6,9 +6,12 @@
 #   pragma warning(disable : 4714) // marked as __forceinline not inlined
 #endif
 
+#include "erhe_raytrace/bvh/bvh_ray_packet.hpp"
 #include "erhe_raytrace/iscene.hpp"
 
+#include <bvh/v2/bbox.h>
 #include <bvh/v2/bvh.h>
+#include <bvh/v2/node.h>
 
 #include <string>
 #include <vector>
@@ -34,15 +37,51 @@ public:
     void detach     (IInstance* geometry)        override;
     void commit     ()                           override;
     auto intersect  (Ray& ray, Hit& hit) -> bool override;
+    auto intersect_batch(gsl::span<Ray> rays, gsl::span<Hit> hits) -> std::size_t override;
     auto debug_label() const -> std::string_view override;
 
     // Bvh_scene public API
     auto intersect_instance(Ray& ray, Hit& hit, Bvh_instance* instance) -> bool;
+    auto intersect_instance_packet(
+        Bvh_ray_packet&           packet,
+        Bvh_ray_packet::Lane_mask lanes,
+        Bvh_instance*             instance
+    ) -> Bvh_ray_packet::Lane_mask;
+
+    // Scene space bounds of all geometries and instances, updated by commit()
+    [[nodiscard]] auto get_bounding_box() const -> const bvh::v2::BBox<float, 3>&;
+
+    // Called by attached instances when their world space bounds change
+    void set_instance_bounds_dirty();
 
 private:
+    using Node = bvh::v2::Node<float, 3>;
+    using BBox = bvh::v2::BBox<float, 3>;
+
+    void build_instance_bvh ();
+    void refit_instance_bvh ();
+    auto refit_instance_node(std::size_t node_index) -> BBox;
+    auto intersect_instances(Ray& ray, Hit& hit) -> bool;
+    auto intersect_instances_packet(Bvh_ray_packet& packet, Bvh_ray_packet::Lane_mask lanes) -> Bvh_ray_packet::Lane_mask;
+
     std::vector<Bvh_geometry*> m_geometries;
     std::vector<Bvh_instance*> m_instances;
     std::string                m_debug_label;
+    BBox                       m_bounding_box{BBox::make_empty()};
+
+    // Top-level BVH over instance world space bounds. Instances are indexed
+    // by m_bvh_instances; instances without valid bounds (not yet committed
+    // or empty) are kept in m_unbounded_instances and tested separately.
+    // Attach and detach mark the BVH dirty; commit() then rebuilds it, and
+    // queries test every instance until then. Instance bound changes mark
+    // the bounds dirty; commit() or the next query then refits the BVH.
+    // Because of the lazy refit, queries on one scene must not run
+    // concurrently with each other.
+    bvh::v2::Bvh<Node>         m_instance_bvh;
+    std::vector<Bvh_instance*> m_bvh_instances;
+    std::vector<Bvh_instance*> m_unbounded_instances;
+    bool                       m_instance_bvh_dirty   {true};
+    bool                       m_instance_bounds_dirty{false};
 };
 
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <bvh/v2/bbox.h>
 #include <bvh/v2/vec.h>
 #include <glm/glm.hpp>
 
@@ -20,4 +21,13 @@ namespace erhe::raytrace
     return bvh::v2::Vec<float, 3>{v.x, v.y, v.z};
 }
 
+// Empty boxes (from BBox::make_empty()) have min > max
+[[nodiscard]] inline auto is_valid(const bvh::v2::BBox<float, 3>& bbox) -> bool
+{
+    return
+        (bbox.min[0] <= bbox.max[0]) &&
+        (bbox.min[1] <= bbox.max[1]) &&
+        (bbox.min[2] <= bbox.max[2]);
+}
+
 } // namespace erhe::physics
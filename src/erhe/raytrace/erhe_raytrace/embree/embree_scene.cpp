@@ -249,6 +249,21 @@ void Embree_scene::intersect(Ray& ray, Hit& hit)
     }
 }
 
+auto Embree_scene::intersect_batch(gsl::span<Ray> rays, gsl::span<Hit> hits) -> std::size_t
+{
+    std::size_t hit_count{0};
+    const std::size_t count = std::min(rays.size(), hits.size());
+    for (std::size_t i = 0; i < count; ++i) {
+        // Hit of an earlier call must not be counted as a hit of this call
+        hits[i] = Hit{};
+        intersect(rays[i], hits[i]);
+        if (hits[i].geometry != nullptr) {
+            ++hit_count;
+        }
+    }
+    return hit_count;
+}
+
 //void Embree_scene::set_dirty()
 //{
 //    m_dirty = true;
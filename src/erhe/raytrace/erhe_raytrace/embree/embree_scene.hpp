@@ -47,6 +47,7 @@ public:
     // rtcGetSceneLinearBounds()
 
     void intersect(Ray& ray, Hit& out_hit) override;
+    auto intersect_batch(gsl::span<Ray> rays, gsl::span<Hit> hits) -> std::size_t override; // rtcIntersect1() per ray
 
     //void set_dirty();
     auto get_rtc_scene() -> RTCScene;
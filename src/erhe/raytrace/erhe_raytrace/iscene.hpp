@@ -1,5 +1,7 @@
 #pragma once
 
+#include <gsl/span>
+
 #include <memory>
 #include <string_view>
 
@@ -22,6 +24,13 @@ public:
     virtual void detach   (IInstance* instance) = 0;
     virtual void commit   () = 0;
     virtual auto intersect(Ray& ray, Hit& hit) -> bool = 0;
+
+    // Traces rays[i] into hits[i] for all i, with the same closest hit rules
+    // as intersect(). rays and hits must have the same size. Every hits[i] is
+    // reset to Hit{} first, so rays which miss have hits[i].geometry nullptr
+    // even if hits holds results of an earlier call. Backends may trace rays
+    // in packets. Returns the number of rays which hit something.
+    virtual auto intersect_batch(gsl::span<Ray> rays, gsl::span<Hit> hits) -> std::size_t = 0;
     [[nodiscard]] virtual auto debug_label() const -> std::string_view = 0;
 
     [[nodiscard]] static auto create       (const std::string_view debug_label) -> IScene*;
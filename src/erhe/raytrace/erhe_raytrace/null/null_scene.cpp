@@ -1,8 +1,11 @@
 #include "erhe_raytrace/null/null_scene.hpp"
 #include "erhe_raytrace/null/null_geometry.hpp"
 #include "erhe_raytrace/iinstance.hpp"
+#include "erhe_raytrace/ray.hpp"
 #include "erhe_raytrace/raytrace_log.hpp"
 
+#include <algorithm>
+
 namespace erhe::raytrace
 {
 
@@ -92,8 +95,22 @@ void Null_scene::commit()
 {
 }
 
-void Null_scene::intersect(Ray&, Hit&)
+auto Null_scene::intersect(Ray&, Hit&) -> bool
 {
+    return false;
+}
+
+auto Null_scene::intersect_batch(gsl::span<Ray> rays, gsl::span<Hit> hits) -> std::size_t
+{
+    std::size_t hit_count{0};
+    const std::size_t count = std::min(rays.size(), hits.size());
+    for (std::size_t i = 0; i < count; ++i) {
+        hits[i] = Hit{};
+        if (intersect(rays[i], hits[i])) {
+            ++hit_count;
+        }
+    }
+    return hit_count;
 }
 
 auto Null_scene::debug_label() const -> std::string_view
@@ -23,7 +23,8 @@ public:
     void detach   (IGeometry* geometry) override;
     void detach   (IInstance* geometry) override;
     void commit   ()           override;
-    void intersect(Ray&, Hit&) override;
+    auto intersect(Ray& ray, Hit& hit) -> bool override;
+    auto intersect_batch(gsl::span<Ray> rays, gsl::span<Hit> hits) -> std::size_t override;
     [[nodiscard]] auto debug_label() const -> std::string_view override;
 
 private:
@@ -280,6 +280,9 @@ void Text_renderer::next_frame()
     m_projection_writer.reset();
     m_index_range_first = 0;
     m_index_count       = 0;
+    if (m_font) {
+        m_font->begin_frame();
+    }
 }
 
 void Text_renderer::print(
@@ -350,6 +353,8 @@ void Text_renderer::render(
 
     //ERHE_PROFILE_GPU_SCOPE(c_text_renderer_render)
 
+    m_font->update_texture();
+
     const auto handle = m_graphics_instance.get_handle(
         *m_font->texture().get(),
         m_nearest_sampler
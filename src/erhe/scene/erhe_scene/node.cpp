@@ -215,6 +215,8 @@ void Node::handle_add_attachment(
     log->trace("'{}'::handle_add_attachment '{}'", describe(), attachment->get_name());
     position = std::min(node_data.attachments.size(), position);
     node_data.attachments.insert(node_data.attachments.begin() + position, attachment);
+    bump_subtree_serial();
+    queue_node_changed(Scene_message::bit_attachments);
 }
 
 void Node::handle_remove_attachment(
@@ -233,6 +235,8 @@ void Node::handle_remove_attachment(
     if (i != node_data.attachments.end()) {
         log->trace("Removing attachment '{}' from node '{}'", attachment_to_remove->get_name(), get_name());
         node_data.attachments.erase(i, node_data.attachments.end());
+        bump_subtree_serial();
+        queue_node_changed(Scene_message::bit_attachments);
     } else {
         log->error(
             "attachment '{}' cannot be removed from node '{}': attachment not found",
@@ -250,6 +254,15 @@ void Node::handle_flag_bits_update(
     for (const auto& attachment : get_attachments()) {
         attachment->handle_node_flag_bits_update(old_flag_bits, new_flag_bits);
     }
+    queue_node_changed(Scene_message::bit_flags);
+}
+
+void Node::queue_node_changed(const unsigned int changes)
+{
+    Scene* const scene = get_scene();
+    if (scene != nullptr) {
+        scene->queue_node_changed(*this, changes);
+    }
 }
 
 auto Node::get_attachments() const -> const std::vector<std::shared_ptr<Node_attachment>>&
@@ -288,6 +301,12 @@ void Node::handle_parent_update(
     erhe::Item_host* const new_item_host = (new_parent != nullptr) ? new_parent->get_item_host() : nullptr;
     if (old_item_host != new_item_host) {
         handle_item_host_update(old_item_host, new_item_host);
+    } else {
+        Scene* const scene = get_scene();
+        if (scene != nullptr) {
+            scene->handle_node_parent_update();
+            scene->queue_node_changed(*this, Scene_message::bit_parent);
+        }
     }
 
     hierarchy_sanity_check();
@@ -131,6 +131,9 @@ public:
     void set_node_from_world   (const Transform& node_from_world);
 
     Node_data node_data;
+
+private:
+    void queue_node_changed(unsigned int changes);
 };
 
 [[nodiscard]] auto is_node(const erhe::Item_base* item) -> bool;
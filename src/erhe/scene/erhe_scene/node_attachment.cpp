@@ -49,6 +49,14 @@ void Node_attachment::handle_node_transform_update()
 {
 }
 
+void Node_attachment::handle_item_update()
+{
+    // Attachments are shown as part of the node in hierarchy views
+    if (m_node != nullptr) {
+        m_node->bump_subtree_serial();
+    }
+}
+
 void Node_attachment::handle_node_update(Node* old_node, Node* new_node)
 {
     const uint64_t old_flag_bits = old_node ? old_node->get_flag_bits() : 0;
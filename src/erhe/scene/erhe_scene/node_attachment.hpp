@@ -34,6 +34,7 @@ public:
 
     // Implements Item_base
     auto get_item_host() const -> erhe::Item_host* override;
+    void handle_item_update() override;
 
     // Public API
     virtual auto clone_attachment() const -> std::shared_ptr<Node_attachment>;
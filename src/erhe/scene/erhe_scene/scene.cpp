@@ -279,10 +279,11 @@ void Scene::sort_transform_nodes()
             return lhs->get_depth() < rhs->get_depth();
         }
     );
+    m_transform_hierarchy.rebuild(m_flat_node_vector);
     m_nodes_sorted = true;
 }
 
-void Scene::update_node_transforms()
+void Scene::update_node_transforms(erhe::concurrency::Thread_pool* thread_pool)
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -290,12 +291,120 @@ void Scene::update_node_transforms()
         sort_transform_nodes();
     }
 
-    for (auto& node : m_flat_node_vector) {
-        if (node->is_no_transform_update()) {
-            continue;
+    if (!m_message_bus.is_node_changed_enabled()) {
+        m_transform_hierarchy.update(thread_pool);
+        return;
+    }
+
+    m_local_changed_nodes.clear();
+    m_transform_hierarchy.update(thread_pool, &m_local_changed_nodes);
+    for (Node* const node : m_local_changed_nodes) {
+        queue_node_changed(*node, Scene_message::bit_transform);
+    }
+}
+
+void Scene::queue_node_changed(Node& node, const unsigned int changes)
+{
+    if (!m_message_bus.is_node_changed_enabled() || ((node.get_flag_bits() & erhe::Item_flags::no_message) != 0)) {
+        return;
+    }
+    // Node may be under destruction
+    const std::shared_ptr<erhe::Item_base> item = node.weak_from_this().lock();
+    if (!item) {
+        return;
+    }
+    m_message_bus.queue_message(
+        Scene_message{
+            .event_type = Scene_event_type::node_changed,
+            .scene      = this,
+            .lhs        = std::static_pointer_cast<Node>(item),
+            .changes    = changes
         }
-        node->update_transform(0);
+    );
+}
+
+void Scene::set_world_transforms(
+    const gsl::span<Node* const>     nodes,
+    const gsl::span<const glm::vec3> translations,
+    const gsl::span<const glm::quat> rotations
+)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ERHE_VERIFY(translations.size() == nodes.size());
+    ERHE_VERIFY(rotations   .size() == nodes.size());
+
+    // One serial for the whole batch; update_node_transforms() picks up the
+    // changed parent_from_node_serial and notifies attachments in depth order.
+    const uint64_t  serial = Node_transforms::get_next_serial();
+    const glm::vec3 unit_scale{1.0f};
+
+    // World transforms first, so that parent transforms used below are
+    // up to date when both parent and child are in nodes
+    for (std::size_t i = 0, end = nodes.size(); i < end; ++i) {
+        Node_transforms& transforms = nodes[i]->node_data.transforms;
+        transforms.world_from_node.set_trs(translations[i], rotations[i], unit_scale);
+        transforms.world_from_node_serial = serial;
     }
+
+    // World transform of a parent outside the batch can be stale, when one
+    // of its ancestors has moved and update_node_transforms() has not run
+    // yet. Compose it from local transforms up to the scene root, or up to
+    // an ancestor whose world transform is current (in the batch, or world
+    // normative).
+    const auto get_world_from_parent = [this, serial](const std::shared_ptr<Node>& parent) -> glm::mat4 {
+        glm::mat4             ancestor_from_parent{1.0f};
+        std::shared_ptr<Node> ancestor = parent;
+        while (
+            ancestor &&
+            (ancestor != m_root_node) &&
+            (ancestor->node_data.transforms.world_from_node_serial != serial) &&
+            !ancestor->is_no_transform_update()
+        ) {
+            ancestor_from_parent = ancestor->parent_from_node() * ancestor_from_parent;
+            ancestor = ancestor->get_parent_node();
+        }
+        if (!ancestor || (ancestor == m_root_node)) {
+            return ancestor_from_parent;
+        }
+        return ancestor->world_from_node() * ancestor_from_parent;
+    };
+
+    // Sibling bodies typically share a parent
+    const Node* cached_parent{nullptr};
+    glm::mat4   cached_world_from_parent{1.0f};
+    glm::mat4   cached_parent_from_world{1.0f};
+
+    for (Node* const node : nodes) {
+        Node_transforms& transforms = node->node_data.transforms;
+        const std::shared_ptr<Node> parent = node->get_parent_node();
+        if (!parent || (parent == m_root_node)) {
+            transforms.parent_from_node = transforms.world_from_node;
+        } else if (parent->node_data.transforms.world_from_node_serial == serial) {
+            // Parent is in the batch, its world transform was set above
+            transforms.parent_from_node.set(
+                parent->node_from_world() * transforms.world_from_node.get_matrix(),
+                transforms.world_from_node.get_inverse_matrix() * parent->world_from_node()
+            );
+        } else {
+            if (parent.get() != cached_parent) {
+                cached_parent            = parent.get();
+                cached_world_from_parent = get_world_from_parent(parent);
+                cached_parent_from_world = glm::inverse(cached_world_from_parent);
+            }
+            transforms.parent_from_node.set(
+                cached_parent_from_world * transforms.world_from_node.get_matrix(),
+                transforms.world_from_node.get_inverse_matrix() * cached_world_from_parent
+            );
+        }
+        transforms.parent_from_node_serial = serial;
+    }
+}
+
+void Scene::handle_node_parent_update()
+{
+    // Depths and parent indices may have changed
+    m_nodes_sorted = false;
 }
 
 Scene::Scene(const Scene& src)
@@ -333,6 +442,7 @@ Scene::~Scene()
 
     m_root_node->recursive_remove();
 
+    m_transform_hierarchy.clear();
     m_flat_node_vector.clear();
     m_mesh_layers.clear();
     m_light_layers.clear();
@@ -404,6 +514,7 @@ void Scene::unregister_node(
     } else {
         node->node_data.host = nullptr;
         m_flat_node_vector.erase(i, m_flat_node_vector.end());
+        m_nodes_sorted = false;
     }
 
     sanity_check();
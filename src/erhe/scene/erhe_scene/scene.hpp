@@ -2,15 +2,22 @@
 
 #include "erhe_item/hierarchy.hpp"
 #include "erhe_scene/scene_message_bus.hpp"
+#include "erhe_scene/transform_hierarchy.hpp"
 #include "erhe_item/unique_id.hpp"
 
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <gsl/span>
 
 #include <memory>
 #include <string>
 #include <string_view>
 #include <vector>
 
+namespace erhe::concurrency {
+    class Thread_pool;
+}
+
 namespace erhe::scene
 {
 
@@ -89,7 +96,23 @@ public:
     // Public API
     void sanity_check          () const;
     void sort_transform_nodes  ();
-    void update_node_transforms();
+    void update_node_transforms(erhe::concurrency::Thread_pool* thread_pool = nullptr);
+    void handle_node_parent_update();
+
+    // Queues a node_changed message, if enabled in the message bus.
+    // Transform changes are detected in update_node_transforms().
+    void queue_node_changed(Node& node, unsigned int changes);
+
+    // Sets world transforms (with unit scale) of many nodes at once, for
+    // example from physics. Attachments and child nodes are not notified
+    // here; that happens in the next update_node_transforms(). Parents
+    // outside the batch may have pending transform changes, their world
+    // transforms are composed from ancestor local transforms.
+    void set_world_transforms(
+        gsl::span<Node* const>     nodes,
+        gsl::span<const glm::vec3> translations,
+        gsl::span<const glm::quat> rotations
+    );
 
     [[nodiscard]] auto get_mesh_by_id       (erhe::Unique_id<Node>::id_type id) const -> std::shared_ptr<Mesh>;
     [[nodiscard]] auto get_light_by_id      (erhe::Unique_id<Node>::id_type id) const -> std::shared_ptr<Light>;
@@ -131,6 +154,8 @@ private:
     std::vector<std::shared_ptr<Skin>>        m_skins;
     std::vector<std::shared_ptr<Light_layer>> m_light_layers;
     std::vector<std::shared_ptr<Camera>>      m_cameras;
+    Transform_hierarchy                       m_transform_hierarchy;
+    std::vector<Node*>                        m_local_changed_nodes;
     bool                                      m_nodes_sorted{false};
 };
 
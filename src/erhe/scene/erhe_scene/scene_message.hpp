@@ -20,10 +20,17 @@ enum class Scene_event_type : int {
 class Scene_message
 {
 public:
+    // Bits for changes in node_changed messages
+    static constexpr unsigned int bit_transform  {1u << 0}; // parent_from_node
+    static constexpr unsigned int bit_attachments{1u << 1};
+    static constexpr unsigned int bit_flags      {1u << 2};
+    static constexpr unsigned int bit_parent     {1u << 3};
+
     Scene_event_type      event_type{Scene_event_type::invalid};
     Scene*                scene{nullptr};
     std::shared_ptr<Node> lhs{};
     std::shared_ptr<Node> rhs{};
+    unsigned int          changes{0};
 };
 
 }
@@ -1,8 +1,49 @@
 #include "erhe_scene/scene_message_bus.hpp"
 
+#include <cstddef>
+#include <cstdint>
+
 namespace erhe::scene
 {
 
-Scene_message_bus::Scene_message_bus() = default;
+namespace {
+
+// Node changed messages are collapsed per node until the next update()
+auto node_changed_coalesce_key(const Scene_message& message) -> uint64_t
+{
+    if (message.event_type != Scene_event_type::node_changed) {
+        return 0;
+    }
+    return static_cast<uint64_t>(reinterpret_cast<std::uintptr_t>(message.lhs.get()));
+}
+
+void node_changed_coalesce_merge(Scene_message& queued, const Scene_message& incoming)
+{
+    queued.changes |= incoming.changes;
+}
+
+// Statistics are kept per event type
+auto statistics_kind(const Scene_message& message) -> std::size_t
+{
+    return static_cast<std::size_t>(message.event_type);
+}
+
+}
+
+Scene_message_bus::Scene_message_bus()
+{
+    set_coalescing(&node_changed_coalesce_key, &node_changed_coalesce_merge);
+    set_statistics_kinds(&statistics_kind, static_cast<std::size_t>(Scene_event_type::selection_changed) + 1);
+}
+
+void Scene_message_bus::set_node_changed_enabled(const bool enabled)
+{
+    m_node_changed_enabled = enabled;
+}
+
+auto Scene_message_bus::is_node_changed_enabled() const -> bool
+{
+    return m_node_changed_enabled;
+}
 
 } // namespace erhe::scene
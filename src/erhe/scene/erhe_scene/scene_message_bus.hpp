@@ -11,6 +11,15 @@ class Scene_message_bus
 {
 public:
     Scene_message_bus();
+
+    // node_changed messages are queued only when enabled, since they are
+    // generated for every moving node. Queued messages are coalesced per
+    // node, with changes bits merged, until update().
+    void set_node_changed_enabled(bool enabled);
+    [[nodiscard]] auto is_node_changed_enabled() const -> bool;
+
+private:
+    bool m_node_changed_enabled{false};
 };
 
 } // namespace erhe::scene
@@ -0,0 +1,207 @@
+#include "erhe_scene/transform_hierarchy.hpp"
+#include "erhe_scene/node.hpp"
+#include "erhe_scene/scene_log.hpp"
+#include "erhe_concurrency/parallel_for.hpp"
+#include "erhe_profile/profile.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace erhe::scene
+{
+
+auto Transform_hierarchy::size() const -> std::size_t
+{
+    return m_nodes.size();
+}
+
+void Transform_hierarchy::clear()
+{
+    m_nodes              .clear();
+    m_parent_nodes       .clear();
+    m_parent             .clear();
+    m_level_offsets      .clear();
+    m_parent_from_node   .clear();
+    m_node_from_parent   .clear();
+    m_world_from_node    .clear();
+    m_node_from_world    .clear();
+    m_local_serial       .clear();
+    m_world_serial       .clear();
+    m_no_transform_update.clear();
+    m_local_dirty        .clear();
+    m_world_dirty        .clear();
+}
+
+void Transform_hierarchy::rebuild(const std::vector<std::shared_ptr<Node>>& nodes)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    clear();
+
+    const std::size_t count = nodes.size();
+    m_nodes       .reserve(count);
+    m_parent_nodes.reserve(count);
+    m_parent      .reserve(count);
+
+    std::unordered_map<const Node*, int32_t> node_to_index;
+    node_to_index.reserve(count);
+
+    std::size_t previous_depth = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        Node* const node  = nodes[i].get();
+        const auto  depth = node->get_depth();
+        if ((i == 0) || (depth != previous_depth)) {
+            ERHE_VERIFY((i == 0) || (depth > previous_depth));
+            m_level_offsets.push_back(i);
+            previous_depth = depth;
+        }
+
+        const std::shared_ptr<Node> parent = node->get_parent_node();
+        const auto j = node_to_index.find(parent.get());
+        m_nodes       .push_back(node);
+        m_parent_nodes.push_back(parent.get());
+        m_parent      .push_back((j != node_to_index.end()) ? j->second : -1);
+        node_to_index[node] = static_cast<int32_t>(i);
+    }
+    m_level_offsets.push_back(count);
+
+    m_parent_from_node   .resize(count, glm::mat4{1.0f});
+    m_node_from_parent   .resize(count, glm::mat4{1.0f});
+    m_world_from_node    .resize(count, glm::mat4{1.0f});
+    m_node_from_world    .resize(count, glm::mat4{1.0f});
+    m_local_serial       .resize(count, unknown_serial);
+    m_world_serial       .resize(count, 0);
+    m_no_transform_update.resize(count, 0);
+    m_local_dirty        .resize(count, 0);
+    m_world_dirty        .resize(count, 0);
+
+    log->trace("transform hierarchy: {} nodes, {} levels", count, m_level_offsets.size() - 1);
+}
+
+void Transform_hierarchy::gather(const std::size_t begin, const std::size_t end)
+{
+    for (std::size_t i = begin; i < end; ++i) {
+        const Node* const      node       = m_nodes[i];
+        const Node_transforms& transforms = node->node_data.transforms;
+        const bool no_transform_update = node->is_no_transform_update();
+        const bool local_dirty =
+            (transforms.parent_from_node_serial != m_local_serial[i]) ||
+            (no_transform_update != (m_no_transform_update[i] != 0));
+        m_no_transform_update[i] = no_transform_update ? 1 : 0;
+        m_local_dirty[i]         = local_dirty ? 1 : 0;
+        if (!local_dirty) {
+            continue;
+        }
+        m_local_serial    [i] = transforms.parent_from_node_serial;
+        m_parent_from_node[i] = transforms.parent_from_node.get_matrix();
+        m_node_from_parent[i] = transforms.parent_from_node.get_inverse_matrix();
+        if (no_transform_update) {
+            // World transform is maintained by the node itself
+            m_world_from_node[i] = transforms.world_from_node.get_matrix();
+            m_node_from_world[i] = transforms.world_from_node.get_inverse_matrix();
+            m_world_serial   [i] = transforms.world_from_node_serial;
+        }
+    }
+}
+
+void Transform_hierarchy::propagate(const std::size_t begin, const std::size_t end)
+{
+    static const glm::mat4 identity{1.0f};
+
+    for (std::size_t i = begin; i < end; ++i) {
+        const int32_t parent = m_parent[i];
+
+        const glm::mat4* parent_world_from_node{&identity};
+        const glm::mat4* parent_node_from_world{&identity};
+        uint64_t         parent_serial         {0};
+        bool             parent_dirty          {false};
+        if (parent >= 0) {
+            parent_world_from_node = &m_world_from_node[parent];
+            parent_node_from_world = &m_node_from_world[parent];
+            parent_serial          = m_world_serial    [parent];
+            parent_dirty           = m_world_dirty     [parent] != 0;
+        } else if (m_parent_nodes[i] != nullptr) {
+            const Node_transforms& parent_transforms = m_parent_nodes[i]->node_data.transforms;
+            parent_world_from_node = &parent_transforms.world_from_node.get_matrix();
+            parent_node_from_world = &parent_transforms.world_from_node.get_inverse_matrix();
+            parent_serial          = parent_transforms.world_from_node_serial;
+            parent_dirty           = parent_serial > m_world_serial[i];
+        }
+
+        const bool dirty = (m_local_dirty[i] != 0) || parent_dirty;
+        m_world_dirty[i] = dirty ? 1 : 0;
+        if (!dirty || (m_no_transform_update[i] != 0)) {
+            continue;
+        }
+
+        m_world_from_node[i] = (*parent_world_from_node) * m_parent_from_node[i];
+        m_node_from_world[i] = m_node_from_parent[i] * (*parent_node_from_world);
+        m_world_serial   [i] = std::max(m_local_serial[i], parent_serial);
+    }
+}
+
+void Transform_hierarchy::scatter(const std::size_t begin, const std::size_t end)
+{
+    for (std::size_t i = begin; i < end; ++i) {
+        if ((m_world_dirty[i] == 0) || (m_no_transform_update[i] != 0)) {
+            continue;
+        }
+        m_nodes[i]->node_data.transforms.world_from_node.set(m_world_from_node[i], m_node_from_world[i]);
+    }
+}
+
+void Transform_hierarchy::update(
+    erhe::concurrency::Thread_pool* const thread_pool,
+    std::vector<Node*>* const             local_changed_nodes
+)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    using erhe::concurrency::parallel_for;
+
+    const std::size_t count = m_nodes.size();
+    if (count == 0) {
+        return;
+    }
+
+    parallel_for(thread_pool, count, grain_size, [this](std::size_t begin, std::size_t end) { gather(begin, end); });
+
+    if (local_changed_nodes != nullptr) {
+        for (std::size_t i = 0; i < count; ++i) {
+            if (m_local_dirty[i] != 0) {
+                local_changed_nodes->push_back(m_nodes[i]);
+            }
+        }
+    }
+
+    // Parents are always in an earlier level
+    for (std::size_t level = 0, level_end = m_level_offsets.size() - 1; level < level_end; ++level) {
+        const std::size_t level_begin = m_level_offsets[level];
+        const std::size_t level_size  = m_level_offsets[level + 1] - level_begin;
+        parallel_for(
+            thread_pool, level_size, grain_size,
+            [this, level_begin](std::size_t begin, std::size_t end) {
+                propagate(level_begin + begin, level_begin + end);
+            }
+        );
+    }
+
+    // Trs_transform::set() decomposes the matrix, so write back in parallel too
+    parallel_for(thread_pool, count, grain_size, [this](std::size_t begin, std::size_t end) { scatter(begin, end); });
+
+    // Attachments are not thread safe; notify serially, in depth order
+    for (std::size_t i = 0; i < count; ++i) {
+        if ((m_world_dirty[i] == 0) || (m_no_transform_update[i] != 0)) {
+            continue;
+        }
+        Node* const node = m_nodes[i];
+        node->handle_transform_update(m_world_serial[i]);
+
+        // handle_transform_update() allocates a new serial when given 0
+        m_local_serial[i] = node->node_data.transforms.parent_from_node_serial;
+        m_world_serial[i] = node->node_data.transforms.world_from_node_serial;
+    }
+}
+
+} // namespace erhe::scene
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace erhe::concurrency {
+    class Thread_pool;
+}
+
+namespace erhe::scene
+{
+
+class Node;
+
+// Depth ordered structure of arrays copy of scene node transforms.
+//
+// Local and world matrices are kept in contiguous arrays with parent
+// indices. update() only recomputes nodes whose parent_from_node serial
+// has changed, and their descendants. Each depth level is processed in
+// parallel when a thread pool is given; results are then written back to
+// Node_transforms and attachments are notified on the calling thread.
+class Transform_hierarchy
+{
+public:
+    // nodes must be sorted by depth. Nodes whose parent is not in nodes
+    // (typically the scene root) read parent transform from the parent node.
+    void rebuild(const std::vector<std::shared_ptr<Node>>& nodes);
+    void clear  ();
+    // When local_changed_nodes is given, nodes whose parent_from_node
+    // changed since previous update are appended to it.
+    void update (erhe::concurrency::Thread_pool* thread_pool, std::vector<Node*>* local_changed_nodes = nullptr);
+
+    [[nodiscard]] auto size() const -> std::size_t;
+
+private:
+    void gather   (std::size_t begin, std::size_t end);
+    void propagate(std::size_t begin, std::size_t end);
+    void scatter  (std::size_t begin, std::size_t end);
+
+    static constexpr uint64_t    unknown_serial{~uint64_t{0}};
+    static constexpr std::size_t grain_size    {512};
+
+    std::vector<Node*>       m_nodes;
+    std::vector<Node*>       m_parent_nodes;
+    std::vector<int32_t>     m_parent;             // index into arrays, -1 if parent is not in arrays
+    std::vector<std::size_t> m_level_offsets;      // first index of each depth level, plus end
+    std::vector<glm::mat4>   m_parent_from_node;
+    std::vector<glm::mat4>   m_node_from_parent;
+    std::vector<glm::mat4>   m_world_from_node;
+    std::vector<glm::mat4>   m_node_from_world;
+    std::vector<uint64_t>    m_local_serial;       // parent_from_node_serial seen by gather()
+    std::vector<uint64_t>    m_world_serial;       // serial of m_world_from_node
+    std::vector<uint8_t>     m_no_transform_update;
+    std::vector<uint8_t>     m_local_dirty;
+    std::vector<uint8_t>     m_world_dirty;
+};
+
+} // namespace erhe::scene
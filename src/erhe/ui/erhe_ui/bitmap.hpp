@@ -72,10 +72,23 @@ public:
     // Applies premultiplication
     // TODO(tksuoran@gmail.com): Gamma
     void post_process(Bitmap& destination, const float gamma)
+    {
+        post_process(destination, gamma, 0, 0, width(), height());
+    }
+
+    // Processes only the given region, destination must be at least as large
+    void post_process(
+        Bitmap&     destination,
+        const float gamma,
+        const int   x0,
+        const int   y0,
+        const int   region_width,
+        const int   region_height
+    )
     {
         static_cast<void>(gamma);
-        for (int y = 0; y < height(); ++y) {
-            for (int x = 0; x < width(); ++x) {
+        for (int y = y0; y < y0 + region_height; ++y) {
+            for (int x = x0; x < x0 + region_width; ++x) {
                 const auto ic      = get(x, y, 0);
                 const auto oc      = get(x, y, 1);
                 const auto inside  = static_cast<float>(ic) / 255.0f;
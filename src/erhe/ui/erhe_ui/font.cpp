@@ -1,8 +1,10 @@
 #include "erhe_ui/font.hpp"
 #include "erhe_ui/glyph.hpp"
+#include "erhe_ui/glyph_atlas.hpp"
 #include "erhe_ui/ui_log.hpp"
 #include "erhe_graphics/instance.hpp"
 #include "erhe_profile/profile.hpp"
+#include "erhe_verify/verify.hpp"
 
 #include <fmt/printf.h>
 
@@ -18,8 +20,6 @@
 #   include <hb-ft.h>
 #endif
 
-#include <SkylineBinPack.h> // RectangleBinPack
-
 #include <stdexcept>
 #include <string_view>
 
@@ -27,7 +27,6 @@ namespace erhe::ui
 {
 
 using erhe::graphics::Texture;
-using std::map;
 using std::shared_ptr;
 using std::unique_ptr;
 using std::make_shared;
@@ -48,15 +47,27 @@ Font::~Font() noexcept
 #endif
 }
 
-#if defined(ERHE_FONT_RASTERIZATION_LIBRARY_FREETYPE) && defined(ERHE_TEXT_LAYOUT_LIBRARY_HARFBUZZ)
 Font::Font(
     erhe::graphics::Instance&    graphics_instance,
     const std::filesystem::path& path,
     const unsigned int           size,
     const float                  outline_thickness
 )
-    : m_graphics_instance{graphics_instance}
-    , m_path             {path}
+    : Font{path, size, outline_thickness}
+{
+    m_graphics_instance = &graphics_instance;
+    if (m_atlas) {
+        post_process();
+    }
+}
+
+#if defined(ERHE_FONT_RASTERIZATION_LIBRARY_FREETYPE) && defined(ERHE_TEXT_LAYOUT_LIBRARY_HARFBUZZ)
+Font::Font(
+    const std::filesystem::path& path,
+    const unsigned int           size,
+    const float                  outline_thickness
+)
+    : m_path             {path}
     , m_bolding          {(size > 10) ? 0.5f : 0.0f}
     , m_outline_thickness{outline_thickness}
 {
@@ -146,184 +157,141 @@ auto Font::render() -> bool
 
     m_line_height = std::ceil(static_cast<float>(face->size->metrics.height) / 64.0f);
 
-    using GlyphSet = map<char, unique_ptr<Glyph>>;
-
-    GlyphSet glyphs;
-
-    std::vector<float> outline_sizes;
     for (float outline_thickness = m_outline_thickness;
          outline_thickness > 0.0f;
          outline_thickness -= 10.0f
     ) {
-        outline_sizes.emplace_back(outline_thickness);
+        m_outline_sizes.emplace_back(outline_thickness);
     }
 
-    std::vector<GlyphSet> outline_glyphs_vector(outline_sizes.size());
-
-    map<char, Glyph::BitmapLayout> glyph_box; // all glyphs fit inside
+    // Single atlas page, sized to hold a few hundred glyphs
+    int atlas_size = 256;
+    while ((atlas_size < 4096) && (atlas_size < static_cast<int>(m_pixel_size) * 32)) {
+        atlas_size *= 2;
+    }
+    m_texture_width  = atlas_size;
+    m_texture_height = atlas_size;
+    m_atlas  = make_unique<Glyph_atlas>(m_texture_width, m_texture_height, 2);
+    m_bitmap = make_unique<Bitmap>(m_texture_width, m_texture_height, 2);
 
-    // First pass: Render glyphs to bitmaps, keep track of glyph box
-    for (auto c : m_chars)
-{
+    // Warm up with common characters, others are rasterized on first use
+    for (const char c : m_chars) {
         const auto uc = static_cast<unsigned char>(c);
-        glyphs[c] = make_unique<Glyph>(m_freetype_library, face, uc, m_bolding, 0.0f, m_hint_mode);
-        const auto glyph = glyphs[c].get();
-        glyph_box[c] = glyphs[c]->bitmap;
-        m_glyph_to_char[glyph->glyph_index] = c;
-
-        if (m_outline_thickness == 0.0f) {
-            continue;
-        }
+        static_cast<void>(get_glyph(FT_Get_Char_Index(face, uc)));
+    }
 
-        auto& box = glyph_box[c];
-        for (size_t i = 0; i < outline_glyphs_vector.size(); ++i) {
-            auto& outline_glyphs = outline_glyphs_vector[i];
-            auto  og             = make_unique<Glyph>(m_freetype_library, face, uc, m_bolding, outline_sizes[i], m_hint_mode);
-            box.left   = std::min(box.left,   og->bitmap.left);
-            box.right  = std::max(box.right,  og->bitmap.right);
-            box.top    = std::max(box.top,    og->bitmap.top);
-            box.bottom = std::min(box.bottom, og->bitmap.bottom);
-            outline_glyphs[c] = std::move(og);
-        }
+    if (m_graphics_instance != nullptr) {
+        post_process();
     }
 
-    // Second pass: Search pack resolution
-    rbp::SkylineBinPack packer;
-    m_texture_width  = 2;
-    m_texture_height = 2;
-    for (;;) {
-        // Reserve 1 pixel border
-        packer.Init(m_texture_width - 2, m_texture_height - 2, false);
-
-        bool pack_failed = false;
-        for (auto c : m_chars) {
-            const auto& box = glyph_box[c];
-            const int width  = box.right - box.left;
-            const int height = box.top   - box.bottom;
-            if (width == 0 || height == 0) {
-                glyphs[c]->atlas_rect = {};
-                continue;
-            }
+    return true;
+}
 
-            glyphs[c]->atlas_rect = packer.Insert(width + 1, height + 1, rbp::SkylineBinPack::LevelBottomLeft);
-            if (
-                (glyphs[c]->atlas_rect.width  == 0) ||
-                (glyphs[c]->atlas_rect.height == 0)
-            ) {
-                pack_failed = true;
-                break;
-            }
+auto Font::get_glyph(const uint32_t glyph_index) const -> const ft_char*
+{
+    if (!m_atlas) {
+        return nullptr;
+    }
+    const auto i = m_glyphs.find(glyph_index);
+    if (i != m_glyphs.end()) {
+        if (i->second.width == 0) {
+            return nullptr;
         }
-
-        if (!pack_failed) {
-            break;
+        if (m_atlas->find(glyph_index) != nullptr) {
+            return &i->second;
         }
+        // Evicted, rasterize again
+    }
+    return rasterize(glyph_index);
+}
 
-        if (m_texture_width <= m_texture_height) {
-            m_texture_width *= 2;
-        } else {
-            m_texture_height *= 2;
-        }
+auto Font::rasterize(const uint32_t glyph_index) const -> const ft_char*
+{
+    ERHE_PROFILE_FUNCTION();
 
-        ERHE_VERIFY(m_texture_width <= 16384);
+    FT_Face face = m_freetype_face;
+    const Glyph glyph{m_freetype_library, face, glyph_index, m_bolding, 0.0f, m_hint_mode};
+
+    std::vector<unique_ptr<Glyph>> outline_glyphs;
+    Glyph::BitmapLayout box = glyph.bitmap; // all glyphs fit inside
+    for (const float outline_size : m_outline_sizes) {
+        auto og = make_unique<Glyph>(m_freetype_library, face, glyph_index, m_bolding, outline_size, m_hint_mode);
+        box.left   = std::min(box.left,   og->bitmap.left);
+        box.right  = std::max(box.right,  og->bitmap.right);
+        box.top    = std::max(box.top,    og->bitmap.top);
+        box.bottom = std::min(box.bottom, og->bitmap.bottom);
+        outline_glyphs.push_back(std::move(og));
     }
 
-    log_font->trace("packing glyps to {} x {} succeeded", m_texture_width, m_texture_height);
+    const int box_width  = box.right - box.left;
+    const int box_height = box.top   - box.bottom;
 
-    // Third pass: render glyphs
-    m_bitmap = make_unique<Bitmap>(m_texture_width, m_texture_height, 2);
-    m_bitmap->fill(0);
-    for (auto c : m_chars) {
-        auto uc = static_cast<unsigned char>(c);
-        if (!glyphs[c]) {
-            continue;
-        }
-        auto  g          = glyphs[c].get();
-        auto& box        = glyph_box[c];
-        int   box_width  = box.right - box.left;
-        int   box_height = box.top   - box.bottom;
-        bool  render     = (box_width != 0) && (box_height != 0);
-
-        const auto& r = g->atlas_rect;
-        log_font->trace("char '{}' blit size {} * {}", c, face->glyph->bitmap.width, face->glyph->bitmap.rows);
-
-        bool  rotated = (r.width != r.height) && ((box_width + 1) == r.height) && ((box_height + 1) == r.width);
-        float x_scale = 1.0f / static_cast<float>(m_texture_width);
-        float y_scale = 1.0f / static_cast<float>(m_texture_height);
-        auto  fx      = static_cast<float>(r.x) + 1.0f;
-        auto  fy      = static_cast<float>(r.y) + 1.0f;
-        auto  fw      = static_cast<float>(box_width);
-        auto  fh      = static_cast<float>(box_height);
-
-        ft_char d;
-        d.width    = box_width;
-        d.height   = box_height;
-        d.g_left   = g->bitmap.left;
-        d.g_bottom = g->bitmap.bottom;
-        d.g_top    = g->bitmap.top;
-        d.g_height = g->bitmap.height;
-        d.b_left   = box.left;  // g->bitmap.left    - x_extra;
-        d.b_bottom = box.bottom;// g->bitmap.bottom  - y_extra;
-        d.b_top    = box.top;
-        d.rotated  = rotated;
-
-        if (!rotated) {
-            d.u[0] =  fx       * x_scale;
-            d.v[0] =  fy       * y_scale;
-            d.u[1] = (fx + fw) * x_scale;
-            d.v[1] =  fy       * y_scale;
-            d.u[2] = (fx + fw) * x_scale;
-            d.v[2] = (fy + fh) * y_scale;
-            d.u[3] =  fx       * x_scale;
-            d.v[3] = (fy + fh) * y_scale;
-        } else {
-            d.u[0] = (fx + fh) * x_scale;
-            d.v[0] =  fy       * y_scale;
-            d.u[1] = (fx + fh) * x_scale;
-            d.v[1] = (fy + fw) * y_scale;
-            d.u[2] =  fx       * x_scale;
-            d.v[2] = (fy + fw) * y_scale;
-            d.u[3] =  fx       * x_scale;
-            d.v[3] =  fy       * y_scale;
-        }
-        if (render) {
-            m_bitmap->blit<false>(
-                g->bitmap.width,
-                g->bitmap.height,
-                r.x + 1 + std::max(0, rotated ? (g->bitmap.bottom - box.bottom) : (g->bitmap.left   - box.left  )),
-                r.y + 1 + std::max(0, rotated ? (g->bitmap.left   - box.left  ) : (g->bitmap.bottom - box.bottom)),
-                g->buffer(),
-                g->bitmap.pitch,
-                g->bitmap.width,
-                1,
-                0,
-                rotated
-            );
-            if (m_outline_thickness > 0.0f) {
-                for (auto& outline_glyphs : outline_glyphs_vector) {
-                    const auto og = outline_glyphs[c].get();
-                    m_bitmap->blit<true>(
-                        og->bitmap.width,
-                        og->bitmap.height,
-                        r.x + 1 + std::max(0, rotated ? (og->bitmap.bottom - box.bottom) : (og->bitmap.left   - box.left  )),
-                        r.y + 1 + std::max(0, rotated ? (og->bitmap.left   - box.left  ) : (og->bitmap.bottom - box.bottom)),
-                        og->buffer(),
-                        og->bitmap.pitch,
-                        og->bitmap.width,
-                        1,
-                        1,
-                        rotated
-                    );
-                }
-            }
-        }
-        m_chars_256[uc] = d;
+    ft_char& d = m_glyphs[glyph_index];
+    d = ft_char{};
+    if ((box_width == 0) || (box_height == 0)) {
+        return nullptr;
     }
 
-    post_process();
+    d.width    = box_width;
+    d.height   = box_height;
+    d.g_left   = glyph.bitmap.left;
+    d.g_bottom = glyph.bitmap.bottom;
+    d.g_top    = glyph.bitmap.top;
+    d.g_height = glyph.bitmap.height;
+    d.b_left   = box.left;
+    d.b_bottom = box.bottom;
+    d.b_top    = box.top;
+
+    const Glyph_atlas_entry* const entry = m_atlas->allocate(glyph_index, box_width, box_height);
+    if (entry == nullptr) {
+        log_font->warn("Glyph atlas is full, glyph index {} skipped", glyph_index);
+        return nullptr;
+    }
 
-    return true;
-    //m_bitmap->dump();
+    const auto& r       = entry->rect;
+    const float x_scale = 1.0f / static_cast<float>(m_texture_width);
+    const float y_scale = 1.0f / static_cast<float>(m_texture_height);
+    const auto  fx      = static_cast<float>(r.x);
+    const auto  fy      = static_cast<float>(r.y);
+    const auto  fw      = static_cast<float>(box_width);
+    const auto  fh      = static_cast<float>(box_height);
+    d.u[0] =  fx       * x_scale;
+    d.v[0] =  fy       * y_scale;
+    d.u[1] = (fx + fw) * x_scale;
+    d.v[1] =  fy       * y_scale;
+    d.u[2] = (fx + fw) * x_scale;
+    d.v[2] = (fy + fh) * y_scale;
+    d.u[3] =  fx       * x_scale;
+    d.v[3] = (fy + fh) * y_scale;
+
+    Bitmap& bitmap = m_atlas->bitmap();
+    bitmap.blit<false>(
+        glyph.bitmap.width,
+        glyph.bitmap.height,
+        r.x + std::max(0, glyph.bitmap.left   - box.left  ),
+        r.y + std::max(0, glyph.bitmap.bottom - box.bottom),
+        glyph.buffer(),
+        glyph.bitmap.pitch,
+        glyph.bitmap.width,
+        1,
+        0,
+        false
+    );
+    for (const auto& og : outline_glyphs) {
+        bitmap.blit<true>(
+            og->bitmap.width,
+            og->bitmap.height,
+            r.x + std::max(0, og->bitmap.left   - box.left  ),
+            r.y + std::max(0, og->bitmap.bottom - box.bottom),
+            og->buffer(),
+            og->bitmap.pitch,
+            og->bitmap.width,
+            1,
+            1,
+            false
+        );
+    }
+    return &d;
 }
 
 namespace {
@@ -440,31 +408,94 @@ void Font::render(){}
 void Font::trace_info() const {}
 #endif
 
+namespace {
+
+auto get_byte_count(const std::string& text, const std::vector<float>& vertices, const std::vector<uint32_t>& glyph_indices) -> uint64_t
+{
+    return
+        text.capacity() +
+        vertices.capacity() * sizeof(float) +
+        glyph_indices.capacity() * sizeof(uint32_t);
+}
+
+}
+
 void Font::post_process()
 {
     ERHE_PROFILE_FUNCTION();
 
-    Bitmap bm{
-        m_bitmap->width(),
-        m_bitmap->height(),
-        m_bitmap->components()
-    };
-    m_bitmap->post_process(bm, m_gamma);
-
-    auto internal_format = gl::Internal_format::rg8;
+    ERHE_VERIFY(m_graphics_instance != nullptr);
 
     const Texture::Create_info create_info{
-        .instance        = m_graphics_instance,
+        .instance        = *m_graphics_instance,
         .target          = gl::Texture_target::texture_2d,
-        .internal_format = internal_format,
+        .internal_format = gl::Internal_format::rg8,
         .use_mipmaps     = false,
         .width           = m_texture_width,
         .height          = m_texture_height
     };
 
     m_texture = std::make_unique<Texture>(create_info);
-    m_texture->upload(create_info.internal_format, bm.as_span(), create_info.width, create_info.height);
     m_texture->set_debug_label(m_path.filename().generic_string());
+
+    m_atlas->mark_dirty(rbp::Rect{0, 0, m_texture_width, m_texture_height});
+    update_texture();
+}
+
+void Font::update_texture()
+{
+    if (!m_atlas || !m_texture || !m_atlas->is_dirty()) {
+        return;
+    }
+
+    ERHE_PROFILE_FUNCTION();
+
+    const rbp::Rect r = m_atlas->dirty_rect();
+    m_atlas->bitmap().post_process(*m_bitmap.get(), m_gamma, r.x, r.y, r.width, r.height);
+    m_texture->upload_subimage(
+        m_texture->internal_format(),
+        m_bitmap->as_span(),
+        m_bitmap->width(),
+        r.x,
+        r.y,
+        r.width,
+        r.height,
+        0,
+        r.x,
+        r.y
+    );
+    m_atlas->clear_dirty();
+}
+
+void Font::begin_frame()
+{
+    if (m_atlas) {
+        m_atlas->begin_frame();
+    }
+
+    ++m_frame;
+    std::erase_if(
+        m_shaped_runs,
+        [this](const auto& i) {
+            const Shaped_run& run = i.second;
+            if (run.last_used_frame + s_shaped_run_max_age >= m_frame) {
+                return false;
+            }
+            --m_shaped_run_statistics.entry_count;
+            m_shaped_run_statistics.byte_count -= get_byte_count(i.first, run.vertices, run.glyph_indices);
+            return true;
+        }
+    );
+}
+
+auto Font::atlas() const -> const Glyph_atlas*
+{
+    return m_atlas.get();
+}
+
+auto Font::get_shaped_run_statistics() const -> const Shaped_run_cache_statistics&
+{
+    return m_shaped_run_statistics;
 }
 
 // https://en.wikipedia.org/wiki/List_of_typographic_features
@@ -492,29 +523,16 @@ void Font::post_process()
 // vert Vertical Alternates             A subset of vrt2: prefer the latter feature
 
 #if defined(ERHE_TEXT_LAYOUT_LIBRARY_HARFBUZZ)
-auto Font::print(
-    gsl::span<float>    float_data,
-    gsl::span<uint32_t> uint_data,
-    std::string_view    text,
-    glm::vec3           text_position,
-    const uint32_t      text_color,
-    Rectangle&          out_bounds
-) const -> size_t
+void Font::shape(const std::string_view text, Shaped_run& run) const
 {
     ERHE_PROFILE_FUNCTION();
 
-    SPDLOG_LOGGER_TRACE(
-        log_font,
-        "Font::print(text = {}, x = {}, y = {}, z = {})",
-        text,
-        text_position.x,
-        text_position.y,
-        text_position.z
-    );
+    SPDLOG_LOGGER_TRACE(log_font, "Font::shape(text = {})", text);
 
-    if (text.empty()) {
-        return 0;
-    }
+    run.vertices.clear();
+    run.glyph_indices.clear();
+    run.bounds_min = glm::vec2{0.0f};
+    run.bounds_max = glm::vec2{0.0f};
 
     hb_feature_t userfeatures[1]; // clig, dlig
     userfeatures[0].tag   = HB_TAG('l','i','g','a');
@@ -526,112 +544,152 @@ auto Font::print(
     hb_buffer_set_direction (m_harfbuzz_buffer, HB_DIRECTION_LTR);
     hb_buffer_set_script    (m_harfbuzz_buffer, HB_SCRIPT_LATIN);
     hb_buffer_set_language  (m_harfbuzz_buffer, hb_language_from_string("en", -1));
-    hb_buffer_add_utf8      (m_harfbuzz_buffer, text.data(), -1, 0, -1);
+    hb_buffer_add_utf8      (m_harfbuzz_buffer, text.data(), static_cast<int>(text.size()), 0, -1);
     hb_shape                (m_harfbuzz_font, m_harfbuzz_buffer, &userfeatures[0], 1);
 
     unsigned int glyph_count{0};
     hb_glyph_info_t*     glyph_info = hb_buffer_get_glyph_infos    (m_harfbuzz_buffer, &glyph_count);
     hb_glyph_position_t* glyph_pos  = hb_buffer_get_glyph_positions(m_harfbuzz_buffer, &glyph_count);
 
-    std::size_t chars_printed{0};
-    std::size_t word_offset{0};
+    Rectangle bounds{};
+    bounds.reset_for_grow();
+    float x{0.0f};
+    float y{0.0f};
     for (unsigned int i = 0; i < glyph_count; ++i) {
         const auto  glyph_id  = glyph_info[i].codepoint;
         const float x_offset  = static_cast<float>(glyph_pos[i].x_offset ) / 64.0f;
         const float y_offset  = static_cast<float>(glyph_pos[i].y_offset ) / 64.0f;
         const float x_advance = static_cast<float>(glyph_pos[i].x_advance) / 64.0f;
         const float y_advance = static_cast<float>(glyph_pos[i].y_advance) / 64.0f;
-        auto j = m_glyph_to_char.find(glyph_id);
-        if (j != m_glyph_to_char.end()) {
-            auto c = j->second;
-            auto uc = static_cast<unsigned char>(c);
-            const ft_char& font_char = m_chars_256[uc];
-            if (font_char.width != 0) {
-                const float b  = static_cast<float>(font_char.g_bottom - font_char.b_bottom);
-                const float t  = static_cast<float>(font_char.g_top    - font_char.b_top);
-                const float w  = static_cast<float>(font_char.width);
-                const float h  = static_cast<float>(font_char.height);
-                const float ox = static_cast<float>(font_char.b_left);
-                const float oy = static_cast<float>(font_char.b_bottom + t + b);
-                const float x0 = text_position.x + x_offset + ox;
-                const float y0 = text_position.y + y_offset + oy;
-                const float x1 = x0 + w;
-                const float y1 = y0 + h;
-
-                float_data[word_offset++] = x0;
-                float_data[word_offset++] = y0;
-                float_data[word_offset++] = text_position.z;
-                uint_data [word_offset++] = text_color;
-                float_data[word_offset++] = font_char.u[0];
-                float_data[word_offset++] = font_char.v[0];
-                float_data[word_offset++] = x1;
-                float_data[word_offset++] = y0;
-                float_data[word_offset++] = text_position.z;
-                uint_data [word_offset++] = text_color;
-                float_data[word_offset++] = font_char.u[1];
-                float_data[word_offset++] = font_char.v[1];
-                float_data[word_offset++] = x1;
-                float_data[word_offset++] = y1;
-                float_data[word_offset++] = text_position.z;
-                uint_data [word_offset++] = text_color;
-                float_data[word_offset++] = font_char.u[2];
-                float_data[word_offset++] = font_char.v[2];
-                float_data[word_offset++] = x0;
-                float_data[word_offset++] = y1;
-                float_data[word_offset++] = text_position.z;
-                uint_data [word_offset++] = text_color;
-                float_data[word_offset++] = font_char.u[3];
-                float_data[word_offset++] = font_char.v[3];
-
-                out_bounds.extend_by(x0, y0);
-                out_bounds.extend_by(x1, y1);
-                ++chars_printed;
+        const ft_char* const font_char_ptr = get_glyph(glyph_id);
+        if (font_char_ptr != nullptr) {
+            const ft_char& font_char = *font_char_ptr;
+            const float b  = static_cast<float>(font_char.g_bottom - font_char.b_bottom);
+            const float t  = static_cast<float>(font_char.g_top    - font_char.b_top);
+            const float w  = static_cast<float>(font_char.width);
+            const float h  = static_cast<float>(font_char.height);
+            const float ox = static_cast<float>(font_char.b_left);
+            const float oy = static_cast<float>(font_char.b_bottom + t + b);
+            const float x0 = x + x_offset + ox;
+            const float y0 = y + y_offset + oy;
+            const float x1 = x0 + w;
+            const float y1 = y0 + h;
+
+            run.vertices.insert(
+                run.vertices.end(),
+                {
+                    x0, y0, font_char.u[0], font_char.v[0],
+                    x1, y0, font_char.u[1], font_char.v[1],
+                    x1, y1, font_char.u[2], font_char.v[2],
+                    x0, y1, font_char.u[3], font_char.v[3]
+                }
+            );
+            run.glyph_indices.push_back(glyph_id);
+            bounds.extend_by(x0, y0);
+            bounds.extend_by(x1, y1);
+        }
+        x += x_advance;
+        y += y_advance;
+    }
+
+    if (!run.glyph_indices.empty()) {
+        run.bounds_min = bounds.min();
+        run.bounds_max = bounds.max();
+    }
+    run.atlas_eviction_count = m_atlas ? m_atlas->get_statistics().eviction_count : 0;
+}
+
+auto Font::get_shaped_run(const std::string_view text) const -> const Shaped_run&
+{
+    const uint64_t atlas_eviction_count = m_atlas ? m_atlas->get_statistics().eviction_count : 0;
+
+    auto i = m_shaped_runs.find(text);
+    if (i != m_shaped_runs.end()) {
+        Shaped_run& run = i->second;
+        run.last_used_frame = m_frame;
+        if (run.atlas_eviction_count == atlas_eviction_count) {
+            ++m_shaped_run_statistics.hit_count;
+            // Keep glyphs resident while the run is in use
+            for (const uint32_t glyph_index : run.glyph_indices) {
+                static_cast<void>(m_atlas->find(glyph_index));
             }
+            return run;
         }
-        text_position.x += x_advance;
-        text_position.y += y_advance;
+
+        // Some glyphs may have been evicted and rasterized to a new location
+        ++m_shaped_run_statistics.miss_count;
+        m_shaped_run_statistics.byte_count -= get_byte_count(i->first, run.vertices, run.glyph_indices);
+        shape(text, run);
+        m_shaped_run_statistics.byte_count += get_byte_count(i->first, run.vertices, run.glyph_indices);
+        return run;
     }
 
-    return chars_printed;
+    ++m_shaped_run_statistics.miss_count;
+    i = m_shaped_runs.emplace(std::string{text}, Shaped_run{}).first;
+    Shaped_run& run = i->second;
+    run.last_used_frame = m_frame;
+    shape(text, run);
+    run.vertices.shrink_to_fit();
+    run.glyph_indices.shrink_to_fit();
+    ++m_shaped_run_statistics.entry_count;
+    m_shaped_run_statistics.byte_count += get_byte_count(i->first, run.vertices, run.glyph_indices);
+    return run;
 }
 
-auto Font::get_glyph_count(const std::string_view text) const -> size_t
+auto Font::print(
+    gsl::span<float>    float_data,
+    gsl::span<uint32_t> uint_data,
+    std::string_view    text,
+    glm::vec3           text_position,
+    const uint32_t      text_color,
+    Rectangle&          out_bounds
+) const -> size_t
 {
+    ERHE_PROFILE_FUNCTION();
+
+    SPDLOG_LOGGER_TRACE(
+        log_font,
+        "Font::print(text = {}, x = {}, y = {}, z = {})",
+        text,
+        text_position.x,
+        text_position.y,
+        text_position.z
+    );
+
     if (text.empty()) {
         return 0;
     }
 
-    hb_feature_t userfeatures[1]; // clig, dlig
-    userfeatures[0].tag   = HB_TAG('l','i','g','a');
-    userfeatures[0].value = 0;
-    userfeatures[0].start = HB_FEATURE_GLOBAL_START;
-    userfeatures[0].end   = HB_FEATURE_GLOBAL_END;
+    const Shaped_run& run          = get_shaped_run(text);
+    const std::size_t glyph_count  = run.glyph_indices.size();
+    const std::size_t vertex_count = glyph_count * 4;
+    const float*      src          = run.vertices.data();
+    std::size_t       word_offset{0};
+    for (std::size_t i = 0; i < vertex_count; ++i) {
+        float_data[word_offset++] = text_position.x + src[0];
+        float_data[word_offset++] = text_position.y + src[1];
+        float_data[word_offset++] = text_position.z;
+        uint_data [word_offset++] = text_color;
+        float_data[word_offset++] = src[2];
+        float_data[word_offset++] = src[3];
+        src += 4;
+    }
 
-    hb_buffer_clear_contents(m_harfbuzz_buffer);
-    hb_buffer_set_direction (m_harfbuzz_buffer, HB_DIRECTION_LTR);
-    hb_buffer_set_script    (m_harfbuzz_buffer, HB_SCRIPT_LATIN);
-    hb_buffer_set_language  (m_harfbuzz_buffer, hb_language_from_string("en", -1));
-    hb_buffer_add_utf8      (m_harfbuzz_buffer, text.data(), -1, 0, -1);
-    hb_shape                (m_harfbuzz_font, m_harfbuzz_buffer, &userfeatures[0], 1);
+    if (glyph_count > 0) {
+        out_bounds.extend_by(text_position.x + run.bounds_min.x, text_position.y + run.bounds_min.y);
+        out_bounds.extend_by(text_position.x + run.bounds_max.x, text_position.y + run.bounds_max.y);
+    }
 
-    unsigned int glyph_count{0};
-    hb_glyph_info_t* glyph_info = hb_buffer_get_glyph_infos(m_harfbuzz_buffer, &glyph_count);
+    return glyph_count;
+}
 
-    std::size_t chars_printed{0};
-    for (unsigned int i = 0; i < glyph_count; ++i) {
-        const auto glyph_id = glyph_info[i].codepoint;
-        auto j = m_glyph_to_char.find(glyph_id);
-        if (j != m_glyph_to_char.end()) {
-            auto c = j->second;
-            auto uc = static_cast<unsigned char>(c);
-            const ft_char& font_char = m_chars_256[uc];
-            if (font_char.width != 0) {
-                ++chars_printed;
-            }
-        }
+auto Font::get_glyph_count(const std::string_view text) const -> size_t
+{
+    if (text.empty()) {
+        return 0;
     }
 
-    return chars_printed;
+    return get_shaped_run(text).glyph_indices.size();
 }
 
 auto Font::measure(const std::string_view text) const -> Rectangle
@@ -662,25 +720,21 @@ auto Font::measure(const std::string_view text) const -> Rectangle
         const float y_offset  = static_cast<float>(glyph_pos[i].y_offset ) / 64.0f;
         const float x_advance = static_cast<float>(glyph_pos[i].x_advance) / 64.0f;
         const float y_advance = static_cast<float>(glyph_pos[i].y_advance) / 64.0f;
-        const auto  j = m_glyph_to_char.find(glyph_id);
-        if (j != m_glyph_to_char.end()) {
-            const auto c = j->second;
-            const auto uc = static_cast<unsigned char>(c);
-            const ft_char& font_char = m_chars_256[uc];
-            if (font_char.width != 0) {
-                const float b  = static_cast<float>(font_char.g_bottom - font_char.b_bottom);
-                const float t  = static_cast<float>(font_char.g_top    - font_char.b_top);
-                const float w  = static_cast<float>(font_char.width);
-                const float h  = static_cast<float>(font_char.height);
-                const float ox = static_cast<float>(font_char.b_left);
-                const float oy = static_cast<float>(font_char.b_bottom + t + b);
-                const float x0 = x + x_offset + ox;
-                const float y0 = y + y_offset + oy;
-                const float x1 = x0 + w;
-                const float y1 = y0 + h;
-                bounds.extend_by(x0, y0);
-                bounds.extend_by(x1, y1);
-            }
+        const ft_char* const font_char_ptr = get_glyph(glyph_id);
+        if (font_char_ptr != nullptr) {
+            const ft_char& font_char = *font_char_ptr;
+            const float b  = static_cast<float>(font_char.g_bottom - font_char.b_bottom);
+            const float t  = static_cast<float>(font_char.g_top    - font_char.b_top);
+            const float w  = static_cast<float>(font_char.width);
+            const float h  = static_cast<float>(font_char.height);
+            const float ox = static_cast<float>(font_char.b_left);
+            const float oy = static_cast<float>(font_char.b_bottom + t + b);
+            const float x0 = x + x_offset + ox;
+            const float y0 = y + y_offset + oy;
+            const float x1 = x0 + w;
+            const float y1 = y0 + h;
+            bounds.extend_by(x0, y0);
+            bounds.extend_by(x1, y1);
         }
         x += x_advance;
         y += y_advance;
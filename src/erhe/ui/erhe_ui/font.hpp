@@ -7,10 +7,13 @@
 #include <gsl/pointers>
 #include <gsl/span>
 
+#include <array>
 #include <filesystem>
-#include <map>
+#include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 struct FT_LibraryRec_;
@@ -21,6 +24,22 @@ struct hb_buffer_t;
 namespace erhe::ui
 {
 
+class Glyph_atlas;
+
+class Shaped_run_cache_statistics
+{
+public:
+    uint64_t hit_count  {0};
+    uint64_t miss_count {0};
+    uint64_t entry_count{0};
+    uint64_t byte_count {0}; // cached strings and vertices
+};
+
+// Glyphs are rasterized on first use into a fixed size Glyph_atlas page.
+// Least recently used glyphs are evicted when the page is full. Only the
+// modified part of the atlas is uploaded by update_texture().
+// Shaped strings are cached, so printing an unchanged string only offsets
+// cached quad vertices. Strings not printed for a while are evicted.
 class Font final
 {
 public:
@@ -31,6 +50,14 @@ public:
         float                        outline_thickness = 0.0f
     );
 
+    // Without graphics instance glyphs are rasterized to atlas() only, and
+    // no texture is created. texture() must not be used.
+    Font(
+        const std::filesystem::path& path,
+        unsigned int                 size,
+        float                        outline_thickness = 0.0f
+    );
+
     ~Font() noexcept;
 
     void save() const;
@@ -142,8 +169,18 @@ public:
 
     auto render() -> bool;
 
+    // Creates texture and uploads the whole atlas
     void post_process();
 
+    // Uploads glyphs rasterized since the previous call
+    void update_texture();
+
+    // Glyphs used before the next begin_frame() call are not evicted
+    void begin_frame();
+
+    [[nodiscard]] auto atlas                    () const -> const Glyph_atlas*;
+    [[nodiscard]] auto get_shaped_run_statistics() const -> const Shaped_run_cache_statistics&;
+
     void trace_info() const;
 
 private:
@@ -159,17 +196,51 @@ private:
         int b_left   {0};
         int b_bottom {0};
         int b_top    {0};
-        bool rotated{false};
         std::array<float, 4> u{0.0f, 0.0f, 0.0f, 0.0f};
         std::array<float, 4> v{0.0f, 0.0f, 0.0f, 0.0f};
     };
 
-    erhe::graphics::Instance&  m_graphics_instance;
+    // Glyph quads of one shaped string, relative to text position
+    class Shaped_run
+    {
+    public:
+        std::vector<float>    vertices;      // x, y, u, v for 4 vertices per glyph
+        std::vector<uint32_t> glyph_indices;
+        glm::vec2             bounds_min          {0.0f};
+        glm::vec2             bounds_max          {0.0f};
+        uint64_t              last_used_frame     {0};
+        uint64_t              atlas_eviction_count{0}; // texture coordinates are valid while unchanged
+    };
+
+    class String_hash
+    {
+    public:
+        using is_transparent = void;
+        auto operator()(const std::string_view value) const -> std::size_t
+        {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+
+    static constexpr uint64_t s_shaped_run_max_age{120}; // frames
+
+    // Returns nullptr for glyphs without pixels and glyphs which do not fit in the atlas
+    [[nodiscard]] auto get_glyph     (uint32_t glyph_index) const -> const ft_char*;
+    [[nodiscard]] auto rasterize     (uint32_t glyph_index) const -> const ft_char*;
+    [[nodiscard]] auto get_shaped_run(std::string_view text) const -> const Shaped_run&;
+    void shape(std::string_view text, Shaped_run& run) const;
+
+    erhe::graphics::Instance*  m_graphics_instance{nullptr};
+
+    mutable std::unordered_map<uint32_t, ft_char> m_glyphs; // glyph index to metrics and texture coordinates
+    mutable std::unique_ptr<Glyph_atlas>          m_atlas;
+    std::vector<float>                            m_outline_sizes;
 
-    std::map<uint32_t, size_t> m_glyph_to_char;
+    mutable std::unordered_map<std::string, Shaped_run, String_hash, std::equal_to<>> m_shaped_runs;
+    mutable Shaped_run_cache_statistics                                                m_shaped_run_statistics;
+    uint64_t                                                                           m_frame{1};
 
-    ft_char               m_chars_256[256];
-    std::string           m_chars;
+    std::string           m_chars; // rasterized up front
     std::filesystem::path m_path;
 
     bool         m_hinting          {true};
@@ -186,7 +257,7 @@ private:
     int          m_texture_height   {0};
 
     std::unique_ptr<erhe::graphics::Texture> m_texture;
-    std::unique_ptr<Bitmap>                  m_bitmap;
+    std::unique_ptr<Bitmap>                  m_bitmap; // post processed atlas for upload
 #if defined(ERHE_FONT_RASTERIZATION_LIBRARY_FREETYPE)
     struct FT_LibraryRec_*                   m_freetype_library{nullptr};
     struct FT_FaceRec_*                      m_freetype_face{nullptr};
@@ -21,15 +21,14 @@ namespace erhe::ui
 Glyph::Glyph(
     FT_Library          library,
     FT_Face             font_face,
-    const unsigned char c,
+    const unsigned int  glyph_index,
     const float         bolding,
     const float         outline_thickness,
     const int           hint_mode
 )
-    : char_code        {c}
+    : glyph_index      {glyph_index}
     , outline_thickness{outline_thickness}
 {
-    glyph_index = FT_Get_Char_Index(font_face, char_code);
     if (glyph_index == 0) {
         return;
     }
@@ -129,9 +128,8 @@ void Glyph::dump() const
 {
     const char* shades = " .:#";
     fmt::print(
-        "\nglyph index = {} code = '{}': width = {} height = {} left = {} top = {} outline = {}\n",
+        "\nglyph index = {}: width = {} height = {} left = {} top = {} outline = {}\n",
         glyph_index,
-        static_cast<char>(char_code),
         bitmap.width,
         bitmap.height,
         bitmap.left,
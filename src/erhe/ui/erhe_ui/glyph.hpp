@@ -28,7 +28,7 @@ public:
     Glyph(
         FT_Library    library,
         FT_Face       font_face,
-        unsigned char c,
+        unsigned int  glyph_index,
         float         bolding,
         float         outline_thickness,
         int           hint_mode
@@ -43,7 +43,6 @@ public:
 
     rbp::Rect    atlas_rect       {0, 0, 0, 0};     // atlas space
     Rectangle    font_rect;      // font metric space
-    FT_ULong     char_code        {0};
     unsigned int glyph_index      {0};
     float        outline_thickness{0.0f};
 
@@ -0,0 +1,219 @@
+#include "erhe_ui/glyph_atlas.hpp"
+#include "erhe_profile/profile.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace erhe::ui
+{
+
+namespace {
+
+// Packer space excludes 1 pixel border around the page, and each packed
+// rectangle includes 1 pixel gap on the right and top of the glyph.
+auto to_packer_rect(const rbp::Rect& rect) -> rbp::Rect
+{
+    return rbp::Rect{rect.x - 1, rect.y - 1, rect.width + 1, rect.height + 1};
+}
+
+auto from_packer_rect(const rbp::Rect& rect) -> rbp::Rect
+{
+    return rbp::Rect{rect.x + 1, rect.y + 1, rect.width - 1, rect.height - 1};
+}
+
+}
+
+Glyph_atlas::Glyph_atlas(const int width, const int height, const Bitmap::component_t components)
+    : m_bitmap{width, height, components}
+{
+    ERHE_VERIFY(width > 2);
+    ERHE_VERIFY(height > 2);
+    m_packer.Init(width - 2, height - 2, false);
+    clear_dirty();
+}
+
+void Glyph_atlas::begin_frame()
+{
+    ++m_frame;
+}
+
+auto Glyph_atlas::find(const uint32_t key) -> const Glyph_atlas_entry*
+{
+    const auto i = m_entries.find(key);
+    if (i == m_entries.end()) {
+        ++m_statistics.miss_count;
+        return nullptr;
+    }
+    ++m_statistics.hit_count;
+    i->second.last_used = m_frame;
+    return &i->second;
+}
+
+auto Glyph_atlas::get(const uint32_t key) const -> const Glyph_atlas_entry*
+{
+    const auto i = m_entries.find(key);
+    return (i != m_entries.end()) ? &i->second : nullptr;
+}
+
+auto Glyph_atlas::allocate(const uint32_t key, const int width, const int height) -> const Glyph_atlas_entry*
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ERHE_VERIFY(width > 0);
+    ERHE_VERIFY(height > 0);
+    ERHE_VERIFY(m_entries.find(key) == m_entries.end());
+
+    rbp::Rect rect = insert(width, height);
+    if (rect.height == 0) {
+        // Evict at least 1/8 of the page at once to amortize packer rebuilds
+        const int min_area = std::max(
+            (width + 1) * (height + 1),
+            (m_bitmap.width() * m_bitmap.height()) / 8
+        );
+        while ((rect.height == 0) && evict(min_area)) {
+            rebuild_packer();
+            rect = insert(width, height);
+        }
+        if (rect.height == 0) {
+            return nullptr;
+        }
+    }
+
+    const rbp::Rect glyph_rect = from_packer_rect(rect);
+
+    // Outline glyphs are blitted with max(), so stale pixels must be cleared
+    for (int y = glyph_rect.y; y < glyph_rect.y + glyph_rect.height; ++y) {
+        for (int x = glyph_rect.x; x < glyph_rect.x + glyph_rect.width; ++x) {
+            for (Bitmap::component_t c = 0; c < m_bitmap.components(); ++c) {
+                m_bitmap.put(x, y, c, 0);
+            }
+        }
+    }
+    mark_dirty(glyph_rect);
+
+    Glyph_atlas_entry& entry = m_entries[key];
+    entry.key       = key;
+    entry.rect      = glyph_rect;
+    entry.last_used = m_frame;
+    return &entry;
+}
+
+void Glyph_atlas::clear()
+{
+    m_entries.clear();
+    m_packer.Init(m_bitmap.width() - 2, m_bitmap.height() - 2, false);
+    m_bitmap.fill(0);
+    mark_dirty(rbp::Rect{0, 0, m_bitmap.width(), m_bitmap.height()});
+}
+
+auto Glyph_atlas::insert(const int width, const int height) -> rbp::Rect
+{
+    return m_packer.Insert(width + 1, height + 1, rbp::MaxRectsBinPack::RectBestShortSideFit);
+}
+
+auto Glyph_atlas::evict(const int min_area) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    m_eviction_candidates.clear();
+    for (const auto& i : m_entries) {
+        if (i.second.last_used < m_frame) {
+            m_eviction_candidates.push_back(&i.second);
+        }
+    }
+    if (m_eviction_candidates.empty()) {
+        return false;
+    }
+    std::sort(
+        m_eviction_candidates.begin(),
+        m_eviction_candidates.end(),
+        [](const Glyph_atlas_entry* lhs, const Glyph_atlas_entry* rhs) {
+            return lhs->last_used < rhs->last_used;
+        }
+    );
+
+    int evicted_area{0};
+    for (const Glyph_atlas_entry* entry : m_eviction_candidates) {
+        if (evicted_area >= min_area) {
+            break;
+        }
+        evicted_area += (entry->rect.width + 1) * (entry->rect.height + 1);
+        ++m_statistics.eviction_count;
+        m_entries.erase(entry->key);
+    }
+    m_eviction_candidates.clear();
+    return true;
+}
+
+void Glyph_atlas::rebuild_packer()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ++m_statistics.rebuild_count;
+    m_packer.Init(m_bitmap.width() - 2, m_bitmap.height() - 2, false);
+    for (const auto& i : m_entries) {
+        m_packer.Occupy(to_packer_rect(i.second.rect));
+    }
+}
+
+void Glyph_atlas::mark_dirty(const rbp::Rect& rect)
+{
+    m_dirty_x0 = std::min(m_dirty_x0, rect.x);
+    m_dirty_y0 = std::min(m_dirty_y0, rect.y);
+    m_dirty_x1 = std::max(m_dirty_x1, rect.x + rect.width);
+    m_dirty_y1 = std::max(m_dirty_y1, rect.y + rect.height);
+}
+
+void Glyph_atlas::clear_dirty()
+{
+    m_dirty_x0 = std::numeric_limits<int>::max();
+    m_dirty_y0 = std::numeric_limits<int>::max();
+    m_dirty_x1 = std::numeric_limits<int>::lowest();
+    m_dirty_y1 = std::numeric_limits<int>::lowest();
+}
+
+auto Glyph_atlas::width() const -> int
+{
+    return m_bitmap.width();
+}
+
+auto Glyph_atlas::height() const -> int
+{
+    return m_bitmap.height();
+}
+
+auto Glyph_atlas::bitmap() -> Bitmap&
+{
+    return m_bitmap;
+}
+
+auto Glyph_atlas::bitmap() const -> const Bitmap&
+{
+    return m_bitmap;
+}
+
+auto Glyph_atlas::is_dirty() const -> bool
+{
+    return (m_dirty_x1 > m_dirty_x0) && (m_dirty_y1 > m_dirty_y0);
+}
+
+auto Glyph_atlas::dirty_rect() const -> rbp::Rect
+{
+    if (!is_dirty()) {
+        return rbp::Rect{0, 0, 0, 0};
+    }
+    return rbp::Rect{m_dirty_x0, m_dirty_y0, m_dirty_x1 - m_dirty_x0, m_dirty_y1 - m_dirty_y0};
+}
+
+auto Glyph_atlas::entry_count() const -> std::size_t
+{
+    return m_entries.size();
+}
+
+auto Glyph_atlas::get_statistics() const -> const Glyph_atlas_statistics&
+{
+    return m_statistics;
+}
+
+} // namespace erhe::ui
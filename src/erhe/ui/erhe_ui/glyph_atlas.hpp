@@ -0,0 +1,87 @@
+#pragma once
+
+#include "erhe_ui/bitmap.hpp"
+
+#include <MaxRectsBinPack.h> // RectangleBinPack
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace erhe::ui
+{
+
+class Glyph_atlas_entry
+{
+public:
+    uint32_t  key      {0};
+    rbp::Rect rect     {0, 0, 0, 0}; // atlas space, excluding 1 pixel border
+    uint64_t  last_used{0};          // frame number
+};
+
+class Glyph_atlas_statistics
+{
+public:
+    uint64_t hit_count     {0};
+    uint64_t miss_count    {0};
+    uint64_t eviction_count{0}; // entries evicted
+    uint64_t rebuild_count {0}; // packer rebuilds after eviction
+};
+
+// Incrementally packed glyph atlas page kept in a CPU side bitmap.
+// Entries are allocated on first use and evicted in least recently used
+// order when the page is full. Entries used in the current frame are never
+// evicted, and entries never move once allocated. Modified pixels are
+// tracked as a single dirty rectangle, which the owner uploads to GPU.
+// Does not depend on freetype or graphics, so it can be used with any
+// rasterizer.
+class Glyph_atlas final
+{
+public:
+    Glyph_atlas(int width, int height, Bitmap::component_t components);
+
+    // Entries used after this are protected from eviction until next call
+    void begin_frame();
+
+    // Returns nullptr if key is not resident. Marks entry as used.
+    [[nodiscard]] auto find(uint32_t key) -> const Glyph_atlas_entry*;
+
+    // Returns nullptr if key is not resident. Does not mark entry as used.
+    [[nodiscard]] auto get(uint32_t key) const -> const Glyph_atlas_entry*;
+
+    // Returns nullptr if width x height does not fit even after evicting all
+    // entries not used in the current frame. Caller writes pixels to
+    // bitmap() inside the returned rect and calls mark_dirty().
+    [[nodiscard]] auto allocate(uint32_t key, int width, int height) -> const Glyph_atlas_entry*;
+
+    void clear();
+    void mark_dirty(const rbp::Rect& rect);
+    void clear_dirty();
+
+    [[nodiscard]] auto width         () const -> int;
+    [[nodiscard]] auto height        () const -> int;
+    [[nodiscard]] auto bitmap        () -> Bitmap&;
+    [[nodiscard]] auto bitmap        () const -> const Bitmap&;
+    [[nodiscard]] auto is_dirty      () const -> bool;
+    [[nodiscard]] auto dirty_rect    () const -> rbp::Rect;
+    [[nodiscard]] auto entry_count   () const -> std::size_t;
+    [[nodiscard]] auto get_statistics() const -> const Glyph_atlas_statistics&;
+
+private:
+    [[nodiscard]] auto insert(int width, int height) -> rbp::Rect;
+    [[nodiscard]] auto evict (int min_area) -> bool;
+    void rebuild_packer();
+
+    Bitmap                                          m_bitmap;
+    rbp::MaxRectsBinPack                            m_packer;
+    std::unordered_map<uint32_t, Glyph_atlas_entry> m_entries;
+    std::vector<const Glyph_atlas_entry*>           m_eviction_candidates;
+    uint64_t                                        m_frame     {1};
+    int                                             m_dirty_x0  {0};
+    int                                             m_dirty_y0  {0};
+    int                                             m_dirty_x1  {0};
+    int                                             m_dirty_y1  {0};
+    Glyph_atlas_statistics                          m_statistics;
+};
+
+} // namespace erhe::ui